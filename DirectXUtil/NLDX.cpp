@@ -27,6 +27,7 @@ using xziar::nailang::ArgLimits;
 using xziar::nailang::AutoVarHandler;
 using xziar::nailang::NailangRuntime;
 using xziar::nailang::NailangRuntimeException;
+using xziar::nailang::TextRope;
 using xziar::nailang::detail::ExceptionTarget;
 using common::mlog::LogLevel;
 using common::str::Encoding;
@@ -227,7 +228,7 @@ std::unique_ptr<xcomp::InstanceContext> NLDXRawExecutor::PrepareInstance(const x
     return std::make_unique<KernelContext>(static_cast<uint8_t>(kerId));
 }
 
-void NLDXRawExecutor::OutputInstance(const xcomp::OutputBlock& block, std::u32string& output)
+void NLDXRawExecutor::OutputInstance(const xcomp::OutputBlock& block, TextRope& output)
 {
     const auto kerCount = static_cast<NLDXContext&>(GetContext()).GetKernelCount();
     auto& kerCtx = GetCurInstance();
@@ -266,7 +267,7 @@ void NLDXRawExecutor::OutputInstance(const xcomp::OutputBlock& block, std::u32st
     // prefixes
     kerCtx.WritePrefixes(output);
     // content
-    output.append(kerCtx.Content);
+    output.Append(std::move(kerCtx.Content));
     // suffixes
     kerCtx.WriteSuffixes(output);
     output.append(U"}\r\n"sv);
@@ -274,7 +275,7 @@ void NLDXRawExecutor::OutputInstance(const xcomp::OutputBlock& block, std::u32st
         output.append(U"#endif\r\n"sv);
 }
 
-void NLDXRawExecutor::ProcessStruct(const xcomp::OutputBlock& block, std::u32string& output)
+void NLDXRawExecutor::ProcessStruct(const xcomp::OutputBlock& block, TextRope& output)
 {
     auto frame = XCNLRawExecutor::PushFrame(block, CreateContext(), nullptr);
 
@@ -335,7 +336,7 @@ NLDXRawExecutor::MetaFuncResult NLDXRawExecutor::HandleMetaFunc(FuncPack& meta,
     return NLDXExecutor::HandleMetaFunc(meta, allMetas);
 }
 
-void NLDXRawExecutor::OnReplaceFunction(std::u32string& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args)
+void NLDXRawExecutor::OnReplaceFunction(TextRope& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args)
 {
     if (func == U"unroll"sv)
     {
@@ -667,7 +668,7 @@ void NLDXRuntime::HandleInstanceArg(const xcomp::InstanceArgInfo& arg, xcomp::In
     }
 }
 
-void NLDXRuntime::BeforeFinishOutput(std::u32string&, std::u32string& structs, std::u32string&, std::u32string&)
+void NLDXRuntime::BeforeFinishOutput(TextRope&, TextRope& structs, TextRope&, TextRope&)
 {
     std::u32string bindings = U"\r\n/* Bounded Resources */\r\n"s;
 
@@ -931,6 +932,7 @@ std::string NLDXProcessor::GenerateDX(NLDXProgStub& stub) const
     auto str = stub.Runtime->GenerateOutput();
     constexpr std::u32string_view postacts[] = { U"xcomp.PostAct"sv, U"dxu.PostAct"sv };
     stub.PostAct(postacts);
+    stub.ReportProfile();
     return str;
 }
 
@@ -976,6 +978,9 @@ std::shared_ptr<xcomp::XCNLProgram> NLDXProcessor::Parse(common::span<const std:
     logger.info(u"Translate into [utf32] for [{}] chars.\n", src.size());
     const auto prog = xcomp::XCNLProgram::Create(std::move(src), std::move(fileName));
     logger.verbose(u"Parse finished, get [{}] Blocks.\n", prog->GetProgram().Size());
+    const auto& opt = prog->GetOptStats();
+    logger.verbose(u"Optimized in [{:.3f}]ms, folded [{}] exprs and [{}] funcs, decided [{}] metas, removed [{}] statements.\n",
+        opt.TimeNs / 1e6, opt.FoldedExprs, opt.FoldedFuncs, opt.DecidedMetas, opt.RemovedStatements);
     return prog;
 }
 
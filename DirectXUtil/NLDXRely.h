@@ -52,7 +52,7 @@ struct KernelContext : public xcomp::InstanceContext
     }
     forceinline constexpr uint32_t GetWorkgroupSize() const noexcept { return WorkgroupSize; }
 protected:
-    std::vector<NamedText> Attributes;
+    NamedTextList Attributes;
     uint32_t WorkgroupSize = 0;
     uint8_t KernelId = 0;
 };
@@ -145,11 +145,11 @@ private:
     [[nodiscard]] XCNLExecutor& GetExecutor() noexcept final;
     [[nodiscard]] const XCNLExecutor& GetExecutor() const noexcept final;
     [[nodiscard]] std::unique_ptr<xcomp::InstanceContext> PrepareInstance(const xcomp::OutputBlock& block) final;
-    void OutputInstance(const xcomp::OutputBlock& block, std::u32string& output) final;
-    void ProcessStruct(const xcomp::OutputBlock& block, std::u32string& output) final;
+    void OutputInstance(const xcomp::OutputBlock& block, xziar::nailang::TextRope& output) final;
+    void ProcessStruct(const xcomp::OutputBlock& block, xziar::nailang::TextRope& output) final;
     [[nodiscard]] bool HandleInstanceMeta(xziar::nailang::FuncPack& meta);
     [[nodiscard]] MetaFuncResult HandleMetaFunc(xziar::nailang::FuncPack& meta, xziar::nailang::MetaSet& allMetas) final;
-    void OnReplaceFunction(std::u32string& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args) final;
+    void OnReplaceFunction(xziar::nailang::TextRope& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args) final;
 protected:
     forceinline KernelContext& GetCurInstance() const { return static_cast<KernelContext&>(GetInstanceInfo()); }
 public:
@@ -202,7 +202,7 @@ protected:
 
     [[nodiscard]] xcomp::OutputBlock::BlockType GetBlockType(const RawBlock& block, MetaFuncs metas) const noexcept final;
     void HandleInstanceArg(const xcomp::InstanceArgInfo& arg, xcomp::InstanceContext& ctx, const xziar::nailang::FuncPack& meta, const xziar::nailang::Arg* source) final;
-    void BeforeFinishOutput(std::u32string& prefixes, std::u32string& structs, std::u32string& globals, std::u32string& kernels) final;
+    void BeforeFinishOutput(xziar::nailang::TextRope& prefixes, xziar::nailang::TextRope& structs, xziar::nailang::TextRope& globals, xziar::nailang::TextRope& kernels) final;
 public:
     [[nodiscard]] static std::u32string_view GetDXTypeName(xcomp::VTypeInfo info) noexcept;
     NLDXRuntime(common::mlog::MiniLogger<false>& logger, std::shared_ptr<NLDXContext> evalCtx);
@@ -9,6 +9,7 @@ using std::u16string;
 using std::vector;
 using common::BaseException;
 using common::SimpleTimer;
+using common::PromiseResult;
 using common::fs::path;
 using xziar::img::Image;
 using xziar::img::ImageDataType;
@@ -22,50 +23,48 @@ struct FontInfo
     uint8_t w, h;
 };
 
-void FontCreator::loadCL(const string& src)
+PromiseResult<oclProgram> FontCreator::loadCL(const string& src)
 {
-    oclProgram clProg;
-    try
-    {
-        auto stub = oclProgram_::Create(clCtx, src);
-        oclu::CLProgConfig config;
-        config.Flags.insert("-cl-fast-relaxed-math");
-        config.Defines["LOC_MEM_SIZE"] = clCtx->Devices[0]->LocalMemSize;
-        stub.Build(config);
-        clProg = stub.Finish();
-    }
-    catch (const OCLException& cle)
+    auto stub = oclProgram_::Create(clCtx, src);
+    oclu::CLProgConfig config;
+    config.Flags.insert("-cl-fast-relaxed-math");
+    config.Defines["LOC_MEM_SIZE"] = clCtx->Devices[0]->LocalMemSize;
+    return std::move(stub).BuildAsync(std::move(config));
+}
+
+PromiseResult<oclProgram> FontCreator::loadDownSampler(const string& src)
+{
+    auto stub = oclProgram_::Create(clCtx, src);
+    oclu::CLProgConfig config;
+    if (clCtx->GetVendor() == Vendors::NVIDIA)
     {
-        fntLog().error(u"Fail to build opencl Program:{}\n{}\n", cle.Message(), cle.GetDetailMessage());
-        COMMON_THROW(BaseException, u"build Program error");
+        config.Flags.insert({"-cl-kernel-arg-info", "-cl-nv-verbose"});
+        config.Defines.Add("NVIDIA");
     }
-    kerSdf = clProg->GetKernel("bmpsdf");
-    kerSdfGray = clProg->GetKernel("graysdf");
-    kerSdfGray4 = clProg->GetKernel("graysdf4");
+    config.Defines["LOC_MEM_SIZE"] = clCtx->Devices[0]->LocalMemSize;
+    return std::move(stub).BuildAsync(std::move(config));
 }
 
-void FontCreator::loadDownSampler(const string& src)
+void FontCreator::loadKernels(const string& src)
 {
-    oclProgram clProg;
+    oclProgram progSdf, progDownSamp;
     try
     {
-        auto stub = oclProgram_::Create(clCtx, src);
-        oclu::CLProgConfig config;
-        if (clCtx->GetVendor() == Vendors::NVIDIA)
-        {
-            config.Flags.insert({"-cl-kernel-arg-info", "-cl-nv-verbose"});
-            config.Defines.Add("NVIDIA");
-        }
-        config.Defines["LOC_MEM_SIZE"] = clCtx->Devices[0]->LocalMemSize;
-        stub.Build(config);
-        clProg = stub.Finish();
+        // both programs are built concurrently
+        const auto pmsSdf = loadCL(src);
+        const auto pmsDownSamp = loadDownSampler(LoadShaderFromDLL(IDR_SHADER_DWNSAMP));
+        progSdf = pmsSdf->Get();
+        progDownSamp = pmsDownSamp->Get();
     }
     catch (const OCLException& cle)
     {
         fntLog().error(u"Fail to build opencl Program:{}\n{}\n", cle.Message(), cle.GetDetailMessage());
         COMMON_THROW(BaseException, u"build Program error");
     }
-    kerDownSamp = clProg->GetKernel("avg16");// "downsample4");
+    kerSdf = progSdf->GetKernel("bmpsdf");
+    kerSdfGray = progSdf->GetKernel("graysdf");
+    kerSdfGray4 = progSdf->GetKernel("graysdf4");
+    kerDownSamp = progDownSamp->GetKernel("avg16");// "downsample4");
 }
 
 FontCreator::FontCreator(const oclu::oclContext ctx) : clCtx(ctx)
@@ -83,8 +82,7 @@ FontCreator::FontCreator(const oclu::oclContext ctx) : clCtx(ctx)
             lut[i] = i * i * 65536.0f;
     }
     
-    loadCL(LoadShaderFromDLL(IDR_SHADER_SDFTEST));
-    loadDownSampler(LoadShaderFromDLL(IDR_SHADER_DWNSAMP));
+    loadKernels(LoadShaderFromDLL(IDR_SHADER_SDFTEST));
     testTex = oglTex2DDynamic_::Create();
     testTex->SetProperty(TextureFilterVal::Nearest, TextureWrapVal::Repeat);
 }
@@ -105,8 +103,7 @@ void FontCreator::reload(const string& src)
     kerSdf.reset();
     kerSdfGray.reset();
     kerDownSamp.reset();
-    loadCL(src);
-    loadDownSampler(LoadShaderFromDLL(IDR_SHADER_DWNSAMP));
+    loadKernels(src);
 }
 
 void FontCreator::setChar(char32_t ch) const
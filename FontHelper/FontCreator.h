@@ -21,8 +21,9 @@ private:
     oclu::oclBuffer sq256lut;
     oclu::oclContext clCtx;
     oclu::oclCmdQue clQue;
-    void loadCL(const std::string& src);
-    void loadDownSampler(const std::string& src);
+    [[nodiscard]] common::PromiseResult<oclu::oclProgram> loadCL(const std::string& src);
+    [[nodiscard]] common::PromiseResult<oclu::oclProgram> loadDownSampler(const std::string& src);
+    void loadKernels(const std::string& src);
 public:
     FontCreator(const oclu::oclContext ctx);
     ~FontCreator();
@@ -0,0 +1,308 @@
+#include "ImageUtilPch.h"
+#include "ColorLUT.h"
+
+
+namespace xziar::img
+{
+using common::BaseException;
+using common::SimpleTimer;
+
+
+namespace lut
+{
+// pixels processed per batch, each batch is converted into RGBA float then looked up in place
+static constexpr size_t BatchPixels = 1024;
+// half max, used as the linear value of the last LogP1 entry, avoids inf/inf in tone mapping
+static constexpr float LinearMax = 65504.0f;
+
+static constexpr float LogUEScale = 1.0f / 14.0f;
+static constexpr float LogUEBias = 444.0f / 1023.0f;
+static const float LogUEMidGray = std::log2(0.18f) / 14.0f;
+
+static forceinline float ToneMap(const LUTToneMap toneMap, const float color, const float exposure) noexcept
+{
+    const float lum = exposure * color;
+    switch (toneMap)
+    {
+    case LUTToneMap::ACES:
+    {
+        constexpr float A = 2.51f, B = 0.03f, C = 2.43f, D = 0.59f, E = 0.14f;
+        return (lum * (A * lum + B)) / (lum * (C * lum + D) + E);
+    }
+    case LUTToneMap::Reinhard:
+        return lum / (lum + 1.0f);
+    case LUTToneMap::Exp:
+        return 1.0f - std::exp(-lum);
+    default:
+        return color;
+    }
+}
+static forceinline float LinearToSRGB(const float color) noexcept
+{
+    return color <= 0.00304f ? 12.92f * color : 1.055f * std::pow(color, 1.0f / 2.4f) - 0.055f;
+}
+static forceinline float DecodeRange(const LUTRange range, const float val) noexcept
+{
+    if (range == LUTRange::LogUE)
+        return std::exp2((val - LogUEBias) * 14.0f) * 0.18f;
+    return val < 1.0f ? val / (1.0f - val) : LinearMax;
+}
+static forceinline float EncodeRange(const LUTRange range, const float val) noexcept
+{
+    if (range == LUTRange::LogUE)
+        return val > 0 ? std::log2(val) * LogUEScale - LogUEMidGray + LogUEBias : 0.0f;
+    return val > 0 ? val / (val + 1.0f) : 0.0f;
+}
+
+// turn linear RGB of RGBA pixels into lut coordinate (scaled to [0, size-1]), alpha is kept
+static void EncodeRows(float* data, const size_t count, const LUTRange range, const float scale) noexcept
+{
+    size_t i = 0;
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20
+    if (range == LUTRange::LogP1)
+    {
+        const auto zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), scale4 = _mm_set1_ps(scale);
+        const auto maskRGB = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        for (; i < count; ++i)
+        {
+            const auto pix = _mm_loadu_ps(data + i * 4);
+            const auto val = _mm_max_ps(pix, zero); // also flush NaN to 0
+            const auto coord = _mm_mul_ps(_mm_div_ps(val, _mm_add_ps(val, one)), scale4);
+            _mm_storeu_ps(data + i * 4, _mm_or_ps(_mm_and_ps(maskRGB, coord), _mm_andnot_ps(maskRGB, pix)));
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        for (uint8_t c = 0; c < 3; ++c)
+            data[i * 4 + c] = EncodeRange(range, data[i * 4 + c]) * scale;
+    }
+}
+
+// weighted sum of [N] lut entries, written to RGB of [out]
+template<size_t N>
+static forceinline void Blend(const float* base, const std::array<uint32_t, N>& offsets, const std::array<float, N>& weights, float* out) noexcept
+{
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20
+    auto sum = _mm_mul_ps(_mm_load_ps(base + offsets[0]), _mm_set1_ps(weights[0]));
+    for (size_t i = 1; i < N; ++i)
+    {
+# if COMMON_SIMD_LV >= 150
+        sum = _mm_fmadd_ps(_mm_load_ps(base + offsets[i]), _mm_set1_ps(weights[i]), sum);
+# else
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(base + offsets[i]), _mm_set1_ps(weights[i])));
+# endif
+    }
+    const float alpha = out[3];
+    _mm_storeu_ps(out, sum);
+    out[3] = alpha;
+#else
+    float sum[3] = { 0.f, 0.f, 0.f };
+    for (size_t i = 0; i < N; ++i)
+    {
+        for (uint8_t c = 0; c < 3; ++c)
+            sum[c] += base[offsets[i] + c] * weights[i];
+    }
+    out[0] = sum[0], out[1] = sum[1], out[2] = sum[2];
+#endif
+}
+
+// look up one pixel, RGB of [pix] holds lut coordinate and is replaced with the result
+template<LUTInterp Interp>
+static forceinline void SampleOne(const float* lut, const uint32_t size, float* pix) noexcept
+{
+    const float maxCoord = static_cast<float>(size - 1);
+    const std::array<uint32_t, 3> strides = { 4u, size * 4u, size * size * 4u };
+    uint32_t offset = 0;
+    float frac[3];
+    for (uint8_t c = 0; c < 3; ++c)
+    {
+        const auto coord = std::min(pix[c] > 0 ? pix[c] : 0.0f, maxCoord); // NaN goes to 0
+        const auto idx = std::min(static_cast<uint32_t>(coord), size - 2);
+        frac[c] = coord - static_cast<float>(idx);
+        offset += idx * strides[c];
+    }
+    const float* base = lut + offset;
+    if constexpr (Interp == LUTInterp::Tetrahedral)
+    {
+        // walk from c000 to c111 along axes in descending order of fraction
+        uint8_t a = 0, b = 1, c = 2;
+        if (frac[a] < frac[b]) std::swap(a, b);
+        if (frac[b] < frac[c]) std::swap(b, c);
+        if (frac[a] < frac[b]) std::swap(a, b);
+        const uint32_t o1 = strides[a], o2 = o1 + strides[b], o3 = o2 + strides[c];
+        Blend<4>(base, { 0u, o1, o2, o3 }, { 1.0f - frac[a], frac[a] - frac[b], frac[b] - frac[c], frac[c] }, pix);
+    }
+    else
+    {
+        const float r1 = frac[0], g1 = frac[1], b1 = frac[2], r0 = 1.0f - r1, g0 = 1.0f - g1, b0 = 1.0f - b1;
+        const uint32_t sg = strides[1], sb = strides[2];
+        Blend<8>(base, { 0u, 4u, sg, sg + 4u, sb, sb + 4u, sb + sg, sb + sg + 4u },
+            { r0 * g0 * b0, r1 * g0 * b0, r0 * g1 * b0, r1 * g1 * b0, r0 * g0 * b1, r1 * g0 * b1, r0 * g1 * b1, r1 * g1 * b1 }, pix);
+    }
+}
+
+template<LUTInterp Interp>
+static void SampleRows(const float* lut, const uint32_t size, float* data, const size_t count) noexcept
+{
+    for (size_t i = 0; i < count; ++i)
+        SampleOne<Interp>(lut, size, data + i * 4);
+}
+
+static forceinline uint8_t ToUNorm8(const float val) noexcept
+{
+    return static_cast<uint8_t>(std::clamp(val, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+}
+
+
+ColorLUT3D::ColorLUT3D(const uint32_t size, const LUTRange range) :
+    Data(size_t(size) * size * size * 4 * sizeof(float)), Size(size), Range(range)
+{ }
+
+void ColorLUT3D::ProcessRows(float* data, const size_t count, const bool needEncode, const LUTInterp interp) const noexcept
+{
+    if (needEncode)
+        lut::EncodeRows(data, count, Range, static_cast<float>(Size - 1));
+    if (interp == LUTInterp::Tetrahedral)
+        lut::SampleRows<LUTInterp::Tetrahedral>(Data.GetRawPtr<float>(), Size, data, count);
+    else
+        lut::SampleRows<LUTInterp::Trilinear>(Data.GetRawPtr<float>(), Size, data, count);
+}
+
+ColorLUT3D ColorLUT3D::Bake(const uint32_t size, const LUTToneMap toneMap, const float exposure, const LUTRange range, uint32_t threads)
+{
+    if (size < 2)
+        COMMON_THROW(BaseException, u"lut size should be at least 2");
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    ColorLUT3D lut(size, range);
+    const auto data = lut.Data.GetRawPtr<float>();
+    const float step = 1.0f / (size - 1);
+    // every entry only depends on its own channel value, so compute per-axis curve once
+    std::vector<float> curve(size);
+    for (uint32_t i = 0; i < size; ++i)
+        curve[i] = lut::LinearToSRGB(lut::ToneMap(toneMap, lut::DecodeRange(range, i * step), exposure));
+    ParallelFor(size, threads, [&](const size_t b)
+    {
+        auto ptr = data + b * size * size * 4;
+        for (uint32_t g = 0; g < size; ++g)
+        {
+            for (uint32_t r = 0; r < size; ++r)
+            {
+                *ptr++ = curve[r];
+                *ptr++ = curve[g];
+                *ptr++ = curve[b];
+                *ptr++ = 1.0f;
+            }
+        }
+    });
+    return lut;
+}
+
+std::array<float, 3> ColorLUT3D::Sample(const float r, const float g, const float b, const LUTInterp interp) const noexcept
+{
+    alignas(16) float pix[4] = { r, g, b, 1.0f };
+    const float scale = static_cast<float>(Size - 1);
+    for (uint8_t c = 0; c < 3; ++c)
+        pix[c] = lut::EncodeRange(Range, pix[c]) * scale;
+    if (interp == LUTInterp::Tetrahedral)
+        lut::SampleOne<LUTInterp::Tetrahedral>(Data.GetRawPtr<float>(), Size, pix);
+    else
+        lut::SampleOne<LUTInterp::Trilinear>(Data.GetRawPtr<float>(), Size, pix);
+    return { pix[0], pix[1], pix[2] };
+}
+
+Image ColorLUT3D::Apply(const ImageRegion& image, const LUTInterp interp, uint32_t threads) const
+{
+    const auto dtype = image.GetDataType();
+    if (REMOVE_MASK(dtype, ImageDataType::ALPHA_MASK, ImageDataType::FLOAT_MASK) != ImageDataType::RGB)
+        COMMON_THROW(BaseException, u"only RGB/RGBA image is supported");
+    Image output(dtype);
+    const uint32_t width = image.GetWidth(), height = image.GetHeight();
+    if (width == 0 || height == 0)
+        return output;
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const bool isFloat = HAS_FIELD(dtype, ImageDataType::FLOAT_MASK);
+    const uint8_t channel = HAS_FIELD(dtype, ImageDataType::ALPHA_MASK) ? 4 : 3;
+    // 8bit input only has 256 levels, so encode them once
+    std::array<float, 256> coordTable;
+    for (uint32_t i = 0; i < 256; ++i)
+        coordTable[i] = lut::EncodeRange(Range, i / 255.0f) * static_cast<float>(Size - 1);
+    output.SetSize(width, height, false);
+
+    SimpleTimer timer;
+    timer.Start();
+    const size_t batchPerRow = (width + lut::BatchPixels - 1) / lut::BatchPixels;
+    ParallelFor(height * batchPerRow, threads, [&](const size_t batch)
+    {
+        const auto row = static_cast<uint32_t>(batch / batchPerRow);
+        const auto colBegin = (batch % batchPerRow) * lut::BatchPixels;
+        const auto count = std::min(lut::BatchPixels, width - colBegin);
+        alignas(16) float buf[lut::BatchPixels * 4];
+        if (isFloat)
+        {
+            const auto src = image.GetRawPtr<float>(row) + colBegin * channel;
+            auto dst = output.GetRawPtr<float>(row) + colBegin * channel;
+            if (channel == 4)
+                memcpy(buf, src, count * 4 * sizeof(float));
+            else
+            {
+                for (size_t i = 0; i < count; ++i)
+                    buf[i * 4 + 0] = src[i * 3 + 0], buf[i * 4 + 1] = src[i * 3 + 1], buf[i * 4 + 2] = src[i * 3 + 2];
+            }
+            ProcessRows(buf, count, true, interp);
+            for (size_t i = 0; i < count; ++i, dst += channel)
+            {
+                dst[0] = buf[i * 4 + 0], dst[1] = buf[i * 4 + 1], dst[2] = buf[i * 4 + 2];
+                if (channel == 4)
+                    dst[3] = src[i * 4 + 3];
+            }
+        }
+        else
+        {
+            const auto src = image.GetRawPtr<uint8_t>(row) + colBegin * channel;
+            auto dst = output.GetRawPtr<uint8_t>(row) + colBegin * channel;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto pix = src + i * channel;
+                buf[i * 4 + 0] = coordTable[pix[0]], buf[i * 4 + 1] = coordTable[pix[1]], buf[i * 4 + 2] = coordTable[pix[2]];
+            }
+            ProcessRows(buf, count, false, interp);
+            for (size_t i = 0; i < count; ++i, dst += channel)
+            {
+                dst[0] = lut::ToUNorm8(buf[i * 4 + 0]), dst[1] = lut::ToUNorm8(buf[i * 4 + 1]), dst[2] = lut::ToUNorm8(buf[i * 4 + 2]);
+                if (channel == 4)
+                    dst[3] = src[i * 4 + 3];
+            }
+        }
+    });
+    timer.Stop();
+    ImgLog().debug(u"[lut]apply on [{}x{}] with [{}] threads, cost {} ms\n", width, height, threads, timer.ElapseMs());
+    return output;
+}
+
+void ColorLUT3D::ApplyHalf(common::span<uint16_t> pixels, const LUTInterp interp, uint32_t threads) const
+{
+    if (pixels.size() % 4 != 0)
+        COMMON_THROW(BaseException, u"RGBA16F data should have 4 elements for each pixel");
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t count = pixels.size() / 4;
+    const size_t batches = (count + lut::BatchPixels - 1) / lut::BatchPixels;
+    ParallelFor(batches, threads, [&](const size_t batch)
+    {
+        const auto begin = batch * lut::BatchPixels;
+        const auto num = std::min(lut::BatchPixels, count - begin);
+        const auto ptr = pixels.data() + begin * 4;
+        alignas(16) float buf[lut::BatchPixels * 4];
+        common::CopyEx.CopyFloat(buf, ptr, num * 4);
+        ProcessRows(buf, num, true, interp);
+        common::CopyEx.CopyFloat(ptr, buf, num * 4);
+    });
+}
+
+
+}
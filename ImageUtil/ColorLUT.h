@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ImageUtilRely.h"
+#include "ImageCore.h"
+#include <array>
+
+
+namespace xziar::img
+{
+
+enum class LUTToneMap : uint8_t { None = 0, ACES, Reinhard, Exp };
+// how linear color is mapped into lut coordinate, LogP1 is used by ColorLUT.cl, LogUE is used by ColorLUT.glsl
+enum class LUTRange : uint8_t { LogP1 = 0, LogUE };
+enum class LUTInterp : uint8_t { Trilinear = 0, Tetrahedral };
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+/*3D color lut on CPU, entries are RGBA float with R changing fastest, same as the 3D texture generated on GPU*/
+class IMGUTILAPI ColorLUT3D
+{
+private:
+    common::AlignedBuffer Data;
+    uint32_t Size;
+    LUTRange Range;
+    ColorLUT3D(const uint32_t size, const LUTRange range);
+    void ProcessRows(float* data, const size_t count, const bool needEncode, const LUTInterp interp) const noexcept;
+public:
+    ///<summary>Bake the lut with the same math as ColorLUT.cl</summary>
+    ///<param name="size">entries for each axis</param>
+    ///<param name="toneMap">tone mapping curve</param>
+    ///<param name="exposure">linear exposure multiplier</param>
+    ///<param name="range">coordinate encoding of the lut</param>
+    ///<param name="threads">threads to use, 0 means hardware concurrency</param>
+    ///<returns>baked lut</returns>
+    [[nodiscard]] static ColorLUT3D Bake(const uint32_t size, const LUTToneMap toneMap, const float exposure,
+        const LUTRange range = LUTRange::LogP1, uint32_t threads = 0);
+
+    [[nodiscard]] uint32_t GetSize() const noexcept { return Size; }
+    [[nodiscard]] LUTRange GetRange() const noexcept { return Range; }
+    [[nodiscard]] common::span<const float> GetData() const noexcept
+    {
+        return { Data.GetRawPtr<float>(), Data.GetSize() / sizeof(float) };
+    }
+
+    ///<summary>Look up a single linear color, the reference path</summary>
+    [[nodiscard]] std::array<float, 3> Sample(const float r, const float g, const float b, const LUTInterp interp = LUTInterp::Tetrahedral) const noexcept;
+    ///<summary>Apply lut to a scene-linear image, alpha is kept</summary>
+    ///<param name="image">source image, RGB/RGBA, 8bit or float</param>
+    ///<param name="interp">interpolation method</param>
+    ///<param name="threads">threads to use, 0 means hardware concurrency</param>
+    ///<returns>image of the same datatype, 8bit result is already sRGB-encoded by the lut</returns>
+    [[nodiscard]] Image Apply(const ImageRegion& image, const LUTInterp interp = LUTInterp::Tetrahedral, uint32_t threads = 0) const;
+    ///<summary>Apply lut to RGBA16F pixels in place</summary>
+    ///<param name="pixels">RGBA half data</param>
+    ///<param name="interp">interpolation method</param>
+    ///<param name="threads">threads to use, 0 means hardware concurrency</param>
+    void ApplyHalf(common::span<uint16_t> pixels, const LUTInterp interp = LUTInterp::Tetrahedral, uint32_t threads = 0) const;
+};
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
+
+}
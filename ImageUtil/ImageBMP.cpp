@@ -208,7 +208,7 @@ BmpWriter::BmpWriter(RandomOutputStream& stream) : Stream(stream)
 {
 }
 
-void BmpWriter::Write(const Image& image, const uint8_t)
+void BmpWriter::Write(const ImageRegion& image, const uint8_t)
 {
     if (image.GetWidth() > INT32_MAX || image.GetHeight() > INT32_MAX)
         return;
@@ -241,21 +241,20 @@ void BmpWriter::Write(const Image& image, const uint8_t)
     if (image.IsGray())//must be ImageDataType::Gray only
     {
         Stream.WriteFrom(convert::GrayToRGBAMAP);
-        if (frowsize == irowsize)
+        if (frowsize == irowsize && image.IsContinuous())
             Stream.Write(image.GetSize(), image.GetRawPtr());
         else
         {
-            const byte* __restrict imgptr = image.GetRawPtr();
             const uint8_t empty[4] = { 0 };
             const size_t padding = frowsize - irowsize;
             for (uint32_t i = 0; i < image.GetHeight(); ++i)
             {
-                Stream.Write(irowsize, imgptr);
+                Stream.Write(irowsize, image.GetRawPtr(i));
                 Stream.Write(padding, empty);
             }
         }
     }
-    else if (frowsize == irowsize && isInputBGR)//perfect match, write directly
+    else if (frowsize == irowsize && isInputBGR && image.IsContinuous())//perfect match, write directly
         Stream.Write(image.GetSize(), image.GetRawPtr());
     else
     {
@@ -64,7 +64,7 @@ private:
 public:
     BmpWriter(common::io::RandomOutputStream& stream);
     virtual ~BmpWriter() override {};
-    virtual void Write(const Image& image, const uint8_t quality) override;
+    virtual void Write(const ImageRegion& image, const uint8_t quality) override;
 };
 
 
@@ -0,0 +1,215 @@
+#include "ImageUtilPch.h"
+#include "ImageBlur.h"
+
+
+namespace xziar::img
+{
+using common::BaseException;
+using common::SimpleTimer;
+
+
+std::array<float, 4> ComputeIIRCoeff(const float sigma) noexcept
+{
+    double q1;
+    if (sigma >= 2.5)
+        q1 = 0.98711 * sigma - 0.96330;
+    else if (sigma >= 0.5)
+        q1 = 3.97156 - 4.14554 * std::sqrt(1 - 0.26891 * sigma);
+    else
+        q1 = 0.1147705018520355224609375;
+    const double q2 = q1 * q1, q3 = q1 * q2;
+    const double b0 = 1 / (1.57825 + (2.44413 * q1) + (1.4281 * q2) + (0.422205 * q3));
+    std::array<float, 4> coeff;
+    coeff[1] = (float)(((2.44413 * q1) + (2.85619 * q2) + (1.26661 * q3)) * b0);
+    coeff[2] = (float)((                 -(1.4281 * q2) - (1.26661 * q3)) * b0);
+    coeff[3] = (float)((                                 (0.422205 * q3)) * b0);
+    coeff[0] = (float) (1 - coeff[1] - coeff[2] - coeff[3]);
+    return coeff;
+}
+
+
+namespace blur
+{
+// lanes per block, horizontal pass transposes [BlockRows] rows into [x][row*channel] so lanes are continuous
+static constexpr uint32_t BlockRows = 8;
+// floats per strip of vertical pass, each strip is processed by one thread
+static constexpr size_t StripLanes = 256;
+
+// cur = c0 * cur + c1 * p1 + c2 * p2 + c3 * p3, in-place on [cur]
+static void IIRStep(float* cur, const float* p1, const float* p2, const float* p3, const size_t count, const std::array<float, 4>& coeff) noexcept
+{
+    size_t i = 0;
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 100
+    {
+        const auto c0 = _mm256_set1_ps(coeff[0]), c1 = _mm256_set1_ps(coeff[1]), c2 = _mm256_set1_ps(coeff[2]), c3 = _mm256_set1_ps(coeff[3]);
+        for (; i + 8 <= count; i += 8)
+        {
+            const auto x = _mm256_loadu_ps(cur + i);
+            const auto y1 = _mm256_loadu_ps(p1 + i), y2 = _mm256_loadu_ps(p2 + i), y3 = _mm256_loadu_ps(p3 + i);
+# if COMMON_SIMD_LV >= 150
+            auto y = _mm256_mul_ps(x, c0);
+            y = _mm256_fmadd_ps(y1, c1, y);
+            y = _mm256_fmadd_ps(y2, c2, y);
+            y = _mm256_fmadd_ps(y3, c3, y);
+# else
+            const auto y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, c0), _mm256_mul_ps(y1, c1)), _mm256_add_ps(_mm256_mul_ps(y2, c2), _mm256_mul_ps(y3, c3)));
+# endif
+            _mm256_storeu_ps(cur + i, y);
+        }
+    }
+#endif
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20
+    {
+        const auto c0 = _mm_set1_ps(coeff[0]), c1 = _mm_set1_ps(coeff[1]), c2 = _mm_set1_ps(coeff[2]), c3 = _mm_set1_ps(coeff[3]);
+        for (; i + 4 <= count; i += 4)
+        {
+            const auto x = _mm_loadu_ps(cur + i);
+            const auto y1 = _mm_loadu_ps(p1 + i), y2 = _mm_loadu_ps(p2 + i), y3 = _mm_loadu_ps(p3 + i);
+            const auto y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, c0), _mm_mul_ps(y1, c1)), _mm_add_ps(_mm_mul_ps(y2, c2), _mm_mul_ps(y3, c3)));
+            _mm_storeu_ps(cur + i, y);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+        cur[i] = cur[i] * coeff[0] + p1[i] * coeff[1] + p2[i] * coeff[2] + p3[i] * coeff[3];
+}
+
+// forward then backward along [lines] lines, each line has [count] lanes and lines are [step] floats apart
+// history before the first line is the first input, history after the last line is the last forward output
+static void IIRLines(float* data, const size_t lines, const size_t step, const size_t count, float* border, const std::array<float, 4>& coeff) noexcept
+{
+    const auto line = [&](const size_t idx) { return data + idx * step; };
+    memcpy(border, line(0), count * sizeof(float));
+    for (size_t i = 0; i < lines; ++i)
+        IIRStep(line(i), i >= 1 ? line(i - 1) : border, i >= 2 ? line(i - 2) : border, i >= 3 ? line(i - 3) : border, count, coeff);
+    memcpy(border, line(lines - 1), count * sizeof(float));
+    for (size_t i = lines; i-- > 0;)
+        IIRStep(line(i), i + 1 < lines ? line(i + 1) : border, i + 2 < lines ? line(i + 2) : border, i + 3 < lines ? line(i + 3) : border, count, coeff);
+}
+
+// sRGB decode table for 8bit input, and encode table indexed by linear value
+struct SRGBTable
+{
+    static constexpr uint32_t EncodeSize = 16384;
+    std::array<float, 256> ToLinear;
+    std::array<uint8_t, EncodeSize> FromLinear;
+    SRGBTable() noexcept
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            const auto val = i / 255.0;
+            ToLinear[i] = static_cast<float>(val <= 0.04045 ? val / 12.92 : std::pow((val + 0.055) / 1.055, 2.4));
+        }
+        for (uint32_t i = 0; i < EncodeSize; ++i)
+        {
+            const auto val = i / double(EncodeSize - 1);
+            const auto srgb = val <= 0.0031308 ? val * 12.92 : 1.055 * std::pow(val, 1 / 2.4) - 0.055;
+            FromLinear[i] = static_cast<uint8_t>(std::clamp(srgb * 255 + 0.5, 0.0, 255.0));
+        }
+    }
+    static const SRGBTable& Get() noexcept
+    {
+        static const SRGBTable table;
+        return table;
+    }
+};
+
+}
+
+
+Image GaussianBlurIIR(const ImageRegion& image, const float sigma, const bool isSRGB, uint32_t threads)
+{
+    if (HAS_FIELD(image.GetDataType(), ImageDataType::FLOAT_MASK))
+        COMMON_THROW(BaseException, u"float image not supported yet");
+    Image output(image.GetDataType());
+    const uint32_t width = image.GetWidth(), height = image.GetHeight();
+    if (width == 0 || height == 0)
+        return output;
+    if (threads == 0)
+        threads = common::WorkerPool::GetShared().GetThreadCount();
+    const auto coeff = ComputeIIRCoeff(sigma);
+    const size_t channel = image.GetElementSize();
+    // alpha always occupies the last channel
+    const size_t colorChannel = HAS_FIELD(image.GetDataType(), ImageDataType::ALPHA_MASK) ? channel - 1 : channel;
+    const size_t rowLanes = width * channel;
+    const auto& table = blur::SRGBTable::Get();
+    std::array<float, 256> linearTable;
+    for (uint32_t i = 0; i < 256; ++i)
+        linearTable[i] = i * (1.0f / 255.0f);
+    const float* inTables[4];
+    for (size_t c = 0; c < channel; ++c)
+        inTables[c] = (isSRGB && c < colorChannel) ? table.ToLinear.data() : linearTable.data();
+    common::AlignedBuffer buffer(rowLanes * height * sizeof(float));
+    const auto data = buffer.GetRawPtr<float>();
+    SimpleTimer timer;
+    timer.Start();
+
+    const size_t rowBlocks = (height + blur::BlockRows - 1) / blur::BlockRows;
+    // convert and horizontal pass
+    ParallelFor(rowBlocks, threads, [&](const size_t blk)
+    {
+        const auto rowBegin = static_cast<uint32_t>(blk * blur::BlockRows);
+        const auto rows = std::min(blur::BlockRows, height - rowBegin);
+        const size_t lanes = rows * channel;
+        std::vector<float> tmp(width * lanes), border(lanes);
+        // convert and transpose into [x][row*channel]
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            auto src = image.GetRawPtr<uint8_t>(rowBegin + r);
+            auto dst = tmp.data() + r * channel;
+            for (uint32_t x = 0; x < width; ++x, src += channel, dst += lanes)
+                for (size_t c = 0; c < channel; ++c)
+                    dst[c] = inTables[c][src[c]];
+        }
+        blur::IIRLines(tmp.data(), width, lanes, lanes, border.data(), coeff);
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            auto dst = data + (rowBegin + r) * rowLanes;
+            const auto src = tmp.data() + r * channel;
+            for (uint32_t x = 0; x < width; ++x)
+                for (size_t c = 0; c < channel; ++c)
+                    *dst++ = src[x * lanes + c];
+        }
+    });
+    timer.Stop();
+    const auto timeX = timer.ElapseMs();
+
+    // vertical pass, rows are already continuous lanes
+    timer.Start();
+    const size_t strips = (rowLanes + blur::StripLanes - 1) / blur::StripLanes;
+    ParallelFor(strips, threads, [&](const size_t strip)
+    {
+        const auto laneBegin = strip * blur::StripLanes;
+        const auto lanes = std::min(blur::StripLanes, rowLanes - laneBegin);
+        std::vector<float> border(lanes);
+        blur::IIRLines(data + laneBegin, height, rowLanes, lanes, border.data(), coeff);
+    });
+    timer.Stop();
+    const auto timeY = timer.ElapseMs();
+
+    // convert back
+    timer.Start();
+    output.SetSize(width, height, false);
+    ParallelFor(height, threads, [&](const size_t row)
+    {
+        const auto src = data + row * rowLanes;
+        auto dst = output.GetRawPtr<uint8_t>(static_cast<uint32_t>(row));
+        for (size_t i = 0; i < rowLanes; i += channel)
+        {
+            for (size_t c = 0; c < channel; ++c)
+            {
+                const auto val = std::clamp(src[i + c], 0.0f, 1.0f);
+                dst[i + c] = (isSRGB && c < colorChannel) ?
+                    table.FromLinear[static_cast<uint32_t>(val * (blur::SRGBTable::EncodeSize - 1) + 0.5f)] :
+                    static_cast<uint8_t>(val * 255.0f + 0.5f);
+            }
+        }
+    });
+    timer.Stop();
+    ImgLog().debug(u"[blur]IIR on [{}x{}] with [{}] threads, X cost {} ms, Y cost {} ms, convert cost {} ms\n", 
+        width, height, threads, timeX, timeY, timer.ElapseMs());
+    return output;
+}
+
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ImageUtilRely.h"
+#include "ImageCore.h"
+#include <array>
+
+
+namespace xziar::img
+{
+
+///<summary>Young/van Vliet recursive gaussian coefficients, same as the ones used by GaussianIIR.cl</summary>  
+///<param name="sigma">sigma of gaussian</param>
+///<returns>{ B, b1, b2, b3 }</returns>
+[[nodiscard]] IMGUTILAPI std::array<float, 4> ComputeIIRCoeff(const float sigma) noexcept;
+
+///<summary>Recursive gaussian blur (forward and backward 3rd-order IIR for each axis) on CPU</summary>  
+///<param name="image">source image, only 8bit image supported</param>
+///<param name="sigma">sigma of gaussian</param>
+///<param name="isSRGB">blur color channels in linear space, alpha is always linear</param>
+///<param name="threads">threads to use from the shared worker pool, 0 means all workers</param>
+[[nodiscard]] IMGUTILAPI Image GaussianBlurIIR(const ImageRegion& image, const float sigma, const bool isSRGB = false, uint32_t threads = 0);
+
+}
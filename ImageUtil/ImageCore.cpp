@@ -110,13 +110,22 @@ void Image::PlaceImage(const Image& src, const uint32_t srcX, const uint32_t src
         return;//place self,should throw
     if (srcX >= src.Width || srcY >= src.Height || destX >= Width || destY >= Height)
         return;
+    PlaceImage(src.RegionView(srcX, srcY), destX, destY);
+}
+
+void Image::PlaceImage(const ImageRegion& src, const uint32_t destX, const uint32_t destY)
+{
+    if (src.Data >= Data && src.Data < Data + Size)
+        return;//place self,should throw
+    if (src.Width == 0 || src.Height == 0 || destX >= Width || destY >= Height)
+        return;
 
-    const byte* __restrict srcPtr = src.GetRawPtr(srcY, srcX);
+    const byte* __restrict srcPtr = src.GetRawPtr();
     byte* __restrict destPtr = GetRawPtr(destY, destX);
-    const auto srcStep = src.RowSize(), destStep = RowSize();
-    const auto copypix = std::min(Width - destX, src.Width - srcX);
-    auto rowcnt = std::min(Height - destY, src.Height - srcY);
-    const bool isCopyWholeRow = copypix == Width && Width == src.Width;
+    const auto srcStep = src.RowPitch(), destStep = RowSize();
+    const auto copypix = std::min(Width - destX, src.Width);
+    auto rowcnt = std::min(Height - destY, src.Height);
+    const bool isCopyWholeRow = copypix == Width && Width == src.Width && src.IsContinuous();
     if (src.DataType == DataType)
     {
         auto copysize = copypix * ElementSize;
@@ -213,32 +222,9 @@ void Image::Resize(uint32_t width, uint32_t height, const bool isSRGB, const boo
 
 Image Image::ResizeTo(uint32_t width, uint32_t height, const bool isSRGB, const bool mulAlpha) const
 {
-    if (width == 0 && height == 0)
-        COMMON_THROW(BaseException, u"image size cannot be all zero!");
-    width = width == 0 ? (uint32_t)((uint64_t)height * Width / Height) : width;
-    height = height == 0 ? (uint32_t)((uint64_t)width * Height / Width) : height;
-    Image output(DataType);
-    output.SetSize(width, height);
-
-    const auto datatype = HAS_FIELD(DataType, ImageDataType::FLOAT_MASK) ? STBIR_TYPE_FLOAT : STBIR_TYPE_UINT8;
-    const int32_t channel = HAS_FIELD(DataType, ImageDataType::FLOAT_MASK) ? ElementSize / sizeof(float) : ElementSize;
-    int flag = 0;
-    if (HAS_FIELD(DataType, ImageDataType::ALPHA_MASK))
-    {
-        if (!mulAlpha)
-            flag |= STBIR_FLAG_ALPHA_PREMULTIPLIED;
-    }
-    else
-        flag |= STBIR_ALPHA_CHANNEL_NONE;
-    stbir_resize(Data, (int32_t)Width, (int32_t)Height, 0, output.GetRawPtr(), (int32_t)width, (int32_t)height, 0,
-        datatype, channel, ElementSize - 1, flag,
-        STBIR_EDGE_REFLECT, STBIR_EDGE_REFLECT, STBIR_FILTER_TRIANGLE, STBIR_FILTER_TRIANGLE,
-        isSRGB ? STBIR_COLORSPACE_SRGB : STBIR_COLORSPACE_LINEAR, nullptr);
-
-    return output;
+    return RegionView().ResizeTo(width, height, isSRGB, mulAlpha);
 }
 
-
 Image Image::Region(const uint32_t x, const uint32_t y, uint32_t w, uint32_t h) const
 {
     if (w == 0) w = Width;
@@ -254,6 +240,11 @@ Image Image::Region(const uint32_t x, const uint32_t y, uint32_t w, uint32_t h)
     return newimg;
 }
 
+ImageRegion Image::RegionView(const uint32_t x, const uint32_t y, uint32_t w, uint32_t h) const
+{
+    return ImageRegion(*this, x, y, w, h);
+}
+
 Image Image::ConvertTo(const ImageDataType dataType, const uint32_t x, const uint32_t y, uint32_t w, uint32_t h) const
 {
     if (w == 0) w = Width;
@@ -290,5 +281,60 @@ Image Image::ConvertToFloat(const float floatRange) const
     }
 }
 
+ImageRegion ImageRegion::Create(const common::AlignedBuffer& data, const uint32_t width, const uint32_t height, const size_t pitch,
+    const ImageDataType dataType, const uint32_t x, const uint32_t y, uint32_t w, uint32_t h)
+{
+    if (x > width || y > height)
+        COMMON_THROW(BaseException, u"region out of image range");
+    w = w == 0 ? width - x : std::min(w, width - x);
+    h = h == 0 ? height - y : std::min(h, height - y);
+    if (w == 0 || h == 0)
+        return ImageRegion(common::AlignedBuffer(), w, h, pitch, dataType);
+    const auto eleSize = Image::GetElementSize(dataType);
+    const size_t offset = y * pitch + static_cast<size_t>(x) * eleSize;
+    const size_t size = (h - 1) * pitch + static_cast<size_t>(w) * eleSize;
+    return ImageRegion(data.CreateSubBuffer(offset, size), w, h, pitch, dataType);
+}
+
+ImageRegion ImageRegion::SubRegion(const uint32_t x, const uint32_t y, uint32_t w, uint32_t h) const
+{
+    return Create(GetData(), Width, Height, Pitch, DataType, x, y, w, h);
+}
+
+Image ImageRegion::ConvertTo(const ImageDataType dataType) const
+{
+    Image newimg(dataType);
+    newimg.SetSize(Width, Height, false);
+    newimg.PlaceImage(*this, 0, 0);
+    return newimg;
+}
+
+Image ImageRegion::ResizeTo(uint32_t width, uint32_t height, const bool isSRGB, const bool mulAlpha) const
+{
+    if (width == 0 && height == 0)
+        COMMON_THROW(BaseException, u"image size cannot be all zero!");
+    width = width == 0 ? (uint32_t)((uint64_t)height * Width / Height) : width;
+    height = height == 0 ? (uint32_t)((uint64_t)width * Height / Width) : height;
+    Image output(DataType);
+    output.SetSize(width, height);
+
+    const auto datatype = HAS_FIELD(DataType, ImageDataType::FLOAT_MASK) ? STBIR_TYPE_FLOAT : STBIR_TYPE_UINT8;
+    const int32_t channel = HAS_FIELD(DataType, ImageDataType::FLOAT_MASK) ? ElementSize / sizeof(float) : ElementSize;
+    int flag = 0;
+    if (HAS_FIELD(DataType, ImageDataType::ALPHA_MASK))
+    {
+        if (!mulAlpha)
+            flag |= STBIR_FLAG_ALPHA_PREMULTIPLIED;
+    }
+    else
+        flag |= STBIR_ALPHA_CHANNEL_NONE;
+    stbir_resize(Data, (int32_t)Width, (int32_t)Height, (int32_t)Pitch, output.GetRawPtr(), (int32_t)width, (int32_t)height, 0,
+        datatype, channel, ElementSize - 1, flag,
+        STBIR_EDGE_REFLECT, STBIR_EDGE_REFLECT, STBIR_FILTER_TRIANGLE, STBIR_FILTER_TRIANGLE,
+        isSRGB ? STBIR_COLORSPACE_SRGB : STBIR_COLORSPACE_LINEAR, nullptr);
+
+    return output;
+}
+
 }
 
@@ -24,10 +24,12 @@ enum class ImageDataType : uint8_t
 MAKE_ENUM_BITFIELD(ImageDataType)
 
 class ImageView;
+class ImageRegion;
 /*Custom Image Data Holder, with pixel data alignment promise*/
 class IMGUTILAPI Image : protected common::AlignedBuffer
 {
     friend class ImageView;
+    friend class ImageRegion;
 private:
     void ResetSize(const uint32_t width, const uint32_t height);
 protected:
@@ -134,6 +136,11 @@ public:
     ///<param name="destX">image destination's left-top position</param>
     ///<param name="destY">image destination's left-top position</param>
     void PlaceImage(const Image& other, const uint32_t srcX, const uint32_t srcY, const uint32_t destX, const uint32_t destY);
+    ///<summary>Place image region into current image</summary>  
+    ///<param name="other">image region being putted</param>
+    ///<param name="destX">image destination's left-top position</param>
+    ///<param name="destY">image destination's left-top position</param>
+    void PlaceImage(const ImageRegion& other, const uint32_t destX, const uint32_t destY);
     ///<summary>Resize the image in-place</summary>  
     ///<param name="width">width</param>
     ///<param name="height">height</param>
@@ -144,6 +151,8 @@ public:
     ///<param name="height">height</param>
     Image ResizeTo(uint32_t width, uint32_t height, const bool isSRGB = false, const bool mulAlpha = true) const;
     [[nodiscard]] Image Region(const uint32_t x = 0, const uint32_t y = 0, uint32_t w = 0, uint32_t h = 0) const;
+    ///<summary>Create a strided view of the region, sharing the data without copy</summary>  
+    [[nodiscard]] ImageRegion RegionView(const uint32_t x = 0, const uint32_t y = 0, uint32_t w = 0, uint32_t h = 0) const;
     [[nodiscard]] Image ConvertTo(const ImageDataType dataType, const uint32_t x = 0, const uint32_t y = 0, uint32_t w = 0, uint32_t h = 0) const;
     [[nodiscard]] Image ConvertToFloat(const float floatRange = 1) const;
 };
@@ -201,6 +210,7 @@ public:
     using Image::RotateTo180;
     using Image::ResizeTo;
     using Image::Region;
+    using Image::RegionView;
     using Image::ConvertTo;
     using Image::ConvertToFloat;
     using Image::IsGray;
@@ -222,6 +232,68 @@ public:
     }
 };
 
+/*Read-only strided view of an image region, shares the underlying buffer*/
+class IMGUTILAPI ImageRegion : protected common::AlignedBuffer
+{
+    friend class Image;
+private:
+    uint32_t Width, Height;
+    size_t Pitch;
+    ImageDataType DataType;
+    uint8_t ElementSize;
+    ImageRegion(common::AlignedBuffer&& data, const uint32_t width, const uint32_t height, const size_t pitch, const ImageDataType dataType) noexcept :
+        common::AlignedBuffer(std::move(data)), Width(width), Height(height), Pitch(pitch), DataType(dataType), ElementSize(Image::GetElementSize(dataType))
+    { }
+    // [w] and [h] are clamped to the source, 0 means till the end
+    static ImageRegion Create(const common::AlignedBuffer& data, const uint32_t width, const uint32_t height, const size_t pitch, 
+        const ImageDataType dataType, const uint32_t x, const uint32_t y, uint32_t w, uint32_t h);
+public:
+    ImageRegion(const Image& image, const uint32_t x = 0, const uint32_t y = 0, const uint32_t w = 0, const uint32_t h = 0) :
+        ImageRegion(Create(image.GetData(), image.Width, image.Height, image.RowSize(), image.DataType, x, y, w, h)) { }
+    ImageRegion(const ImageView& imgview, const uint32_t x = 0, const uint32_t y = 0, const uint32_t w = 0, const uint32_t h = 0) :
+        ImageRegion(imgview.AsRawImage(), x, y, w, h) { }
+
+    [[nodiscard]] uint32_t      GetWidth()       const noexcept { return Width;       }
+    [[nodiscard]] uint32_t      GetHeight()      const noexcept { return Height;      }
+    [[nodiscard]] ImageDataType GetDataType()    const noexcept { return DataType;    }
+    [[nodiscard]] uint8_t       GetElementSize() const noexcept { return ElementSize; }
+    [[nodiscard]] size_t RowSize()    const noexcept { return static_cast<size_t>(Width) * ElementSize; }
+    [[nodiscard]] size_t RowPitch()   const noexcept { return Pitch; }
+    [[nodiscard]] size_t PixelCount() const noexcept { return static_cast<size_t>(Width) * Height; }
+    // size of pixel data, excluding the gap between rows
+    [[nodiscard]] size_t GetSize()    const noexcept { return RowSize() * Height; }
+    [[nodiscard]] bool IsContinuous() const noexcept { return Pitch == RowSize() || Height <= 1; }
+    [[nodiscard]] bool IsGray() const noexcept { return REMOVE_MASK(DataType, ImageDataType::ALPHA_MASK, ImageDataType::FLOAT_MASK) == ImageDataType::GRAY; }
+    // the shared buffer, covering from the first pixel to the last pixel
+    [[nodiscard]] const common::AlignedBuffer& GetData() const noexcept
+    {
+        return *static_cast<const common::AlignedBuffer*>(this);
+    }
+
+    template<typename T = std::byte>
+    [[nodiscard]] const T* GetRawPtr(const uint32_t row = 0, const uint32_t col = 0) const noexcept
+    {
+        return reinterpret_cast<const T*>(Data + static_cast<size_t>(row) * Pitch + static_cast<size_t>(col) * ElementSize);
+    }
+    template<typename T = std::byte>
+    [[nodiscard]] std::vector<const T*> GetRowPtrs(const size_t offset = 0) const
+    {
+        std::vector<const T*> pointers(Height, nullptr);
+        for (uint32_t row = 0; row < Height; ++row)
+            pointers[row] = GetRawPtr<T>(row) + offset;
+        return pointers;
+    }
+
+    [[nodiscard]] ImageRegion SubRegion(const uint32_t x = 0, const uint32_t y = 0, uint32_t w = 0, uint32_t h = 0) const;
+    ///<summary>Copy the region into a continuous image</summary>  
+    [[nodiscard]] Image ToImage() const { return ConvertTo(DataType); }
+    [[nodiscard]] Image ConvertTo(const ImageDataType dataType) const;
+    ///<summary>Resize the region</summary>  
+    ///<param name="width">width</param>
+    ///<param name="height">height</param>
+    [[nodiscard]] Image ResizeTo(uint32_t width, uint32_t height, const bool isSRGB = false, const bool mulAlpha = true) const;
+};
+
 constexpr inline uint8_t Image::GetElementSize(const ImageDataType dataType) noexcept
 {
     const uint8_t baseSize = HAS_FIELD(dataType, ImageDataType::FLOAT_MASK) ? 4 : 1;
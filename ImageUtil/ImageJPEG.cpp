@@ -274,9 +274,27 @@ Image JpegReader::Read(const ImageDataType dataType)
         return image;
     }
 
+    if (HintWidth > 0 || HintHeight > 0)
+    {
+        // DCT-domain scaling skips most of IDCT and upsampling work, pick the smallest 1/N that still covers the fit size
+        const auto [fitW, fitH] = FitSize(decompStruct->image_width, decompStruct->image_height, HintWidth, HintHeight);
+        decompStruct->scale_denom = 8;
+        for (const uint32_t num : { 1u, 2u, 4u, 8u })
+        {
+            const auto w = (decompStruct->image_width  * num + 7) / 8;
+            const auto h = (decompStruct->image_height * num + 7) / 8;
+            if (w >= fitW && h >= fitH)
+            {
+                decompStruct->scale_num = num;
+                break;
+            }
+        }
+        ImgLog().verbose(u"LIBJPEG decode with scale {}/8 for fit size [{}x{}].\n", decompStruct->scale_num, fitW, fitH);
+    }
+
     jpeg_start_decompress(decompStruct);
 
-    image.SetSize(decompStruct->image_width, decompStruct->image_height);
+    image.SetSize(decompStruct->output_width, decompStruct->output_height);
     auto ptrs = image.GetRowPtrs(needAlpha ? image.GetWidth() : 0);
     while (decompStruct->output_scanline < decompStruct->output_height)
     {
@@ -330,7 +348,7 @@ inline JpegWriter::~JpegWriter()
         delete (jpeg_error_mgr*)JpegErrorHandler;
 }
 
-void JpegWriter::Write(const Image& image, const uint8_t quality)
+void JpegWriter::Write(const ImageRegion& image, const uint8_t quality)
 {
     if (image.GetWidth() > JPEG_MAX_DIMENSION || image.GetHeight() > JPEG_MAX_DIMENSION)
         return;
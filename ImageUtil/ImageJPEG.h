@@ -40,7 +40,7 @@ private:
 public:
     JpegWriter(common::io::RandomOutputStream& stream);
     virtual ~JpegWriter() override;
-    virtual void Write(const Image& image, const uint8_t quality) override;
+    virtual void Write(const ImageRegion& image, const uint8_t quality) override;
 };
 
 class IMGUTILAPI JpegSupport : public ImgSupport
@@ -206,6 +206,270 @@ Image PngReader::Read(const ImageDataType dataType)
 }
 
 
+namespace filter
+{
+// PNG filters on encode side only read raw bytes, so every byte is independent and can be vectorized.
+// [left] is raw[i-bpp], [up] is prior[i], [upleft] is prior[i-bpp], first bpp bytes treat left/upleft as 0.
+
+static uint8_t PaethPredict(const uint8_t a, const uint8_t b, const uint8_t c) noexcept
+{
+    const int32_t p = int32_t(a) + b - c;
+    const int32_t pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+template<uint8_t Type>
+static void FilterRow(uint8_t* __restrict out, const uint8_t* __restrict cur, const uint8_t* __restrict prev, const size_t len, const size_t bpp) noexcept
+{
+    size_t i = 0;
+    for (; i < bpp; ++i) // no left
+    {
+        if constexpr (Type == 1) out[i] = cur[i];
+        else if constexpr (Type == 2) out[i] = static_cast<uint8_t>(cur[i] - prev[i]);
+        else if constexpr (Type == 3) out[i] = static_cast<uint8_t>(cur[i] - (prev[i] >> 1));
+        else if constexpr (Type == 4) out[i] = static_cast<uint8_t>(cur[i] - prev[i]); // paeth(0, b, 0) = b
+        else out[i] = cur[i];
+    }
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20
+    [[maybe_unused]] const auto zero = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16)
+    {
+        const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i));
+        __m128i val;
+        if constexpr (Type == 1)
+        {
+            val = _mm_sub_epi8(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i - bpp)));
+        }
+        else if constexpr (Type == 2)
+        {
+            val = _mm_sub_epi8(x, _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i)));
+        }
+        else if constexpr (Type == 3)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i - bpp));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+            // avg_epu8 rounds up, fix to floor
+            const auto avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+            val = _mm_sub_epi8(x, avg);
+        }
+        else if constexpr (Type == 4)
+        {
+            const auto a8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i - bpp));
+            const auto b8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+            const auto c8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i - bpp));
+            const auto predict = [&](const __m128i a, const __m128i b, const __m128i c)
+            {
+                // pa = |b-c|, pb = |a-c|, pc = |a+b-2c|
+                const auto bc = _mm_sub_epi16(b, c), ac = _mm_sub_epi16(a, c);
+                const auto abs16 = [&](const __m128i v) { return _mm_max_epi16(v, _mm_sub_epi16(zero, v)); };
+                const auto pa = abs16(bc), pb = abs16(ac), pc = abs16(_mm_add_epi16(bc, ac));
+                const auto useA = _mm_andnot_si128(_mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc)), _mm_set1_epi16(-1));
+                const auto useB = _mm_andnot_si128(_mm_cmpgt_epi16(pb, pc), _mm_set1_epi16(-1));
+                const auto bOrC = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c));
+                return _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, bOrC));
+            };
+            const auto lo = predict(_mm_unpacklo_epi8(a8, zero), _mm_unpacklo_epi8(b8, zero), _mm_unpacklo_epi8(c8, zero));
+            const auto hi = predict(_mm_unpackhi_epi8(a8, zero), _mm_unpackhi_epi8(b8, zero), _mm_unpackhi_epi8(c8, zero));
+            val = _mm_sub_epi8(x, _mm_packus_epi16(lo, hi));
+        }
+        else
+        {
+            val = x;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), val);
+    }
+#endif
+    for (; i < len; ++i)
+    {
+        if constexpr (Type == 1) out[i] = static_cast<uint8_t>(cur[i] - cur[i - bpp]);
+        else if constexpr (Type == 2) out[i] = static_cast<uint8_t>(cur[i] - prev[i]);
+        else if constexpr (Type == 3) out[i] = static_cast<uint8_t>(cur[i] - ((uint32_t(cur[i - bpp]) + prev[i]) >> 1));
+        else if constexpr (Type == 4) out[i] = static_cast<uint8_t>(cur[i] - PaethPredict(cur[i - bpp], prev[i], prev[i - bpp]));
+        else out[i] = cur[i];
+    }
+}
+
+// sum of absolute value of bytes as signed, the heuristic used by libpng
+static uint64_t FilterCost(const uint8_t* data, const size_t len) noexcept
+{
+    uint64_t sum = 0;
+    size_t i = 0;
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20
+    const auto zero = _mm_setzero_si128();
+    auto acc = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16)
+    {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const auto absV = _mm_min_epu8(v, _mm_sub_epi8(zero, v)); // |int8| as uint8, -128 becomes 128
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(absV, zero));
+    }
+    alignas(16) uint64_t parts[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(parts), acc);
+    sum = parts[0] + parts[1];
+#endif
+    for (; i < len; ++i)
+    {
+        const auto v = static_cast<int8_t>(data[i]);
+        sum += static_cast<uint32_t>(v < 0 ? -v : v);
+    }
+    return sum;
+}
+
+using FilterFunc = void(*)(uint8_t* __restrict, const uint8_t* __restrict, const uint8_t* __restrict, const size_t, const size_t) noexcept;
+static constexpr FilterFunc Filters[5] = { &FilterRow<0>, &FilterRow<1>, &FilterRow<2>, &FilterRow<3>, &FilterRow<4> };
+
+// output: filter type byte + filtered row, prev should be zero row for first row
+static void FilterLine(uint8_t* out, uint8_t* tmp, const uint8_t* cur, const uint8_t* prev, const size_t len, const size_t bpp, const PngFilter filter) noexcept
+{
+    if (filter != PngFilter::Adaptive)
+    {
+        const auto type = static_cast<uint8_t>(filter);
+        out[0] = type;
+        Filters[type](out + 1, cur, prev, len, bpp);
+        return;
+    }
+    uint64_t bestCost = UINT64_MAX;
+    for (uint8_t type = 0; type < 5; ++type)
+    {
+        auto dst = type == 0 ? out + 1 : tmp;
+        Filters[type](dst, cur, prev, len, bpp);
+        const auto cost = FilterCost(dst, len);
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            out[0] = type;
+            if (type != 0)
+                memcpy(out + 1, tmp, len);
+        }
+    }
+}
+
+}
+
+
+static void WriteBE32(uint8_t* ptr, const uint32_t val) noexcept
+{
+    ptr[0] = static_cast<uint8_t>(val >> 24); ptr[1] = static_cast<uint8_t>(val >> 16);
+    ptr[2] = static_cast<uint8_t>(val >> 8);  ptr[3] = static_cast<uint8_t>(val);
+}
+static void WritePngChunk(RandomOutputStream& stream, const char(&type)[5], const uint8_t* data, const size_t size)
+{
+    uint8_t header[8];
+    WriteBE32(header, static_cast<uint32_t>(size));
+    memcpy(header + 4, type, 4);
+    auto crc = crc32(0, header + 4, 4);
+    if (size > 0)
+        crc = crc32(crc, data, static_cast<uInt>(size));
+    uint8_t tail[4];
+    WriteBE32(tail, static_cast<uint32_t>(crc));
+    stream.Write(8, header);
+    if (size > 0)
+        stream.Write(size, data);
+    stream.Write(4, tail);
+}
+
+// pigz-style: rows are splitted into chunks, each chunk is filtered and deflated independently,
+// non-last chunk ends with a sync flush so that raw deflate streams can be concatenated.
+// chunk uses previous chunk's last 32KB filtered data as dictionary, so ratio is close to single stream.
+void PngWriter::WriteParallel(const ImageRegion& image, const int compLevel, const uint32_t threads)
+{
+    const uint32_t width = image.GetWidth(), height = image.GetHeight();
+    const size_t bpp = image.GetElementSize();
+    const size_t rowBytes = size_t(width) * bpp, lineBytes = rowBytes + 1;
+    constexpr size_t ChunkTarget = 256 * 1024;
+    constexpr size_t WindowSize = 32768;
+    const uint32_t rowsPerChunk = static_cast<uint32_t>(std::clamp<size_t>(ChunkTarget / lineBytes, 1, height));
+    const size_t chunkCount = (height + rowsPerChunk - 1) / rowsPerChunk;
+    const std::vector<uint8_t> zeroRow(rowBytes, 0);
+
+    SimpleTimer timer;
+    timer.Start();
+    // filter stage
+    std::vector<uint8_t> filtered(lineBytes * height);
+    ParallelFor(chunkCount, threads, [&](const size_t chunk)
+    {
+        std::vector<uint8_t> tmp(rowBytes);
+        const auto rowBegin = static_cast<uint32_t>(chunk * rowsPerChunk), rowEnd = std::min(rowBegin + rowsPerChunk, height);
+        for (auto row = rowBegin; row < rowEnd; ++row)
+        {
+            const auto cur = image.GetRawPtr<uint8_t>(row);
+            const auto prev = row == 0 ? zeroRow.data() : image.GetRawPtr<uint8_t>(row - 1);
+            filter::FilterLine(filtered.data() + lineBytes * row, tmp.data(), cur, prev, rowBytes, bpp, Filter);
+        }
+    });
+    timer.Stop();
+    const auto filterMs = timer.ElapseMs();
+
+    // deflate stage
+    timer.Start();
+    std::vector<std::vector<uint8_t>> outputs(chunkCount);
+    std::vector<uLong> adlers(chunkCount);
+    std::atomic_bool hasError{ false };
+    ParallelFor(chunkCount, threads, [&](const size_t chunk)
+    {
+        const auto begin = filtered.data() + lineBytes * rowsPerChunk * chunk;
+        const auto size = lineBytes * (std::min<size_t>((chunk + 1) * rowsPerChunk, height) - chunk * rowsPerChunk);
+        const bool isLast = chunk + 1 == chunkCount;
+        adlers[chunk] = adler32(1, begin, static_cast<uInt>(size));
+        z_stream zs = {};
+        if (deflateInit2(&zs, compLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            hasError = true; return;
+        }
+        if (chunk > 0)
+        {
+            const auto dictSize = std::min<size_t>(WindowSize, begin - filtered.data());
+            deflateSetDictionary(&zs, begin - dictSize, static_cast<uInt>(dictSize));
+        }
+        auto& output = outputs[chunk];
+        output.resize(deflateBound(&zs, static_cast<uLong>(size)) + 16);
+        zs.next_in   = const_cast<Bytef*>(begin);
+        zs.avail_in  = static_cast<uInt>(size);
+        zs.next_out  = output.data();
+        zs.avail_out = static_cast<uInt>(output.size());
+        const auto ret = deflate(&zs, isLast ? Z_FINISH : Z_SYNC_FLUSH);
+        if ((isLast && ret != Z_STREAM_END) || (!isLast && ret != Z_OK) || zs.avail_in != 0)
+            hasError = true;
+        output.resize(zs.total_out);
+        deflateEnd(&zs);
+    });
+    if (hasError)
+        COMMON_THROW(BaseException, u"deflate failed when writing png");
+    timer.Stop();
+    ImgLog().debug(u"[png]parallel write [{}] chunks with [{}] threads, filter cost {} ms, deflate cost {} ms\n", chunkCount, threads, filterMs, timer.ElapseMs());
+
+    // assemble
+    constexpr uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    Stream.Write(8, Signature);
+    uint8_t ihdr[13];
+    WriteBE32(ihdr + 0, width);
+    WriteBE32(ihdr + 4, height);
+    ihdr[8] = 8; // bit depth
+    ihdr[9] = static_cast<uint8_t>((image.IsGray() ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGB) | 
+        (HAS_FIELD(image.GetDataType(), ImageDataType::ALPHA_MASK) ? PNG_COLOR_MASK_ALPHA : 0));
+    ihdr[10] = ihdr[11] = ihdr[12] = 0; // deflate, adaptive filtering, no interlace
+    WritePngChunk(Stream, "IHDR", ihdr, sizeof(ihdr));
+
+    uLong adler = adlers[0];
+    for (size_t i = 1; i < chunkCount; ++i)
+    {
+        const auto len = lineBytes * (std::min<size_t>((i + 1) * rowsPerChunk, height) - i * rowsPerChunk);
+        adler = adler32_combine(adler, adlers[i], static_cast<z_off_t>(len));
+    }
+    // zlib header, FLEVEL follows the level
+    const uint8_t cmf = 0x78;
+    const uint8_t flevel = compLevel < 2 ? 0 : (compLevel < 6 ? 1 : (compLevel == 6 ? 2 : 3));
+    uint8_t flg = static_cast<uint8_t>(flevel << 6);
+    flg = static_cast<uint8_t>(flg + (31 - (cmf * 256 + flg) % 31));
+    outputs.front().insert(outputs.front().begin(), { cmf, flg });
+    uint8_t trailer[4];
+    WriteBE32(trailer, static_cast<uint32_t>(adler));
+    outputs.back().insert(outputs.back().end(), trailer, trailer + 4);
+    for (const auto& output : outputs)
+        WritePngChunk(Stream, "IDAT", output.data(), output.size());
+    WritePngChunk(Stream, "IEND", nullptr, 0);
+}
+
 PngWriter::PngWriter(RandomOutputStream& stream)
     : Stream(stream), PngStruct(CreateWriteStruct()), PngInfo(CreateInfo((png_structp)PngStruct))
 {
@@ -223,7 +487,7 @@ PngWriter::~PngWriter()
     }
 }
 
-void PngWriter::Write(const Image& image, const uint8_t quality)
+void PngWriter::Write(const ImageRegion& image, const uint8_t quality)
 {
     // [0,75]=0, [76,82]=1, [83,87]=2, [88,90]=3, [91,92]=4, [93,94]=5, [95,96]=6, [97,98]=7, [99]=8, [100]=9
     const auto compLevel = static_cast<uint16_t>(std::pow((quality - 1)*0.01, 8) * 10);
@@ -234,14 +498,32 @@ void PngWriter::Write(const Image& image, const uint8_t quality)
         return;
     Stream.SetPos(0);
 
+    const bool isBGR = REMOVE_MASK(image.GetDataType(), ImageDataType::ALPHA_MASK, ImageDataType::FLOAT_MASK) == ImageDataType::BGR;
+    const uint32_t threads = Threads > 0 ? Threads : 
+        (image.GetSize() >= ParallelMinSize ? common::WorkerPool::GetShared().GetThreadCount() : 1u);
+    if (threads > 1 && !isBGR)
+    {
+        WriteParallel(image, compLevel, threads);
+        return;
+    }
+
     const auto alphaMask = HAS_FIELD(image.GetDataType(), ImageDataType::ALPHA_MASK) ? PNG_COLOR_MASK_ALPHA : 0;
     const auto colorMask = image.IsGray() ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGB;
     const auto colorType = alphaMask | colorMask;
     png_set_IHDR(pngStruct, pngInfo, image.GetWidth(), image.GetHeight(), 8, colorType, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
     png_set_compression_level(pngStruct, compLevel);
+    switch (Filter)
+    {
+    case PngFilter::None:       png_set_filter(pngStruct, 0, PNG_FILTER_NONE);  break;
+    case PngFilter::Sub:        png_set_filter(pngStruct, 0, PNG_FILTER_SUB);   break;
+    case PngFilter::Up:         png_set_filter(pngStruct, 0, PNG_FILTER_UP);    break;
+    case PngFilter::Average:    png_set_filter(pngStruct, 0, PNG_FILTER_AVG);   break;
+    case PngFilter::Paeth:      png_set_filter(pngStruct, 0, PNG_FILTER_PAETH); break;
+    default:                    png_set_filter(pngStruct, 0, PNG_ALL_FILTERS);  break;
+    }
     png_write_info(pngStruct, pngInfo);
 
-    if (REMOVE_MASK(image.GetDataType(), ImageDataType::ALPHA_MASK, ImageDataType::FLOAT_MASK) == ImageDataType::BGR)
+    if (isBGR)
         png_set_swap_alpha(pngStruct);
 
     auto ptrs = image.GetRowPtrs();
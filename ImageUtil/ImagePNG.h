@@ -21,16 +21,27 @@ public:
     [[nodiscard]] virtual Image Read(const ImageDataType dataType) override;
 };
 
+enum class PngFilter : uint8_t { None = 0, Sub = 1, Up = 2, Average = 3, Paeth = 4, Adaptive = 0xff };
+
 class IMGUTILAPI PngWriter : public ImgWriter
 {
 private:
     common::io::RandomOutputStream& Stream;
     void *PngStruct = nullptr;
     void *PngInfo = nullptr;
+    void WriteParallel(const ImageRegion& image, const int compLevel, const uint32_t threads);
 public:
+    // fixed filter for all rows, or adaptive (per-row minimum sum of absolute differences)
+    PngFilter Filter = PngFilter::Adaptive;
+    // threads for chunked parallel deflate, 1 means always use libpng,
+    // 0 (default) means all workers of the shared pool when the image has at least [ParallelMinSize] bytes, otherwise libpng.
+    // both paths produce valid PNG of the same pixels, but the bytes differ
+    uint32_t Threads = 0;
+    // minimal image size in bytes to use parallel deflate when [Threads] is 0, smaller image is not worth the threads
+    size_t ParallelMinSize = 4 * 1024 * 1024;
     PngWriter(common::io::RandomOutputStream& stream);
     virtual ~PngWriter() override;
-    virtual void Write(const Image& image, const uint8_t quality) override;
+    virtual void Write(const ImageRegion& image, const uint8_t quality) override;
 };
 
 class IMGUTILAPI PngSupport : public ImgSupport
@@ -198,8 +198,13 @@ static void WriteToFile(void *context, void *data, int size)
     stream.Write(size, data);
 }
 
-void StbWriter::Write(const Image& image, const uint8_t quality)
+void StbWriter::Write(const ImageRegion& image, const uint8_t quality)
 {
+    if (!image.IsContinuous() && TargetType != ImgType::PNG) // only png writer accepts stride
+    {
+        Write(image.ToImage(), quality);
+        return;
+    }
     const auto width = static_cast<int32_t>(image.GetWidth()), height = static_cast<int32_t>(image.GetHeight());
     const int32_t reqComp = Image::GetElementSize(image.GetDataType());
 
@@ -207,7 +212,7 @@ void StbWriter::Write(const Image& image, const uint8_t quality)
     switch (TargetType)
     {
     case ImgType::BMP:  ret = stbi_write_bmp_to_func(&WriteToFile, &Stream, width, height, reqComp, image.GetRawPtr()); break;
-    case ImgType::PNG:  ret = stbi_write_png_to_func(&WriteToFile, &Stream, width, height, reqComp, image.GetRawPtr(), 0); break;
+    case ImgType::PNG:  ret = stbi_write_png_to_func(&WriteToFile, &Stream, width, height, reqComp, image.GetRawPtr(), static_cast<int32_t>(image.RowPitch())); break;
     case ImgType::TGA:  ret = stbi_write_tga_to_func(&WriteToFile, &Stream, width, height, reqComp, image.GetRawPtr()); break;
     case ImgType::JPG:  ret = stbi_write_jpg_to_func(&WriteToFile, &Stream, width, height, reqComp, image.GetRawPtr(), quality); break;
     default:            COMMON_THROW(BaseException, u"unsupported image type");
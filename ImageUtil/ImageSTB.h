@@ -31,7 +31,7 @@ private:
 public:
     StbWriter(common::io::RandomOutputStream& stream, const std::u16string& ext);
     virtual ~StbWriter() override;
-    virtual void Write(const Image& image, const uint8_t quality) override;
+    virtual void Write(const ImageRegion& image, const uint8_t quality) override;
 };
 
 class IMGUTILAPI StbSupport : public ImgSupport
@@ -14,8 +14,27 @@ namespace xziar::img
 class IMGUTILAPI ImgReader : public common::NonCopyable
 {
 protected:
+    // size that result will be shrinked to fit into, 0 means no limit
+    uint32_t HintWidth = 0, HintHeight = 0;
 public:
     virtual ~ImgReader() {}
+    // reader may decode at a reduced size (no smaller than the fit size) when format supports it
+    void SetSizeHint(const uint32_t width, const uint32_t height) noexcept
+    {
+        HintWidth = width; HintHeight = height;
+    }
+    // size of shrinking [width, height] to fit into [maxWidth, maxHeight] with aspect kept, never enlarge
+    [[nodiscard]] static constexpr std::pair<uint32_t, uint32_t> FitSize(const uint32_t width, const uint32_t height, 
+        const uint32_t maxWidth, const uint32_t maxHeight) noexcept
+    {
+        const uint32_t mw = maxWidth == 0 ? width : maxWidth, mh = maxHeight == 0 ? height : maxHeight;
+        if (width <= mw && height <= mh)
+            return { width, height };
+        if (uint64_t(width) * mh > uint64_t(height) * mw) // limited by width
+            return { mw, std::max<uint32_t>(static_cast<uint32_t>(uint64_t(height) * mw / width), 1u) };
+        else
+            return { std::max<uint32_t>(static_cast<uint32_t>(uint64_t(width) * mh / height), 1u), mh };
+    }
     [[nodiscard]] virtual bool Validate() = 0;
     [[nodiscard]] virtual Image Read(const ImageDataType dataType) = 0;
 };
@@ -24,7 +43,7 @@ class IMGUTILAPI ImgWriter : public common::NonCopyable
 {
 public:
     virtual ~ImgWriter() {};
-    virtual void Write(const Image& image, const uint8_t quality) = 0;
+    virtual void Write(const ImageRegion& image, const uint8_t quality) = 0;
 };
 
 class IMGUTILAPI ImgSupport
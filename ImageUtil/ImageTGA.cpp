@@ -1,5 +1,7 @@
 #include "ImageUtilPch.h"
 #include "ImageTGA.h"
+#include "SystemCommon/MiscIntrins.h"
+#include "common/MemoryStream.hpp"
 
 namespace xziar::img::tga
 {
@@ -340,251 +342,191 @@ public:
         }
     }
 
-    template<typename Writer>
-    static void WriteRLEColor3(const Image& image, Writer& writer)
+    // bit j is set when pixel[j] == pixel[j+1], covers [Count] pixels, reads [ElementSize + 16] bytes
+    template<uint8_t ElementSize>
+    struct NeighborEq
     {
-        if (image.GetElementSize() != 3)
-            return;
-        const uint32_t colMax = image.GetWidth() * 3;//tga's limit should promise this will not overflow
-        for (uint32_t row = 0; row < image.GetHeight(); ++row)
+        static constexpr uint32_t Count = ElementSize == 1 ? 16 : (ElementSize == 3 ? 5 : 4);
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20
+        static uint32_t Mask(const uint8_t* ptr) noexcept
         {
-            const uint8_t * __restrict data = image.GetRawPtr<uint8_t>(row);
-            uint32_t last = 0;
-            uint32_t len = 0;
-            bool repeat = false;
-            for (uint32_t col = 0; col < colMax; col += 3, ++len)
+            const auto cur  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+            const auto next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + ElementSize));
+            if constexpr (ElementSize == 1)
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(cur, next)));
+            else if constexpr (ElementSize == 4)
+                return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(cur, next))));
+            else
             {
-                uint32_t cur = data[col] + (data[col + 1] << 8) + (data[col + 2] << 16);
-                switch (len)
-                {
-                case 0:
-                    break;
-                case 1:
-                    repeat = (cur == last);
-                    break;
-                default:
-                    if (cur == last && !repeat)//changed
-                    {
-                        WriteRLE3((const byte*)&data[col - len], len - 1, false, writer);
-                        len = 1, repeat = true;
-                    }
-                    else if (cur != last && repeat)//changed
-                    {
-                        WriteRLE3((const byte*)&data[col - len], len, true, writer);
-                        len = 0, repeat = false;
-                    }
-                }
-                last = cur;
+                // pixel equal only when all 3 bytes equal, check bit 0,3,6,9,12
+                const auto m = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(cur, next)));
+                const auto all = m & (m >> 1) & (m >> 2) & 0x1249u;
+                return GatherBits(all);
             }
-            if (len > 0)
-                WriteRLE3((const byte*)&data[image.GetWidth() - len], len, repeat, writer);
         }
-    }
-
-    template<typename Writer>
-    static void WriteRLEColor4(const Image& image, Writer& writer)
+        // gather bit 0,3,6,9,12 to bit 0~4
+        static constexpr uint32_t GatherBits(const uint32_t val) noexcept
+        {
+            return (val & 0x1u) | ((val >> 2) & 0x2u) | ((val >> 4) & 0x4u) | ((val >> 6) & 0x8u) | ((val >> 8) & 0x10u);
+        }
+#endif
+    };
+    
+    // find first idx in [idx, count-1) whose (pixel[idx] == pixel[idx+1]) matches [wantEqual], return count-1 when not found
+    template<uint8_t ElementSize>
+    static uint32_t FindNeighbor(const uint8_t* __restrict data, uint32_t idx, const uint32_t count, const bool wantEqual) noexcept
     {
-        if (image.GetElementSize() != 4)
-            return;
-        for (uint32_t row = 0; row < image.GetHeight(); ++row)
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20
+        using Eq = NeighborEq<ElementSize>;
+        constexpr uint32_t FullMask = (1u << Eq::Count) - 1;
+        const size_t totalBytes = size_t(count) * ElementSize;
+        while (size_t(idx) * ElementSize + ElementSize + 16 <= totalBytes)
         {
-            const uint32_t * __restrict data = image.GetRawPtr<uint32_t>(row);
-            uint32_t last = 0;
-            uint32_t len = 0;
-            bool repeat = false;
-            for (uint32_t col = 0; col < image.GetWidth(); ++col, ++len)
-            {
-                switch (len)
-                {
-                case 0:
-                    break;
-                case 1:
-                    repeat = (data[col] == last);
-                    break;
-                default:
-                    if (data[col] == last && !repeat)//changed
-                    {
-                        WriteRLE4((const byte*)&data[col - len], len - 1, false, writer);
-                        len = 1, repeat = true;
-                    }
-                    else if (data[col] != last && repeat)//changed
-                    {
-                        WriteRLE4((const byte*)&data[col - len], len, true, writer);
-                        len = 0, repeat = false;
-                    }
-                }
-                last = data[col];
-            }
-            if (len > 0)
-                WriteRLE4((const byte*)&data[image.GetWidth() - len], len, repeat, writer);
+            auto mask = Eq::Mask(data + size_t(idx) * ElementSize);
+            if (!wantEqual)
+                mask = ~mask & FullMask;
+            if (mask)
+                return idx + common::MiscIntrin.TailZero(mask);
+            idx += Eq::Count;
+        }
+#endif
+        for (; idx + 1 < count; ++idx)
+        {
+            const auto ptr = data + size_t(idx) * ElementSize;
+            if ((memcmp(ptr, ptr + ElementSize, ElementSize) == 0) == wantEqual)
+                return idx;
         }
+        return count - 1;
     }
-    template<typename Writer>
-    static void WriteRLEGray(const Image& image, Writer& writer)
+
+    template<uint8_t ElementSize, typename Writer>
+    static void WriteRLE(const ImageRegion& image, Writer& writer)
     {
-        if (image.GetElementSize() != 1)
+        if (image.GetElementSize() != ElementSize)
             return;
+        const uint32_t width = image.GetWidth();
         for (uint32_t row = 0; row < image.GetHeight(); ++row)
         {
-            const byte * __restrict data = image.GetRawPtr(row);
-            byte last{};
-            uint32_t len = 0;
-            bool repeat = false;
-            for (uint32_t col = 0; col < image.GetWidth(); ++col, ++len)
+            const uint8_t * __restrict data = image.GetRawPtr<uint8_t>(row);
+            uint32_t col = 0;
+            while (col < width)
             {
-                switch (len)
-                {
-                case 0:
-                    break;
-                case 1:
-                    repeat = (data[col] == last);
-                    break;
-                default:
-                    if (data[col] == last && !repeat)//changed
-                    {
-                        WriteRLE1(&data[col - len], len - 1, false, writer);
-                        len = 1, repeat = true;
-                    }
-                    else if (data[col] != last && repeat)//changed
-                    {
-                        WriteRLE1(&data[col - len], len, true, writer);
-                        len = 0, repeat = false;
-                    }
-                }
-                last = data[col];
+                const auto ptr = data + size_t(col) * ElementSize;
+                const bool repeat = col + 1 < width && memcmp(ptr, ptr + ElementSize, ElementSize) == 0;
+                // repeat: [col, end] are same; literal: [col, end) has no repeat, end is the start of next run
+                auto end = FindNeighbor<ElementSize>(data, col, width, !repeat);
+                if (repeat || end == width - 1)
+                    end++;
+                const auto len = end - col;
+                if constexpr (ElementSize == 1)
+                    WriteRLE1(reinterpret_cast<const byte*>(ptr), len, repeat, writer);
+                else if constexpr (ElementSize == 3)
+                    WriteRLE3(reinterpret_cast<const byte*>(ptr), len, repeat, writer);
+                else
+                    WriteRLE4(reinterpret_cast<const byte*>(ptr), len, repeat, writer);
+                col = end;
             }
-            if (len > 0)
-                WriteRLE1(&data[image.GetWidth() - len], len, repeat, writer);
         }
     }
 };
 
+//the whole payload is mapped (memory stream) or read once, runs are then decoded from memory
 //implementation promise each read should be at least a line, so no need for worry about overflow
-//reading from file is the bottleneck
-class RLEFileDecoder
+class RLEMemoryDecoder
 {
 private:
     RandomInputStream& Stream;
+    std::vector<std::byte> Holder;
+    const uint8_t* Data = nullptr;
+    size_t Size = 0, Pos = 0, BasePos = 0;
     const uint8_t ElementSize;
-    static inline uint8_t ByteToSize(const byte b)
+    bool IsLoaded = false;
+    static inline uint8_t ByteToSize(const uint8_t b) noexcept
     {
-        return std::to_integer<uint8_t>(b & byte(0x7f)) + 1;
+        return static_cast<uint8_t>((b & 0x7f) + 1);
     }
-    bool Read1(size_t limit, uint8_t * __restrict output)
+    // lazy load, since color map is read from stream before indexes
+    void Load()
     {
-        while (limit)
+        if (IsLoaded)
+            return;
+        IsLoaded = true;
+        BasePos = Stream.CurrentPos();
+        if (const auto memStream = dynamic_cast<common::io::MemoryInputStream*>(&Stream); memStream)
         {
-            const byte info = *Stream.ReadByteNE();
-            const uint8_t size = ByteToSize(info);
-            if (size > limit)
-                return false;
-            limit -= size;
-            if (::HAS_FIELD(info, 0x80))
-            {
-                const auto obj = *Stream.ReadByteNE<uint8_t>();
-                common::CopyEx.BroadcastMany(output, obj, size);
-                output += size;
-                /*for (auto count = size; count--;)
-                    *output++ = obj;*/
-            }
-            else
-            {
-                if (!Stream.Read(size, output))
-                    return false;
-                output += size;
-            }
+            const auto [ptr, size] = memStream->ExposeAvaliable();
+            Data = reinterpret_cast<const uint8_t*>(ptr), Size = size;
         }
-        return true;
-    }
-    bool Read2(size_t limit, uint16_t * __restrict output)
-    {
-        while (limit)
+        else
         {
-            const byte info = *Stream.ReadByteNE();
-            const uint8_t size = ByteToSize(info);
-            if (size > limit)
-                return false;
-            limit -= size;
-            if (::HAS_FIELD(info, 0x80))
-            {
-                uint16_t obj;
-                if (!Stream.Read(obj))
-                    return false;
-                common::CopyEx.BroadcastMany(output, obj, size);
-                output += size;
-                /*for (auto count = size; count--;)
-                    *output++ = obj;*/
-            }
-            else
-            {
-                if (!Stream.Read(size * 2, output))
-                    return false;
-                output += size;
-            }
+            Holder = Stream.ReadToVector<std::byte>(Stream.GetSize() - BasePos);
+            Data = reinterpret_cast<const uint8_t*>(Holder.data()), Size = Holder.size();
         }
-        return true;
     }
-    bool Read3(size_t limit, uint8_t * __restrict output)
+    // 3-byte pixel has no broadcast, repeat a 48-byte pattern (16 pixels)
+    static void Broadcast3(uint8_t* __restrict output, const uint8_t* __restrict obj, size_t count) noexcept
     {
-        while (limit)
+        if (count >= 16)
         {
-            const byte info = *Stream.ReadByteNE();
-            const uint8_t size = ByteToSize(info);
-            if (size > limit)
-                return false;
-            limit -= size;
-            if (::HAS_FIELD(info, 0x80))
-            {
-                uint8_t obj[3];
-                if (!Stream.Read(3, obj))//use array load will keep invoke ftell(), which serverely decrease the performance
-                    return false;
-                for (auto count = size; count--;)
-                {
-                    *output++ = obj[0];
-                    *output++ = obj[1];
-                    *output++ = obj[2];
-                }
-            }
-            else
-            {
-                if (!Stream.Read(size * 3, output))
-                    return false;
-                output += size * 3;
-            }
+            uint8_t pattern[48];
+            for (size_t i = 0; i < 48; i += 3)
+                pattern[i] = obj[0], pattern[i + 1] = obj[1], pattern[i + 2] = obj[2];
+            for (; count >= 16; count -= 16, output += 48)
+                memcpy(output, pattern, 48);
         }
-        return true;
+        for (; count--; output += 3)
+            output[0] = obj[0], output[1] = obj[1], output[2] = obj[2];
     }
-    bool Read4(size_t limit, uint32_t * __restrict output)
+    template<uint8_t EleSize>
+    bool ReadN(size_t limit, uint8_t* __restrict output)
     {
         while (limit)
         {
-            const byte info = *Stream.ReadByteNE();
+            if (Pos >= Size)
+                return false;
+            const uint8_t info = Data[Pos++];
             const uint8_t size = ByteToSize(info);
             if (size > limit)
                 return false;
             limit -= size;
-            if (::HAS_FIELD(info, 0x80))
+            const size_t bytes = (info & 0x80) ? EleSize : size_t(size) * EleSize;
+            if (Pos + bytes > Size)
+                return false;
+            const auto src = Data + Pos;
+            Pos += bytes;
+            if (info & 0x80)
             {
-                uint32_t obj;
-                if (!Stream.Read(obj))
-                    return false;
-                common::CopyEx.BroadcastMany(output, obj, size);
-                output += size;
-                /*for (auto count = size; count--;)
-                    *output++ = obj;*/
+                if constexpr (EleSize == 1)
+                    common::CopyEx.BroadcastMany(output, *src, size);
+                else if constexpr (EleSize == 2)
+                {
+                    uint16_t obj;
+                    memcpy(&obj, src, 2);
+                    common::CopyEx.BroadcastMany(reinterpret_cast<uint16_t*>(output), obj, size);
+                }
+                else if constexpr (EleSize == 3)
+                    Broadcast3(output, src, size);
+                else
+                {
+                    uint32_t obj;
+                    memcpy(&obj, src, 4);
+                    common::CopyEx.BroadcastMany(reinterpret_cast<uint32_t*>(output), obj, size);
+                }
             }
             else
-            {
-                if (!Stream.Read(size * 4, output))
-                    return false;
-                output += size;
-            }
+                memcpy(output, src, bytes);
+            output += size_t(size) * EleSize;
         }
         return true;
     }
 public:
-    RLEFileDecoder(RandomInputStream& stream, const uint8_t elementDepth) 
+    RLEMemoryDecoder(RandomInputStream& stream, const uint8_t elementDepth) 
         : Stream(stream), ElementSize(elementDepth == 15 ? 2 : (elementDepth / 8)) {}
+    ~RLEMemoryDecoder()
+    {
+        if (IsLoaded) // keep stream position consistent with consumed data
+            Stream.SetPos(BasePos + Pos);
+    }
     void Skip(const size_t offset = 0) { Stream.Skip(offset); }
 
     template<typename T>
@@ -599,16 +541,17 @@ public:
 
     bool Read(const size_t len, void *ptr)
     {
+        Load();
         switch (ElementSize)
         {
         case 1:
-            return Read1(len, (uint8_t*)ptr);
+            return ReadN<1>(len, (uint8_t*)ptr);
         case 2:
-            return Read2(len / 2, (uint16_t*)ptr);
+            return ReadN<2>(len / 2, (uint8_t*)ptr);
         case 3:
-            return Read3(len / 3, (uint8_t*)ptr);
+            return ReadN<3>(len / 3, (uint8_t*)ptr);
         case 4:
-            return Read4(len / 4, (uint32_t*)ptr);
+            return ReadN<4>(len / 4, (uint8_t*)ptr);
         default:
             return false;
         }
@@ -630,7 +573,7 @@ Image TgaReader::Read(const ImageDataType dataType)
     {
         if (HAS_FIELD(Header.ImageType, detail::TGAImgType::RLE_MASK))
         {
-            RLEFileDecoder decoder(Stream, Header.PixelDepth);
+            RLEMemoryDecoder decoder(Stream, Header.PixelDepth);
             TgaHelper::ReadFromColorMapped(Header, image, Stream, decoder);
         }
         else
@@ -640,7 +583,7 @@ Image TgaReader::Read(const ImageDataType dataType)
     {
         if (HAS_FIELD(Header.ImageType, detail::TGAImgType::RLE_MASK))
         {
-            RLEFileDecoder decoder(Stream, Header.PixelDepth);
+            RLEMemoryDecoder decoder(Stream, Header.PixelDepth);
             TgaHelper::ReadDirect(Header, image, decoder);
         }
         else
@@ -669,7 +612,7 @@ TgaWriter::TgaWriter(RandomOutputStream& stream) : Stream(stream)
 {
 }
 
-void TgaWriter::Write(const Image& image, const uint8_t)
+void TgaWriter::Write(const ImageRegion& image, const uint8_t)
 {
     constexpr char identity[] = "Truevision TGA file created by zexTGA";
     if (image.GetWidth() > INT16_MAX || image.GetHeight() > INT16_MAX)
@@ -695,13 +638,20 @@ void TgaWriter::Write(const Image& image, const uint8_t)
     Stream.Write(identity);
     SimpleTimer timer;
     timer.Start();
-    //next: true image data
-    if (image.IsGray())
-        TgaHelper::WriteRLEGray(image, Stream);
-    else if (HAS_FIELD(image.GetDataType(), ImageDataType::ALPHA_MASK))
-        TgaHelper::WriteRLEColor4(image, Stream);
-    else
-        TgaHelper::WriteRLEColor3(image, Stream);
+    //next: true image data, encoded into memory then write at once
+    std::vector<byte> output;
+    // worst case is 1 flag per 128 pixels
+    output.reserve(image.GetSize() + image.GetSize() / 128 + image.GetHeight() + 16);
+    {
+        common::io::ContainerOutputStream<std::vector<byte>> writer(output);
+        if (image.IsGray())
+            TgaHelper::WriteRLE<1>(image, writer);
+        else if (HAS_FIELD(image.GetDataType(), ImageDataType::ALPHA_MASK))
+            TgaHelper::WriteRLE<4>(image, writer);
+        else
+            TgaHelper::WriteRLE<3>(image, writer);
+    }
+    Stream.Write(output.size(), output.data());
     timer.Stop();
     ImgLog().debug(u"zextga write cost {} ms\n", timer.ElapseMs());
 }
@@ -71,7 +71,7 @@ private:
 public:
     TgaWriter(common::io::RandomOutputStream& stream);
     virtual ~TgaWriter() override {};
-    virtual void Write(const Image& image, const uint8_t quality) override;
+    virtual void Write(const ImageRegion& image, const uint8_t quality) override;
 };
 
 class IMGUTILAPI TgaSupport : public ImgSupport
@@ -1,6 +1,8 @@
 #include "ImageUtilPch.h"
 #include "ImageUtil.h"
 #include "ImageSupport.hpp"
+#include "SystemCommon/WorkerPool.h"
+#include <mutex>
 
 
 namespace xziar::img
@@ -67,6 +69,11 @@ static u16string GetExtName(const common::fs::path& path)
 }
 
 Image ReadImage(const common::fs::path& path, const ImageDataType dataType)
+{
+    return ReadImage(path, 0, 0, dataType);
+}
+
+Image ReadImage(const common::fs::path& path, const uint32_t maxWidth, const uint32_t maxHeight, const ImageDataType dataType)
 {
 #if defined(USEMAP) || true
     auto stream = common::file::MapFileForRead(path);
@@ -78,10 +85,15 @@ Image ReadImage(const common::fs::path& path, const ImageDataType dataType)
     common::file::FileInputStream stream(common::file::FileObject::OpenThrow(path, OpenFlag::ReadBinary));
 #endif
     ImgLog().debug(u"Read Image {}\n", path.u16string());
-    return ReadImage(stream, GetExtName(path), dataType);
+    return ReadImage(stream, GetExtName(path), maxWidth, maxHeight, dataType);
 }
 
 Image ReadImage(RandomInputStream& stream, const std::u16string& ext, const ImageDataType dataType)
+{
+    return ReadImage(stream, ext, 0, 0, dataType);
+}
+
+Image ReadImage(RandomInputStream& stream, const std::u16string& ext, const uint32_t maxWidth, const uint32_t maxHeight, const ImageDataType dataType)
 {
     const auto extName = common::str::ToUpperEng(ext, common::str::Encoding::UTF16LE);
     auto testList = GenerateSupportList(extName, dataType, true, true);
@@ -96,7 +108,14 @@ Image ReadImage(RandomInputStream& stream, const std::u16string& ext, const Imag
                 continue;
             }
             ImgLog().debug(u"Using [{}]\n", support.Name);
+            reader->SetSizeHint(maxWidth, maxHeight);
             auto img = reader->Read(dataType);
+            if (maxWidth > 0 || maxHeight > 0)
+            {
+                const auto [w, h] = ImgReader::FitSize(img.GetWidth(), img.GetHeight(), maxWidth, maxHeight);
+                if (w != img.GetWidth() || h != img.GetHeight())
+                    img.Resize(w, h);
+            }
             return img;
         }
         catch (const BaseException& be)
@@ -107,14 +126,166 @@ Image ReadImage(RandomInputStream& stream, const std::u16string& ext, const Imag
     COMMON_THROW(BaseException, u"cannot read image");
 }
 
-void WriteImage(const Image& image, const common::fs::path & path, const uint8_t quality)
+struct BatchReadState;
+
+class BatchReadProvider : public common::BasicPromiseProvider
+{
+    friend struct BatchReadState;
+    friend class BatchReadResult;
+private:
+    std::shared_ptr<BatchReadState> State;
+    size_t Index = 0;
+public:
+    ~BatchReadProvider() override { }
+    // called once when the result is first queried, waited or awaited
+    void PreparePms() override;
+};
+
+class BatchReadResult : public common::detail::BasicResult_<Image, BatchReadProvider>
+{
+    friend struct BatchReadState;
+private:
+    std::atomic_flag Taken = ATOMIC_FLAG_INIT;
+    bool Decoding = false;
+protected:
+    [[nodiscard]] Image GetResult() override;
+public:
+    BatchReadResult() { }
+    ~BatchReadResult() override;
+};
+
+// decodes are issued in request order, at most [Window] images are being decoded or waiting to be extracted.
+// results hold the state, the state only tracks results weakly, so a dropped result is skipped.
+struct BatchReadState : public std::enable_shared_from_this<BatchReadState>
+{
+    vector<ImageReadRequest> Requests;
+    vector<std::weak_ptr<BatchReadResult>> Results;
+    std::mutex Mutex;
+    size_t NextIdx = 0;
+    size_t Pending = 0;
+    size_t Window = 0;
+    // should be called with Mutex locked
+    void IssueUntil(const size_t end)
+    {
+        for (; NextIdx < end; ++NextIdx)
+        {
+            Pending++;
+            common::WorkerPool::GetShared().Post([self = shared_from_this(), idx = NextIdx]() { self->Decode(idx); });
+        }
+    }
+    void Fill()
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (Pending < Window)
+            IssueUntil(std::min(Requests.size(), NextIdx + (Window - Pending)));
+    }
+    // someone waits for [idx], issue it even if the window is full
+    void Demand(const size_t idx)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (idx >= NextIdx)
+            IssueUntil(idx + 1);
+    }
+    void OnTaken()
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Pending--;
+        }
+        Fill();
+    }
+    vector<common::PromiseResult<Image>> Start()
+    {
+        vector<common::PromiseResult<Image>> results;
+        Results.reserve(Requests.size());
+        results.reserve(Requests.size());
+        for (size_t i = 0; i < Requests.size(); ++i)
+        {
+            auto result = std::make_shared<BatchReadResult>();
+            result->Promise.State = shared_from_this();
+            result->Promise.Index = i;
+            Results.push_back(result);
+            results.push_back(std::move(result));
+        }
+        Fill();
+        return results;
+    }
+    void Decode(const size_t idx) noexcept
+    {
+        const auto result = Results[idx].lock();
+        if (!result) // dropped before decoding
+        {
+            OnTaken();
+            return;
+        }
+        result->Decoding = true;
+        const auto& req = Requests[idx];
+        try
+        {
+            result->SetResult(ReadImage(req.Path, req.MaxWidth, req.MaxHeight, req.DataType));
+        }
+        catch (const BaseException& be)
+        {
+            result->SetException(be);
+        }
+        catch (...)
+        {
+            const auto ex = std::current_exception();
+            result->SetException(ex);
+        }
+    }
+};
+
+void BatchReadProvider::PreparePms()
+{
+    State->Demand(Index);
+}
+
+BatchReadResult::~BatchReadResult()
+{
+    // dropped after decoding started without being extracted, release its slot
+    if (Decoding && !Taken.test_and_set())
+        Promise.State->OnTaken();
+}
+Image BatchReadResult::GetResult()
+{
+    const auto notify = [&]()
+    {
+        if (!Taken.test_and_set())
+            Promise.State->OnTaken();
+    };
+    try
+    {
+        auto img = BasicResult_::GetResult();
+        notify();
+        return img;
+    }
+    catch (...)
+    {
+        notify();
+        throw;
+    }
+}
+
+vector<common::PromiseResult<Image>> ReadImages(vector<ImageReadRequest> requests, const uint32_t parallelism)
+{
+    if (requests.empty())
+        return {};
+    auto state = std::make_shared<BatchReadState>();
+    state->Requests = std::move(requests);
+    state->Window = parallelism > 0 ? parallelism : common::WorkerPool::GetShared().GetThreadCount();
+    ImgLog().debug(u"Batch reading [{}] images, [{}] at a time\n", state->Requests.size(), state->Window);
+    return state->Start();
+}
+
+void WriteImage(const ImageRegion& image, const common::fs::path & path, const uint8_t quality)
 {
     common::file::FileOutputStream stream(common::file::FileObject::OpenThrow(path, common::file::OpenFlag::CreateNewBinary));
     ImgLog().debug(u"Write Image {}\n", path.u16string());
     WriteImage(image, stream, GetExtName(path), quality);
 }
 
-void WriteImage(const Image& image, RandomOutputStream& stream, const std::u16string& ext, const uint8_t quality)
+void WriteImage(const ImageRegion& image, RandomOutputStream& stream, const std::u16string& ext, const uint8_t quality)
 {
     const auto extName = common::str::ToUpperEng(ext, common::str::Encoding::UTF16LE);
     auto testList = GenerateSupportList(extName, image.GetDataType(), false, false);
@@ -2,6 +2,7 @@
 
 #include "ImageUtilRely.h"
 #include "ImageCore.h"
+#include "SystemCommon/PromiseTask.h"
 #include "common/FileBase.hpp"
 
 
@@ -16,11 +17,33 @@ template<typename T>
     common::io::ContainerInputStream<std::vector<T>> stream(data);
     return ReadImage(stream, ext, dataType);
 }
+// read image shrinked to fit into [maxWidth, maxHeight] (aspect kept, never enlarged), 0 means no limit on that dimension.
+// reader may decode at reduced size directly (e.g, JPEG's DCT scaling), otherwise it's decoded then resized.
+[[nodiscard]] IMGUTILAPI Image ReadImage(const common::fs::path& path, const uint32_t maxWidth, const uint32_t maxHeight, const ImageDataType dataType = ImageDataType::RGBA);
+[[nodiscard]] IMGUTILAPI Image ReadImage(common::io::RandomInputStream& stream, const std::u16string& ext, const uint32_t maxWidth, const uint32_t maxHeight, const ImageDataType dataType = ImageDataType::RGBA);
+template<typename T>
+[[nodiscard]] Image ReadImage(const std::vector<T>& data, const std::u16string& ext, const uint32_t maxWidth, const uint32_t maxHeight, const ImageDataType dataType = ImageDataType::RGBA)
+{
+    common::io::ContainerInputStream<std::vector<T>> stream(data);
+    return ReadImage(stream, ext, maxWidth, maxHeight, dataType);
+}
+
+struct ImageReadRequest
+{
+    common::fs::path Path;
+    ImageDataType DataType = ImageDataType::RGBA;
+    uint32_t MaxWidth = 0, MaxHeight = 0;
+};
+// decode images concurrently on the shared common::WorkerPool, results are in the same order as requests.
+// At most [parallelism] images of this batch are being decoded or decoded but not extracted (0 means number of workers),
+// the next decode is issued when a result is extracted or dropped, which bounds the memory of the batch.
+// Querying, waiting on or adding callback to a result not issued yet issues it and all results before it.
+[[nodiscard]] IMGUTILAPI std::vector<common::PromiseResult<Image>> ReadImages(std::vector<ImageReadRequest> requests, const uint32_t parallelism = 0);
 
-IMGUTILAPI void WriteImage(const Image& image, const common::fs::path& path, const uint8_t quality = 90);
-IMGUTILAPI void WriteImage(const Image& image, common::io::RandomOutputStream& stream, const std::u16string& ext, const uint8_t quality = 90);
+IMGUTILAPI void WriteImage(const ImageRegion& image, const common::fs::path& path, const uint8_t quality = 90);
+IMGUTILAPI void WriteImage(const ImageRegion& image, common::io::RandomOutputStream& stream, const std::u16string& ext, const uint8_t quality = 90);
 template<typename T>
-[[nodiscard]] std::vector<T> WriteImage(const Image& image, const std::u16string& ext, const uint8_t quality = 90)
+[[nodiscard]] std::vector<T> WriteImage(const ImageRegion& image, const std::u16string& ext, const uint8_t quality = 90)
 {
     static_assert(sizeof(T) == 1, "only accept 1 byte element type");
     std::vector<T> output;
@@ -12,6 +12,7 @@
 #include "SystemCommon/FileMapperEx.h"
 #include "SystemCommon/CopyEx.h"
 #include "SystemCommon/StringConvert.h"
+#include "SystemCommon/WorkerPool.h"
 
 #include "common/FileBase.hpp"
 #include "common/Linq2.hpp"
@@ -23,8 +24,18 @@
 #include <cmath>
 #include <algorithm>
 #include <functional>
+#include <atomic>
+#include <thread>
 
 namespace xziar::img
 {
 common::mlog::MiniLogger<false>& ImgLog();
+
+// run [func] over [0, count) with at most [threads] threads (including caller) of the shared common::WorkerPool,
+// 0 means all workers, index is dispatched one by one
+template<typename F>
+inline void ParallelFor(const size_t count, const uint32_t threads, F&& func)
+{
+    common::WorkerPool::GetShared().ParallelFor(count, threads, std::forward<F>(func));
+}
 }
\ No newline at end of file
@@ -0,0 +1,442 @@
+#include "ImageUtilPch.h"
+#include "TexDecompress.h"
+
+
+namespace xziar::img
+{
+using common::BaseException;
+using common::SimpleTimer;
+
+
+namespace bcn
+{
+
+// expand 565 color into RGBA8 with bit replication
+static forceinline uint32_t Expand565(const uint32_t color) noexcept
+{
+    const uint32_t r = (color >> 11) & 0x1f, g = (color >> 5) & 0x3f, b = color & 0x1f;
+    return ((r << 3) | (r >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((b << 3) | (b >> 2)) << 16) | 0xff000000u;
+}
+static forceinline uint32_t Mix(const uint32_t c0, const uint32_t c1, const uint32_t w0, const uint32_t w1, const uint32_t div) noexcept
+{
+    uint32_t ret = 0xff000000u;
+    for (uint32_t shift = 0; shift < 24; shift += 8)
+        ret |= (((c0 >> shift & 0xff) * w0 + (c1 >> shift & 0xff) * w1 + div / 2) / div) << shift;
+    return ret;
+}
+template<typename T>
+static forceinline T LoadLE(const std::byte* src) noexcept
+{
+    T val;
+    memcpy(&val, src, sizeof(T));
+    return val;
+}
+
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 31
+// pshufb masks that pick 4 RGBA palette entries by a byte of 4 2-bit indices
+struct PaletteShuffle
+{
+    alignas(16) std::array<std::array<uint8_t, 16>, 256> Masks;
+    // place 4 bytes of row [r] (of 16 bytes) into byte [lane] of 4 u32, others are zeroed
+    alignas(16) std::array<std::array<std::array<uint8_t, 16>, 4>, 4> Spread;
+    PaletteShuffle() noexcept
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (uint32_t k = 0; k < 4; ++k)
+            {
+                const auto sel = static_cast<uint8_t>((i >> (k * 2)) & 0x3);
+                for (uint8_t b = 0; b < 4; ++b)
+                    Masks[i][k * 4 + b] = static_cast<uint8_t>(sel * 4 + b);
+            }
+        }
+        for (uint8_t r = 0; r < 4; ++r)
+        {
+            for (uint8_t lane = 0; lane < 4; ++lane)
+            {
+                Spread[r][lane].fill(0x80);
+                for (uint8_t k = 0; k < 4; ++k)
+                    Spread[r][lane][k * 4 + lane] = static_cast<uint8_t>(r * 4 + k);
+            }
+        }
+    }
+    static const PaletteShuffle& Get() noexcept
+    {
+        static const PaletteShuffle shuffle;
+        return shuffle;
+    }
+};
+#endif
+
+// BC1 color block, [isBC1] enables 3-color mode, [hasAlpha] makes the 4th color transparent in 3-color mode
+static forceinline void DecodeColor(const std::byte* src, uint32_t* out, const bool isBC1, const bool hasAlpha) noexcept
+{
+    const auto c0 = LoadLE<uint16_t>(src), c1 = LoadLE<uint16_t>(src + 2);
+    const auto indexes = LoadLE<uint32_t>(src + 4);
+    alignas(16) uint32_t palette[4];
+    palette[0] = Expand565(c0);
+    palette[1] = Expand565(c1);
+    if (c0 > c1 || !isBC1)
+    {
+        palette[2] = Mix(palette[0], palette[1], 2, 1, 3);
+        palette[3] = Mix(palette[0], palette[1], 1, 2, 3);
+    }
+    else
+    {
+        palette[2] = Mix(palette[0], palette[1], 1, 1, 2);
+        palette[3] = hasAlpha ? 0x0u : 0xff000000u;
+    }
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 31
+    const auto& shuffle = PaletteShuffle::Get();
+    const auto pal = _mm_load_si128(reinterpret_cast<const __m128i*>(palette));
+    for (uint32_t r = 0; r < 4; ++r)
+    {
+        const auto mask = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle.Masks[(indexes >> (r * 8)) & 0xff].data()));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + r * 4), _mm_shuffle_epi8(pal, mask));
+    }
+#else
+    for (uint32_t i = 0; i < 16; ++i)
+        out[i] = palette[(indexes >> (i * 2)) & 0x3];
+#endif
+}
+
+// BC4 style single channel block, output 16 bytes
+static forceinline void DecodeChannel(const std::byte* src, uint8_t* out) noexcept
+{
+    alignas(16) uint8_t palette[16] = { 0 };
+    const uint32_t a0 = static_cast<uint8_t>(src[0]), a1 = static_cast<uint8_t>(src[1]);
+    palette[0] = static_cast<uint8_t>(a0), palette[1] = static_cast<uint8_t>(a1);
+    if (a0 > a1)
+    {
+        for (uint32_t i = 1; i < 7; ++i)
+            palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1 + 3) / 7);
+    }
+    else
+    {
+        for (uint32_t i = 1; i < 5; ++i)
+            palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1 + 2) / 5);
+        palette[6] = 0, palette[7] = 255;
+    }
+    uint64_t indexes = 0;
+    memcpy(&indexes, src + 2, 6);
+    alignas(16) uint8_t idxs[16];
+    for (uint32_t i = 0; i < 16; ++i)
+        idxs[i] = static_cast<uint8_t>((indexes >> (i * 3)) & 0x7);
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 31
+    const auto val = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(palette)), _mm_load_si128(reinterpret_cast<const __m128i*>(idxs)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), val);
+#else
+    for (uint32_t i = 0; i < 16; ++i)
+        out[i] = palette[idxs[i]];
+#endif
+}
+
+// put 16 bytes of a channel into byte [lane] of pixels, [keepMask] selects bytes of [out] to keep
+static forceinline void MergeChannel(uint32_t* out, const uint8_t* channel, const uint8_t lane, const uint32_t keepMask) noexcept
+{
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 31
+    const auto& shuffle = PaletteShuffle::Get();
+    const auto val = _mm_loadu_si128(reinterpret_cast<const __m128i*>(channel));
+    const auto keep = _mm_set1_epi32(static_cast<int32_t>(keepMask));
+    for (uint32_t r = 0; r < 4; ++r)
+    {
+        const auto ptr = reinterpret_cast<__m128i*>(out + r * 4);
+        const auto spread = _mm_shuffle_epi8(val, _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle.Spread[r][lane].data())));
+        _mm_storeu_si128(ptr, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(ptr), keep), spread));
+    }
+#else
+    for (uint32_t i = 0; i < 16; ++i)
+        out[i] = (out[i] & keepMask) | (static_cast<uint32_t>(channel[i]) << (lane * 8));
+#endif
+}
+
+static void DecodeBC1(const std::byte* src, uint32_t* out) noexcept
+{
+    DecodeColor(src, out, true, false);
+}
+static void DecodeBC1A(const std::byte* src, uint32_t* out) noexcept
+{
+    DecodeColor(src, out, true, true);
+}
+static void DecodeBC2(const std::byte* src, uint32_t* out) noexcept
+{
+    DecodeColor(src + 8, out, false, false);
+    const auto alphas = LoadLE<uint64_t>(src);
+    alignas(16) uint8_t alpha[16];
+    for (uint32_t i = 0; i < 16; ++i)
+        alpha[i] = static_cast<uint8_t>(((alphas >> (i * 4)) & 0xf) * 17);
+    MergeChannel(out, alpha, 3, 0x00ffffffu);
+}
+static void DecodeBC3(const std::byte* src, uint32_t* out) noexcept
+{
+    DecodeColor(src + 8, out, false, false);
+    alignas(16) uint8_t alpha[16];
+    DecodeChannel(src, alpha);
+    MergeChannel(out, alpha, 3, 0x00ffffffu);
+}
+static void DecodeBC4(const std::byte* src, uint32_t* out) noexcept
+{
+    alignas(16) uint8_t red[16];
+    DecodeChannel(src, red);
+    std::fill_n(out, 16, 0xff000000u);
+    MergeChannel(out, red, 0, 0xff000000u);
+}
+static void DecodeBC5(const std::byte* src, uint32_t* out) noexcept
+{
+    alignas(16) uint8_t red[16], green[16];
+    DecodeChannel(src, red);
+    DecodeChannel(src + 8, green);
+    std::fill_n(out, 16, 0xff000000u);
+    MergeChannel(out, red, 0, 0xff000000u);
+    MergeChannel(out, green, 1, 0xff0000ffu);
+}
+
+
+// partition of each pixel (2bit each), [0,64) for 2 subsets and [64,128) for 3 subsets, same as BC7Compress.cl
+static constexpr uint32_t PatternTable[128] =
+{
+    0x50505050u, 0x40404040u, 0x54545454u, 0x54505040u, 0x50404000u, 0x55545450u, 0x55545040u, 0x54504000u,
+    0x50400000u, 0x55555450u, 0x55544000u, 0x54400000u, 0x55555440u, 0x55550000u, 0x55555500u, 0x55000000u,
+    0x55150100u, 0x00004054u, 0x15010000u, 0x00405054u, 0x00004050u, 0x15050100u, 0x05010000u, 0x40505054u,
+    0x00404050u, 0x05010100u, 0x14141414u, 0x05141450u, 0x01155440u, 0x00555500u, 0x15014054u, 0x05414150u,
+    0x44444444u, 0x55005500u, 0x11441144u, 0x05055050u, 0x05500550u, 0x11114444u, 0x41144114u, 0x44111144u,
+    0x15055054u, 0x01055040u, 0x05041050u, 0x05455150u, 0x14414114u, 0x50050550u, 0x41411414u, 0x00141400u,
+    0x00041504u, 0x00105410u, 0x10541000u, 0x04150400u, 0x50410514u, 0x41051450u, 0x05415014u, 0x14054150u,
+    0x41050514u, 0x41505014u, 0x40011554u, 0x54150140u, 0x50505500u, 0x00555050u, 0x15151010u, 0x54540404u,
+    0xAA685050u, 0x6A5A5040u, 0x5A5A4200u, 0x5450A0A8u, 0xA5A50000u, 0xA0A05050u, 0x5555A0A0u, 0x5A5A5050u,
+    0xAA550000u, 0xAA555500u, 0xAAAA5500u, 0x90909090u, 0x94949494u, 0xA4A4A4A4u, 0xA9A59450u, 0x2A0A4250u,
+    0xA5945040u, 0x0A425054u, 0xA5A5A500u, 0x55A0A0A0u, 0xA8A85454u, 0x6A6A4040u, 0xA4A45000u, 0x1A1A0500u,
+    0x0050A4A4u, 0xAAA59090u, 0x14696914u, 0x69691400u, 0xA08585A0u, 0xAA821414u, 0x50A4A450u, 0x6A5A0200u,
+    0xA9A58000u, 0x5090A0A8u, 0xA8A09050u, 0x24242424u, 0x00AA5500u, 0x24924924u, 0x24499224u, 0x50A50A50u,
+    0x500AA550u, 0xAAAA4444u, 0x66660000u, 0xA5A0A5A0u, 0x50A050A0u, 0x69286928u, 0x44AAAA44u, 0x66666600u,
+    0xAA444444u, 0x54A854A8u, 0x95809580u, 0x96969600u, 0xA85454A8u, 0x80959580u, 0xAA141414u, 0x96960000u,
+    0xAAAA1414u, 0xA05050A0u, 0xA0A5A5A0u, 0x96000000u, 0x40804080u, 0xA9A8A9A8u, 0xAAAAAA44u, 0x2A4A5254u
+};
+// anchor index of subset 1 (high 4bit) and subset 2 (low 4bit), same as BC7Compress.cl
+static constexpr uint8_t SkipTable[128] =
+{
+    0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u,
+    0xf0u, 0x20u, 0x80u, 0x20u, 0x20u, 0x80u, 0x80u, 0xf0u, 0x20u, 0x80u, 0x20u, 0x20u, 0x80u, 0x80u, 0x20u, 0x20u,
+    0xf0u, 0xf0u, 0x60u, 0x80u, 0x20u, 0x80u, 0xf0u, 0xf0u, 0x20u, 0x80u, 0x20u, 0x20u, 0x20u, 0xf0u, 0xf0u, 0x60u,
+    0x60u, 0x20u, 0x60u, 0x80u, 0xf0u, 0xf0u, 0x20u, 0x20u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0xf0u, 0x20u, 0x20u, 0xf0u,
+    0x3fu, 0x38u, 0xf8u, 0xf3u, 0x8fu, 0x3fu, 0xf3u, 0xf8u, 0x8fu, 0x8fu, 0x6fu, 0x6fu, 0x6fu, 0x5fu, 0x3fu, 0x38u,
+    0x3fu, 0x38u, 0x8fu, 0xf3u, 0x3fu, 0x38u, 0x6fu, 0xa8u, 0x53u, 0x8fu, 0x86u, 0x6au, 0x8fu, 0x5fu, 0xfau, 0xf8u,
+    0x8fu, 0xf3u, 0x3fu, 0x5au, 0x6au, 0xa8u, 0x89u, 0xfau, 0xf6u, 0x3fu, 0xf8u, 0x5fu, 0xf3u, 0xf6u, 0xf6u, 0xf8u,
+    0x3fu, 0xf3u, 0x5fu, 0x5fu, 0x5fu, 0x8fu, 0x5fu, 0xafu, 0x5fu, 0xafu, 0x8fu, 0xdfu, 0xf3u, 0xcfu, 0x3fu, 0x38u
+};
+static constexpr uint8_t WeightTable2[4] = { 0, 21, 43, 64 };
+static constexpr uint8_t WeightTable3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static constexpr uint8_t WeightTable4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+static constexpr const uint8_t* GetWeights(const uint32_t bits) noexcept
+{
+    return bits == 2 ? WeightTable2 : (bits == 3 ? WeightTable3 : WeightTable4);
+}
+
+struct BC7Mode
+{
+    uint8_t Subsets, PartBits, RotBits, IdxSelBits, ColorBits, AlphaBits, EPBits, SPBits, IdxBits, Idx2Bits;
+};
+static constexpr BC7Mode BC7Modes[8] =
+{
+    { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+    { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+    { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+    { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+    { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+    { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+    { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+    { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+struct BitReader
+{
+    uint64_t Lo, Hi;
+    uint32_t Pos = 0;
+    BitReader(const std::byte* src) noexcept : Lo(LoadLE<uint64_t>(src)), Hi(LoadLE<uint64_t>(src + 8)) { }
+    forceinline uint32_t Read(const uint32_t bits) noexcept
+    {
+        uint64_t val;
+        if (Pos >= 64)
+            val = Hi >> (Pos - 64);
+        else if (Pos + bits <= 64)
+            val = Lo >> Pos;
+        else
+            val = (Lo >> Pos) | (Hi << (64 - Pos));
+        Pos += bits;
+        return static_cast<uint32_t>(val) & ((1u << bits) - 1);
+    }
+};
+
+static void DecodeBC7(const std::byte* src, uint32_t* out) noexcept
+{
+    const auto modeByte = static_cast<uint32_t>(src[0]);
+    if (modeByte == 0) // reserved mode
+    {
+        std::fill_n(out, 16, 0u);
+        return;
+    }
+    uint32_t modeIdx = 0;
+    while (!(modeByte & (1u << modeIdx)))
+        ++modeIdx;
+    const auto& mode = BC7Modes[modeIdx];
+    BitReader reader(src);
+    reader.Pos = modeIdx + 1;
+    const auto part = reader.Read(mode.PartBits);
+    const auto rotation = reader.Read(mode.RotBits);
+    const auto idxSel = reader.Read(mode.IdxSelBits);
+
+    // [subset][endpoint][channel]
+    uint32_t eps[3][2][4];
+    for (uint32_t c = 0; c < 3; ++c)
+        for (uint32_t s = 0; s < mode.Subsets; ++s)
+            for (uint32_t e = 0; e < 2; ++e)
+                eps[s][e][c] = reader.Read(mode.ColorBits);
+    if (mode.AlphaBits > 0)
+    {
+        for (uint32_t s = 0; s < mode.Subsets; ++s)
+            for (uint32_t e = 0; e < 2; ++e)
+                eps[s][e][3] = reader.Read(mode.AlphaBits);
+    }
+    const uint32_t channels = mode.AlphaBits > 0 ? 4 : 3;
+    uint32_t colorBits = mode.ColorBits, alphaBits = mode.AlphaBits;
+    if (mode.EPBits || mode.SPBits)
+    {
+        for (uint32_t s = 0; s < mode.Subsets; ++s)
+        {
+            for (uint32_t e = 0; e < 2; ++e)
+            {
+                // shared p-bit is read once for both endpoints
+                const auto pbit = (mode.SPBits && e == 1) ? (eps[s][0][0] & 0x1) : reader.Read(1);
+                for (uint32_t c = 0; c < channels; ++c)
+                    eps[s][e][c] = (eps[s][e][c] << 1) | pbit;
+            }
+        }
+        colorBits++;
+        if (alphaBits > 0)
+            alphaBits++;
+    }
+    for (uint32_t s = 0; s < mode.Subsets; ++s)
+    {
+        for (uint32_t e = 0; e < 2; ++e)
+        {
+            for (uint32_t c = 0; c < 3; ++c)
+                eps[s][e][c] = (eps[s][e][c] << (8 - colorBits)) | (eps[s][e][c] >> (2 * colorBits - 8));
+            eps[s][e][3] = alphaBits > 0 ? ((eps[s][e][3] << (8 - alphaBits)) | (eps[s][e][3] >> (2 * alphaBits - 8))) : 255u;
+        }
+    }
+
+    uint32_t subsets[16] = { 0 };
+    uint32_t anchors[3] = { 0, 0, 0 };
+    if (mode.Subsets > 1)
+    {
+        const auto partIdx = mode.Subsets == 3 ? part + 64 : part;
+        const auto pattern = PatternTable[partIdx];
+        for (uint32_t i = 0; i < 16; ++i)
+            subsets[i] = (pattern >> (i * 2)) & 0x3;
+        anchors[1] = SkipTable[partIdx] >> 4;
+        anchors[2] = SkipTable[partIdx] & 0xf;
+    }
+    uint8_t idxs[16], idxs2[16];
+    for (uint32_t i = 0; i < 16; ++i)
+        idxs[i] = static_cast<uint8_t>(reader.Read(mode.IdxBits - (i == anchors[subsets[i]] ? 1 : 0)));
+    if (mode.Idx2Bits > 0)
+    {
+        for (uint32_t i = 0; i < 16; ++i)
+            idxs2[i] = static_cast<uint8_t>(reader.Read(mode.Idx2Bits - (i == 0 ? 1 : 0)));
+    }
+    const uint8_t* colorIdxs = idxs;
+    const uint8_t* alphaIdxs = mode.Idx2Bits > 0 ? idxs2 : idxs;
+    const uint8_t* colorWeights = GetWeights(mode.IdxBits);
+    const uint8_t* alphaWeights = GetWeights(mode.Idx2Bits > 0 ? mode.Idx2Bits : mode.IdxBits);
+    if (idxSel)
+    {
+        std::swap(colorIdxs, alphaIdxs);
+        std::swap(colorWeights, alphaWeights);
+    }
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        const auto& ep = eps[subsets[i]];
+        const uint32_t cw = colorWeights[colorIdxs[i]], aw = alphaWeights[alphaIdxs[i]];
+        uint32_t rgba[4];
+        for (uint32_t c = 0; c < 3; ++c)
+            rgba[c] = ((64 - cw) * ep[0][c] + cw * ep[1][c] + 32) >> 6;
+        rgba[3] = ((64 - aw) * ep[0][3] + aw * ep[1][3] + 32) >> 6;
+        if (rotation > 0)
+            std::swap(rgba[3], rgba[rotation - 1]);
+        out[i] = rgba[0] | (rgba[1] << 8) | (rgba[2] << 16) | (rgba[3] << 24);
+    }
+}
+
+}
+
+
+bool CanDecompressTexture(const TextureFormat format) noexcept
+{
+    switch (REMOVE_MASK(format, TextureFormat::MASK_SRGB))
+    {
+    case TextureFormat::BC1:
+    case TextureFormat::BC1A:
+    case TextureFormat::BC2:
+    case TextureFormat::BC3:
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+    case TextureFormat::BC7:
+        return true;
+    default:
+        return false;
+    }
+}
+
+Image DecompressTexture(common::span<const std::byte> data, const uint32_t width, const uint32_t height, const TextureFormat format, uint32_t threads)
+{
+    void(*decoder)(const std::byte*, uint32_t*) noexcept = nullptr;
+    size_t blockBytes = 16;
+    switch (REMOVE_MASK(format, TextureFormat::MASK_SRGB))
+    {
+    case TextureFormat::BC1:  decoder = bcn::DecodeBC1;  blockBytes = 8; break;
+    case TextureFormat::BC1A: decoder = bcn::DecodeBC1A; blockBytes = 8; break;
+    case TextureFormat::BC2:  decoder = bcn::DecodeBC2;  break;
+    case TextureFormat::BC3:  decoder = bcn::DecodeBC3;  break;
+    case TextureFormat::BC4:  decoder = bcn::DecodeBC4;  blockBytes = 8; break;
+    case TextureFormat::BC5:  decoder = bcn::DecodeBC5;  break;
+    case TextureFormat::BC7:  decoder = bcn::DecodeBC7;  break;
+    default:
+        COMMON_THROW(BaseException, u"unsupported texture format to decompress");
+    }
+    const uint32_t blockW = (width + 3) / 4, blockH = (height + 3) / 4;
+    if (data.size() < blockW * blockH * blockBytes)
+        COMMON_THROW(BaseException, u"compressed data is smaller than texture size");
+    Image output(ImageDataType::RGBA);
+    if (width == 0 || height == 0)
+        return output;
+    output.SetSize(width, height, false);
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    // avoid spawning threads for small mipmap
+    threads = std::min<uint32_t>(threads, std::max<uint32_t>(blockW * blockH / 1024, 1u));
+
+    SimpleTimer timer;
+    timer.Start();
+    ParallelFor(blockH, threads, [&](const size_t by)
+    {
+        const auto rowBegin = static_cast<uint32_t>(by * 4);
+        const auto rows = std::min(4u, height - rowBegin);
+        auto src = data.data() + by * blockW * blockBytes;
+        alignas(16) uint32_t pixels[16];
+        for (uint32_t bx = 0; bx < blockW; ++bx, src += blockBytes)
+        {
+            decoder(src, pixels);
+            const auto cols = std::min(4u, width - bx * 4);
+            for (uint32_t r = 0; r < rows; ++r)
+                memcpy(output.GetRawPtr<uint32_t>(rowBegin + r, bx * 4), pixels + r * 4, cols * sizeof(uint32_t));
+        }
+    });
+    timer.Stop();
+    ImgLog().debug(u"[bcn]decompress [{}] of [{}x{}] with [{}] threads, cost {} ms\n",
+        TexFormatUtil::GetFormatName(format), width, height, threads, timer.ElapseMs());
+    return output;
+}
+
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ImageUtilRely.h"
+#include "ImageCore.h"
+#include "TexFormat.h"
+
+
+namespace xziar::img
+{
+
+///<summary>Check if [format] can be decoded by DecompressTexture</summary>
+[[nodiscard]] IMGUTILAPI bool CanDecompressTexture(const TextureFormat format) noexcept;
+///<summary>Decode BCn compressed texture data into RGBA image on CPU</summary>
+///<param name="data">compressed blocks, row by row</param>
+///<param name="width">width of the texture</param>
+///<param name="height">height of the texture</param>
+///<param name="format">BC1/BC1A/BC2/BC3/BC4/BC5/BC7, sRGB variants are decoded as-is</param>
+///<param name="threads">threads to use, 0 means hardware concurrency</param>
+///<returns>RGBA image, BC4/BC5 fill missing color channels with 0 like GPU readback</returns>
+[[nodiscard]] IMGUTILAPI Image DecompressTexture(common::span<const std::byte> data, const uint32_t width, const uint32_t height,
+    const TextureFormat format, uint32_t threads = 0);
+
+}
@@ -0,0 +1,471 @@
+#include "ImageUtilPch.h"
+#include "TexDiskCache.h"
+#include "SystemCommon/MiscIntrins.h"
+
+
+namespace xziar::img
+{
+using std::u16string;
+using common::fs::path;
+namespace fs = common::fs;
+
+
+namespace texcache
+{
+// KTX2-like layout: header, level table, then level data aligned to LevelAlign
+static constexpr std::array<char, 8> Magic = { 'X', 'Z', 'T', 'E', 'X', 'C', '\r', '\n' };
+static constexpr uint32_t Version = 1;
+static constexpr uint32_t MaxLevels = 32;
+static constexpr uint64_t LevelAlign = 64;
+static constexpr std::u16string_view Ext = u".xztex";
+
+struct Header
+{
+    std::array<char, 8> Magic;
+    uint32_t Version;
+    uint32_t Variant;
+    TexDiskCache::Digest Source;
+    uint32_t Format;
+    uint32_t Width;
+    uint32_t Height;
+    uint32_t LevelCount;
+};
+struct LevelEntry
+{
+    uint64_t Offset;
+    uint64_t Size;
+};
+static_assert(sizeof(Header) == 64 && sizeof(LevelEntry) == 16);
+
+// records of source files, appended as [FileEntry][UTF-16 path], later ones override earlier ones
+static constexpr std::u16string_view FileIndexName = u"sources.idx";
+struct FileEntry
+{
+    TexDiskCache::Digest Hash;
+    uint64_t Size;
+    int64_t Time;
+    uint32_t PathLength;
+    uint32_t Reserved;
+};
+static_assert(sizeof(FileEntry) == 56);
+
+static std::optional<std::pair<uint64_t, int64_t>> StatFile(const path& fpath)
+{
+    std::error_code ec;
+    const auto size = fs::file_size(fpath, ec);
+    if (ec)
+        return {};
+    const auto time = fs::last_write_time(fpath, ec);
+    if (ec)
+        return {};
+    return std::pair<uint64_t, int64_t>{ size, static_cast<int64_t>(time.time_since_epoch().count()) };
+}
+static u16string FileKey(const path& fpath)
+{
+    std::error_code ec;
+    const auto absPath = fs::absolute(fpath, ec);
+    return (ec ? fpath : absPath).lexically_normal().u16string();
+}
+
+static u16string KeyToName(const TexDiskCache::Key& key)
+{
+    constexpr char16_t Hex[] = u"0123456789abcdef";
+    u16string name;
+    name.reserve(64 + 1 + 8 + Ext.size());
+    for (const auto b : key.Source)
+    {
+        name.push_back(Hex[static_cast<uint8_t>(b) >> 4]);
+        name.push_back(Hex[static_cast<uint8_t>(b) & 0xf]);
+    }
+    name.push_back(u'-');
+    for (int32_t shift = 28; shift >= 0; shift -= 4)
+        name.push_back(Hex[(key.Variant >> shift) & 0xf]);
+    name.append(Ext);
+    return name;
+}
+
+// keeps the mapping alive as long as any level is referenced
+class MappedFileInfo : public common::AlignedBuffer::ExternBufInfo
+{
+    common::file::FileMappingInputStream Stream;
+    [[nodiscard]] size_t GetSize() const noexcept override
+    {
+        return Stream.ExposeAvaliable().second;
+    }
+    [[nodiscard]] std::byte* GetPtr() const noexcept override
+    {
+        return const_cast<std::byte*>(Stream.ExposeAvaliable().first);
+    }
+public:
+    MappedFileInfo(common::file::FileMappingInputStream&& stream) noexcept : Stream(std::move(stream)) { }
+    ~MappedFileInfo() override {}
+};
+
+static common::AlignedBuffer ReadWhole(const path& fpath, const bool useMapping)
+{
+    if (useMapping)
+    {
+        try
+        {
+            return common::AlignedBuffer::CreateBuffer(std::make_unique<MappedFileInfo>(common::file::MapFileForRead(fpath)), 4096);
+        }
+        catch (const common::BaseException&)
+        { } // fallback to read
+    }
+    common::file::FileInputStream stream(common::file::FileObject::OpenThrow(fpath, common::file::OpenFlag::ReadBinary));
+    common::AlignedBuffer buf(stream.GetSize());
+    if (!stream.Read(buf.GetSize(), buf.GetRawPtr()))
+        return {};
+    return buf;
+}
+
+static std::optional<CompressedTex> Parse(const common::AlignedBuffer& buf, const TexDiskCache::Key& key)
+{
+    const auto size = buf.GetSize();
+    if (size < sizeof(Header))
+        return {};
+    Header header;
+    memcpy(&header, buf.GetRawPtr(), sizeof(Header));
+    if (header.Magic != Magic || header.Version != Version || header.Variant != key.Variant || header.Source != key.Source)
+        return {};
+    if (header.LevelCount == 0 || header.LevelCount > MaxLevels || header.Width == 0 || header.Height == 0)
+        return {};
+    if (size < sizeof(Header) + sizeof(LevelEntry) * header.LevelCount)
+        return {};
+    CompressedTex tex;
+    tex.Format = static_cast<TextureFormat>(header.Format);
+    tex.Width  = header.Width;
+    tex.Height = header.Height;
+    tex.Levels.reserve(header.LevelCount);
+    for (uint32_t i = 0; i < header.LevelCount; ++i)
+    {
+        LevelEntry level;
+        memcpy(&level, buf.GetRawPtr() + sizeof(Header) + sizeof(LevelEntry) * i, sizeof(LevelEntry));
+        if (level.Size == 0 || level.Offset > size || level.Size > size - level.Offset)
+            return {};
+        tex.Levels.push_back(buf.CreateSubBuffer(level.Offset, level.Size));
+    }
+    return tex;
+}
+}
+
+
+TexDiskCache::TexDiskCache(path directory, const uint64_t maxBytes, const bool useMapping) :
+    Directory(std::move(directory)), MaxBytes(maxBytes), UseMapping(useMapping)
+{
+    std::error_code ec;
+    fs::create_directories(Directory, ec);
+    std::vector<std::tuple<fs::file_time_type, u16string, uint64_t>> entries;
+    for (fs::directory_iterator it(Directory, ec), end; !ec && it != end; it.increment(ec))
+    {
+        const auto& item = *it;
+        std::error_code itemEc;
+        if (!item.is_regular_file(itemEc))
+            continue;
+        const auto& fpath = item.path();
+        if (fpath.extension().u16string() != texcache::Ext)
+        {
+            if (fpath.extension().u16string() == u".tmp") // left by interrupted store
+                fs::remove(fpath, itemEc);
+            continue;
+        }
+        const auto time = item.last_write_time(itemEc);
+        const auto size = item.file_size(itemEc);
+        if (!itemEc)
+            entries.emplace_back(time, fpath.filename().u16string(), size);
+    }
+    // newest first
+    std::sort(entries.begin(), entries.end(), [](const auto& l, const auto& r) { return std::get<0>(l) > std::get<0>(r); });
+    for (auto& [time, name, size] : entries)
+    {
+        LRU.push_back(Entry{ name, size });
+        Index.emplace(std::move(name), std::prev(LRU.end()));
+        TotalBytes += size;
+    }
+    Evict({});
+    LoadFileIndex();
+    ImgLog().debug(u"TexDiskCache at [{}] has [{}] entries, [{}] bytes, [{}] known sources.\n", 
+        Directory.u16string(), LRU.size(), TotalBytes, Files.size());
+}
+TexDiskCache::~TexDiskCache() {}
+
+void TexDiskCache::LoadFileIndex()
+{
+    const auto indexPath = Directory / texcache::FileIndexName;
+    std::vector<std::byte> data;
+    try
+    {
+        common::file::ReadAll(indexPath, data);
+    }
+    catch (const common::BaseException&)
+    {
+        return;
+    }
+    size_t offset = 0, records = 0;
+    while (offset + sizeof(texcache::FileEntry) <= data.size())
+    {
+        texcache::FileEntry entry;
+        memcpy(&entry, data.data() + offset, sizeof(entry));
+        const auto pathBytes = size_t(entry.PathLength) * sizeof(char16_t);
+        if (data.size() - offset - sizeof(entry) < pathBytes) // interrupted append
+            break;
+        u16string key(entry.PathLength, u'\0');
+        memcpy(key.data(), data.data() + offset + sizeof(entry), pathBytes);
+        Files.insert_or_assign(std::move(key), FileRecord{ entry.Hash, entry.Size, entry.Time });
+        offset += sizeof(entry) + pathBytes;
+        records++;
+    }
+    if (records <= Files.size() * 2 + 64)
+        return;
+    // too many overridden records, rewrite it
+    auto tmpPath = indexPath;
+    tmpPath += ".tmp";
+    std::error_code ec;
+    try
+    {
+        common::file::FileOutputStream stream(common::file::FileObject::OpenThrow(tmpPath, common::file::OpenFlag::CreateNewBinary));
+        for (const auto& [key, record] : Files)
+        {
+            const texcache::FileEntry entry{ record.Hash, record.Size, record.Time, static_cast<uint32_t>(key.size()), 0 };
+            stream.Write(sizeof(entry), &entry);
+            stream.Write(key.size() * sizeof(char16_t), key.data());
+        }
+        stream.Flush();
+    }
+    catch (const common::BaseException& be)
+    {
+        ImgLog().warning(u"TexDiskCache failed to compact source index: {}\n", be.Message());
+        fs::remove(tmpPath, ec);
+        return;
+    }
+    fs::rename(tmpPath, indexPath, ec);
+    if (ec)
+        fs::remove(tmpPath, ec);
+}
+
+TexDiskCache::Digest TexDiskCache::HashFile(const path& fpath)
+{
+    return common::file::SHA256OfFile(fpath);
+}
+TexDiskCache::Digest TexDiskCache::HashImage(const Image& image) noexcept
+{
+    const uint32_t info[] = { image.GetWidth(), image.GetHeight(), static_cast<uint32_t>(image.GetDataType()) };
+    auto hasher = common::DigestFunc.SHA256Stream();
+    hasher.Update(common::span<const uint32_t>(info));
+    hasher.Update(common::span<const std::byte>(image.GetRawPtr(), image.GetSize()));
+    return hasher.Finalize();
+}
+
+std::optional<TexDiskCache::Digest> TexDiskCache::LookupFile(const path& fpath)
+{
+    const auto stat = texcache::StatFile(fpath);
+    if (!stat)
+        return {};
+    const auto key = texcache::FileKey(fpath);
+    std::lock_guard<std::mutex> lock(FileLock);
+    if (const auto it = Files.find(key); it != Files.end() && it->second.Size == stat->first && it->second.Time == stat->second)
+        return it->second.Hash;
+    return {};
+}
+
+TexDiskCache::Digest TexDiskCache::RecordFile(const path& fpath)
+{
+    const auto stat = texcache::StatFile(fpath);
+    const auto hash = HashFile(fpath);
+    if (!stat || texcache::StatFile(fpath) != stat) // changed while hashing
+        return hash;
+    auto key = texcache::FileKey(fpath);
+    const texcache::FileEntry entry{ hash, stat->first, stat->second, static_cast<uint32_t>(key.size()), 0 };
+    std::lock_guard<std::mutex> lock(FileLock);
+    try
+    {
+        common::file::FileOutputStream stream(common::file::FileObject::OpenThrow(Directory / texcache::FileIndexName, common::file::OpenFlag::Append));
+        stream.Write(sizeof(entry), &entry);
+        stream.Write(key.size() * sizeof(char16_t), key.data());
+    }
+    catch (const common::BaseException& be)
+    {
+        ImgLog().warning(u"TexDiskCache failed to record source [{}]: {}\n", key, be.Message());
+    }
+    Files.insert_or_assign(std::move(key), FileRecord{ hash, stat->first, stat->second });
+    return hash;
+}
+
+// caller holds the lock
+void TexDiskCache::Touch(const u16string& name, const uint64_t size)
+{
+    if (const auto it = Index.find(name); it != Index.end())
+    {
+        TotalBytes -= it->second->Size;
+        it->second->Size = size;
+        LRU.splice(LRU.begin(), LRU, it->second);
+    }
+    else
+    {
+        LRU.push_front(Entry{ name, size });
+        Index.emplace(name, LRU.begin());
+    }
+    TotalBytes += size;
+}
+// caller holds the lock
+void TexDiskCache::Evict(const u16string& keep)
+{
+    while (TotalBytes > MaxBytes && !LRU.empty())
+    {
+        auto& victim = LRU.back();
+        if (victim.Name == keep)
+            break;
+        std::error_code ec;
+        fs::remove(Directory / victim.Name, ec); // may fail if still mapped on Windows, then it's only dropped from index
+        TotalBytes -= victim.Size;
+        Index.erase(victim.Name);
+        LRU.pop_back();
+    }
+}
+
+std::optional<CompressedTex> TexDiskCache::Load(const Key& key)
+{
+    const auto name = texcache::KeyToName(key);
+    const auto fpath = Directory / name;
+    std::error_code ec;
+    if (!fs::is_regular_file(fpath, ec))
+        return {};
+    std::optional<CompressedTex> tex;
+    try
+    {
+        tex = texcache::Parse(texcache::ReadWhole(fpath, UseMapping), key);
+    }
+    catch (const common::BaseException& be)
+    {
+        ImgLog().warning(u"TexDiskCache failed to read [{}]: {}\n", name, be.Message());
+        return {};
+    }
+    if (!tex)
+    {
+        ImgLog().warning(u"TexDiskCache drops broken entry [{}].\n", name);
+        Remove(key);
+        return {};
+    }
+    // file time persists the recency across runs
+    fs::last_write_time(fpath, fs::file_time_type::clock::now(), ec);
+    std::lock_guard<std::mutex> lock(IndexLock);
+    // stat under the lock, file may have been evicted by another thread after being read
+    if (const auto size = fs::file_size(fpath, ec); !ec)
+        Touch(name, size);
+    else if (const auto it = Index.find(name); it != Index.end())
+    {
+        TotalBytes -= it->second->Size;
+        LRU.erase(it->second);
+        Index.erase(it);
+    }
+    return tex;
+}
+
+bool TexDiskCache::Store(const Key& key, const CompressedTex& tex)
+{
+    if (tex.Levels.empty() || tex.Levels.size() > texcache::MaxLevels)
+        return false;
+    const auto name = texcache::KeyToName(key);
+    texcache::Header header;
+    header.Magic      = texcache::Magic;
+    header.Version    = texcache::Version;
+    header.Variant    = key.Variant;
+    header.Source     = key.Source;
+    header.Format     = static_cast<uint32_t>(tex.Format);
+    header.Width      = tex.Width;
+    header.Height     = tex.Height;
+    header.LevelCount = static_cast<uint32_t>(tex.Levels.size());
+    std::vector<texcache::LevelEntry> levels;
+    uint64_t offset = sizeof(texcache::Header) + sizeof(texcache::LevelEntry) * tex.Levels.size();
+    for (const auto& level : tex.Levels)
+    {
+        offset = (offset + texcache::LevelAlign - 1) / texcache::LevelAlign * texcache::LevelAlign;
+        levels.push_back({ offset, level.GetSize() });
+        offset += level.GetSize();
+    }
+    const auto totalSize = offset;
+
+    // write to a temp file then rename, so that a half-written entry is never visible
+    auto tmpPath = Directory / name;
+    tmpPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    std::error_code ec;
+    try
+    {
+        common::file::FileOutputStream stream(common::file::FileObject::OpenThrow(tmpPath, common::file::OpenFlag::CreateNewBinary));
+        constexpr std::byte Padding[texcache::LevelAlign] = {};
+        stream.Write(sizeof(header), &header);
+        stream.Write(sizeof(texcache::LevelEntry) * levels.size(), levels.data());
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            if (const auto pos = stream.CurrentPos(); pos < levels[i].Offset)
+                stream.Write(static_cast<size_t>(levels[i].Offset - pos), Padding);
+            stream.Write(tex.Levels[i].GetSize(), tex.Levels[i].GetRawPtr());
+        }
+        stream.Flush();
+    }
+    catch (const common::BaseException& be)
+    {
+        ImgLog().warning(u"TexDiskCache failed to write [{}]: {}\n", name, be.Message());
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    fs::rename(tmpPath, Directory / name, ec);
+    if (ec) // the old one may still be mapped
+    {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(IndexLock);
+    Touch(name, totalSize);
+    Evict(name);
+    return true;
+}
+
+void TexDiskCache::Remove(const Key& key)
+{
+    const auto name = texcache::KeyToName(key);
+    std::error_code ec;
+    fs::remove(Directory / name, ec);
+    std::lock_guard<std::mutex> lock(IndexLock);
+    if (const auto it = Index.find(name); it != Index.end())
+    {
+        TotalBytes -= it->second->Size;
+        LRU.erase(it->second);
+        Index.erase(it);
+    }
+}
+
+void TexDiskCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(IndexLock);
+    for (const auto& entry : LRU)
+    {
+        std::error_code ec;
+        fs::remove(Directory / entry.Name, ec);
+    }
+    LRU.clear();
+    Index.clear();
+    TotalBytes = 0;
+}
+
+void TexDiskCache::SetMaxBytes(const uint64_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(IndexLock);
+    MaxBytes = maxBytes;
+    Evict({});
+}
+
+uint64_t TexDiskCache::GetTotalBytes() const
+{
+    std::lock_guard<std::mutex> lock(IndexLock);
+    return TotalBytes;
+}
+
+uint64_t TexDiskCache::GetMaxBytes() const
+{
+    std::lock_guard<std::mutex> lock(IndexLock);
+    return MaxBytes;
+}
+
+
+}
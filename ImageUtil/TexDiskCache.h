@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ImageUtilRely.h"
+#include "ImageCore.h"
+#include "TexFormat.h"
+#include "common/FileBase.hpp"
+#include <array>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+
+namespace xziar::img
+{
+
+// texture data ready for upload, level 0 is the full size one
+struct CompressedTex
+{
+    std::vector<common::AlignedBuffer> Levels;
+    TextureFormat Format = TextureFormat::EMPTY;
+    uint32_t Width = 0, Height = 0;
+};
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+/*persistent cache of processed textures, one file per entry, least recently used entries are evicted when exceeding size limit*/
+class IMGUTILAPI TexDiskCache : public common::NonCopyable
+{
+public:
+    using Digest = std::array<std::byte, 32>;
+    struct Key
+    {
+        Digest Source;
+        // how the source is processed, defined by user, different variants of the same source are different entries
+        uint32_t Variant;
+    };
+private:
+    struct Entry
+    {
+        std::u16string Name;
+        uint64_t Size;
+    };
+    struct FileRecord
+    {
+        Digest Hash;
+        uint64_t Size;
+        int64_t Time;
+    };
+    common::fs::path Directory;
+    uint64_t MaxBytes;
+    uint64_t TotalBytes = 0;
+    std::list<Entry> LRU; // front is the most recently used
+    std::unordered_map<std::u16string, std::list<Entry>::iterator> Index;
+    std::unordered_map<std::u16string, FileRecord> Files; // keyed by absolute path
+    mutable std::mutex IndexLock;
+    std::mutex FileLock;
+    bool UseMapping;
+    void Touch(const std::u16string& name, const uint64_t size);
+    void Evict(const std::u16string& keep);
+    void LoadFileIndex();
+public:
+    ///<summary>Open (or create) a cache directory, existing entries are indexed by their last access time</summary>
+    ///<param name="directory">directory to hold cache files</param>
+    ///<param name="maxBytes">size limit of all entries</param>
+    ///<param name="useMapping">map cache files instead of reading them into memory</param>
+    TexDiskCache(common::fs::path directory, const uint64_t maxBytes, const bool useMapping = true);
+    ~TexDiskCache();
+
+    [[nodiscard]] static Digest HashFile(const common::fs::path& path);
+    [[nodiscard]] static Digest HashImage(const Image& image) noexcept;
+    ///<summary>Digest of a file recorded by RecordFile, only file size and last write time are checked</summary>
+    ///<returns>empty when not recorded or the file has changed since then</returns>
+    [[nodiscard]] std::optional<Digest> LookupFile(const common::fs::path& path);
+    ///<summary>Hash a file and record the digest with its size and last write time, records persist across runs</summary>
+    Digest RecordFile(const common::fs::path& path);
+
+    ///<summary>Load an entry, levels share the same mapping when mapping is used</summary>
+    ///<returns>empty when not found or broken</returns>
+    [[nodiscard]] std::optional<CompressedTex> Load(const Key& key);
+    ///<summary>Store an entry, replace the old one if exists</summary>
+    ///<returns>if stored successfully</returns>
+    bool Store(const Key& key, const CompressedTex& tex);
+    void Remove(const Key& key);
+    void Clear();
+    void SetMaxBytes(const uint64_t maxBytes);
+    [[nodiscard]] uint64_t GetTotalBytes() const;
+    [[nodiscard]] uint64_t GetMaxBytes() const;
+    [[nodiscard]] const common::fs::path& GetDirectory() const noexcept { return Directory; }
+};
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
+
+}
@@ -83,7 +83,7 @@ AutoVarHandlerBase::~AutoVarHandlerBase() { }
 
 AutoVarHandlerBase::Accessor* AutoVarHandlerBase::FindMember(std::u32string_view name, bool create)
 {
-    const common::str::HashedStrView hsv(name);
+    const HashedStrView hsv(name);
     for (auto& [pos, acc] : MemberList)
     {
         if (NamePool.GetHashedStr(pos) == hsv)
@@ -60,7 +60,7 @@ protected:
         [[nodiscard]] std::u32string_view GetTypeName(const CustomVar&) noexcept final;
     };
     std::u32string TypeName;
-    common::HashedStringPool<char32_t> NamePool;
+    HashedStringPool NamePool;
     std::vector<std::pair<common::StringPiece<char32_t>, Accessor>> MemberList;
     std::function<void(void*, Arg)> Assigner;
     AutoVarHandlerBase(std::u32string_view typeName);
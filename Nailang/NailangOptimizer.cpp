@@ -0,0 +1,431 @@
+#include "NailangPch.h"
+#include "NailangOptimizer.h"
+#include "common/TimeUtil.hpp"
+
+
+namespace xziar::nailang
+{
+using namespace std::string_view_literals;
+
+
+// all of them only depend on args
+static constexpr std::u32string_view PureMathFuncs[] =
+{
+    U"Max"sv, U"Min"sv, U"Sqrt"sv, U"Ceil"sv, U"Floor"sv, U"Round"sv, U"Log"sv, U"Log2"sv, U"Log10"sv, U"Lerp"sv, U"Pow"sv,
+    U"LeadZero"sv, U"TailZero"sv, U"PopCount"sv, U"ToUint"sv, U"ToInt"sv, U"ToFP"sv,
+    U"ParseInt"sv, U"ParseUint"sv, U"ParseFloat"sv, U"ParseSciFloat"sv,
+};
+
+static bool IsSameExpr(const Expr& lhs, const Expr& rhs) noexcept
+{
+    static_assert(sizeof(Expr) == 16);
+    return memcmp(&lhs, &rhs, sizeof(Expr)) == 0;
+}
+static bool IsPlainMeta(const FuncCall& meta, const std::u32string_view name) noexcept
+{
+    return meta.Name->Info() == FuncName::FuncInfo::Meta && *meta.Name == name;
+}
+
+
+NailangOptimizer::NailangOptimizer(MemoryPool& pool) :
+    NailangBasicRuntime(std::make_shared<CompactEvaluateContext>()), Pool(pool)
+{ }
+NailangOptimizer::~NailangOptimizer()
+{ }
+
+bool NailangOptimizer::IsLiteral(const Expr& expr) noexcept
+{
+    switch (expr.TypeData)
+    {
+    case Expr::Type::Str:
+    case Expr::Type::Uint:
+    case Expr::Type::Int:
+    case Expr::Type::FP:
+    case Expr::Type::Bool:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool NailangOptimizer::IsPureFunc(const FuncCall& call) const noexcept
+{
+    const auto& name = *call.Name;
+    if (name.Info() != FuncName::FuncInfo::ExprPart)
+        return false;
+    if (name.PartCount == 1)
+        return name == U"Format"sv;
+    if (name.PartCount == 2 && name.GetPart(0) == U"Math"sv)
+        return std::find(std::begin(PureMathFuncs), std::end(PureMathFuncs), name.GetPart(1)) != std::end(PureMathFuncs);
+    return false;
+}
+
+NailangOptimizer::ElseUsage NailangOptimizer::CheckElse(common::span<const FuncCall> metas) noexcept
+{
+    auto usage = ElseUsage::None;
+    for (size_t i = 0; i < metas.size(); ++i)
+    {
+        const auto& meta = metas[i];
+        const bool isElse = IsPlainMeta(meta, U"Else"sv);
+        if (IsPlainMeta(meta, U"MetaIf"sv)) // may turn into [Else]
+        {
+            for (size_t j = 1; j < meta.Args.size() && meta.Args[j].TypeData == Expr::Type::Str; j += 2)
+            {
+                if (meta.Args[j].GetVar<Expr::Type::Str>() == U"Else"sv)
+                    return ElseUsage::Unknown;
+            }
+        }
+        if (isElse)
+        {
+            if (i != 0)
+                return ElseUsage::Unknown;
+            usage = ElseUsage::First;
+        }
+    }
+    return usage;
+}
+
+std::optional<bool> NailangOptimizer::GetLiteralBool(const Expr& expr) noexcept
+{
+    switch (expr.TypeData)
+    {
+    case Expr::Type::Str:   return Arg(expr.GetVar<Expr::Type::Str >()).GetBool();
+    case Expr::Type::Uint:  return Arg(expr.GetVar<Expr::Type::Uint>()).GetBool();
+    case Expr::Type::Int:   return Arg(expr.GetVar<Expr::Type::Int >()).GetBool();
+    case Expr::Type::FP:    return Arg(expr.GetVar<Expr::Type::FP  >()).GetBool();
+    case Expr::Type::Bool:  return expr.GetVar<Expr::Type::Bool>();
+    default:                return {};
+    }
+}
+
+std::u32string_view NailangOptimizer::Intern(const std::u32string_view str)
+{
+    if (const auto it = InternedStrs.find(str); it != InternedStrs.end())
+        return *it;
+    const auto space = Pool.CreateArray(common::span<const char32_t>(str.data(), str.size()));
+    const std::u32string_view ret(space.data(), space.size());
+    InternedStrs.insert(ret);
+    Stats.InternedStrs++;
+    return ret;
+}
+
+std::optional<Expr> NailangOptimizer::ToLiteral(const Arg& arg)
+{
+    switch (arg.TypeData)
+    {
+    case Arg::Type::Bool:   return Expr(arg.GetBool().value());
+    case Arg::Type::Uint:   return Expr(arg.GetUint().value());
+    case Arg::Type::Int:    return Expr(arg.GetInt().value());
+    case Arg::Type::FP:     return Expr(arg.GetFP().value());
+    case Arg::Type::U32Str:
+    case Arg::Type::U32Sv:
+    {
+        const auto str = arg.GetStr().value();
+        if (str.size() > UINT32_MAX)
+            return {};
+        return Expr(str.empty() ? U""sv : Intern(str));
+    }
+    default:                return {};
+    }
+}
+
+std::optional<Expr> NailangOptimizer::TryEvaluate(const Expr& expr)
+{
+    try
+    {
+        auto frame = Executor.PushFrame(RootContext, NailangFrame::FrameFlags::Empty);
+        EvalTempStore store;
+        return ToLiteral(Executor.EvaluateExpr(expr, store));
+    }
+    catch (const common::BaseException&)
+    { } // keep the expr, runtime will report it when it is really evaluated
+    return {};
+}
+
+common::span<const Expr> NailangOptimizer::OptimizeArgs(common::span<const Expr> args)
+{
+    boost::container::small_vector<Expr, 8> newArgs;
+    bool changed = false;
+    for (const auto& arg : args)
+    {
+        newArgs.push_back(OptimizeExpr(arg));
+        changed |= !IsSameExpr(arg, newArgs.back());
+    }
+    return changed ? Pool.CreateArray(newArgs) : args;
+}
+
+const FuncCall* NailangOptimizer::OptimizeCall(const FuncCall& call)
+{
+    const auto args = OptimizeArgs(call.Args);
+    return args.data() == call.Args.data() ? &call : Pool.Create<FuncCall>(call.Name, args, call.Position);
+}
+
+const AssignExpr* NailangOptimizer::OptimizeAssign(const AssignExpr& assign)
+{
+    // target is kept as is when it's a var, the runtime locates it directly
+    const auto target    = assign.Target.TypeData == Expr::Type::Var ? assign.Target : OptimizeExpr(assign.Target);
+    const auto statement = OptimizeExpr(assign.Statement);
+    if (IsSameExpr(target, assign.Target) && IsSameExpr(statement, assign.Statement))
+        return &assign;
+    return Pool.Create<AssignExpr>(target, statement, assign.AssignInfo, assign.IsSelfAssign, assign.Position);
+}
+
+Expr NailangOptimizer::OptimizeExpr(const Expr& expr)
+{
+    using Type = Expr::Type;
+    switch (expr.TypeData)
+    {
+    case Type::Func:
+    {
+        const auto& call = *expr.GetVar<Type::Func>();
+        const auto args = OptimizeArgs(call.Args);
+        const FuncCall folded(call.Name, args, call.Position);
+        if (IsPureFunc(folded) && std::all_of(args.begin(), args.end(), IsLiteral))
+        {
+            if (auto ret = TryEvaluate(&folded); ret)
+            {
+                Stats.FoldedFuncs++;
+                return *ret;
+            }
+        }
+        return args.data() == call.Args.data() ? expr : Expr(Pool.Create<FuncCall>(folded));
+    }
+    case Type::Unary:
+    {
+        const auto& unary = *expr.GetVar<Type::Unary>();
+        if (unary.Operator == EmbedOps::CheckExist) // depends on runtime vars
+            return expr;
+        const UnaryExpr folded(unary.Operator, OptimizeExpr(unary.Operand));
+        if (IsLiteral(folded.Operand))
+        {
+            if (auto ret = TryEvaluate(&folded); ret)
+            {
+                Stats.FoldedExprs++;
+                return *ret;
+            }
+        }
+        return IsSameExpr(folded.Operand, unary.Operand) ? expr : Expr(Pool.Create<UnaryExpr>(folded));
+    }
+    case Type::Binary:
+    {
+        const auto& binary = *expr.GetVar<Type::Binary>();
+        const auto left = binary.Operator == EmbedOps::ValueOr ? binary.LeftOperand : OptimizeExpr(binary.LeftOperand);
+        if (binary.Operator == EmbedOps::And || binary.Operator == EmbedOps::Or)
+        {
+            // short-circuit, right side is never evaluated
+            if (const auto l = GetLiteralBool(left); l.has_value() && *l == (binary.Operator == EmbedOps::Or))
+            {
+                Stats.FoldedExprs++;
+                return *l;
+            }
+        }
+        const BinaryExpr folded(binary.Operator, left, OptimizeExpr(binary.RightOperand));
+        if (IsLiteral(folded.LeftOperand) && IsLiteral(folded.RightOperand))
+        {
+            if (auto ret = TryEvaluate(&folded); ret)
+            {
+                Stats.FoldedExprs++;
+                return *ret;
+            }
+        }
+        if (IsSameExpr(folded.LeftOperand, binary.LeftOperand) && IsSameExpr(folded.RightOperand, binary.RightOperand))
+            return expr;
+        return Pool.Create<BinaryExpr>(folded);
+    }
+    case Type::Ternary:
+    {
+        const auto& ternary = *expr.GetVar<Type::Ternary>();
+        const auto cond = OptimizeExpr(ternary.Condition);
+        if (const auto c = GetLiteralBool(cond); c.has_value())
+        {
+            Stats.FoldedExprs++;
+            return OptimizeExpr(*c ? ternary.LeftOperand : ternary.RightOperand);
+        }
+        const TernaryExpr folded(cond, OptimizeExpr(ternary.LeftOperand), OptimizeExpr(ternary.RightOperand));
+        if (IsSameExpr(folded.Condition, ternary.Condition) && IsSameExpr(folded.LeftOperand, ternary.LeftOperand) &&
+            IsSameExpr(folded.RightOperand, ternary.RightOperand))
+            return expr;
+        return Pool.Create<TernaryExpr>(folded);
+    }
+    case Type::Query:
+    {
+        // only the target and indexes, subfields are names
+        const auto& query = *expr.GetVar<Type::Query>();
+        const auto target = OptimizeExpr(query.Target);
+        const auto queries = query.TypeData == QueryExpr::QueryType::Index ? OptimizeArgs(query.GetQueries()) : query.GetQueries();
+        if (IsSameExpr(target, query.Target) && queries.data() == query.QueryPtr)
+            return expr;
+        return Pool.Create<QueryExpr>(target, queries, query.TypeData);
+    }
+    case Type::Assign:
+        return OptimizeAssign(*expr.GetVar<Type::Assign>());
+    default:
+        return expr;
+    }
+}
+
+NailangOptimizer::MetaDecision NailangOptimizer::OptimizeMetas(common::span<const FuncCall> metas, std::vector<FuncCall>& output,
+    const bool allowIf, const bool allowSkip)
+{
+    MetaDecision decision;
+    boost::container::small_vector<FuncCall, 4> folded;
+    // [MetaIf] conditions are all evaluated before any meta being handled
+    bool hasDynamic = false;
+    for (const auto& meta : metas)
+    {
+        folded.push_back(*OptimizeCall(meta));
+        if (IsPlainMeta(folded.back(), U"MetaIf"sv) && !folded.back().Args.empty() && !GetLiteralBool(folded.back().Args[0]))
+            hasDynamic = true;
+    }
+    const auto outBegin = output.size();
+    for (auto& meta : folded)
+    {
+        auto name = meta.FullFuncName();
+        auto info = meta.Name->Info();
+        auto args = meta.Args;
+        bool dropped = false, rewritten = false;
+        while (info == FuncName::FuncInfo::Meta && name == U"MetaIf"sv && args.size() >= 2 && args[1].TypeData == Expr::Type::Str)
+        {
+            const auto cond = GetLiteralBool(args[0]);
+            auto newName = args[1].GetVar<Expr::Type::Str>();
+            const auto newInfo = FuncName::PrepareFuncInfo(newName, FuncName::FuncInfo::Meta);
+            if (!cond || newName.empty())
+                break;
+            Stats.DecidedMetas++;
+            if (!*cond)
+            {
+                dropped = true;
+                break;
+            }
+            name = newName, info = newInfo, args = args.subspan(2);
+            rewritten = true;
+        }
+        if (dropped)
+            continue;
+        if (rewritten)
+            meta = FuncCall(FuncName::Create(Pool, name, info), args, meta.Position);
+        if (info == FuncName::FuncInfo::Meta && name == U"Skip"sv && args.size() <= 1)
+        {
+            const auto val = args.empty() ? std::optional<bool>(true) : GetLiteralBool(args[0]);
+            if (val.has_value() && (!*val || (allowSkip && !hasDynamic)))
+            {
+                Stats.DecidedMetas++;
+                if (!*val)
+                    continue;
+                decision.Skip = true;
+                break;
+            }
+        }
+        else if (info == FuncName::FuncInfo::Meta && name == U"If"sv && args.size() == 1 && allowIf && !hasDynamic)
+        {
+            if (const auto val = GetLiteralBool(args[0]); val.has_value())
+            {
+                Stats.DecidedMetas++;
+                decision.IfResult = *val;
+                if (!*val)
+                {
+                    decision.Skip = true;
+                    break;
+                }
+                continue;
+            }
+        }
+        output.push_back(meta);
+        // later metas only run when this one passes
+        hasDynamic = true;
+    }
+    if (decision.Skip)
+        output.resize(outBegin);
+    return decision;
+}
+
+Statement NailangOptimizer::OptimizeContent(const Statement& content, std::pair<uint32_t, uint16_t> metas)
+{
+    switch (content.TypeData)
+    {
+    case Statement::Type::FuncCall: return { OptimizeCall(*content.Get<FuncCall>()), metas };
+    case Statement::Type::Assign:   return { OptimizeAssign(*content.Get<AssignExpr>()), metas };
+    case Statement::Type::RawBlock: return { content.Get<RawBlock>(), metas };
+    case Statement::Type::Block:    return { Pool.Create<Block>(OptimizeContents(*content.Get<Block>())), metas };
+    default:                        return content;
+    }
+}
+
+Block NailangOptimizer::OptimizeContents(const Block& block)
+{
+    std::vector<Statement> contents;
+    std::vector<FuncCall> allMetas;
+    contents.reserve(block.Size());
+    allMetas.reserve(block.MetaFuncations.size());
+    const auto getElseUsage = [&](size_t idx)
+    {
+        return idx < block.Size() ? CheckElse(block[idx].first) : ElseUsage::None;
+    };
+    bool dropNext = false, stripElse = false;
+    for (size_t idx = 0; idx < block.Size(); ++idx)
+    {
+        auto [metas, content] = block[idx];
+        if (dropNext) // skipped by [Else]
+        {
+            dropNext = false;
+            Stats.RemovedStatements++;
+            continue;
+        }
+        if (stripElse) // [Else] always passes
+        {
+            stripElse = false;
+            metas = metas.subspan(1);
+            Stats.DecidedMetas++;
+        }
+        // IfRecord only lives till the next statement
+        const auto nextUsage = getElseUsage(idx + 1);
+        const bool allowIf = nextUsage == ElseUsage::None || (nextUsage == ElseUsage::First && getElseUsage(idx + 2) == ElseUsage::None);
+        const auto offset = allMetas.size();
+        const auto decision = OptimizeMetas(metas, allMetas, allowIf, nextUsage == ElseUsage::None);
+        if (decision.IfResult.has_value() && nextUsage == ElseUsage::First)
+        {
+            dropNext  =  *decision.IfResult;
+            stripElse = !*decision.IfResult;
+        }
+        if (decision.Skip)
+        {
+            Stats.RemovedStatements++;
+            continue;
+        }
+        const std::pair<uint32_t, uint16_t> metaInfo{ gsl::narrow_cast<uint32_t>(offset), gsl::narrow_cast<uint16_t>(allMetas.size() - offset) };
+        contents.push_back(OptimizeContent(content, metaInfo));
+    }
+    Block ret;
+    static_cast<RawBlock&>(ret) = block;
+    ret.Content = Pool.CreateArray(contents);
+    ret.MetaFuncations = Pool.CreateArray(allMetas);
+    return ret;
+}
+
+Block NailangOptimizer::OptimizeBlock(const Block& block)
+{
+    common::SimpleTimer timer;
+    timer.Start();
+    auto ret = OptimizeContents(block);
+    timer.Stop();
+    Stats.TimeNs += timer.ElapseNs();
+    return ret;
+}
+
+void NailangOptimizer::OptimizeProgram(Block& program)
+{
+    common::SimpleTimer timer;
+    timer.Start();
+    std::vector<Statement> contents(program.Content.begin(), program.Content.end());
+    for (auto& content : contents)
+    {
+        if (content.TypeData == Statement::Type::Block)
+            content = Statement(Pool.Create<Block>(OptimizeContents(*content.Get<Block>())), { content.Offset, content.Count });
+    }
+    program.Content = Pool.CreateArray(contents);
+    timer.Stop();
+    Stats.TimeNs += timer.ElapseNs();
+}
+
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "NailangRuntime.h"
+#include <unordered_set>
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+
+namespace xziar::nailang
+{
+
+
+struct NailangOptStats
+{
+    uint32_t FoldedExprs        = 0; // operator/ternary exprs replaced by literal
+    uint32_t FoldedFuncs        = 0; // builtin calls replaced by literal
+    uint32_t DecidedMetas       = 0; // conditional metas decided and removed
+    uint32_t RemovedStatements  = 0;
+    uint32_t InternedStrs       = 0;
+    uint64_t TimeNs             = 0;
+};
+
+
+/**
+ * @brief fold constant exprs and statically decided conditional metas of parsed blocks
+ * @detail pure operators and whitelisted builtin funcs on literals are evaluated by the basic executor,
+ *         [If]/[Skip]/[MetaIf] with literal condition are removed together with the statements they skip,
+ *         [If] is only decided when the following [Else] can be decided as well.
+ *         Evaluation errors are left to the runtime. New nodes and strings are allocated from the given pool.
+*/
+class NAILANGAPI NailangOptimizer : protected NailangBasicRuntime
+{
+private:
+    enum class ElseUsage : uint8_t { None, First, Unknown };
+    struct MetaDecision
+    {
+        std::optional<bool> IfResult;
+        bool Skip = false;
+    };
+    MemoryPool& Pool;
+    std::unordered_set<std::u32string_view> InternedStrs;
+    NailangOptStats Stats;
+
+    [[nodiscard]] static ElseUsage CheckElse(common::span<const FuncCall> metas) noexcept;
+    [[nodiscard]] static std::optional<bool> GetLiteralBool(const Expr& expr) noexcept;
+    [[nodiscard]] std::u32string_view Intern(const std::u32string_view str);
+    [[nodiscard]] std::optional<Expr> ToLiteral(const Arg& arg);
+    [[nodiscard]] std::optional<Expr> TryEvaluate(const Expr& expr);
+    [[nodiscard]] common::span<const Expr> OptimizeArgs(common::span<const Expr> args);
+    [[nodiscard]] const FuncCall* OptimizeCall(const FuncCall& call);
+    [[nodiscard]] const AssignExpr* OptimizeAssign(const AssignExpr& assign);
+    [[nodiscard]] MetaDecision OptimizeMetas(common::span<const FuncCall> metas, std::vector<FuncCall>& output,
+        const bool allowIf, const bool allowSkip);
+    [[nodiscard]] Statement OptimizeContent(const Statement& content, std::pair<uint32_t, uint16_t> metas);
+    [[nodiscard]] Block OptimizeContents(const Block& block);
+protected:
+    [[nodiscard]] virtual bool IsPureFunc(const FuncCall& call) const noexcept;
+public:
+    NailangOptimizer(MemoryPool& pool);
+    ~NailangOptimizer() override;
+
+    [[nodiscard]] static bool IsLiteral(const Expr& expr) noexcept;
+    [[nodiscard]] Expr OptimizeExpr(const Expr& expr);
+    [[nodiscard]] Block OptimizeBlock(const Block& block);
+    // top-level statements are driven by the host rather than the executor, so only nested blocks are optimized
+    void OptimizeProgram(Block& program);
+    [[nodiscard]] constexpr const NailangOptStats& GetStats() const noexcept { return Stats; }
+};
+
+
+}
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
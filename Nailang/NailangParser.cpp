@@ -950,36 +950,35 @@ void ReplaceEngine::HandleException(const NailangParseException& ex) const
     ex.ThrowSelf();
 }
 
-void ReplaceEngine::OnReplaceOptBlock(std::u32string&, void*, std::u32string_view, std::u32string_view)
+void ReplaceEngine::OnReplaceOptBlock(TextRope&, void*, std::u32string_view, std::u32string_view)
 {
     NLPS_THROW_EX(u"ReplaceOptBlock unimplemented"sv);
 }
-void ReplaceEngine::OnReplaceVariable(std::u32string&, void*, std::u32string_view)
+void ReplaceEngine::OnReplaceVariable(TextRope&, void*, std::u32string_view)
 {
     NLPS_THROW_EX(u"ReplaceVariable unimplemented"sv);
 }
-void ReplaceEngine::OnReplaceFunction(std::u32string&, void*, std::u32string_view, common::span<const std::u32string_view>)
+void ReplaceEngine::OnReplaceFunction(TextRope&, void*, std::u32string_view, common::span<const std::u32string_view>)
 {
     NLPS_THROW_EX(u"ReplaceFunction unimplemented"sv);
 }
 
-std::u32string ReplaceEngine::ProcessOptBlock(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+void ReplaceEngine::ProcessOptBlock(TextRope& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
 {
     Expects(!prefix.empty() && !suffix.empty()); // Illegal prefix/suffix
     common::parser::ParserContext context(source);
     ContextReader reader(context);
-    std::u32string output;
     while (true)
     {
         auto before = reader.ReadUntil(prefix);
         if (before.empty()) // reaching end
         {
-            output.append(reader.ReadAll());
+            output.AppendView(reader.ReadAll());
             break;
         }
         {
             before.remove_suffix(prefix.size());
-            output.append(before);
+            output.AppendView(before);
         }
         reader.ReadWhile(IgnoreBlank);
         if (reader.ReadNext() != U'{')
@@ -1001,26 +1000,24 @@ std::u32string ReplaceEngine::ProcessOptBlock(const std::u32string_view source,
         OnReplaceOptBlock(output, cookie, TrimStrBlank(cond), str);
         reader.ReadLine();
     }
-    return output;
 }
 
-std::u32string ReplaceEngine::ProcessVariable(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+void ReplaceEngine::ProcessVariable(TextRope& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
 {
     Expects(!prefix.empty() && !suffix.empty()); // Illegal prefix/suffix
     common::parser::ParserContext context(source);
     ContextReader reader(context);
-    std::u32string output;
     while (true)
     {
         auto before = reader.ReadUntil(prefix);
         if (before.empty()) // reaching end
         {
-            output.append(reader.ReadAll());
+            output.AppendView(reader.ReadAll());
             break;
         }
         {
             before.remove_suffix(prefix.size());
-            output.append(before);
+            output.AppendView(before);
         }
         reader.ReadWhile(IgnoreBlank);
         auto var = reader.ReadUntil(suffix);
@@ -1035,26 +1032,24 @@ std::u32string ReplaceEngine::ProcessVariable(const std::u32string_view source,
         // find a variable replacement
         OnReplaceVariable(output, cookie, TrimStrBlank(var));
     }
-    return output;
 }
 
-std::u32string ReplaceEngine::ProcessFunction(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+void ReplaceEngine::ProcessFunction(TextRope& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
 {
     Expects(!prefix.empty()); // Illegal suffix
     common::parser::ParserContext context(source);
     ContextReader reader(context);
-    std::u32string output;
     while (true)
     {
         auto before = reader.ReadUntil(prefix);
         if (before.empty()) // reaching end
         {
-            output.append(reader.ReadAll());
+            output.AppendView(reader.ReadAll());
             break;
         }
         {
             before.remove_suffix(prefix.size());
-            output.append(before);
+            output.AppendView(before);
         }
         reader.ReadWhile(IgnoreBlank);
         auto funcName = reader.ReadUntil(U"("sv);
@@ -1162,7 +1157,25 @@ std::u32string ReplaceEngine::ProcessFunction(const std::u32string_view source,
         // find a function replacement
         OnReplaceFunction(output, cookie, TrimStrBlank(funcName), args);
     }
-    return output;
+}
+
+std::u32string ReplaceEngine::ProcessOptBlock(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+{
+    TextRope output;
+    ProcessOptBlock(output, source, prefix, suffix, cookie);
+    return output.ToU32String();
+}
+std::u32string ReplaceEngine::ProcessVariable(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+{
+    TextRope output;
+    ProcessVariable(output, source, prefix, suffix, cookie);
+    return output.ToU32String();
+}
+std::u32string ReplaceEngine::ProcessFunction(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie)
+{
+    TextRope output;
+    ProcessFunction(output, source, prefix, suffix, cookie);
+    return output.ToU32String();
 }
 
 ReplaceEngine::~ReplaceEngine()
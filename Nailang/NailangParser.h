@@ -1,5 +1,6 @@
 #pragma once
 #include "NailangStruct.h"
+#include "NailangRope.h"
 #include "SystemCommon/Exceptions.h"
 #include "common/parser/ParserBase.hpp"
 #include <optional>
@@ -149,9 +150,13 @@ class NAILANGAPI ReplaceEngine
 protected:
     static std::u32string_view TrimStrBlank(const std::u32string_view str) noexcept;
     [[noreturn]] virtual void HandleException(const NailangParseException& ex) const;
-    virtual void OnReplaceOptBlock(std::u32string& output, void* cookie, std::u32string_view cond, std::u32string_view content);
-    virtual void OnReplaceVariable(std::u32string& output, void* cookie, std::u32string_view var);
-    virtual void OnReplaceFunction(std::u32string& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args);
+    virtual void OnReplaceOptBlock(TextRope& output, void* cookie, std::u32string_view cond, std::u32string_view content);
+    virtual void OnReplaceVariable(TextRope& output, void* cookie, std::u32string_view var);
+    virtual void OnReplaceFunction(TextRope& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args);
+    // unreplaced parts are referenced from source without copy, source must outlive output
+    void ProcessOptBlock(TextRope& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
+    void ProcessVariable(TextRope& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
+    void ProcessFunction(TextRope& output, const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
     std::u32string ProcessOptBlock(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
     std::u32string ProcessVariable(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
     std::u32string ProcessFunction(const std::u32string_view source, const std::u32string_view prefix, const std::u32string_view suffix, void* cookie = nullptr);
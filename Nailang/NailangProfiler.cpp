@@ -0,0 +1,133 @@
+#include "NailangPch.h"
+#include "NailangProfiler.h"
+#include <map>
+#include <algorithm>
+
+
+namespace xziar::nailang
+{
+using namespace std::string_view_literals;
+
+
+NailangProfiler::NailangProfiler()
+{
+    Reset();
+}
+NailangProfiler::~NailangProfiler()
+{ }
+
+void NailangProfiler::Reset()
+{
+    Nodes.clear();
+    Nodes.emplace_back(U""sv, Category::Root, 0u);
+    Current = 0;
+}
+
+uint32_t NailangProfiler::Enter(Category type, std::u32string_view name)
+{
+    for (const auto idx : Nodes[Current].Children)
+    {
+        const auto& node = Nodes[idx];
+        if (node.Type == type && node.Name == name)
+            return Current = idx;
+    }
+    const auto idx = static_cast<uint32_t>(Nodes.size());
+    Nodes.emplace_back(name, type, Current);
+    Nodes[Current].Children.push_back(idx); // after emplace_back, which may invalidate reference
+    return Current = idx;
+}
+
+void NailangProfiler::Leave(uint32_t idx, uint64_t ns, bool record) noexcept
+{
+    auto& node = Nodes[idx];
+    Current = node.Parent;
+    if (record)
+    {
+        node.Count++;
+        node.InclusiveNs += ns;
+        Nodes[Current].ChildNs += ns;
+    }
+}
+
+std::vector<NailangProfiler::Summary> NailangProfiler::Summarize() const
+{
+    std::map<std::pair<Category, std::u32string_view>, Summary> summaries;
+    for (uint32_t i = 1; i < Nodes.size(); ++i)
+    {
+        const auto& node = Nodes[i];
+        if (node.Count == 0)
+            continue;
+        auto& summary = summaries[{ node.Type, node.Name }];
+        summary.Name = node.Name;
+        summary.Type = node.Type;
+        summary.Count += node.Count;
+        summary.ExclusiveNs += node.ExclusiveNs();
+        bool isRecursive = false;
+        for (auto p = node.Parent; p != 0; p = Nodes[p].Parent)
+        {
+            if (Nodes[p].Type == node.Type && Nodes[p].Name == node.Name)
+            {
+                isRecursive = true;
+                break;
+            }
+        }
+        if (!isRecursive)
+            summary.InclusiveNs += node.InclusiveNs;
+    }
+    std::vector<Summary> ret;
+    ret.reserve(summaries.size());
+    for (const auto& [key, summary] : summaries)
+        ret.push_back(summary);
+    std::stable_sort(ret.begin(), ret.end(), [](const Summary& lhs, const Summary& rhs)
+        {
+            return lhs.ExclusiveNs > rhs.ExclusiveNs;
+        });
+    return ret;
+}
+
+std::string NailangProfiler::ExportFoldedStacks() const
+{
+    std::u32string output, stack;
+    const auto visit = [&](const auto& self, const uint32_t idx) -> void
+    {
+        const auto& node = Nodes[idx];
+        const auto prevLen = stack.size();
+        if (idx != 0)
+        {
+            if (prevLen > 0)
+                stack.push_back(U';');
+            stack.append(GetCategoryName(node.Type)).push_back(U':');
+            for (const auto ch : node.Name) // ';' splits frames and newline splits records
+                stack.push_back((ch == U';' || ch == U'\n' || ch == U'\r') ? U'_' : ch);
+            if (const auto ns = node.ExclusiveNs(); ns > 0)
+            {
+                const auto count = std::to_string(ns);
+                output.append(stack).push_back(U' ');
+                output.append(count.begin(), count.end());
+                output.push_back(U'\n');
+            }
+        }
+        for (const auto child : node.Children)
+            self(self, child);
+        stack.resize(prevLen);
+    };
+    visit(visit, 0);
+    return common::str::to_string(output, common::str::Encoding::UTF8, common::str::Encoding::UTF32);
+}
+
+std::u32string_view NailangProfiler::GetCategoryName(const Category type) noexcept
+{
+    switch (type)
+    {
+    case Category::Root:        return U"Root"sv;
+    case Category::Block:       return U"Block"sv;
+    case Category::RawBlock:    return U"RawBlock"sv;
+    case Category::Func:        return U"Func"sv;
+    case Category::ReplaceFunc: return U"ReplaceFunc"sv;
+    case Category::Extension:   return U"Extension"sv;
+    default:                    return U"Unknown"sv;
+    }
+}
+
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "NailangRely.h"
+#include <chrono>
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+
+namespace xziar::nailang
+{
+
+
+/**
+ * @brief records call count and inclusive/exclusive time of blocks, funcs and extension handlers as a call tree
+ * @detail hooks only hold a nullable pointer, so a runtime without profiler only pays a null check per scope.
+ *         Not thread-safe, one profiler should be used by one runtime.
+*/
+class NAILANGAPI NailangProfiler
+{
+public:
+    enum class Category : uint8_t { Root, Block, RawBlock, Func, ReplaceFunc, Extension };
+    struct Node
+    {
+        std::u32string Name;
+        std::vector<uint32_t> Children;
+        uint32_t Parent;
+        Category Type;
+        uint64_t Count       = 0;
+        uint64_t InclusiveNs = 0;
+        uint64_t ChildNs     = 0;
+        Node(std::u32string_view name, Category type, uint32_t parent) : Name(name), Parent(parent), Type(type) { }
+        [[nodiscard]] constexpr uint64_t ExclusiveNs() const noexcept
+        {
+            return InclusiveNs > ChildNs ? InclusiveNs - ChildNs : 0;
+        }
+    };
+    struct Summary
+    {
+        std::u32string_view Name;
+        Category Type;
+        uint64_t Count       = 0;
+        uint64_t InclusiveNs = 0; // recursive calls are only counted at the outermost one
+        uint64_t ExclusiveNs = 0;
+    };
+    class [[nodiscard]] Scope
+    {
+    private:
+        NailangProfiler* Profiler;
+        uint32_t NodeIdx = 0;
+        std::chrono::high_resolution_clock::time_point Begin;
+    public:
+        Scope(NailangProfiler* profiler, Category type, std::u32string_view name) : Profiler(profiler)
+        {
+            if (Profiler)
+            {
+                NodeIdx = Profiler->Enter(type, name);
+                Begin = std::chrono::high_resolution_clock::now();
+            }
+        }
+        ~Scope()
+        {
+            if (Profiler)
+            {
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - Begin).count();
+                Profiler->Leave(NodeIdx, static_cast<uint64_t>(ns), true);
+            }
+        }
+        COMMON_NO_COPY(Scope)
+        COMMON_NO_MOVE(Scope)
+        // the handler is not responsible for the call, its time is left to the parent
+        void Discard() noexcept
+        {
+            if (Profiler)
+            {
+                Profiler->Leave(NodeIdx, 0, false);
+                Profiler = nullptr;
+            }
+        }
+    };
+private:
+    std::vector<Node> Nodes;
+    uint32_t Current = 0;
+    [[nodiscard]] uint32_t Enter(Category type, std::u32string_view name);
+    void Leave(uint32_t idx, uint64_t ns, bool record) noexcept;
+public:
+    NailangProfiler();
+    ~NailangProfiler();
+    COMMON_NO_COPY(NailangProfiler)
+
+    void Reset();
+    [[nodiscard]] constexpr const std::vector<Node>& GetNodes() const noexcept { return Nodes; }
+    [[nodiscard]] uint64_t GetTotalNs() const noexcept { return Nodes[0].ChildNs; }
+    // aggregated by category and name, sorted by exclusive time
+    [[nodiscard]] std::vector<Summary> Summarize() const;
+    // folded stacks weighted by exclusive ns, consumable by flamegraph.pl/speedscope
+    [[nodiscard]] std::string ExportFoldedStacks() const;
+    [[nodiscard]] static std::u32string_view GetCategoryName(const Category type) noexcept;
+};
+
+
+}
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
@@ -16,6 +16,7 @@
 #include "common/EnumEx.hpp"
 #include "common/StrBase.hpp"
 #include "SystemCommon/Exceptions.h"
+#include "SystemCommon/MiscIntrins.h"
 #include "common/StringLinq.hpp"
 #include "common/StringPool.hpp"
 #include "common/SharedString.hpp"
@@ -37,6 +38,10 @@
 namespace xziar::nailang
 {
 
+// names are hashed with runtime-selected fast hash instead of DJBHash
+using HashedStrView = common::str::HashedStrView<char32_t, common::FastStrHash>;
+using HashedStringPool = common::HashedStringPool<char32_t, common::FastStrHash>;
+
 
 class MemoryPool : protected common::container::TrunckedContainer<std::byte>
 {
@@ -0,0 +1,179 @@
+#include "NailangPch.h"
+#include "NailangRope.h"
+#include "SystemCommon/StrEncoding.hpp"
+
+
+namespace xziar::nailang
+{
+
+
+TextRope::TextRope() noexcept
+{ }
+TextRope::TextRope(TextRope&& other) noexcept :
+    Segments(std::move(other.Segments)), Chunks(std::move(other.Chunks)), Kept(std::move(other.Kept)),
+    Tail(other.Tail), TailUsed(other.TailUsed), TailCapacity(other.TailCapacity), Length(other.Length), OwnedChars(other.OwnedChars)
+{
+    other.clear();
+}
+TextRope& TextRope::operator=(TextRope&& other) noexcept
+{
+    if (this != &other)
+    {
+        Segments     = std::move(other.Segments);
+        Chunks       = std::move(other.Chunks);
+        Kept         = std::move(other.Kept);
+        Tail         = other.Tail;
+        TailUsed     = other.TailUsed;
+        TailCapacity = other.TailCapacity;
+        Length       = other.Length;
+        OwnedChars   = other.OwnedChars;
+        other.clear();
+    }
+    return *this;
+}
+TextRope::~TextRope()
+{ }
+
+TextRope& TextRope::AppendView(std::u32string_view str)
+{
+    if (str.size() <= CopyThreshold)
+        return append(str);
+    if (!Segments.empty())
+    {
+        auto& last = Segments.back();
+        if (last.data() + last.size() == str.data()) // continuous slices
+        {
+            last = std::u32string_view(last.data(), last.size() + str.size());
+            Length += str.size();
+            return *this;
+        }
+    }
+    Segments.push_back(str);
+    Length += str.size();
+    return *this;
+}
+
+std::u32string_view TextRope::Keep(std::u32string&& str)
+{
+    OwnedChars += str.capacity();
+    return *Kept.emplace_back(std::make_unique<std::u32string>(std::move(str)));
+}
+
+TextRope& TextRope::Append(TextRope&& other)
+{
+    if (&other == this || other.empty())
+        return *this;
+    Segments.insert(Segments.end(), other.Segments.begin(), other.Segments.end());
+    for (auto& chunk : other.Chunks)
+        Chunks.push_back(std::move(chunk));
+    for (auto& str : other.Kept)
+        Kept.push_back(std::move(str));
+    Length     += other.Length;
+    OwnedChars += other.OwnedChars;
+    other.clear();
+    return *this;
+}
+
+TextRope& TextRope::Prepend(std::u32string_view str)
+{
+    if (str.empty())
+        return *this;
+    const auto kept = Keep(std::u32string(str));
+    Segments.insert(Segments.begin(), kept);
+    Length += kept.size();
+    return *this;
+}
+
+TextRope& TextRope::append(std::u32string_view str)
+{
+    if (str.empty())
+        return *this;
+    if (TailCapacity - TailUsed < str.size())
+    {
+        const auto capacity = std::max(ChunkSize, str.size());
+        Tail = Chunks.emplace_back(new char32_t[capacity]).get();
+        TailUsed = 0;
+        TailCapacity = capacity;
+        OwnedChars += capacity;
+    }
+    const auto dst = Tail + TailUsed;
+    memcpy(dst, str.data(), str.size() * sizeof(char32_t));
+    TailUsed += str.size();
+    if (!Segments.empty() && Segments.back().data() + Segments.back().size() == dst)
+        Segments.back() = std::u32string_view(Segments.back().data(), Segments.back().size() + str.size());
+    else
+        Segments.emplace_back(dst, str.size());
+    Length += str.size();
+    return *this;
+}
+
+void TextRope::pop_back() noexcept
+{
+    Expects(!Segments.empty());
+    auto& last = Segments.back();
+    if (Tail && last.data() + last.size() == Tail + TailUsed)
+        TailUsed--;
+    last.remove_suffix(1);
+    if (last.empty())
+        Segments.pop_back();
+    Length--;
+}
+
+void TextRope::clear() noexcept
+{
+    Segments.clear();
+    Chunks.clear();
+    Kept.clear();
+    Tail = nullptr;
+    TailUsed = TailCapacity = 0;
+    Length = OwnedChars = 0;
+}
+
+size_t TextRope::OwnedBytes() const noexcept
+{
+    return OwnedChars * sizeof(char32_t) + Segments.capacity() * sizeof(std::u32string_view);
+}
+
+void TextRope::AppendTo(std::u32string& output) const
+{
+    output.reserve(output.size() + Length);
+    for (const auto seg : Segments)
+        output.append(seg);
+}
+
+std::u32string TextRope::ToU32String() const
+{
+    std::u32string output;
+    AppendTo(output);
+    return output;
+}
+
+void TextRope::AppendUTF8(std::string& output) const
+{
+    using common::str::charset::detail::UTF8;
+    output.reserve(output.size() + Length); // exact for ASCII
+    for (const auto seg : Segments)
+    {
+        for (const auto ch : seg)
+        {
+            if (ch < 0x80u)
+                output.push_back(static_cast<char>(ch));
+            else
+            {
+                uint8_t tmp[4];
+                const auto cnt = UTF8::ToBytes(ch, 4, tmp);
+                output.append(reinterpret_cast<const char*>(tmp), cnt);
+            }
+        }
+    }
+}
+
+std::string TextRope::ToUTF8() const
+{
+    std::string output;
+    AppendUTF8(output);
+    return output;
+}
+
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "NailangRely.h"
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+
+namespace xziar::nailang
+{
+
+
+/**
+ * @brief segmented utf32 text builder for generated sources
+ * @detail borrowed views (eg. slices of the program source) are referenced without copy,
+ *         small appends are packed into owned chunks, the final text is encoded in one pass.
+ *         Provides the subset of std::u32string used by output code, so it can be used with fmt::format_to.
+ *         Borrowed views must outlive the rope.
+*/
+class NAILANGAPI TextRope
+{
+private:
+    static constexpr size_t ChunkSize = 4096;
+    static constexpr size_t CopyThreshold = 32; // tiny views are copied to avoid fragments
+    std::vector<std::u32string_view> Segments;
+    std::vector<std::unique_ptr<char32_t[]>> Chunks;
+    std::vector<std::unique_ptr<std::u32string>> Kept;
+    char32_t* Tail = nullptr;
+    size_t TailUsed = 0, TailCapacity = 0;
+    size_t Length = 0;
+    size_t OwnedChars = 0;
+public:
+    using value_type = char32_t;
+
+    TextRope() noexcept;
+    TextRope(TextRope&& other) noexcept;
+    TextRope& operator=(TextRope&& other) noexcept;
+    ~TextRope();
+    COMMON_NO_COPY(TextRope)
+
+    // reference the string without copy
+    TextRope& AppendView(std::u32string_view str);
+    // keep the string alive with the rope without appending it
+    [[nodiscard]] std::u32string_view Keep(std::u32string&& str);
+    // move segments and storage of the other rope
+    TextRope& Append(TextRope&& other);
+    TextRope& Prepend(std::u32string_view str);
+
+    TextRope& append(std::u32string_view str);
+    TextRope& append(const std::u32string& str) { return append(std::u32string_view(str)); }
+    TextRope& append(const char32_t* str) { return append(std::u32string_view(str)); }
+    void push_back(const char32_t ch)
+    {
+        // fast path for fmt::format_to with back_inserter
+        if (TailUsed < TailCapacity && !Segments.empty())
+        {
+            auto& last = Segments.back();
+            if (last.data() + last.size() == Tail + TailUsed)
+            {
+                Tail[TailUsed++] = ch;
+                last = std::u32string_view(last.data(), last.size() + 1);
+                Length++;
+                return;
+            }
+        }
+        append(std::u32string_view(&ch, 1));
+    }
+    [[nodiscard]] char32_t back() const noexcept { return Segments.back().back(); }
+    void pop_back() noexcept;
+    [[nodiscard]] constexpr size_t size() const noexcept { return Length; }
+    [[nodiscard]] constexpr bool empty() const noexcept { return Length == 0; }
+    void clear() noexcept;
+
+    [[nodiscard]] constexpr size_t SegmentCount() const noexcept { return Segments.size(); }
+    // owned memory in bytes, borrowed views excluded
+    [[nodiscard]] size_t OwnedBytes() const noexcept;
+    void AppendTo(std::u32string& output) const;
+    [[nodiscard]] std::u32string ToU32String() const;
+    void AppendUTF8(std::string& output) const;
+    [[nodiscard]] std::string ToUTF8() const;
+};
+
+
+}
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
@@ -12,7 +12,6 @@ namespace xziar::nailang
 {
 using namespace std::string_view_literals;
 using common::DJBHash;
-using common::str::HashedStrView;
 
 
 #define NLRT_THROW_EX(...) HandleException(CREATE_EXCEPTIONEX(NailangRuntimeException, __VA_ARGS__))
@@ -851,6 +850,7 @@ Arg NailangExecutor::EvaluateFunc(const FuncCall& func, EvalTempStore& store, Me
         NLRT_THROW_EX(FMTSTR(u"MetaFunc [{}] can not be evaluated here.", fullName), func);
     }
     NailangFrame::FuncInfoHolder holder(&GetFrame(), &func);
+    NailangProfiler::Scope profScope(Runtime->Profiler, NailangProfiler::Category::Func, fullName);
     // only for plain function
     if (func.Name->Info() == FuncName::FuncInfo::Empty && func.Name->PartCount == 1)
     {
@@ -1310,6 +1310,7 @@ void NailangExecutor::EvaluateRawBlock(const RawBlock&, common::span<const FuncC
 
 void NailangExecutor::EvaluateBlock(const Block& block, common::span<const FuncCall> metas)
 {
+    NailangProfiler::Scope profScope(Runtime->Profiler, NailangProfiler::Category::Block, block.Name);
     auto curFrame = PushBlockFrame(Runtime->ConstructEvalContext(), NailangFrame::FrameFlags::Empty, &block, metas);
     ExecuteFrame(*curFrame);
 }
@@ -1526,6 +1527,7 @@ NailangBasicRuntime::~NailangBasicRuntime()
 
 void NailangBasicRuntime::ExecuteBlock(const Block& block, common::span<const FuncCall> metas, std::shared_ptr<EvaluateContext> ctx, const bool checkMetas)
 {
+    NailangProfiler::Scope profScope(Profiler, NailangProfiler::Category::Block, block.Name);
     auto curFrame = Executor.PushBlockFrame(std::move(ctx), NailangFrame::FrameFlags::FlowScope, &block, metas);
     if (checkMetas && !metas.empty())
     {
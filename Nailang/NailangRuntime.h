@@ -1,5 +1,6 @@
 #pragma once
 #include "NailangStruct.h"
+#include "NailangProfiler.h"
 #include "SystemCommon/Exceptions.h"
 #include "common/StringPool.hpp"
 #include "common/STLEx.hpp"
@@ -86,7 +87,7 @@ public:
 class NAILANGAPI CompactEvaluateContext : public BasicEvaluateContext
 {
 private:
-    common::HashedStringPool<char32_t> ArgNames;
+    HashedStringPool ArgNames;
 protected:
     std::vector<std::pair<common::StringPiece<char32_t>, Arg>> Args;
     std::vector<std::pair<std::u32string_view, LocalFuncHolder>> LocalFuncs;
@@ -765,6 +766,7 @@ protected:
     MemoryPool MemPool;
     std::shared_ptr<EvaluateContext> RootContext;
     NailangFrameStack FrameStack;
+    NailangProfiler* Profiler = nullptr;
 
     constexpr NailangFrame* CurFrame() const noexcept { return FrameStack.TopFrame; }
 
@@ -794,6 +796,9 @@ protected:
 public:
     NailangRuntime(std::shared_ptr<EvaluateContext> context);
     virtual ~NailangRuntime();
+    // profiler is not owned, pass nullptr to disable
+    void SetProfiler(NailangProfiler* profiler) noexcept { Profiler = profiler; }
+    [[nodiscard]] constexpr NailangProfiler* GetProfiler() const noexcept { return Profiler; }
 };
 
 inline constexpr NailangFrame& NailangExecutor::GetFrame() const noexcept
@@ -55,6 +55,7 @@ public:
     [[nodiscard]] xcomp::ReplaceResult ReplaceFunc(xcomp::XCNLRawExecutor& executor, std::u32string_view func,
         common::span<const std::u32string_view> args) final;
     [[nodiscard]] std::optional<xziar::nailang::Arg> ConfigFunc(xcomp::XCNLExecutor& executor, xziar::nailang::FuncEvalPack& func) final;
+    [[nodiscard]] bool SupportParallelInstance() const noexcept final { return true; }
 
     std::shared_ptr<Dp4aProvider> GetDefaultProvider() const;
     std::shared_ptr<Dp4aProvider> Generate(std::u32string_view mimic, std::u32string_view args) const;
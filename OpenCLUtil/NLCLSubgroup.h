@@ -48,6 +48,7 @@ public:
     [[nodiscard]] xcomp::ReplaceResult ReplaceFunc(xcomp::XCNLRawExecutor& executor, std::u32string_view func,
         common::span<const std::u32string_view> args) final;
     [[nodiscard]] std::optional<xziar::nailang::Arg> ConfigFunc(xcomp::XCNLExecutor& executor, xziar::nailang::FuncEvalPack& call) final;
+    [[nodiscard]] bool SupportParallelInstance() const noexcept final { return true; }
     std::shared_ptr<SubgroupProvider> Generate(common::mlog::MiniLogger<false>& logger, std::u32string_view mimic, std::u32string_view args);
 
     static NLCLSubgroupCapbility GenerateCapabiity(NLCLContext& context, const SubgroupAttributes& attr);
@@ -8,4 +8,6 @@
 #include "oclProgram.h"
 #include "oclBuffer.h"
 #include "oclImage.h"
+#include "oclMemPool.h"
+#include "oclTuner.h"
 #include "oclUtil.h"
@@ -85,6 +85,13 @@ PromiseResult<void> oclSubBuffer_::WriteSpan(const common::PromiseStub& pmss, co
     return oclPromise<void>::Create(std::move(evts), e, que);
 }
 
+common::AlignedBuffer oclSubBuffer_::ReadView(const oclCmdQue& que)
+{
+    if (ZeroCopy)
+        return Map(que, MapFlag::Read).AsBuffer();
+    return Read(que)->Get();
+}
+
 
 oclBuffer_::oclBuffer_(const oclContext& ctx, const MemFlag flag, const size_t size, const uintptr_t id)
     : oclSubBuffer_(ctx, flag, size, id)
@@ -138,6 +145,22 @@ oclBuffer oclBuffer_::Create(const oclContext& ctx, const MemFlag flag, const si
     return MAKE_ENABLER_SHARED(oclBuffer_, (ctx, oclMem_::ProcessMemFlag(*ctx, flag, ptr), size, ptr));
 }
 
+oclBuffer oclBuffer_::WrapHost(const oclContext& ctx, MemFlag flag, const common::AlignedBuffer& buffer)
+{
+    flag = REMOVE_MASK(flag, MemFlag::HostInitMask) | MemFlag::UseHost;
+    auto buf = Create(ctx, flag, buffer.GetSize(), buffer.GetRawPtr());
+    buf->BindHostMemory(buffer);
+    return buf;
+}
+
+oclBuffer oclBuffer_::CreateFromHost(const oclContext& ctx, MemFlag flag, const common::AlignedBuffer& buffer)
+{
+    if (ctx->IsHostUnified())
+        return WrapHost(ctx, flag, buffer);
+    flag = REMOVE_MASK(flag, MemFlag::HostInitMask) | MemFlag::HostCopy;
+    return Create(ctx, flag, buffer.GetSize(), buffer.GetRawPtr());
+}
+
 
 
 }
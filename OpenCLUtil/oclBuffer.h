@@ -58,6 +58,8 @@ public:
     {
         return Read({}, que, offset);
     }
+    // map the buffer when it's zero-copy (unmapped when released), otherwise read a copy
+    [[nodiscard]] common::AlignedBuffer ReadView(const oclCmdQue& que);
 
     [[nodiscard]] common::PromiseResult<void> WriteSpan(const common::PromiseStub& pmss, const oclCmdQue& que, common::span<const std::byte> buf, const size_t offset = 0) const;
     [[nodiscard]] common::PromiseResult<void> WriteSpan(const oclCmdQue& que, common::span<const std::byte> buf, const size_t offset = 0) const
@@ -92,6 +94,7 @@ class OCLUAPI oclBuffer_ : public oclSubBuffer_
 {
     friend class oclKernel_;
     friend class oclContext_;
+    friend class oclMemPool_;
 private:
     MAKE_ENABLER();
 protected:
@@ -104,6 +107,10 @@ public:
         return CreateSubBuffer(offset, size, REMOVE_MASK(Flag, MemFlag::HostInitMask));
     }
     [[nodiscard]] static oclBuffer Create(const oclContext& ctx, const MemFlag flag, const size_t size, const void* ptr = nullptr);
+    // use [buffer] as storage (UseHost) and keep a reference of it, zero-copy on devices with unified host memory
+    [[nodiscard]] static oclBuffer WrapHost(const oclContext& ctx, MemFlag flag, const common::AlignedBuffer& buffer);
+    // wrap [buffer] on devices with unified host memory, otherwise copy it to device memory
+    [[nodiscard]] static oclBuffer CreateFromHost(const oclContext& ctx, MemFlag flag, const common::AlignedBuffer& buffer);
 };
 
 
@@ -142,6 +142,14 @@ bool oclContext_::CheckIncludeDevice(const oclDevice dev) const noexcept
     return false;
 }
 
+bool oclContext_::IsHostUnified() const noexcept
+{
+    for (const auto& dev : Devices)
+        if (!dev->HostUnifiedMemory)
+            return false;
+    return !Devices.empty();
+}
+
 common::PromiseResult<void> oclContext_::CreateUserEvent(common::PmsCore pms)
 {
     if (const auto clEvt = std::dynamic_pointer_cast<oclPromiseCore>(pms); clEvt)
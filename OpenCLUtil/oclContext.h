@@ -45,6 +45,8 @@ public:
     [[nodiscard]] bool ShouldDebugResurce() const;
     [[nodiscard]] bool CheckExtensionSupport(const std::string_view name) const;
     [[nodiscard]] bool CheckIncludeDevice(const oclDevice dev) const noexcept;
+    // all devices share memory with host, so that UseHost memory can be zero-copy
+    [[nodiscard]] bool IsHostUnified() const noexcept;
     common::container::FrozenDenseSet<xziar::img::TextureFormat> Img2DFormatSupport;
     common::container::FrozenDenseSet<xziar::img::TextureFormat> Img3DFormatSupport;
     mutable common::Delegate<const std::u16string&> OnMessage;
@@ -194,6 +194,7 @@ void oclDevice_::Init()
     SupportImage            = GetBool(Funcs, *DeviceID, CL_DEVICE_IMAGE_SUPPORT);
     LittleEndian            = GetBool(Funcs, *DeviceID, CL_DEVICE_ENDIAN_LITTLE);
     HasCompiler             = GetBool(Funcs, *DeviceID, CL_DEVICE_COMPILER_AVAILABLE);
+    HostUnifiedMemory       = Type == DeviceType::CPU || GetBool(Funcs, *DeviceID, CL_DEVICE_HOST_UNIFIED_MEMORY);
 }
 
 std::optional<uint32_t> oclDevice_::GetNvidiaSMVersion() const noexcept
@@ -44,7 +44,7 @@ public:
     uint32_t Version = 0, CVersion = 0;
     xcomp::PCI_BDF PCIEAddress;
     bool SupportProfiling = false, SupportOutOfOrder = false, SupportImplicitGLSync = false, SupportImage = false;
-    bool LittleEndian = true, HasCompiler = false;
+    bool LittleEndian = true, HasCompiler = false, HostUnifiedMemory = false;
     Vendors PlatVendor;
     DeviceType Type;
 
@@ -328,6 +328,22 @@ oclImg2D oclImage2D_::Create(const oclContext & ctx, const MemFlag flag, const u
     return MAKE_ENABLER_SHARED(oclImage2D_, (ctx, flag, width, height, format, ptr));
 }
 
+oclImg2D oclImage2D_::WrapHost(const oclContext& ctx, MemFlag flag, const Image& image, const bool isNormalized)
+{
+    flag = REMOVE_MASK(flag, MemFlag::HostInitMask) | MemFlag::UseHost;
+    auto img = Create(ctx, flag, image, isNormalized);
+    img->BindHostMemory(image.GetData());
+    return img;
+}
+
+oclImg2D oclImage2D_::CreateFromHost(const oclContext& ctx, MemFlag flag, const Image& image, const bool isNormalized)
+{
+    if (ctx->IsHostUnified())
+        return WrapHost(ctx, flag, image, isNormalized);
+    flag = REMOVE_MASK(flag, MemFlag::HostInitMask) | MemFlag::HostCopy;
+    return Create(ctx, flag, image, isNormalized);
+}
+
 
 oclImage3D_::oclImage3D_(const oclContext& ctx, const MemFlag flag, const uint32_t width, const uint32_t height, const uint32_t depth, const TextureFormat format, const void* ptr)
     : oclImage_(ctx, oclMem_::ProcessMemFlag(*ctx, flag, ptr), width, height, depth, format, CL_MEM_OBJECT_IMAGE3D, ptr)
@@ -85,6 +85,7 @@ public:
 
 class OCLUAPI oclImage2D_ : public oclImage_ 
 {
+    friend class oclMemPool_;
 protected:
     MAKE_ENABLER();
     using oclImage_::oclImage_;
@@ -101,6 +102,10 @@ public:
     {
         return Create(ctx, flag, image.GetWidth(), image.GetHeight(), xziar::img::TexFormatUtil::FromImageDType(image.GetDataType(), isNormalized), image.GetRawPtr());
     }
+    // use [image]'s data as storage (UseHost) and keep a reference of it, zero-copy on devices with unified host memory
+    [[nodiscard]] static oclImg2D WrapHost(const oclContext& ctx, MemFlag flag, const xziar::img::Image& image, const bool isNormalized = true);
+    // wrap [image] on devices with unified host memory, otherwise copy it to device memory
+    [[nodiscard]] static oclImg2D CreateFromHost(const oclContext& ctx, MemFlag flag, const xziar::img::Image& image, const bool isNormalized = true);
 };
 
 class OCLUAPI oclImage3D_ : public oclImage_
@@ -43,9 +43,9 @@ DefType(CLMem, cl_mem);
     clCreateCommandQueue, clReleaseCommandQueue, clEnqueueBarrier, clFlush, clFinish, \
     clCreateBuffer, clCreateSubBuffer, clEnqueueMapBuffer, clEnqueueReadBuffer, clEnqueueWriteBuffer, \
     clCreateImage, clCreateImage2D, clCreateImage3D, clEnqueueMapImage, clEnqueueReadImage, clEnqueueWriteImage, \
-    clGetMemObjectInfo, clReleaseMemObject, clEnqueueUnmapMemObject, \
+    clGetMemObjectInfo, clReleaseMemObject, clEnqueueUnmapMemObject, clSetMemObjectDestructorCallback, \
     clCreateProgramWithSource, clReleaseProgram, clBuildProgram, clGetProgramBuildInfo, clGetProgramInfo, \
-    clCreateKernel, clCreateKernelsInProgram, clCloneKernel, clSetKernelArg, clEnqueueNDRangeKernel, \
+    clCreateKernel, clCreateKernelsInProgram, clCloneKernel, clReleaseKernel, clSetKernelArg, clEnqueueNDRangeKernel, \
     clGetKernelInfo, clGetKernelArgInfo, clGetKernelWorkGroupInfo, \
     clEnqueueAcquireGLObjects, clEnqueueReleaseGLObjects, clCreateFromGLBuffer, clCreateFromGLTexture)
 #define PLATFUNCS_EACH_(r, func, f) func(f)
@@ -109,6 +109,12 @@ struct NLCLDebugExtension : public NLCLExtension, public xcomp::debug::XCNLDebug
     NLCLDebugExtension(NLCLContext& context) : NLCLExtension(context) { }
     ~NLCLDebugExtension() override { }
 
+    // debug ids are allocated in kernel order
+    [[nodiscard]] bool SupportParallelInstance() const noexcept override
+    {
+        return !EnableDebug;
+    }
+
     void FinishXCNL(xcomp::XCNLRuntime& runtime) override
     {
         Expects(dynamic_cast<NLCLRuntime*>(&runtime) != nullptr);
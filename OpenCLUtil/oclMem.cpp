@@ -53,8 +53,15 @@ oclMem_::oclMapPtr_::~oclMapPtr_()
 }
 
 
+static void CL_CALLBACK ReleaseHostMemory(cl_mem, void* user_data)
+{
+    delete reinterpret_cast<common::AlignedBuffer*>(user_data);
+}
+
+
 oclMem_::oclMem_(oclContext ctx, void* mem, const MemFlag flag) :
-    detail::oclCommon(*ctx), Context(std::move(ctx)), MemID(mem), Flag(flag)
+    detail::oclCommon(*ctx), Context(std::move(ctx)), MemID(mem), Flag(flag), 
+    ZeroCopy(HAS_FIELD(flag, MemFlag::HostAlloc) && Context->IsHostUnified())
 { }
 oclMem_::~oclMem_()
 {
@@ -87,6 +94,28 @@ void oclMem_::Flush(const oclCmdQue& que)
     }
 }
 
+void oclMem_::BindHostMemory(const common::AlignedBuffer& buffer)
+{
+    if (const auto align = GetHostAlignment(*Context); reinterpret_cast<uintptr_t>(buffer.GetRawPtr()) % align != 0)
+        oclLog().warning(u"host memory {:p} is not aligned to [{}], it may be copied by driver.\n", (void*)buffer.GetRawPtr(), align);
+    // sub buffer only adds a reference
+    auto holder = std::make_unique<common::AlignedBuffer>(buffer.CreateSubBuffer());
+    if (Context->Version >= 11 && 
+        Funcs->clSetMemObjectDestructorCallback(*MemID, &ReleaseHostMemory, holder.get()) == CL_SUCCESS)
+        holder.release();
+    else
+        HostMemory = std::move(holder);
+    ZeroCopy = Context->IsHostUnified();
+}
+
+size_t oclMem_::GetHostAlignment(const oclContext_& context) noexcept
+{
+    size_t align = 4096; // page aligned memory is preferred by most drivers
+    for (const auto& dev : context.Devices)
+        align = std::max<size_t>(align, dev->MemBaseAddrAlign / 8);
+    return align;
+}
+
 MemFlag oclMem_::ProcessMemFlag(const oclContext_& context, MemFlag flag, const void* ptr)
 {
     if (!CheckMemFlagDevAccess(flag))
@@ -62,6 +62,7 @@ class OCLUAPI oclMem_ : public detail::oclCommon, public std::enable_shared_from
     friend class oclKernel_;
     friend class oclContext_;
     friend class oclMapPtr;
+    friend class oclMemPool_;
     template<typename> friend class oclGLObject_;
 private:
     class OCLUAPI oclMapPtr_
@@ -78,19 +79,28 @@ private:
         oclMapPtr_(oclCmdQue&& que, oclMem_* mem, const MapFlag mapFlag);
         ~oclMapPtr_();
     };
+    // only used when destructor callback is not supported
+    std::unique_ptr<common::AlignedBuffer> HostMemory;
 protected:
     const oclContext Context;
     CLHandle<detail::CLMem> MemID;
     const MemFlag Flag;
+    bool ZeroCopy = false;
     oclMem_(oclContext ctx, void* mem, const MemFlag flag);
     [[nodiscard]] virtual common::span<std::byte> MapObject(CLHandle<detail::CLCmdQue> que, const MapFlag mapFlag) = 0;
+    // keep host memory of UseHost object alive until the object is actually released by the driver
+    void BindHostMemory(const common::AlignedBuffer& buffer);
 public:
     COMMON_NO_COPY(oclMem_)
     COMMON_NO_MOVE(oclMem_)
     virtual ~oclMem_();
     [[nodiscard]] oclMapPtr Map(oclCmdQue que, const MapFlag mapFlag);
     void Flush(const oclCmdQue& que);
+    // device works on host memory directly, mapping it does not copy
+    [[nodiscard]] bool IsZeroCopy() const noexcept { return ZeroCopy; }
     static MemFlag ProcessMemFlag(const oclContext_& context, MemFlag flag, const void* ptr);
+    // alignment of host memory required by all devices for zero-copy
+    [[nodiscard]] static size_t GetHostAlignment(const oclContext_& context) noexcept;
 };
 
 
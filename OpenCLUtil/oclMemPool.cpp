@@ -0,0 +1,279 @@
+#include "oclPch.h"
+#include "oclMemPool.h"
+#include "oclUtil.h"
+#include <mutex>
+
+
+namespace oclu
+{
+using xziar::img::TextureFormat;
+using xziar::img::TexFormatUtil;
+MAKE_ENABLER_IMPL(oclMemPool_)
+
+
+class oclMemPool_::PoolHost : public std::enable_shared_from_this<PoolHost>
+{
+private:
+    template<typename T>
+    struct CachedItem
+    {
+        std::unique_ptr<T> Obj;
+        size_t Bytes;
+        uint64_t Stamp;
+    };
+    template<typename T, typename K>
+    using CacheMap = std::map<K, std::vector<CachedItem<T>>, std::less<>>;
+    using ImageKey = std::tuple<uint32_t, uint32_t, TextureFormat>;
+
+    // returns the object to the pool when the last reference is released
+    template<typename T>
+    struct Recycler
+    {
+        std::weak_ptr<PoolHost> Host;
+        void operator()(T* obj) const noexcept
+        {
+            std::unique_ptr<T> holder(obj);
+            if (const auto host = Host.lock(); host)
+                host->Recycle(std::move(holder));
+        }
+    };
+
+    mutable std::mutex Lock;
+    CacheMap<oclBuffer_, size_t> Buffers;
+    CacheMap<oclImage2D_, ImageKey> Images;
+    MemPoolStats Stats;
+    uint64_t Stamp = 0;
+
+    template<typename T, typename K>
+    std::unique_ptr<T> Take(CacheMap<T, K>& cache, const K& key, const MemFlag flag)
+    {
+        std::unique_ptr<T> obj;
+        std::unique_lock<std::mutex> lock(Lock);
+        Stats.Requests++;
+        const auto it = cache.find(key);
+        if (it == cache.end())
+            return obj;
+        auto& items = it->second;
+        // prefer exact match, take the recent one since it's more likely to stay in device cache
+        auto match = std::find_if(items.rbegin(), items.rend(), [&](const auto& item) { return item.Obj->Flag == flag; });
+        if (match == items.rend())
+            match = std::find_if(items.rbegin(), items.rend(), [&](const auto& item) { return CheckFlagCompatible(item.Obj->Flag, flag); });
+        if (match == items.rend())
+            return obj;
+        obj = std::move(match->Obj);
+        Stats.Hits++;
+        Stats.CachedCount--;
+        Stats.CachedBytes -= match->Bytes;
+        items.erase(std::next(match).base());
+        if (items.empty())
+            cache.erase(it);
+        return obj;
+    }
+    template<typename T, typename K>
+    void Put(CacheMap<T, K>& cache, const K& key, std::unique_ptr<T> obj, const size_t bytes)
+    {
+        std::unique_lock<std::mutex> lock(Lock);
+        if (Stats.CachedBytes + bytes > Capacity)
+        {
+            Stats.Released++;
+            Stats.LiveBytes -= bytes;
+            lock.unlock();
+            return; // released outside the lock
+        }
+        cache[key].push_back({ std::move(obj), bytes, Stamp++ });
+        Stats.Recycled++;
+        Stats.CachedCount++;
+        Stats.CachedBytes += bytes;
+    }
+    template<typename T, typename K>
+    static typename CacheMap<T, K>::iterator FindOldest(CacheMap<T, K>& cache, uint64_t& stamp) noexcept
+    {
+        auto oldest = cache.end();
+        for (auto it = cache.begin(); it != cache.end(); ++it)
+        {
+            // items are pushed in returning order
+            if (const auto& item = it->second.front(); item.Stamp < stamp)
+            {
+                stamp = item.Stamp;
+                oldest = it;
+            }
+        }
+        return oldest;
+    }
+    template<typename T, typename K>
+    static size_t PopOldest(CacheMap<T, K>& cache, typename CacheMap<T, K>::iterator it, std::vector<std::unique_ptr<oclMem_>>& released)
+    {
+        auto& items = it->second;
+        const auto bytes = items.front().Bytes;
+        released.push_back(std::move(items.front().Obj));
+        items.erase(items.begin());
+        if (items.empty())
+            cache.erase(it);
+        return bytes;
+    }
+    void Recycle(std::unique_ptr<oclBuffer_> obj)
+    {
+        const auto size = obj->Size;
+        Put(Buffers, size, std::move(obj), size);
+    }
+    void Recycle(std::unique_ptr<oclImage2D_> obj)
+    {
+        const ImageKey key{ obj->Width, obj->Height, obj->GetFormat() };
+        const auto bytes = GetImageBytes(*obj);
+        Put(Images, key, std::move(obj), bytes);
+    }
+public:
+    oclContext Context;
+    size_t Capacity;
+    PoolHost(const oclContext& ctx, const size_t capacity) : Context(ctx), Capacity(capacity) { }
+
+    static size_t GetImageBytes(const oclImage2D_& img) noexcept
+    {
+        return size_t(img.Width) * img.Height * TexFormatUtil::BitPerPixel(img.GetFormat()) / 8;
+    }
+    std::unique_ptr<oclBuffer_> TakeBuffer(const MemFlag flag, const size_t size)
+    {
+        return Take(Buffers, size, flag);
+    }
+    std::unique_ptr<oclImage2D_> TakeImage2D(const MemFlag flag, const uint32_t width, const uint32_t height, const TextureFormat format)
+    {
+        return Take(Images, ImageKey{ width, height, format }, flag);
+    }
+    template<typename T>
+    std::shared_ptr<T> Wrap(std::unique_ptr<T> obj)
+    {
+        return std::shared_ptr<T>(obj.release(), Recycler<T>{ weak_from_this() });
+    }
+    void OnCreate(const size_t bytes)
+    {
+        std::unique_lock<std::mutex> lock(Lock);
+        Stats.LiveBytes += bytes;
+    }
+    void Trim(const size_t maxBytes)
+    {
+        std::vector<std::unique_ptr<oclMem_>> released; // released outside the lock
+        {
+            std::unique_lock<std::mutex> lock(Lock);
+            while (Stats.CachedBytes > maxBytes)
+            {
+                uint64_t stamp = UINT64_MAX;
+                const auto oldBuf = FindOldest(Buffers, stamp);
+                const auto oldImg = FindOldest(Images, stamp);
+                size_t bytes = 0;
+                if (oldImg != Images.end())
+                    bytes = PopOldest(Images, oldImg, released);
+                else if (oldBuf != Buffers.end())
+                    bytes = PopOldest(Buffers, oldBuf, released);
+                else
+                    break;
+                Stats.Released++;
+                Stats.CachedCount--;
+                Stats.CachedBytes -= bytes;
+                Stats.LiveBytes -= bytes;
+            }
+        }
+        if (!released.empty() && Context->ShouldDebugResurce())
+            oclLog().debug(u"oclMemPool trimmed [{}] objects.\n", released.size());
+    }
+    void SetCapacity(const size_t capacity)
+    {
+        {
+            std::unique_lock<std::mutex> lock(Lock);
+            Capacity = capacity;
+        }
+        Trim(capacity);
+    }
+    MemPoolStats GetStats() const
+    {
+        std::unique_lock<std::mutex> lock(Lock);
+        return Stats;
+    }
+};
+
+
+oclMemPool_::oclMemPool_(const oclContext& ctx, const size_t capacity) :
+    Host(std::make_shared<PoolHost>(ctx, capacity))
+{ }
+oclMemPool_::~oclMemPool_()
+{ }
+
+oclBuffer oclMemPool_::AcquireBuffer(MemFlag flag, const size_t size)
+{
+    flag = oclMem_::ProcessMemFlag(*Host->Context, flag, nullptr);
+    if (HAS_FIELD(flag, MemFlag::UseHost) || HAS_FIELD(flag, MemFlag::HostCopy))
+        COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"pooled memory cannot be initialized from host memory");
+    const auto sizeClass = GetSizeClass(size);
+    auto obj = Host->TakeBuffer(flag, sizeClass);
+    if (!obj)
+    {
+        obj.reset(new oclBuffer_(Host->Context, flag, sizeClass, static_cast<const void*>(nullptr)));
+        Host->OnCreate(sizeClass);
+    }
+    return Host->Wrap(std::move(obj));
+}
+
+oclImg2D oclMemPool_::AcquireImage2D(MemFlag flag, const uint32_t width, const uint32_t height, const TextureFormat format)
+{
+    flag = oclMem_::ProcessMemFlag(*Host->Context, flag, nullptr);
+    if (HAS_FIELD(flag, MemFlag::UseHost) || HAS_FIELD(flag, MemFlag::HostCopy))
+        COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"pooled memory cannot be initialized from host memory");
+    auto obj = Host->TakeImage2D(flag, width, height, format);
+    if (!obj)
+    {
+        obj.reset(new oclImage2D_(Host->Context, flag, width, height, format, nullptr));
+        Host->OnCreate(PoolHost::GetImageBytes(*obj));
+    }
+    return Host->Wrap(std::move(obj));
+}
+
+void oclMemPool_::Trim(const size_t maxBytes)
+{
+    Host->Trim(maxBytes);
+}
+
+void oclMemPool_::SetCapacity(const size_t capacity)
+{
+    Host->SetCapacity(capacity);
+}
+
+MemPoolStats oclMemPool_::GetStats() const
+{
+    return Host->GetStats();
+}
+
+size_t oclMemPool_::GetSizeClass(const size_t size) noexcept
+{
+    constexpr size_t MinSize = 4096;
+    if (size <= MinSize)
+        return MinSize;
+    // 4 classes between powers of 2, so at most 25% is wasted
+    size_t pow2 = MinSize;
+    while (pow2 <= size / 2)
+        pow2 *= 2;
+    const auto step = pow2 / 4;
+    return (size + step - 1) / step * step;
+}
+
+bool oclMemPool_::CheckFlagCompatible(const MemFlag cached, const MemFlag requested) noexcept
+{
+    // HostAlloc changes where the memory lives
+    if ((cached & MemFlag::HostInitMask) != (requested & MemFlag::HostInitMask))
+        return false;
+    // ReadWrite can serve any device access
+    if (const auto devAccess = cached & MemFlag::DeviceAccessMask;
+        devAccess != (requested & MemFlag::DeviceAccessMask) && devAccess != MemFlag::ReadWrite)
+        return false;
+    // no host access limitation can serve any host access
+    if (const auto hostAccess = cached & MemFlag::HostAccessMask;
+        hostAccess != (requested & MemFlag::HostAccessMask) && hostAccess != MemFlag::Empty)
+        return false;
+    return true;
+}
+
+oclMemPool oclMemPool_::Create(const oclContext& ctx, const size_t capacity)
+{
+    return MAKE_ENABLER_SHARED(oclMemPool_, (ctx, capacity));
+}
+
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "oclRely.h"
+#include "oclBuffer.h"
+#include "oclImage.h"
+
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+
+namespace oclu
+{
+class oclMemPool_;
+using oclMemPool = std::shared_ptr<oclMemPool_>;
+
+
+struct MemPoolStats
+{
+    uint64_t Requests = 0;
+    uint64_t Hits = 0;
+    uint64_t Recycled = 0;
+    uint64_t Released = 0;
+    size_t CachedCount = 0;
+    size_t CachedBytes = 0;
+    size_t LiveBytes = 0;
+};
+
+
+// reuse device memory of temporary buffers/images within a context.
+// objects return to the pool once all references are released (including kernel calls and map ptrs),
+// make sure the last command using it has been enqueued to the same in-order queue or finished.
+class OCLUAPI oclMemPool_
+{
+private:
+    MAKE_ENABLER();
+    class PoolHost;
+    std::shared_ptr<PoolHost> Host;
+    oclMemPool_(const oclContext& ctx, const size_t capacity);
+public:
+    COMMON_NO_COPY(oclMemPool_)
+    COMMON_NO_MOVE(oclMemPool_)
+    ~oclMemPool_();
+    // buffer's Size is rounded up to the size class, it can be larger than requested
+    [[nodiscard]] oclBuffer AcquireBuffer(MemFlag flag, const size_t size);
+    [[nodiscard]] oclImg2D AcquireImage2D(MemFlag flag, const uint32_t width, const uint32_t height, const xziar::img::TextureFormat format);
+    // release cached objects until cached bytes are no more than [maxBytes]
+    void Trim(const size_t maxBytes = 0);
+    // cached bytes limit, returned objects exceeding it are released directly
+    void SetCapacity(const size_t capacity);
+    [[nodiscard]] MemPoolStats GetStats() const;
+
+    [[nodiscard]] static size_t GetSizeClass(const size_t size) noexcept;
+    [[nodiscard]] static bool CheckFlagCompatible(const MemFlag cached, const MemFlag requested) noexcept;
+    [[nodiscard]] static oclMemPool Create(const oclContext& ctx, const size_t capacity = SIZE_MAX);
+};
+
+
+}
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
@@ -26,6 +26,7 @@ using xziar::nailang::ArgLimits;
 using xziar::nailang::AutoVarHandler;
 using xziar::nailang::NailangRuntime;
 using xziar::nailang::NailangRuntimeException;
+using xziar::nailang::TextRope;
 using xziar::nailang::detail::ExceptionTarget;
 using common::mlog::LogLevel;
 using common::str::Encoding;
@@ -263,7 +264,7 @@ const xcomp::XCNLExecutor& NLCLRawExecutor::GetExecutor() const noexcept
     return *this;
 }
 
-void NLCLRawExecutor::StringifyKernelArg(std::u32string& out, const KernelArgInfo& arg) const
+void NLCLRawExecutor::StringifyKernelArg(TextRope& out, const KernelArgInfo& arg) const
 {
     switch (arg.ArgType)
     {
@@ -297,7 +298,7 @@ std::unique_ptr<xcomp::InstanceContext> NLCLRawExecutor::PrepareInstance(const x
     return std::make_unique<KernelContext>();
 }
 
-void NLCLRawExecutor::OutputInstance(const xcomp::OutputBlock& block, std::u32string& dst)
+void NLCLRawExecutor::OutputInstance(const xcomp::OutputBlock& block, TextRope& dst)
 {
     auto& kerCtx = GetCurInstance();
     // attributes
@@ -325,7 +326,7 @@ void NLCLRawExecutor::OutputInstance(const xcomp::OutputBlock& block, std::u32st
     // prefixes
     kerCtx.WritePrefixes(dst);
     // content
-    dst.append(kerCtx.Content);
+    dst.Append(std::move(kerCtx.Content));
     // suffixes
     kerCtx.WriteSuffixes(dst);
     dst.append(U"}\r\n"sv);
@@ -340,7 +341,7 @@ void NLCLRawExecutor::OutputInstance(const xcomp::OutputBlock& block, std::u32st
         std::move(kerCtx.Args));
 }
 
-void NLCLRawExecutor::ProcessStruct(const xcomp::OutputBlock& block, std::u32string& dst)
+void NLCLRawExecutor::ProcessStruct(const xcomp::OutputBlock& block, TextRope& dst)
 {
     auto frame = XCNLRawExecutor::PushFrame(block, CreateContext(), nullptr);
     dst.append(U"typedef struct \r\n{\r\n"sv);
@@ -452,7 +453,7 @@ NLCLRawExecutor::MetaFuncResult NLCLRawExecutor::HandleMetaFunc(FuncPack& meta,
     return NLCLExecutor::HandleMetaFunc(meta, allMetas);
 }
 
-void NLCLRawExecutor::OnReplaceFunction(std::u32string& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args)
+void NLCLRawExecutor::OnReplaceFunction(TextRope& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args)
 {
     if (func == U"unroll"sv)
     {
@@ -713,7 +714,7 @@ void NLCLRuntime::HandleInstanceArg(const xcomp::InstanceArgInfo& arg, xcomp::In
     }
 }
 
-void NLCLRuntime::BeforeFinishOutput(std::u32string& prefixes, std::u32string&, std::u32string&, std::u32string&)
+void NLCLRuntime::BeforeFinishOutput(TextRope& prefixes, TextRope&, TextRope&, TextRope&)
 {
     std::u32string exts = U"/* Extensions */\r\n"s;
     // Output extensions
@@ -731,7 +732,28 @@ void NLCLRuntime::BeforeFinishOutput(std::u32string& prefixes, std::u32string&,
                 });
     }
     exts.append(U"\r\n"sv);
-    prefixes.insert(prefixes.begin(), exts.begin(), exts.end());
+    prefixes.Prepend(exts);
+}
+
+void NLCLRuntime::MergeFork(xcomp::XCNLRuntime& fork)
+{
+    Expects(dynamic_cast<NLCLRuntime*>(&fork) != nullptr);
+    auto& forkCtx = static_cast<NLCLRuntime&>(fork).Context;
+    for (size_t i = 0; i < Context.EnabledExtensions.size(); ++i)
+    {
+        if (forkCtx.EnabledExtensions[i])
+            Context.EnabledExtensions[i] = true;
+    }
+    for (auto& flag : forkCtx.CompilerFlags)
+    {
+        if (std::find(Context.CompilerFlags.cbegin(), Context.CompilerFlags.cend(), flag) == Context.CompilerFlags.cend())
+            Context.CompilerFlags.push_back(std::move(flag));
+    }
+    for (auto& kernel : forkCtx.CompiledKernels)
+    {
+        Context.CompiledKernels.push_back(std::move(kernel));
+    }
+    forkCtx.CompiledKernels.clear();
 }
 
 xcomp::VTypeInfo NLCLRuntime::TryParseVecType(const std::u32string_view type, bool) const noexcept
@@ -876,6 +898,17 @@ NLCLProgStub::NLCLProgStub(const std::shared_ptr<const xcomp::XCNLProgram>& prog
 NLCLProgStub::NLCLProgStub(const std::shared_ptr<const xcomp::XCNLProgram>& program, std::shared_ptr<NLCLContext> context,
     common::mlog::MiniLogger<false>& logger) : NLCLProgStub(program, context, std::make_unique<NLCLRuntime>(logger, context))
 { }
+NLCLProgStub::NLCLProgStub(const std::shared_ptr<const xcomp::XCNLProgram>& program, oclDevice dev, const common::CLikeDefines& info,
+    common::mlog::MiniLogger<false>& logger) : NLCLProgStub(program, std::make_shared<NLCLContext>(dev, info), logger)
+{
+    Defines.emplace(info);
+}
+std::unique_ptr<xcomp::XCNLProgStub> NLCLProgStub::Fork(common::mlog::MiniLogger<false>& logger) const
+{
+    if (!Defines)
+        return {};
+    return std::make_unique<NLCLProgStub>(Program, GetContext()->Device, *Defines, logger);
+}
 
 
 NLCLResult::~NLCLResult()
@@ -898,9 +931,12 @@ void NLCLProcessor::ConfigureCL(NLCLProgStub& stub) const
 }
 std::string NLCLProcessor::GenerateCL(NLCLProgStub& stub) const
 {
-    auto str = stub.Runtime->GenerateOutput();
+    if (Parallelism)
+        stub.SetParallelism(*Parallelism);
+    auto str = stub.GenerateOutput([&](xcomp::XCNLProgStub& fork) { ConfigureCL(static_cast<NLCLProgStub&>(fork)); });
     constexpr std::u32string_view postacts[] = { U"xcomp.PostAct"sv, U"oclu.PostAct"sv };
     stub.PostAct(postacts);
+    stub.ReportProfile();
     return str;
 }
 
@@ -938,12 +974,15 @@ std::shared_ptr<xcomp::XCNLProgram> NLCLProcessor::Parse(common::span<const std:
     logger.info(u"Translate into [utf32] for [{}] chars.\n", src.size());
     const auto prog = xcomp::XCNLProgram::Create(std::move(src), std::move(fileName));
     logger.verbose(u"Parse finished, get [{}] Blocks.\n", prog->GetProgram().Size());
+    const auto& opt = prog->GetOptStats();
+    logger.verbose(u"Optimized in [{:.3f}]ms, folded [{}] exprs and [{}] funcs, decided [{}] metas, removed [{}] statements.\n",
+        opt.TimeNs / 1e6, opt.FoldedExprs, opt.FoldedFuncs, opt.DecidedMetas, opt.RemovedStatements);
     return prog;
 }
 
 std::unique_ptr<NLCLResult> NLCLProcessor::ProcessCL(const std::shared_ptr<xcomp::XCNLProgram>& prog, const oclDevice dev, const common::CLikeDefines& info) const
 {
-    NLCLProgStub stub(prog, std::make_shared<NLCLContext>(dev, info), Logger());
+    NLCLProgStub stub(prog, dev, info, Logger());
     ConfigureCL(stub);
     return std::make_unique<NLCLUnBuildResult>(stub.GetContext(), GenerateCL(stub));
 }
@@ -952,10 +991,20 @@ std::unique_ptr<NLCLResult> NLCLProcessor::CompileProgram(const std::shared_ptr<
 {
     if (!ctx->CheckIncludeDevice(dev))
         COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"device not included in the context"sv);
-    NLCLProgStub stub(prog, std::make_shared<NLCLContext>(dev, info), Logger());
+    NLCLProgStub stub(prog, dev, info, Logger());
     ConfigureCL(stub);
     return CompileIntoProgram(stub, ctx, config);
 }
 
+common::PromiseResult<std::unique_ptr<NLCLResult>> NLCLProcessor::CompileProgramAsync(std::shared_ptr<xcomp::XCNLProgram> prog,
+    oclContext ctx, oclDevice dev, common::CLikeDefines info, CLProgConfig config) const
+{
+    return RunBuildTask<std::unique_ptr<NLCLResult>>([this, prog = std::move(prog), ctx = std::move(ctx), dev = std::move(dev),
+        info = std::move(info), config = std::move(config)]()
+        {
+            return CompileProgram(prog, ctx, dev, info, config);
+        });
+}
+
 
 }
\ No newline at end of file
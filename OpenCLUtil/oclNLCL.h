@@ -36,6 +36,7 @@ public:
     using LoggerType = std::variant<common::mlog::MiniLogger<false>, common::mlog::MiniLogger<false>*>;
 protected:
     mutable std::variant<common::mlog::MiniLogger<false>, common::mlog::MiniLogger<false>*> TheLogger;
+    std::optional<uint32_t> Parallelism;
     constexpr common::mlog::MiniLogger<false>& Logger() const noexcept
     { 
         return TheLogger.index() == 0 ? std::get<0>(TheLogger) : *std::get<1>(TheLogger);
@@ -48,10 +49,21 @@ public:
     NLCLProcessor();
     NLCLProcessor(common::mlog::MiniLogger<false>&& logger);
     virtual ~NLCLProcessor();
+    /**
+     * @brief set threads used to expand kernel blocks, overrides env [XCNL_THREADS]
+     * @param threads 1 to disable, 0 to use hardware concurrency
+    */
+    void SetParallelism(uint32_t threads) noexcept { Parallelism = threads; }
 
     virtual std::shared_ptr<xcomp::XCNLProgram> Parse(common::span<const std::byte> source, std::u16string fileName = {}) const;
     virtual std::unique_ptr<NLCLResult> ProcessCL(const std::shared_ptr<xcomp::XCNLProgram>& prog, const oclDevice dev, const common::CLikeDefines& info = {}) const;
     virtual std::unique_ptr<NLCLResult> CompileProgram(const std::shared_ptr<xcomp::XCNLProgram>& prog, const oclContext& ctx, const oclDevice dev, const common::CLikeDefines& info = {}, const CLProgConfig& config = {}) const;
+    /**
+     * @brief run CompileProgram (generation and build) on shared build workers, so that multiple programs compile in parallel
+     * @param info defines of string_view should outlive the task, the same for the processor itself
+    */
+    [[nodiscard]] common::PromiseResult<std::unique_ptr<NLCLResult>> CompileProgramAsync(std::shared_ptr<xcomp::XCNLProgram> prog,
+        oclContext ctx, oclDevice dev, common::CLikeDefines info = {}, CLProgConfig config = {}) const;
 };
 
 #if COMMON_COMPILER_MSVC
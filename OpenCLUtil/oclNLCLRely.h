@@ -52,7 +52,7 @@ struct KernelContext : public xcomp::InstanceContext
 
     forceinline constexpr uint32_t GetWorkgroupSize() const noexcept { return WorkgroupSize; }
 protected:
-    std::vector<NamedText> Attributes;
+    NamedTextList Attributes;
     KernelArgStore Args;
     KernelArgStore TailArgs; // args that won't be recorded
     uint32_t WorkgroupSize = 0;
@@ -150,15 +150,15 @@ class OCLUAPI NLCLRawExecutor final : public NLCLExecutor, public xcomp::XCNLRaw
     friend NLCLRuntime;
 private:
     NLCLRawExecutor(NLCLRuntime* runtime);
-    void StringifyKernelArg(std::u32string& out, const KernelArgInfo& arg) const;
+    void StringifyKernelArg(xziar::nailang::TextRope& out, const KernelArgInfo& arg) const;
     [[nodiscard]] XCNLExecutor& GetExecutor() noexcept final;
     [[nodiscard]] const XCNLExecutor& GetExecutor() const noexcept final;
     [[nodiscard]] std::unique_ptr<xcomp::InstanceContext> PrepareInstance(const xcomp::OutputBlock& block) final;
-    void OutputInstance(const xcomp::OutputBlock& block, std::u32string& dst) final;
-    void ProcessStruct(const xcomp::OutputBlock& block, std::u32string& dst) final;
+    void OutputInstance(const xcomp::OutputBlock& block, xziar::nailang::TextRope& dst) final;
+    void ProcessStruct(const xcomp::OutputBlock& block, xziar::nailang::TextRope& dst) final;
     [[nodiscard]] bool HandleInstanceMeta(xziar::nailang::FuncPack& meta);
     [[nodiscard]] MetaFuncResult HandleMetaFunc(xziar::nailang::FuncPack& meta, xziar::nailang::MetaSet& allMeta) final;
-    void OnReplaceFunction(std::u32string& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args) final;
+    void OnReplaceFunction(xziar::nailang::TextRope& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args) final;
 protected:
     forceinline KernelContext& GetCurInstance() const { return static_cast<KernelContext&>(GetInstanceInfo()); }
 public:
@@ -209,7 +209,8 @@ protected:
 
     [[nodiscard]] xcomp::OutputBlock::BlockType GetBlockType(const RawBlock& block, MetaFuncs metas) const noexcept final;
     void HandleInstanceArg(const xcomp::InstanceArgInfo& arg, xcomp::InstanceContext& ctx, const xziar::nailang::FuncPack& meta, const xziar::nailang::Arg*) final;
-    void BeforeFinishOutput(std::u32string& prefixes, std::u32string& structs, std::u32string& globals, std::u32string& kernels) final;
+    void BeforeFinishOutput(xziar::nailang::TextRope& prefixes, xziar::nailang::TextRope& structs, xziar::nailang::TextRope& globals, xziar::nailang::TextRope& kernels) final;
+    void MergeFork(xcomp::XCNLRuntime& fork) final;
 public:
     [[nodiscard]] static std::u32string_view GetCLTypeName(xcomp::VTypeInfo info) noexcept;
     NLCLRuntime(common::mlog::MiniLogger<false>& logger, std::shared_ptr<NLCLContext> evalCtx);
@@ -276,7 +277,11 @@ public:
 class OCLUAPI NLCLProgStub : public xcomp::XCNLProgStub
 {
     friend class NLCLProcessor;
+private:
+    std::optional<common::CLikeDefines> Defines; // kept to create forks
+    [[nodiscard]] std::unique_ptr<xcomp::XCNLProgStub> Fork(common::mlog::MiniLogger<false>& logger) const final;
 public:
+    NLCLProgStub(const std::shared_ptr<const xcomp::XCNLProgram>& program, oclDevice dev, const common::CLikeDefines& info, common::mlog::MiniLogger<false>& logger);
     NLCLProgStub(const std::shared_ptr<const xcomp::XCNLProgram>& program, std::shared_ptr<NLCLContext> context, common::mlog::MiniLogger<false>& logger);
     NLCLProgStub(const std::shared_ptr<const xcomp::XCNLProgram>& program, std::shared_ptr<NLCLContext> context, std::unique_ptr<NLCLRuntime>&& runtime);
 
@@ -22,4 +22,31 @@ namespace oclu
 common::mlog::MiniLogger<false>& oclLog();
 std::pair<uint32_t, uint32_t> ParseVersionString(std::u16string_view str, const size_t verPos = 0);
 
+// run task on shared build workers, workers are limited by env "OCLU_BUILD_THREADS" (0 or unset means number of processors)
+void PostBuildTask(std::function<void()> task);
+template<typename T, typename F>
+[[nodiscard]] common::PromiseResult<T> RunBuildTask(F&& func)
+{
+    common::BasicPromise<T> pms;
+    // std::function requires copyable, while func may hold move-only stub
+    auto holder = std::make_shared<std::decay_t<F>>(std::forward<F>(func));
+    PostBuildTask([pms, holder]()
+        {
+            try
+            {
+                pms.SetData((*holder)());
+            }
+            catch (const common::BaseException& be)
+            {
+                pms.SetException(be);
+            }
+            catch (...)
+            {
+                const auto ex = std::current_exception();
+                pms.SetException(ex);
+            }
+        });
+    return pms.GetPromiseResult();
+}
+
 }
\ No newline at end of file
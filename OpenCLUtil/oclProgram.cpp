@@ -1,7 +1,10 @@
 #include "oclPch.h"
 #include "oclPlatform.h"
 #include "oclProgram.h"
+#include "oclTuner.h"
 #include "oclUtil.h"
+#include "SystemCommon/WorkerPool.h"
+#include <chrono>
 
 namespace oclu
 {
@@ -348,10 +351,11 @@ oclKernel_::oclKernel_(const oclProgram_* prog, void* kerID, string name, Kernel
         ArgStore = std::move(argStore);
     }
     ReqDbgBufSize = ArgStore.DebugBuffer == 0 ? 512 : ArgStore.DebugBuffer;
+    TuneKey = oclLocalSizeTuner::MakeKernelKey(Name, Program.SourceHash, *Program.Device);
 }
 oclKernel_::~oclKernel_()
 {
-    clReleaseKernel(*Kernel);
+    Funcs->clReleaseKernel(*Kernel);
 }
 
 std::optional<SubgroupInfo> oclKernel_::GetSubgroupInfo(const uint8_t dim, const size_t* localsize) const
@@ -388,33 +392,97 @@ oclKernel_::CallSiteInternal::CallSiteInternal(const oclKernel_* kernel) :
     KernelHost(kernel->Program.shared_from_this(), kernel), 
     Kernel(CloneKernel(kernel->Funcs, *kernel->Program.Program, *kernel->Kernel, kernel->Name, kernel->Program.Device))
 { }
+oclKernel_::CallSiteInternal::CallSiteInternal(CallSiteInternal&& other) noexcept :
+    KernelHost(std::move(other.KernelHost)), Kernel(other.Kernel), Shadows(std::move(other.Shadows)),
+    TunedSizes(std::move(other.TunedSizes))
+{
+    other.Kernel = CLHandle<detail::CLKernel>{};
+}
+oclKernel_::CallSiteInternal::~CallSiteInternal()
+{
+    // enqueued commands keep their own reference
+    if (*Kernel)
+        KernelHost->Funcs->clReleaseKernel(*Kernel);
+}
+
+bool oclKernel_::CallSiteInternal::IsArgUnchanged(const uint32_t idx, const void* dat, const size_t size) const noexcept
+{
+    if (Shadows.size() <= idx)
+        return false;
+    const auto& shadow = Shadows[idx];
+    return shadow.Size == size && memcmp(shadow.Data.data(), dat, size) == 0;
+}
+
+void oclKernel_::CallSiteInternal::SetRawArg(const uint32_t idx, const void* dat, const size_t size) const
+{
+    if (IsArgUnchanged(idx, dat, size))
+        return;
+    if (Shadows.size() <= idx)
+        Shadows.resize(idx + 1);
+    auto& shadow = Shadows[idx];
+    shadow.Size = UINT32_MAX; // unknown until the call succeeds
+    auto ret = KernelHost->Funcs->clSetKernelArg(*Kernel, idx, size, dat);
+    if (ret != CL_SUCCESS)
+        COMMON_THROW(OCLException, OCLException::CLComponent::Driver, ret, u"set kernel argument error");
+    if (size <= shadow.Data.size())
+    {
+        memcpy(shadow.Data.data(), dat, size);
+        shadow.Size = static_cast<uint32_t>(size);
+    }
+}
 
 void oclKernel_::CallSiteInternal::SetArg(const uint32_t idx, const oclSubBuffer_& buf) const
 {
     if (const auto info = KernelHost->ArgStore.GetArg(idx); info && !info->IsType(KerArgType::Buffer))
         COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"buffer is set to a non-buffer kernel argument slot");
-    auto ret = KernelHost->Funcs->clSetKernelArg(*Kernel, idx, sizeof(cl_mem), &buf.MemID);
-    if (ret != CL_SUCCESS)
-        COMMON_THROW(OCLException, OCLException::CLComponent::Driver, ret, u"set kernel argument error");
+    SetRawArg(idx, &buf.MemID, sizeof(cl_mem));
 }
 
 void oclKernel_::CallSiteInternal::SetArg(const uint32_t idx, const oclImage_ & img) const
 {
     if (const auto info = KernelHost->ArgStore.GetArg(idx); info && !info->IsType(KerArgType::Image))
         COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"image is set to an non-image kernel argument slot");
-    auto ret = KernelHost->Funcs->clSetKernelArg(*Kernel, idx, sizeof(cl_mem), &img.MemID);
-    if (ret != CL_SUCCESS)
-        COMMON_THROW(OCLException, OCLException::CLComponent::Driver, ret, u"set kernel argument error");
+    SetRawArg(idx, &img.MemID, sizeof(cl_mem));
 }
 
 void oclKernel_::CallSiteInternal::SetArg(const uint32_t idx, const void* dat, const size_t size) const
 {
     if (const auto info = KernelHost->ArgStore.GetArg(idx); info && !info->IsType(KerArgType::Simple))
         COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"simple is set to an non-simple kernel argument slot");
-    KernelHost->ArgStore.GetArg(idx);
-    auto ret = KernelHost->Funcs->clSetKernelArg(*Kernel, idx, size, dat);
-    if (ret != CL_SUCCESS)
-        COMMON_THROW(OCLException, OCLException::CLComponent::Driver, ret, u"set kernel argument error");
+    SetRawArg(idx, dat, size);
+}
+
+std::array<size_t, 3> oclKernel_::CallSiteInternal::TuneLocalSize(const uint8_t dim, DependEvents& depend,
+    const oclCmdQue& que, const size_t* worksize, const size_t* workoffset)
+{
+    std::array<size_t, 3> workSize = { 1, 1, 1 };
+    std::copy_n(worksize, dim, workSize.begin());
+    for (const auto& tuned : TunedSizes)
+    {
+        if (tuned.Dim == dim && tuned.WorkSize == workSize)
+            return tuned.LocalSize;
+    }
+    auto& tuner = oclLocalSizeTuner::Get();
+    const auto key = oclLocalSizeTuner::MakeKey(KernelHost->TuneKey, dim, worksize);
+    auto localSize = tuner.Query(key);
+    if (!localSize)
+    {
+        const auto candidates = oclLocalSizeTuner::GenerateCandidates(KernelHost->WgInfo, *que->Device, dim, worksize);
+        localSize = tuner.Tune(key, candidates, [&](const size_t* localsize) -> uint64_t
+            {
+                const auto t1 = std::chrono::high_resolution_clock::now();
+                // dependency is only waited by the first run
+                const auto pms = Run(dim, std::exchange(depend, {}), que, worksize, workoffset, localsize);
+                pms->WaitFinish();
+                const auto t2 = std::chrono::high_resolution_clock::now();
+                if (const auto time = pms->ElapseNs(); time > 0)
+                    return time;
+                // queue without profiling
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+            });
+    }
+    TunedSizes.push_back({ workSize, *localSize, dim });
+    return *localSize;
 }
 
 PromiseResult<CallResult> oclKernel_::CallSiteInternal::Run(const uint8_t dim, DependEvents depend,
@@ -422,6 +490,12 @@ PromiseResult<CallResult> oclKernel_::CallSiteInternal::Run(const uint8_t dim, D
 {
     if (KernelHost->Program.Device != que->Device)
         COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"queue's device is not the same as this kernel");
+    std::array<size_t, 3> tunedSize = { 0 };
+    if (localsize && localsize[0] == SIZE_MAX)
+    {
+        tunedSize = TuneLocalSize(dim, depend, que, worksize, workoffset);
+        localsize = tunedSize[0] != 0 ? tunedSize.data() : nullptr;
+    }
 
     CallResult result;
     if (KernelHost->ArgStore.HasInfo && KernelHost->ArgStore.HasDebug) // inject debug buffer
@@ -460,23 +534,35 @@ PromiseResult<CallResult> oclKernel_::CallSiteInternal::Run(const uint8_t dim, D
 oclKernel_::KernelDynCallSiteInternal::KernelDynCallSiteInternal(const oclKernel_* kernel, CallArgs&& args) :
     CallSiteInternal(kernel), Args(std::move(args))
 {
-    using ArgType = std::variant<oclSubBuffer, oclImage, std::vector<std::byte>, std::array<std::byte, 32>, common::span<const std::byte>>;
-    uint32_t idx = 0;
-    for (const auto& arg : Args.Args)
+    for (uint32_t idx = 0; idx < Args.Args.size(); ++idx)
+        ApplyArg(idx);
+}
+
+void oclKernel_::KernelDynCallSiteInternal::ApplyArg(const uint32_t idx) const
+{
+    const auto& arg = Args.Args[idx];
+    switch (arg.index())
     {
-        switch (arg.index())
-        {
-        case 0: this->SetArg(idx, *std::get<0>(arg)); break;
-        case 1: this->SetArg(idx, *std::get<1>(arg)); break;
-        case 2: this->SetArg(idx, std::get<2>(arg).data(), std::get<2>(arg).size()); break;
-        case 3: this->SetArg(idx, &std::get<3>(arg)[1], (size_t)std::get<3>(arg)[0]); break;
-        case 4: this->SetArg(idx, std::get<4>(arg).data(), std::get<4>(arg).size()); break;
-        default: assert(false); break;
-        }
-        idx++;
+    case 0: this->SetArg(idx, *std::get<0>(arg)); break;
+    case 1: this->SetArg(idx, *std::get<1>(arg)); break;
+    case 2: this->SetArg(idx, std::get<2>(arg).data(), std::get<2>(arg).size()); break;
+    case 3: this->SetArg(idx, &std::get<3>(arg)[1], (size_t)std::get<3>(arg)[0]); break;
+    case 4: this->SetArg(idx, std::get<4>(arg).data(), std::get<4>(arg).size()); break;
+    default: assert(false); break;
     }
 }
 
+void oclKernel_::KernelDynCallSiteInternal::UpdateArg(const uint32_t idx, CallArgs::ArgType&& arg)
+{
+    if (idx < Args.Args.size())
+        Args.Args[idx] = std::move(arg);
+    else if (idx == Args.Args.size())
+        Args.Args.push_back(std::move(arg));
+    else
+        COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"kernel arguments should be pushed in order");
+    ApplyArg(idx);
+}
+
 
 oclProgStub::oclProgStub(const oclContext& ctx, const oclDevice& dev, string&& str)
     : Context(ctx), Device(dev), Source(std::move(str))
@@ -489,6 +575,13 @@ oclProgStub::oclProgStub(const oclContext& ctx, const oclDevice& dev, string&& s
         COMMON_THROW(OCLException, OCLException::CLComponent::Driver, errcode, u"cannot create program");
 }
 
+oclProgStub::oclProgStub(oclProgStub&& other) noexcept : Program(other.Program), Context(std::move(other.Context)),
+    Device(std::move(other.Device)), Source(std::move(other.Source)), ImportedKernelInfo(std::move(other.ImportedKernelInfo)),
+    DebugMan(std::move(other.DebugMan))
+{
+    other.Program = nullptr;
+}
+
 oclProgStub::~oclProgStub()
 {
     if (*Program)
@@ -570,6 +663,15 @@ oclProgram oclProgStub::Finish()
     return MAKE_ENABLER_SHARED(const oclProgram_, (this));
 }
 
+PromiseResult<oclProgram> oclProgStub::BuildAsync(CLProgConfig config) &&
+{
+    return RunBuildTask<oclProgram>([stub = std::move(*this), config = std::move(config)]() mutable
+        {
+            stub.Build(config);
+            return stub.Finish();
+        });
+}
+
 
 u16string oclProgram_::GetProgBuildLog(const detail::PlatFuncs* funcs, CLHandle<detail::CLProgram> progID, CLHandle<detail::CLDevice> dev)
 {
@@ -597,6 +699,7 @@ u16string oclProgram_::GetProgBuildLog(const detail::PlatFuncs* funcs, CLHandle<
 
 oclProgram_::oclProgram_(oclProgStub* stub) : detail::oclCommon(*stub->Context), Program(stub->Program),
     Context(std::move(stub->Context)), Device(std::move(stub->Device)), Source(std::move(stub->Source)),
+    SourceHash(oclLocalSizeTuner::HashSource(Source)),
     DebugMan(std::move(stub->DebugMan))
 {
     stub->Program = nullptr;
@@ -695,6 +798,31 @@ oclProgram oclProgram_::CreateAndBuild(const oclContext& ctx, string str, const
     return stub.Finish();
 }
 
+PromiseResult<oclProgram> oclProgram_::CreateAndBuildAsync(const oclContext& ctx, string str, CLProgConfig config, const oclDevice& dev)
+{
+    return RunBuildTask<oclProgram>([=, str = std::move(str), config = std::move(config)]() mutable
+        {
+            return CreateAndBuild(ctx, std::move(str), config, dev);
+        });
+}
+
+
+void PostBuildTask(std::function<void()> task)
+{
+    // logger is touched first so it is constructed earlier and destructed after the pool joins its workers
+    [[maybe_unused]] static const auto& Logger = oclLog();
+    static common::WorkerPool Pool("oclBuild", []()
+        {
+#if COMMON_COMPILER_MSVC
+#   pragma warning(suppress: 4996)
+#endif
+            if (const auto env = getenv("OCLU_BUILD_THREADS"); env && *env)
+                return static_cast<uint32_t>(std::strtoul(env, nullptr, 10));
+            return 0u;
+        }());
+    Pool.Post(std::move(task));
+}
+
 
 
 }
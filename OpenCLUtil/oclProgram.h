@@ -10,6 +10,7 @@
 #include "common/FileBase.hpp"
 #include "common/CLikeConfig.hpp"
 #include "common/StringPool.hpp"
+#include <boost/container/small_vector.hpp>
 
 
 
@@ -119,38 +120,42 @@ struct CallArgs
     friend oclKernel_;
 private:
     using ArgType = std::variant<oclSubBuffer, oclImage, std::vector<std::byte>, std::array<std::byte, 32>, common::span<const std::byte>>;
-    std::vector<ArgType> Args;
-public:
-    void PushArg(oclSubBuffer buf)
-    {
-        Args.push_back(buf);
-    }
-    void PushArg(oclImage img)
-    {
-        Args.push_back(img);
-    }
-    void PushArg(const void* dat, const size_t size, const bool ref = false)
+    // inline storage, so that common kernels do not allocate per call
+    boost::container::small_vector<ArgType, 16> Args;
+    static ArgType CreateArg(const void* dat, const size_t size, const bool ref)
     {
         if (ref)
         {
-            common::span<const std::byte> tmp(reinterpret_cast<const std::byte*>(dat), size);
-            Args.push_back(tmp);
+            return common::span<const std::byte>(reinterpret_cast<const std::byte*>(dat), size);
         }
         else if (size <= 31)
         {
             std::array<std::byte, 32> tmp;
             memcpy_s(&tmp[1], size, dat, size);
             tmp[0] = static_cast<std::byte>(size);
-            Args.push_back(tmp);
+            return tmp;
         }
         else
         {
             std::vector<std::byte> tmp;
             tmp.resize(size);
             memcpy_s(&tmp[0], size, dat, size);
-            Args.push_back(tmp);
+            return tmp;
         }
     }
+public:
+    void PushArg(oclSubBuffer buf)
+    {
+        Args.push_back(buf);
+    }
+    void PushArg(oclImage img)
+    {
+        Args.push_back(img);
+    }
+    void PushArg(const void* dat, const size_t size, const bool ref = false)
+    {
+        Args.push_back(CreateArg(dat, size, ref));
+    }
     template<typename T, bool OnlyRef = false>
     void PushSpanArg(T&& dat)
     {
@@ -179,12 +184,21 @@ struct OCLUAPI CallResult
 };
 
 
+// pass as local size to let the call pick one by oclLocalSizeTuner
+struct LocalSizeAuto {};
+inline constexpr LocalSizeAuto AutoLocalSize{};
+
+
 template<size_t N>
 struct SizeN
 {
     size_t Data[N];
     constexpr SizeN() noexcept : Data{ 0 }
     { }
+    constexpr SizeN(LocalSizeAuto) noexcept : Data{ 0 }
+    {
+        Data[0] = SIZE_MAX;
+    }
     constexpr SizeN(const size_t(&data)[N]) noexcept : Data{ 0 }
     {
         for (size_t i = 0; i < N; ++i)
@@ -234,10 +248,33 @@ private:
 
     struct CallSiteInternal
     {
+        // last value set to an arg slot, Size is UINT32_MAX when unknown or too large to track
+        struct ArgShadow
+        {
+            std::array<std::byte, 32> Data;
+            uint32_t Size = UINT32_MAX;
+        };
+        // local size picked by oclLocalSizeTuner for a global size
+        struct TunedSize
+        {
+            std::array<size_t, 3> WorkSize;
+            std::array<size_t, 3> LocalSize;
+            uint8_t Dim;
+        };
         oclKernel KernelHost;
         CLHandle<detail::CLKernel> Kernel;
+        // clSetKernelArg is skipped when the slot already holds the same value
+        mutable boost::container::small_vector<ArgShadow, 16> Shadows;
+        // repeated auto calls skip building the tuner key
+        boost::container::small_vector<TunedSize, 2> TunedSizes;
 
         OCLUAPI CallSiteInternal(const oclKernel_* kernel);
+        OCLUAPI CallSiteInternal(CallSiteInternal&& other) noexcept;
+        OCLUAPI ~CallSiteInternal();
+        CallSiteInternal& operator=(CallSiteInternal&&) = delete;
+        [[nodiscard]] OCLUAPI bool IsArgUnchanged(const uint32_t idx, const void* dat, const size_t size) const noexcept;
+        // call clSetKernelArg unless unchanged, shadow is only updated when it succeeds
+        OCLUAPI void SetRawArg(const uint32_t idx, const void* dat, const size_t size) const;
         OCLUAPI void SetArg(const uint32_t idx, const oclSubBuffer_& buf) const;
         OCLUAPI void SetArg(const uint32_t idx, const oclImage_& img) const;
         OCLUAPI void SetArg(const uint32_t idx, const void* dat, const size_t size) const;
@@ -253,6 +290,9 @@ private:
             static_assert(!std::is_same_v<T, bool>, "boolean is implementation-defined and cannot be pass as kernel argument.");
             return SetArg(idx, &dat, sizeof(T));
         }
+        // tuning runs the kernel several times with current args, the output should not depend on its previous content
+        [[nodiscard]] std::array<size_t, 3> TuneLocalSize(const uint8_t dim, DependEvents& depend,
+            const oclCmdQue& que, const size_t* worksize, const size_t* workoffset);
         OCLUAPI [[nodiscard]] common::PromiseResult<CallResult> Run(const uint8_t dim, DependEvents depend,
             const oclCmdQue& que, const size_t* worksize, const size_t* workoffset, const size_t* localsize);
     };
@@ -305,16 +345,43 @@ private:
     private:
         // clSetKernelArg does not hold parameter ownership, so need to manully hold it
         CallArgs Args;
+        void ApplyArg(const uint32_t idx) const;
     protected:
         OCLUAPI KernelDynCallSiteInternal(const oclKernel_* kernel, CallArgs&& args);
+        OCLUAPI void UpdateArg(const uint32_t idx, CallArgs::ArgType&& arg);
     };
 
+    // prepared call, can be enqueued repeatedly, only changed args are set again
     template<uint8_t N>
     class [[nodiscard]] KernelDynCallSite : protected KernelDynCallSiteInternal
     {
         friend class oclKernel_;
     public:
         using KernelDynCallSiteInternal::KernelDynCallSiteInternal;
+        KernelDynCallSite& SetArg(const uint32_t idx, oclSubBuffer buf)
+        {
+            UpdateArg(idx, std::move(buf));
+            return *this;
+        }
+        KernelDynCallSite& SetArg(const uint32_t idx, oclImage img)
+        {
+            UpdateArg(idx, std::move(img));
+            return *this;
+        }
+        template<typename T>
+        KernelDynCallSite& SetSpanArg(const uint32_t idx, const T& dat)
+        {
+            const auto space = common::as_bytes(common::to_span(dat));
+            UpdateArg(idx, CallArgs::CreateArg(space.data(), space.size(), false));
+            return *this;
+        }
+        template<typename T>
+        KernelDynCallSite& SetSimpleArg(const uint32_t idx, const T& dat)
+        {
+            static_assert(!std::is_same_v<T, bool>, "boolean is implementation-defined and cannot be pass as kernel argument.");
+            UpdateArg(idx, CallArgs::CreateArg(&dat, sizeof(T), false));
+            return *this;
+        }
         [[nodiscard]] common::PromiseResult<CallResult> operator()(const common::PromiseStub& pmss, const oclCmdQue& que,
             const SizeN<N> worksize, const SizeN<N> localsize = {}, const SizeN<N> workoffset = {})
         {
@@ -353,6 +420,12 @@ public:
         static_assert(N > 0 && N < 4, "work dim should be in [1,3]");
         return KernelDynCallSite<N>(this, std::move(args));
     }
+    // create a call to be enqueued repeatedly (eg. per tile), args can be pushed later by SetArg
+    template<uint8_t N>
+    [[nodiscard]] auto PrepareCall(CallArgs&& args = {}) const
+    {
+        return CallDynamic<N>(std::move(args));
+    }
 
 private:
     CLHandle<detail::CLKernel> Kernel;
@@ -362,6 +435,8 @@ public:
     KernelArgStore ArgStore;
     WorkGroupInfo WgInfo;
     std::string Name;
+    // kernel part of oclLocalSizeTuner's key
+    std::string TuneKey;
 };
 
 
@@ -388,8 +463,11 @@ private:
     std::shared_ptr<xcomp::debug::DebugManager> DebugMan;
     oclProgStub(const oclContext& ctx, const oclDevice& dev, std::string&& str);
 public:
+    oclProgStub(oclProgStub&& other) noexcept;
     ~oclProgStub();
     void Build(const CLProgConfig& config);
+    // build and finish on shared build workers, build log is reported the same as Build, errors are thrown by Get
+    [[nodiscard]] common::PromiseResult<oclProgram> BuildAsync(CLProgConfig config) &&;
     [[nodiscard]] std::u16string GetBuildLog() const;
     [[nodiscard]] oclProgram Finish();
 };
@@ -405,6 +483,7 @@ private:
     const oclContext Context;
     const oclDevice Device;
     const std::string Source;
+    const std::string SourceHash; // used by oclLocalSizeTuner
     std::vector<std::string> KernelNames;
     std::vector<std::unique_ptr<oclKernel_>> Kernels;
     std::shared_ptr<xcomp::debug::DebugManager> DebugMan;
@@ -450,6 +529,7 @@ public:
 
     [[nodiscard]] static oclProgStub Create(const oclContext& ctx, std::string str, const oclDevice& dev = {});
     [[nodiscard]] static oclProgram CreateAndBuild(const oclContext& ctx, std::string str, const CLProgConfig& config, const oclDevice& dev = {});
+    [[nodiscard]] static common::PromiseResult<oclProgram> CreateAndBuildAsync(const oclContext& ctx, std::string str, CLProgConfig config, const oclDevice& dev = {});
 };
 
 
@@ -0,0 +1,270 @@
+#include "oclPch.h"
+#include "oclTuner.h"
+#include "oclUtil.h"
+#include "SystemCommon/MiscIntrins.h"
+#include <filesystem>
+
+
+namespace oclu
+{
+using std::string;
+using std::string_view;
+using common::str::Encoding;
+
+
+static size_t ParseNum(string_view& str) noexcept
+{
+    size_t val = 0;
+    while (!str.empty() && str[0] >= '0' && str[0] <= '9')
+    {
+        val = val * 10 + (str[0] - '0');
+        str.remove_prefix(1);
+    }
+    if (!str.empty()) // skip separator
+        str.remove_prefix(1);
+    return val;
+}
+
+
+oclLocalSizeTuner::oclLocalSizeTuner()
+{
+#if COMMON_COMPILER_MSVC
+#   pragma warning(suppress: 4996)
+#endif
+    if (const auto path = getenv("OCLU_LOCALSIZE_CACHE"); path && *path)
+        FilePath = path;
+    if (!FilePath.empty())
+        Load();
+}
+oclLocalSizeTuner::~oclLocalSizeTuner()
+{
+    if (IsDirty)
+        Save();
+}
+
+void oclLocalSizeTuner::Load()
+{
+    const auto fp = fopen(FilePath.c_str(), "r");
+    if (!fp) return;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp))
+    {
+        string_view str(line);
+        while (!str.empty() && (str.back() == '\n' || str.back() == '\r'))
+            str.remove_suffix(1);
+        // key itself contains '|', so take the last 2 parts from the end
+        const auto pos2 = str.rfind('|');
+        if (pos2 == string_view::npos || pos2 == 0) continue;
+        const auto pos1 = str.rfind('|', pos2 - 1);
+        if (pos1 == string_view::npos) continue;
+        auto sizeStr = str.substr(pos1 + 1, pos2 - pos1 - 1);
+        auto timeStr = str.substr(pos2 + 1);
+        Record record;
+        for (auto& size : record.Size)
+            size = ParseNum(sizeStr);
+        record.TimeNs = ParseNum(timeStr);
+        Records.insert_or_assign(string(str.substr(0, pos1)), record);
+    }
+    fclose(fp);
+}
+
+// caller holds the lock, written to a temp file then renamed, so a crash never leaves a partial file
+void oclLocalSizeTuner::Save()
+{
+    IsDirty = false;
+    LastSave = std::chrono::steady_clock::now();
+    const auto tmpPath = FilePath + ".tmp";
+    const auto fp = fopen(tmpPath.c_str(), "w");
+    if (!fp) return;
+    bool isOK = true;
+    for (const auto& [key, record] : Records)
+        isOK &= fprintf(fp, "%s|%zu,%zu,%zu|%llu\n", key.c_str(), record.Size[0], record.Size[1], record.Size[2],
+            static_cast<unsigned long long>(record.TimeNs)) > 0;
+    isOK &= fclose(fp) == 0;
+    std::error_code ec;
+    if (isOK)
+        std::filesystem::rename(tmpPath, FilePath, ec);
+    if (!isOK || ec)
+        std::filesystem::remove(tmpPath, ec);
+}
+
+std::optional<oclLocalSizeTuner::LocalSize> oclLocalSizeTuner::Query(string_view key)
+{
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (const auto it = Records.find(key); it != Records.end())
+        return it->second.Size;
+    return {};
+}
+
+void oclLocalSizeTuner::Update(string_view key, const LocalSize& size, const uint64_t timeNs)
+{
+    std::lock_guard<std::mutex> lock(Mutex);
+    Records.insert_or_assign(string(key), Record{ size, timeNs });
+    if (FilePath.empty())
+        return;
+    IsDirty = true;
+    if (std::chrono::steady_clock::now() - LastSave >= SaveInterval)
+        Save();
+}
+
+oclLocalSizeTuner::LocalSize oclLocalSizeTuner::Tune(string_view key, common::span<const LocalSize> candidates,
+    const std::function<uint64_t(const size_t*)>& measure)
+{
+    {
+        // wait for the one tuning the same key, then use its result
+        std::unique_lock<std::mutex> lock(Mutex);
+        TuneCond.wait(lock, [&]() { return Tuning.find(key) == Tuning.end(); });
+        if (const auto it = Records.find(key); it != Records.end())
+            return it->second.Size;
+        Tuning.emplace(key);
+    }
+    const auto finishTuning = [&]()
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Tuning.erase(Tuning.find(key));
+        }
+        TuneCond.notify_all();
+    };
+    try
+    {
+        const auto choice = TuneCandidates(key, candidates, measure);
+        finishTuning();
+        return choice;
+    }
+    catch (...)
+    {
+        finishTuning();
+        throw;
+    }
+}
+
+oclLocalSizeTuner::LocalSize oclLocalSizeTuner::TuneCandidates(string_view key, common::span<const LocalSize> candidates,
+    const std::function<uint64_t(const size_t*)>& measure)
+{
+    constexpr uint32_t Trials = 3;
+    const LocalSize* choice = nullptr;
+    uint64_t bestTime = UINT64_MAX;
+    for (const auto& candidate : candidates)
+    {
+        const auto localsize = candidate[0] != 0 ? candidate.data() : nullptr;
+        uint64_t minTime = UINT64_MAX;
+        try
+        {
+            [[maybe_unused]] const auto warmup = measure(localsize);
+            for (uint32_t i = 0; i < Trials; ++i)
+                minTime = std::min(minTime, measure(localsize));
+        }
+        catch (const OCLException& oe)
+        {
+            oclLog().verbose(u"local size [{},{},{}] rejected for [{}]: {}\n", candidate[0], candidate[1], candidate[2],
+                key, oe.Message());
+            continue;
+        }
+        if (minTime < bestTime) // prefer earlier one when tie
+        {
+            bestTime = minTime;
+            choice = &candidate;
+        }
+    }
+    if (!choice)
+        COMMON_THROW(OCLException, OCLException::CLComponent::OCLU, u"no local size candidate can be executed");
+    oclLog().debug(u"tuned local size [{},{},{}] for [{}], cost {}us.\n", (*choice)[0], (*choice)[1], (*choice)[2],
+        key, bestTime / 1000);
+    Update(key, *choice, bestTime);
+    return *choice;
+}
+
+void oclLocalSizeTuner::SetCacheFile(string path)
+{
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (IsDirty && !FilePath.empty())
+        Save();
+    FilePath = std::move(path);
+    if (!FilePath.empty())
+        Load();
+}
+
+void oclLocalSizeTuner::Clear()
+{
+    std::lock_guard<std::mutex> lock(Mutex);
+    Records.clear();
+    if (!FilePath.empty())
+        Save();
+}
+
+string oclLocalSizeTuner::HashSource(string_view source)
+{
+    const auto hash = common::DigestFunc.SHA256(common::span<const char>(source.data(), source.size()));
+    return common::MiscIntrin.HexToStr(hash.data(), 8);
+}
+
+string oclLocalSizeTuner::MakeKernelKey(string_view kernel, string_view sourceHash, const oclDevice_& dev)
+{
+    string key(kernel);
+    key.append("|").append(sourceHash)
+        .append("|").append(common::str::to_string(dev.Name, Encoding::UTF8, Encoding::UTF16LE))
+        .append("@").append(common::str::to_string(dev.Ver, Encoding::UTF8, Encoding::UTF16LE));
+    return key;
+}
+
+string oclLocalSizeTuner::MakeKey(string_view kernelKey, const uint8_t dim, const size_t* worksize)
+{
+    string key(kernelKey);
+    key.append("|").append(std::to_string(dim)).append(":");
+    for (uint8_t i = 0; i < dim; ++i)
+    {
+        if (i > 0) key.append("x");
+        key.append(std::to_string(worksize[i]));
+    }
+    return key;
+}
+
+std::vector<oclLocalSizeTuner::LocalSize> oclLocalSizeTuner::GenerateCandidates(const WorkGroupInfo& wgInfo,
+    const oclDevice_& dev, const uint8_t dim, const size_t* worksize)
+{
+    std::vector<LocalSize> candidates;
+    if (wgInfo.HasCompiledWGSize())
+    {
+        candidates.push_back({ wgInfo.CompiledWorkGroupSize[0], wgInfo.CompiledWorkGroupSize[1], wgInfo.CompiledWorkGroupSize[2] });
+        return candidates;
+    }
+    candidates.push_back({ 0, 0, 0 }); // let driver decide
+    const auto maxSize = wgInfo.WorkGroupSize ? wgInfo.WorkGroupSize : dev.MaxWorkGroupSize;
+    const auto multiple = std::max<size_t>(wgInfo.PreferredWorkGroupSizeMultiple, 1);
+    const auto fits = [&](const uint8_t idx, const size_t size)
+    {
+        return size <= dev.MaxWorkItemSize[idx] && worksize[idx] % size == 0;
+    };
+    if (dim == 1)
+    {
+        for (size_t x = multiple; x <= maxSize; x *= 2)
+        {
+            if (fits(0, x))
+                candidates.push_back({ x, 1, 1 });
+        }
+    }
+    else // z is kept 1 for 3D
+    {
+        // total size should fill whole SIMD lanes, prefer x not less than y for row-major access
+        for (size_t x = 1; x <= maxSize; x *= 2)
+        {
+            if (!fits(0, x)) continue;
+            for (size_t y = 1; y <= x && x * y <= maxSize; y *= 2)
+            {
+                if ((x * y) % multiple == 0 && fits(1, y))
+                    candidates.push_back({ x, y, 1 });
+            }
+        }
+    }
+    return candidates;
+}
+
+oclLocalSizeTuner& oclLocalSizeTuner::Get()
+{
+    static oclLocalSizeTuner Tuner;
+    return Tuner;
+}
+
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "oclRely.h"
+#include "oclProgram.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+
+namespace oclu
+{
+
+// pick local size of kernel calls by timing candidates on the device.
+// results are kept by kernel name, source hash, device and global size,
+// and persisted into the file set by env "OCLU_LOCALSIZE_CACHE" or SetCacheFile.
+// the file is rewritten through a temp file, at most once per SaveInterval and when exiting.
+class OCLUAPI oclLocalSizeTuner
+{
+public:
+    using LocalSize = std::array<size_t, 3>;
+private:
+    struct Record
+    {
+        LocalSize Size;
+        uint64_t TimeNs;
+    };
+    std::mutex Mutex;
+    std::condition_variable TuneCond;
+    std::string FilePath;
+    std::map<std::string, Record, std::less<>> Records;
+    std::set<std::string, std::less<>> Tuning; // keys being tuned
+    std::chrono::steady_clock::time_point LastSave;
+    bool IsDirty = false;
+    void Load();
+    void Save();
+    LocalSize TuneCandidates(std::string_view key, common::span<const LocalSize> candidates, const std::function<uint64_t(const size_t*)>& measure);
+    oclLocalSizeTuner();
+    ~oclLocalSizeTuner();
+public:
+    static constexpr std::chrono::seconds SaveInterval{ 5 };
+    COMMON_NO_COPY(oclLocalSizeTuner)
+    COMMON_NO_MOVE(oclLocalSizeTuner)
+    [[nodiscard]] std::optional<LocalSize> Query(std::string_view key);
+    void Update(std::string_view key, const LocalSize& size, const uint64_t timeNs);
+    ///<summary>Time each candidate and record the fastest one, tuning of the same key is done only once at a time</summary>
+    ///<param name="key">key from MakeKey</param>
+    ///<param name="candidates">local sizes to try, all 0 means driver's choice</param>
+    ///<param name="measure">run the kernel with the local size and return elapsed time, throws when the local size is rejected</param>
+    ///<returns>the fastest local size, or the recorded one when the key has been tuned</returns>
+    LocalSize Tune(std::string_view key, common::span<const LocalSize> candidates, const std::function<uint64_t(const size_t*)>& measure);
+    void SetCacheFile(std::string path);
+    // drop all records, including the persisted ones
+    void Clear();
+
+    // kernel part of the key, computed once per kernel
+    [[nodiscard]] static std::string MakeKernelKey(std::string_view kernel, std::string_view sourceHash, const oclDevice_& dev);
+    [[nodiscard]] static std::string MakeKey(std::string_view kernelKey, const uint8_t dim, const size_t* worksize);
+    [[nodiscard]] static std::string HashSource(std::string_view source);
+    [[nodiscard]] static std::vector<LocalSize> GenerateCandidates(const WorkGroupInfo& wgInfo, const oclDevice_& dev,
+        const uint8_t dim, const size_t* worksize);
+    [[nodiscard]] static oclLocalSizeTuner& Get();
+};
+
+
+}
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
@@ -99,19 +99,21 @@ public:
                 }
             }
         }
-        //assign jobs
+        //assign jobs, all new textures are decoded in a batch
+        std::vector<std::pair<fs::path, TexLoadType>> newJobs;
+        for (const auto& job : preJobs)
+        {
+            const auto& imgPath = std::get<1>(job);
+            if (RealJobs.find(imgPath) == RealJobs.end() && 
+                std::find_if(newJobs.cbegin(), newJobs.cend(), [&](const auto& newJob) { return newJob.first == imgPath; }) == newJobs.cend())
+                newJobs.emplace_back(imgPath, std::get<2>(job));
+        }
+        auto loadRess = TexLoader->GetTexturesAsync(newJobs);
+        for (size_t i = 0; i < newJobs.size(); ++i)
+            RealJobs.insert_or_assign(newJobs[i].first, std::move(loadRess[i]));
         for (const auto&[mat, imgPath, type] : preJobs)
         {
-            if (const auto it = FindInMap(RealJobs, imgPath))
-            {
-                DelayJobs.emplace_back(mat, it, type);
-            }
-            else
-            {
-                auto loadRes = TexLoader->GetTexureAsync(imgPath, type);
-                const auto ptr = &(RealJobs.insert_or_assign(imgPath, loadRes).first->second);
-                DelayJobs.emplace_back(mat, ptr, type);
-            }
+            DelayJobs.emplace_back(mat, FindInMap(RealJobs, imgPath), type);
         }
     }
     catch (const common::file::FileException&)
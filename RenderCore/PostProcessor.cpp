@@ -129,6 +129,23 @@ public:
     }
 };
 
+class PostProcessor::CPULutGen : public PostProcessor::LutGen
+{
+private:
+    oglu::oglTex3DS LutTex;
+    uint32_t LutSize;
+public:
+    CPULutGen(const uint32_t lutSize, const oglu::oglTex3DS& tex) : LutTex(tex), LutSize(lutSize)
+    { }
+    ~CPULutGen() override { }
+
+    void UpdateLUT(const float exposure) override
+    {
+        const auto lut = xziar::img::ColorLUT3D::Bake(LutSize, xziar::img::LUTToneMap::ACES, std::pow(2.0f, exposure), xziar::img::LUTRange::LogUE);
+        LutTex->SetData(xziar::img::TextureFormat::RGBAf, lut.GetData().data());
+    }
+};
+
 PostProcessor::PostProcessor(const uint32_t lutSize)
     : PostProcessor(lutSize, LoadShaderFromDLL(IDR_SHADER_POSTPROC)) {}
 PostProcessor::PostProcessor(const uint32_t lutSize, const string& postSrc)
@@ -151,7 +168,15 @@ PostProcessor::PostProcessor(const uint32_t lutSize, const string& postSrc)
     }
     if (!LutGenerator)
     {
-        LutGenerator = std::make_unique<RenderLutGen>(LutSize, LutTex);
+        try
+        {
+            LutGenerator = std::make_unique<RenderLutGen>(LutSize, LutTex);
+        }
+        catch (const BaseException & be)
+        {
+            dizzLog().warning(u"unable to create render lut generator, fallback to CPU:\n {}\n", be.Message());
+            LutGenerator = std::make_unique<CPULutGen>(LutSize, LutTex);
+        }
     }
 
     ScreenBox = oglu::oglArrayBuffer_::Create();
@@ -200,6 +225,11 @@ void PostProcessor::SetEnable(const bool isEnable)
     EnablePostProcess = isEnable;
 }
 
+xziar::img::ColorLUT3D PostProcessor::BakeCPULUT() const
+{
+    return xziar::img::ColorLUT3D::Bake(LutSize, xziar::img::LUTToneMap::ACES, std::pow(2.0f, Exposure), xziar::img::LUTRange::LogUE);
+}
+
 
 bool PostProcessor::UpdateLUT()
 {
@@ -2,6 +2,7 @@
 #include "RenderCoreRely.h"
 #include "RenderPass.h"
 #include "GLShader.h"
+#include "ImageUtil/ColorLUT.h"
 
 namespace dizz
 {
@@ -24,6 +25,7 @@ private:
     class LutGen;
     class ComputeLutGen;
     class RenderLutGen;
+    class CPULutGen;
 
     oglu::oglTex2DS FBOTex;
     oglu::oglTex3DS LutTex;
@@ -57,6 +59,8 @@ public:
     void SetExposure(const float exposure);
     void SetMidFrame(const uint16_t width, const uint16_t height, const bool needFloatDepth);
     void SetEnable(const bool isEnable);
+    // same grading as the LUT texture, for applying on CPU (offline render, thumbnail export)
+    xziar::img::ColorLUT3D BakeCPULUT() const;
 
     bool UpdateLUT();
     bool UpdateFBO();
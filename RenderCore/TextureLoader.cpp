@@ -3,6 +3,7 @@
 #include "TextureUtil/TexCompressor.h"
 #include "TextureUtil/TexMipmap.h"
 #include "SystemCommon/AsyncManager.h"
+#include "SystemCommon/WorkerPool.h"
 #include <thread>
 
 namespace dizz
@@ -14,6 +15,7 @@ using common::container::FindInMap;
 using common::asyexe::AsyncAgent;
 using common::asyexe::StackSize;
 using xziar::img::TextureFormat;
+using xziar::img::TexDiskCache;
 using namespace xziar::img;
 
 
@@ -29,6 +31,8 @@ void TextureLoader::RegistControllable()
     RegistItem<u16string>("Name", "", u"名称", ArgType::RawValue)
         .RegistObject<false>(TextureLoaderName);
     Controllable::EnumSet<int32_t> EnumProcType(ProcPairs);
+    RegistItem<bool>("pipeline", "", u"流水线压缩")
+        .RegistMember(&TextureLoader::UsePipeline);
     RegistItem<bool>("color_mipmap", "Color", u"Mipmap")
         .RegistMemberProxy<TextureLoader>([](auto& control) -> auto&
     { return control.ProcessMethod.find(TexLoadType::Color)->second.NeedMipmap; });
@@ -57,6 +61,7 @@ TextureLoader::TextureLoader(const std::shared_ptr<oglu::texutil::TexMipmap>& mi
         common::SetThreadName(u"TexCompress");
         dizzLog().success(u"TexCompress thread start running.\n");
     });
+    SetDiskCache(DefaultDiskCacheDir(), DefaultDiskCacheSize);
     RegistControllable();
 }
 TextureLoader::~TextureLoader()
@@ -65,7 +70,128 @@ TextureLoader::~TextureLoader()
 }
 
 
-common::PromiseResult<FakeTex> TextureLoader::LoadImgToFakeTex(const fs::path& picPath, Image&& img, const TexLoadType type, const TexProc proc)
+fs::path TextureLoader::DefaultDiskCacheDir()
+{
+    std::error_code ec;
+    const auto tmpDir = fs::temp_directory_path(ec);
+    return ec ? fs::path{} : tmpDir / "RayRenderer" / "TexCache";
+}
+
+void TextureLoader::SetDiskCache(const fs::path& directory, const uint64_t maxBytes)
+{
+    if (directory.empty())
+    {
+        DiskCache.reset();
+        return;
+    }
+    DiskCache = std::make_unique<TexDiskCache>(directory, maxBytes);
+}
+
+uint32_t TextureLoader::GetCacheVariant(const TexLoadType type, const TexProc proc) noexcept
+{
+    // bump revision when processing result changes (e.g, flip, mipmap filter), so that old entries are not hit
+    constexpr uint32_t Revision = 1;
+    return (Revision << 24) | (static_cast<uint32_t>(type) << 16) | (static_cast<uint32_t>(proc.Proc) << 8) | (proc.NeedMipmap ? 1u : 0u);
+}
+
+TextureLoader::SourceHash TextureLoader::HashSource(const fs::path& picPath) const
+{
+    if (!DiskCache)
+        return {};
+    if (auto hash = DiskCache->LookupFile(picPath); hash)
+        return hash;
+    try
+    {
+        return DiskCache->RecordFile(picPath);
+    }
+    catch (const BaseException&)
+    {
+        return {}; // let decoding report the error
+    }
+}
+
+FakeTex TextureLoader::LoadFromDisk(const fs::path& picPath, const SourceHash& srcHash, const TexLoadType type, const TexProc proc)
+{
+    if (!DiskCache || !srcHash)
+        return {};
+    auto cached = DiskCache->Load({ *srcHash, GetCacheVariant(type, proc) });
+    if (!cached)
+        return {};
+    FakeTex tex = std::make_shared<detail::_FakeTex>(std::move(cached->Levels), cached->Format, cached->Width, cached->Height);
+    tex->Name = picPath.filename().u16string();
+    dizzLog().verbose(u"texture [{}] loaded from disk cache.\n", tex->Name);
+    CacheLock.LockWrite();
+    TexCache.try_emplace(picPath.u16string(), tex);
+    CacheLock.UnlockWrite();
+    return tex;
+}
+
+vector<common::AlignedBuffer> TextureLoader::ProcessStaged(const AsyncAgent& agent, ImageView img,
+    const TexLoadType type, const TexProc proc, const TextureFormat format, TexProcStats& stats)
+{
+    common::SimpleTimer timer;
+    vector<ImageView> layers;
+    if (proc.NeedMipmap)
+    {
+        timer.Start();
+        const auto pms = MipMapper->GenerateMipmaps(img, type == TexLoadType::Color);
+        layers = common::linq::FromContainer(agent.Await(pms)).template Cast<ImageView>().ToVector();
+        timer.Stop();
+        stats.MipmapNs += timer.ElapseNs();
+    }
+    layers.insert(layers.begin(), std::move(img));
+    // all levels are kept until the last one is compressed
+    size_t liveBytes = 0;
+    for (const auto& layer : layers)
+        liveBytes += layer.GetSize();
+    vector<common::AlignedBuffer> buffers;
+    timer.Start();
+    for (auto& layer : layers)
+    {
+        if (proc.Proc == TexProcType::Plain)
+            buffers.emplace_back(layer.ExtractData());
+        else
+        {
+            buffers.emplace_back(oglu::texutil::CompressToDat(layer, format));
+            liveBytes += buffers.back().GetSize();
+        }
+    }
+    timer.Stop();
+    stats.CompressNs += timer.ElapseNs();
+    stats.PeakBytes = std::max(stats.PeakBytes, liveBytes);
+    return buffers;
+}
+
+vector<common::AlignedBuffer> TextureLoader::ProcessStreamed(const AsyncAgent& agent, ImageView img,
+    const TexLoadType type, const TexProc proc, const TextureFormat format, TexProcStats& stats)
+{
+    oglu::texutil::MipCompressStream stream(format);
+    // full size level starts compressing while mipmaps are being generated
+    stream.Push(0, img);
+    if (proc.NeedMipmap)
+    {
+        common::SimpleTimer timer;
+        timer.Start();
+        const auto pms = MipMapper->GenerateMipmaps(std::move(img), [&stream](const uint8_t level, ImageView mip)
+            {
+                stream.Push(static_cast<uint8_t>(level + 1), std::move(mip));
+            }, type == TexLoadType::Color);
+        agent.Await(pms);
+        timer.Stop();
+        stats.MipmapNs += timer.ElapseNs();
+    }
+    else
+        img = Image(img.GetDataType()); // let stream release it once compressed
+    // tiles run on the shared workers, the agent yields meanwhile
+    auto buffers = agent.Await(stream.Finish());
+    const auto streamStats = stream.GetStats();
+    stats.CompressNs += streamStats.CompressNs;
+    stats.PeakBytes = std::max(stats.PeakBytes, streamStats.PeakBytes);
+    return buffers;
+}
+
+common::PromiseResult<FakeTex> TextureLoader::LoadImgToFakeTex(const fs::path& picPath, Image&& img, const TexLoadType type, const TexProc proc,
+    SourceHash srcHash)
 {
     const auto w = img.GetWidth(), h = img.GetHeight();
     if (w <= 4 || h <= 4)
@@ -76,20 +202,14 @@ common::PromiseResult<FakeTex> TextureLoader::LoadImgToFakeTex(const fs::path& p
         const auto newH = 1 << uint32_t(std::round(std::log2(h)));
         dizzLog().debug(u"decide to resize image[{}*{}] to [{}*{}].\n", w, h, newW, newH);
         img.Resize(newW, newH, true, false);
-        return LoadImgToFakeTex(picPath, std::move(img), type, proc);
+        return LoadImgToFakeTex(picPath, std::move(img), type, proc, std::move(srcHash));
     }
     img.FlipVertical(); // pre-flip since after compression, OGLU won't care about vertical coordnate system
 
-    return Compressor->AddTask([this, imgview = ImageView(std::move(img)), type, proc, picPath](const auto& agent) mutable
+    return Compressor->AddTask([this, imgview = ImageView(std::move(img)), type, proc, picPath, srcHash](const auto& agent) mutable
     {
         FakeTex tex;
-        vector<ImageView> layers;
-        if (proc.NeedMipmap)
-        {
-            const auto pms = MipMapper->GenerateMipmaps(imgview, type == TexLoadType::Color);
-            layers = common::linq::FromContainer(agent.Await(pms)).template Cast<ImageView>().ToVector();
-        }
-        layers.insert(layers.begin(), imgview);
+        const auto width = imgview.GetWidth(), height = imgview.GetHeight();
         xziar::img::TextureFormat format = xziar::img::TextureFormat::EMPTY,
             srgbMask = (type == TexLoadType::Color ? xziar::img::TextureFormat::MASK_SRGB : xziar::img::TextureFormat::EMPTY);
         switch (proc.Proc)
@@ -105,22 +225,29 @@ common::PromiseResult<FakeTex> TextureLoader::LoadImgToFakeTex(const fs::path& p
         }
         try 
         {
-            vector<common::AlignedBuffer> buffers;
-            for (auto& layer : layers)
+            TexProcStats stats;
+            common::SimpleTimer timer;
+            timer.Start();
+            auto buffers = (UsePipeline && proc.Proc != TexProcType::Plain) ?
+                ProcessStreamed(agent, std::move(imgview), type, proc, format, stats) :
+                ProcessStaged  (agent, std::move(imgview), type, proc, format, stats);
+            timer.Stop();
+            stats.Count = 1;
+            stats.TotalNs = timer.ElapseNs();
+            dizzLog().debug(u"Processed texture [{}] in {}ms (mipmap {}ms, compress {}ms), peak [{}]KB.\n", picPath.filename().u16string(),
+                stats.TotalNs / 1000000, stats.MipmapNs / 1000000, stats.CompressNs / 1000000, stats.PeakBytes / 1024);
             {
-                switch (proc.Proc)
-                {
-                case TexProcType::Plain:
-                    buffers.emplace_back(layer.ExtractData()); break;
-                case TexProcType::CompressBC5:
-                    buffers.emplace_back(oglu::texutil::CompressToDat(layer, format)); break;
-                case TexProcType::CompressBC7:
-                    buffers.emplace_back(oglu::texutil::CompressToDat(layer, format)); break;
-                default:
-                    break;
-                }
+                std::lock_guard<std::mutex> lock(StatsLock);
+                ProcStats.Count      += stats.Count;
+                ProcStats.MipmapNs   += stats.MipmapNs;
+                ProcStats.CompressNs += stats.CompressNs;
+                ProcStats.TotalNs    += stats.TotalNs;
+                ProcStats.PeakBytes   = std::max(ProcStats.PeakBytes, stats.PeakBytes);
             }
-            tex = std::make_shared<detail::_FakeTex>(std::move(buffers), format, imgview.GetWidth(), imgview.GetHeight());
+            xziar::img::CompressedTex result{ std::move(buffers), format, width, height };
+            if (DiskCache && srcHash)
+                DiskCache->Store({ *srcHash, GetCacheVariant(type, proc) }, result);
+            tex = std::make_shared<detail::_FakeTex>(std::move(result.Levels), result.Format, result.Width, result.Height);
             tex->Name = picPath.filename().u16string();
             CacheLock.LockWrite();
             TexCache.try_emplace(picPath.u16string(), tex);
@@ -136,11 +263,12 @@ common::PromiseResult<FakeTex> TextureLoader::LoadImgToFakeTex(const fs::path& p
 }
 
 
-std::optional<Image> TryReadImage(const fs::path& picPath)
+template<typename F>
+static std::optional<Image> TryReadImage(const fs::path& picPath, F&& reader)
 {
     try
     {
-        return ReadImage(picPath);
+        return reader();
     }
     catch (const common::file::FileException& fe)
     {
@@ -155,6 +283,10 @@ std::optional<Image> TryReadImage(const fs::path& picPath)
     }
     return {};
 }
+std::optional<Image> TryReadImage(const fs::path& picPath)
+{
+    return TryReadImage(picPath, [&]() { return ReadImage(picPath); });
+}
 
 TextureLoader::LoadResult TextureLoader::GetTexureAsync(const fs::path& picPath, const TexLoadType type, const bool async)
 {
@@ -163,18 +295,25 @@ TextureLoader::LoadResult TextureLoader::GetTexureAsync(const fs::path& picPath,
     CacheLock.UnlockRead();
     if (tex)
         return *tex;
+    const auto proc = ProcessMethod[type];
     if (async)
     {
-        return Compressor->AddTask([this, picPath, type](const auto& agent)
+        return Compressor->AddTask([this, picPath, type, proc](const auto& agent)
         {
+            auto srcHash = HashSource(picPath);
+            if (auto cached = LoadFromDisk(picPath, srcHash, type, proc); cached)
+                return cached;
             if (auto img = TryReadImage(picPath); img)
-                return agent.Await(LoadImgToFakeTex(picPath, std::move(img.value()), type, ProcessMethod[type]));
+                return agent.Await(LoadImgToFakeTex(picPath, std::move(img.value()), type, proc, std::move(srcHash)));
             else
                 return FakeTex();
         });
     }
+    auto srcHash = HashSource(picPath);
+    if (auto cached = LoadFromDisk(picPath, srcHash, type, proc); cached)
+        return cached;
     if (auto img = TryReadImage(picPath); img)
-        return LoadImgToFakeTex(picPath, std::move(img.value()), type, ProcessMethod[type]);
+        return LoadImgToFakeTex(picPath, std::move(img.value()), type, proc, std::move(srcHash));
     return FakeTex();
 }
 
@@ -185,14 +324,95 @@ TextureLoader::LoadResult TextureLoader::GetTexureAsync(const fs::path& picPath,
     CacheLock.UnlockRead();
     if (tex)
         return *tex;
+    const auto proc = ProcessMethod[type];
     if (async)
     {
-        return Compressor->AddTask([this, picPath, img = std::move(img), type](const auto& agent) mutable
+        return Compressor->AddTask([this, picPath, img = std::move(img), type, proc](const auto& agent) mutable
         {
-            return agent.Await(LoadImgToFakeTex(picPath, std::move(img), type, ProcessMethod[type]));
+            SourceHash srcHash;
+            if (DiskCache)
+                srcHash = TexDiskCache::HashImage(img);
+            if (auto cached = LoadFromDisk(picPath, srcHash, type, proc); cached)
+                return cached;
+            return agent.Await(LoadImgToFakeTex(picPath, std::move(img), type, proc, std::move(srcHash)));
         });
     }
-    return LoadImgToFakeTex(picPath, std::move(img), type, ProcessMethod[type]);
+    SourceHash srcHash;
+    if (DiskCache)
+        srcHash = TexDiskCache::HashImage(img);
+    if (auto cached = LoadFromDisk(picPath, srcHash, type, proc); cached)
+        return cached;
+    return LoadImgToFakeTex(picPath, std::move(img), type, proc, std::move(srcHash));
+}
+
+std::vector<TextureLoader::LoadResult> TextureLoader::GetTexturesAsync(const std::vector<std::pair<fs::path, TexLoadType>>& requests)
+{
+    std::vector<LoadResult> results(requests.size());
+    std::vector<ImageReadRequest> readReqs;
+    std::vector<size_t> readIdxs, missIdxs;
+    CacheLock.LockRead();
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        if (auto tex = FindInMap(TexCache, requests[i].first.u16string()); tex)
+            results[i] = *tex;
+        else
+            missIdxs.push_back(i);
+    }
+    CacheLock.UnlockRead();
+    // sources known by the disk cache are checked before decoding, hit ones skip both decoding and compressing
+    std::vector<SourceHash> srcHashes;
+    for (const auto idx : missIdxs)
+    {
+        const auto& [picPath, type] = requests[idx];
+        SourceHash srcHash;
+        if (DiskCache)
+            srcHash = DiskCache->LookupFile(picPath);
+        if (auto cached = LoadFromDisk(picPath, srcHash, type, ProcessMethod[type]); cached)
+            results[idx] = cached;
+        else
+        {
+            readReqs.push_back({ picPath, ImageDataType::RGBA });
+            readIdxs.push_back(idx);
+            srcHashes.push_back(std::move(srcHash));
+        }
+    }
+    if (readReqs.empty())
+        return results;
+
+    dizzLog().debug(u"batch decoding [{}] textures.\n", readReqs.size());
+    auto decodes = ReadImages(std::move(readReqs));
+    for (size_t i = 0; i < readIdxs.size(); ++i)
+    {
+        const auto& [picPath, type] = requests[readIdxs[i]];
+        // unknown sources are hashed on the shared workers alongside decoding, a hit then drops the decoded image
+        common::PromiseResult<SourceHash> hashPms;
+        if (DiskCache && !srcHashes[i])
+        {
+            common::BasicPromise<SourceHash> pms;
+            common::WorkerPool::GetShared().Post([this, pms, picPath = picPath]()
+            {
+                pms.SetData(HashSource(picPath));
+            });
+            hashPms = pms.GetPromiseResult();
+        }
+        // decode runs on ImageUtil's workers, compressor only waits for it
+        results[readIdxs[i]] = Compressor->AddTask([this, picPath = picPath, type = type, pms = std::move(decodes[i]), 
+            hashPms = std::move(hashPms), knownHash = std::move(srcHashes[i])](const auto& agent)
+        {
+            auto srcHash = knownHash;
+            if (hashPms)
+            {
+                srcHash = agent.Await(hashPms);
+                if (auto cached = LoadFromDisk(picPath, srcHash, type, ProcessMethod[type]); cached)
+                    return cached;
+            }
+            if (auto img = TryReadImage(picPath, [&]() { return agent.Await(pms); }); img)
+                return agent.Await(LoadImgToFakeTex(picPath, std::move(img.value()), type, ProcessMethod[type], srcHash));
+            else
+                return FakeTex();
+        }, picPath.filename().u16string(), StackSize::Big);
+    }
+    return results;
 }
 
 #pragma warning(disable:4996)
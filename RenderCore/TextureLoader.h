@@ -3,8 +3,10 @@
 #include "RenderCoreRely.h"
 #include "Material.h"
 #include "TextureUtil/TexMipmap.h"
+#include "ImageUtil/TexDiskCache.h"
 #include "SystemCommon/AsyncAgent.h"
 #include "common/Controllable.hpp"
+#include <mutex>
 
 
 namespace dizz
@@ -14,6 +16,15 @@ namespace dizz
 enum class TexLoadType : uint8_t { Color, Normal };
 enum class TexProcType : uint8_t { CompressBC7, CompressBC5, Plain };
 
+struct TexProcStats
+{
+    uint32_t Count = 0;
+    uint64_t MipmapNs = 0;
+    uint64_t CompressNs = 0; // summed over all compress threads
+    uint64_t TotalNs = 0;
+    size_t PeakBytes = 0; // max of all textures
+};
+
 #if COMMON_COMPILER_MSVC
 #   pragma warning(push)
 #   pragma warning(disable:4275 4251)
@@ -31,7 +42,20 @@ private:
     std::map<u16string, FakeTex> TexCache;
     common::RWSpinLock CacheLock;
     std::map<TexLoadType, TexProc> ProcessMethod;
-    common::PromiseResult<FakeTex> LoadImgToFakeTex(const fs::path& picPath, xziar::img::Image&& img, const TexLoadType type, const TexProc proc);
+    std::unique_ptr<xziar::img::TexDiskCache> DiskCache;
+    TexProcStats ProcStats;
+    std::mutex StatsLock;
+    bool UsePipeline = true;
+    using SourceHash = std::optional<xziar::img::TexDiskCache::Digest>;
+    static uint32_t GetCacheVariant(const TexLoadType type, const TexProc proc) noexcept;
+    SourceHash HashSource(const fs::path& picPath) const;
+    FakeTex LoadFromDisk(const fs::path& picPath, const SourceHash& srcHash, const TexLoadType type, const TexProc proc);
+    std::vector<common::AlignedBuffer> ProcessStaged(const common::asyexe::AsyncAgent& agent, xziar::img::ImageView img,
+        const TexLoadType type, const TexProc proc, const xziar::img::TextureFormat format, TexProcStats& stats);
+    std::vector<common::AlignedBuffer> ProcessStreamed(const common::asyexe::AsyncAgent& agent, xziar::img::ImageView img,
+        const TexLoadType type, const TexProc proc, const xziar::img::TextureFormat format, TexProcStats& stats);
+    common::PromiseResult<FakeTex> LoadImgToFakeTex(const fs::path& picPath, xziar::img::Image&& img, const TexLoadType type, const TexProc proc,
+        SourceHash srcHash);
     void RegistControllable();
 public:
     using LoadResult = std::variant<FakeTex, common::PromiseResult<FakeTex>>;
@@ -44,7 +68,27 @@ public:
     }
     LoadResult GetTexureAsync(const fs::path& picPath, const TexLoadType type, const bool async = false);
     LoadResult GetTexureAsync(const fs::path& picPath, xziar::img::Image&& img, const TexLoadType type, const bool async = false);
+    // decode all uncached images concurrently, results are in the same order as requests
+    std::vector<LoadResult> GetTexturesAsync(const std::vector<std::pair<fs::path, TexLoadType>>& requests);
     void Shrink();
+    static constexpr uint64_t DefaultDiskCacheSize = uint64_t(4) << 30;
+    static fs::path DefaultDiskCacheDir();
+    // processed textures are kept in [directory] across runs, empty path disables it, should be set before loading
+    void SetDiskCache(const fs::path& directory, const uint64_t maxBytes);
+    [[nodiscard]] const xziar::img::TexDiskCache* GetDiskCache() const noexcept { return DiskCache.get(); }
+    // compress each mip level as soon as it's generated, across threads, instead of after all levels are ready
+    void SetPipeline(const bool usePipeline) noexcept { UsePipeline = usePipeline; }
+    [[nodiscard]] bool GetPipeline() const noexcept { return UsePipeline; }
+    TexProcStats GetProcStats()
+    {
+        std::lock_guard<std::mutex> lock(StatsLock);
+        return ProcStats;
+    }
+    void ResetProcStats()
+    {
+        std::lock_guard<std::mutex> lock(StatsLock);
+        ProcStats = {};
+    }
     void SetLoadPreference(const TexLoadType type, const TexProcType proc, const bool mipmap)
     {
         ProcessMethod[type] = TexProc{ proc, mipmap };
@@ -2,6 +2,8 @@
 #include "ThumbnailManager.h"
 #include "OpenGLUtil/oglWorker.h"
 #include "TextureUtil/TexResizer.h"
+#include "ImageUtil/TexDecompress.h"
+#include "SystemCommon/WorkerPool.h"
 
 
 namespace dizz
@@ -44,8 +46,55 @@ common::PromiseResult<std::optional<ImageView>> ThumbnailManager::GetThumbnail(c
     return InnerPrepareThumbnail(holder);
 }
 
+common::PromiseResult<std::optional<ImageView>> ThumbnailManager::PrepareThumbnailCPU(const FakeTex& fakeTex)
+{
+    common::BasicPromise<std::optional<ImageView>> pms;
+    // runs on the shared CPU workers, so a batch of thumbnails does not start a thread for each
+    common::WorkerPool::GetShared().Post([pms, fakeTex, this]()
+    {
+        try
+        {
+            const TexHolder holder(fakeTex);
+            const auto sizeRet = CalcSize(holder);
+            // same mipmap choice as GL path
+            const uint8_t mipmap = sizeRet.index() == 0 ? std::get<0>(sizeRet) : static_cast<uint8_t>(fakeTex->GetMipmapCount() - 1);
+            auto img = xziar::img::DecompressTexture(fakeTex->TexData[mipmap].AsSpan(), fakeTex->Width >> mipmap, fakeTex->Height >> mipmap, fakeTex->TexFormat);
+            if (sizeRet.index() == 0)
+                img = img.ConvertTo(ImageDataType::RGB);
+            else
+            {
+                // filter in linear space like the GL/CL resizer does for sRGB texture
+                const auto[neww, newh] = std::get<1>(sizeRet);
+                img = img.ResizeTo(neww, newh, xziar::img::TexFormatUtil::IsSRGBType(fakeTex->TexFormat));
+            }
+            ImageView view(std::move(img));
+            CacheLock.LockWrite();
+            ThumbnailMap.emplace(holder.GetWeakRef(), view);
+            CacheLock.UnlockWrite();
+            pms.SetData(std::optional<ImageView>(std::move(view)));
+        }
+        catch (const common::BaseException& be)
+        {
+            pms.SetException(be);
+        }
+        catch (...)
+        {
+            const auto ex = std::current_exception();
+            pms.SetException(ex);
+        }
+    });
+    return pms.GetPromiseResult();
+}
+
 common::PromiseResult<std::optional<ImageView>> ThumbnailManager::InnerPrepareThumbnail(const TexHolder& holder)
 {
+    // compressed data can be decoded on CPU, no need to go through GL
+    if (holder.index() == 2)
+    {
+        const auto& fakeTex = std::get<FakeTex>(holder);
+        if (xziar::img::CanDecompressTexture(fakeTex->TexFormat))
+            return PrepareThumbnailCPU(fakeTex);
+    }
     return GLWorker->InvokeShare([holder, this](const auto& agent) -> std::optional<ImageView>
     {
         auto weakref = holder.GetWeakRef();
@@ -17,6 +17,7 @@ private:
     common::RWSpinLock CacheLock;
     std::map<std::weak_ptr<void>, ImageView, std::owner_less<void>> ThumbnailMap;
     common::PromiseResult<std::optional<ImageView>> InnerPrepareThumbnail(const TexHolder& holder);
+    common::PromiseResult<std::optional<ImageView>> PrepareThumbnailCPU(const FakeTex& fakeTex);
 public:
 
     ThumbnailManager(const std::shared_ptr<oglu::texutil::TexUtilWorker>& texWorker, const std::shared_ptr<oglu::oglWorker>& glWorker);
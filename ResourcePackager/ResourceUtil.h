@@ -1,6 +1,7 @@
 #pragma once
 #include "ResourcePackagerRely.h"
 #include "SystemCommon/MiscIntrins.h"
+#include "SystemCommon/FileMapperEx.h"
 
 namespace xziar::respak
 {
@@ -29,6 +30,10 @@ public:
         common::span<const std::byte> dat(reinterpret_cast<const std::byte*>(data), size);
         return common::DigestFunc.SHA256(dat);
     }
+    forceinline static bytearray<32> SHA256File(const common::fs::path& fpath)
+    {
+        return common::file::SHA256OfFile(fpath);
+    }
 };
 
 }
@@ -1,9 +1,11 @@
 #include "SystemCommonPch.h"
 #include "FileMapperEx.h"
+#include "MiscIntrins.h"
 
 #include <cstddef>
 #include <cstdio>
 #include <cstdint>
+#include <future>
 #include <vector>
 #include <string>
 
@@ -279,4 +281,38 @@ FileMappingInputStream MapFileForRead(const fs::path& fpath)
     );
 }
 
+std::array<std::byte, 32> SHA256OfFile(const fs::path& fpath, const bool preferMapping)
+{
+    auto file = RawFileObject::OpenThrow(fpath, OpenFlag::ReadBinary);
+    auto hasher = DigestFunc.SHA256Stream();
+    if (preferMapping)
+    {
+        if (auto mapping = FileMappingObject::OpenMapping(file, MappingFlag::ReadOnly); mapping)
+        {
+            const FileMappingInputStream stream(std::move(mapping));
+            const auto [ptr, size] = stream.ExposeAvaliable();
+            hasher.Update(common::span<const std::byte>(ptr, size));
+            return hasher.Finalize();
+        }
+    }
+    // double buffered, next chunk is read while current one is being hashed
+    constexpr size_t ChunkSize = 4 * 1024 * 1024;
+    RawFileInputStream stream(std::move(file));
+    std::vector<std::byte> buffers[2] = { std::vector<std::byte>(ChunkSize), std::vector<std::byte>(ChunkSize) };
+    const auto readChunk = [&](std::vector<std::byte>& buf) { return stream.ReadMany(ChunkSize, 1, buf.data()); };
+    size_t curSize = readChunk(buffers[0]);
+    for (uint8_t cur = 0; curSize > 0; cur ^= 1)
+    {
+        if (curSize < ChunkSize) // reach EOF
+        {
+            hasher.Update(common::span<const std::byte>(buffers[cur].data(), curSize));
+            break;
+        }
+        auto next = std::async(std::launch::async, readChunk, std::ref(buffers[cur ^ 1]));
+        hasher.Update(common::span<const std::byte>(buffers[cur].data(), curSize));
+        curSize = next.get();
+    }
+    return hasher.Finalize();
+}
+
 }
@@ -7,6 +7,7 @@
 #include "common/ContainerHelper.hpp"
 
 #include <cstdio>
+#include <array>
 #include <vector>
 
 
@@ -103,5 +104,7 @@ public:
 
 
 SYSCOMMONAPI FileMappingInputStream MapFileForRead(const fs::path& fpath);
+// hash file without loading it as a whole, fallback to chunked read with read-ahead when mapping is not available
+[[nodiscard]] SYSCOMMONAPI std::array<std::byte, 32> SHA256OfFile(const fs::path& fpath, const bool preferMapping = true);
 
 }
@@ -1,7 +1,8 @@
 #include "LoopBase.h"
+#include "SpinLock.h"
 #include <mutex>
 #include <thread>
-#include <condition_variable>
+#include <chrono>
 
 namespace common::loop
 {
@@ -109,26 +110,46 @@ LoopExecutor::~LoopExecutor()
 {
     delete Control;
 }
+void LoopExecutor::SetPlacement(ThreadPlacement placement) noexcept
+{
+    Placement = std::move(placement);
+}
 
 
 class ThreadedExecutor : public LoopExecutor
 {
     std::thread MainThread;
-    std::condition_variable SleepCond;
+    std::atomic<uint32_t> WakeupSignal{ 0 };
 protected:
     void DoSleep(void* runningLock, const uint32_t sleepTime) noexcept override
     {
         auto& mtx = *reinterpret_cast<std::unique_lock<std::mutex>*>(runningLock);
+        mtx.unlock();
         if (sleepTime > LoopBase::LoopAction::MaxSleepTime)
-            SleepCond.wait(mtx);
+        {
+            while (WakeupSignal.load() == 0)
+                AtomicWaiter::Wait(WakeupSignal, 0);
+        }
         else
-            SleepCond.wait_for(mtx, std::chrono::milliseconds(sleepTime));
-
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(sleepTime);
+            while (WakeupSignal.load() == 0)
+            {
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= deadline)
+                    break;
+                const auto remain = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+                AtomicWaiter::Wait(WakeupSignal, 0, static_cast<uint32_t>(remain));
+            }
+        }
+        WakeupSignal = 0; // a wakeup arrived after timeout only causes one extra loop
+        mtx.lock();
     }
     void DoWakeup() noexcept override
     {
-        auto lock = Control->AcquireRunningLock(); // ensure in the sleep
-        SleepCond.notify_one();
+        // signal is kept until consumed, so no need to ensure sleeper is already waiting
+        WakeupSignal = 1;
+        AtomicWaiter::WakeOne(WakeupSignal);
     }
     void DoStart() override
     {
@@ -136,6 +157,8 @@ protected:
             MainThread.join();
         MainThread = std::thread([&]() 
             {
+                if (!Placement.IsDefault())
+                    Placement.Apply();
                 if (TurnToRun())
                     this->RunLoop();
             });
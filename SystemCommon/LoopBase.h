@@ -2,6 +2,7 @@
 
 #include "SystemCommonRely.h"
 #include "Exceptions.h"
+#include "ThreadEx.h"
 #include <atomic>
 #include <any>
 #include <memory>
@@ -22,6 +23,7 @@ class SYSCOMMONAPI LoopExecutor : public NonCopyable
 protected:
     struct ControlBlock;
     ControlBlock* const Control;
+    ThreadPlacement Placement;
 private:
     LoopBase& Loop;
     std::any Cookie = {};
@@ -45,6 +47,8 @@ protected:
     void RunLoop() noexcept;
 public:
     virtual ~LoopExecutor();
+    // applied to the executing thread when loop starts, only affects threaded executor
+    void SetPlacement(ThreadPlacement placement) noexcept;
 };
 
 class SYSCOMMONAPI InplaceExecutor : public LoopExecutor
@@ -113,6 +117,15 @@ public:
 
     [[nodiscard]] static std::unique_ptr<LoopExecutor> GetThreadedExecutor(LoopBase& loop);
     [[nodiscard]] static std::unique_ptr<LoopExecutor> GetInplaceExecutor(LoopBase& loop);
+    [[nodiscard]] static auto GetPlacedExecutor(ThreadPlacement placement)
+    {
+        return [placement = std::move(placement)](LoopBase& loop)
+        {
+            auto host = GetThreadedExecutor(loop);
+            host->SetPlacement(placement);
+            return host;
+        };
+    }
 };
 
 #if COMMON_COMPILER_MSVC
@@ -7,7 +7,7 @@
 #include "common/EnumEx.hpp"
 #include "common/Delegate.hpp"
 #include "common/SharedString.hpp"
-#include "common/SpinLock.hpp"
+#include "SpinLock.h"
 #include <set>
 
 #if COMMON_COMPILER_MSVC
@@ -154,6 +154,10 @@ protected:
 public:
     COMMON_NO_COPY(MiniLoggerBase)
     SYSCOMMONAPI MiniLoggerBase(const std::u16string& name, std::set<std::shared_ptr<LoggerBackend>> outputer = {}, const LogLevel level = LogLevel::Debug);
+    // same name and outputers as [other], with its own level
+    MiniLoggerBase(const MiniLoggerBase& other, const LogLevel level) :
+        LeastLevel(level), Prefix(other.Prefix), Outputer(other.Outputer)
+    { }
     MiniLoggerBase(MiniLoggerBase&& other) noexcept:
         LeastLevel(other.LeastLevel.load()), Prefix(std::move(other.Prefix)), Outputer(std::move(other.Outputer)) 
     { };
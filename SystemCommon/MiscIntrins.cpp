@@ -5,11 +5,15 @@
 #include "common/simd/SIMD128.hpp"
 #include "common/simd/SIMD256.hpp"
 #include "3rdParty/digestpp/algorithm/sha2.hpp"
+#if COMMON_ARCH_ARM && defined(__ARM_FEATURE_CRC32)
+#   include <arm_acle.h>
+#endif
 
 using namespace std::string_view_literals;
 using common::CheckCPUFeature;
 using common::MiscIntrins;
 using common::DigestFuncs;
+using common::HashFuncs;
 
 #define LeadZero32Args BOOST_PP_VARIADIC_TO_SEQ(num)
 #define LeadZero64Args BOOST_PP_VARIADIC_TO_SEQ(num)
@@ -25,8 +29,14 @@ DEFINE_FASTPATH(MiscIntrins, TailZero64);
 DEFINE_FASTPATH(MiscIntrins, PopCount32);
 DEFINE_FASTPATH(MiscIntrins, PopCount64);
 DEFINE_FASTPATH(MiscIntrins, Hex2Str);
-#define Sha256Args BOOST_PP_VARIADIC_TO_SEQ(data, size)
+#define Sha256Args      BOOST_PP_VARIADIC_TO_SEQ(data, size)
+#define Sha256BlockArgs BOOST_PP_VARIADIC_TO_SEQ(state, data, size)
 DEFINE_FASTPATH(DigestFuncs, Sha256);
+DEFINE_FASTPATH(DigestFuncs, Sha256Block);
+#define Crc32CArgs      BOOST_PP_VARIADIC_TO_SEQ(data, size, init)
+#define FastHash64Args  BOOST_PP_VARIADIC_TO_SEQ(data, size, seed)
+DEFINE_FASTPATH(HashFuncs, Crc32C);
+DEFINE_FASTPATH(HashFuncs, FastHash64);
 
 
 namespace
@@ -124,6 +134,39 @@ struct SHANIAVX2
 #endif
     }
 };
+struct SSE42
+{
+    static bool RuntimeCheck() noexcept
+    {
+#if COMMON_ARCH_X86
+        return CheckCPUFeature("sse4_2"sv);
+#else
+        return false;
+#endif
+    }
+};
+struct AVX2
+{
+    static bool RuntimeCheck() noexcept
+    {
+#if COMMON_ARCH_X86
+        return CheckCPUFeature("avx2"sv);
+#else
+        return false;
+#endif
+    }
+};
+struct ARMCRC
+{
+    static bool RuntimeCheck() noexcept
+    {
+#if COMMON_ARCH_X86
+        return false;
+#else
+        return CheckCPUFeature("crc32"sv);
+#endif
+    }
+};
 struct SHA2
 {
     static bool RuntimeCheck() noexcept
@@ -410,6 +453,40 @@ constexpr bool SHA256RoundProcControl[][2] =
     { false, false },
 };
 
+DEFINE_FASTPATH_METHOD(Sha256Block, NAIVE)
+{
+    constexpr auto RotR = [](const uint32_t val, const uint8_t bits) noexcept { return (val >> bits) | (val << (32 - bits)); };
+    for (size_t blk = size / 64; blk > 0; --blk, data += 64)
+    {
+        uint32_t w[64];
+        for (uint8_t i = 0; i < 16; ++i)
+        {
+            const auto ptr = reinterpret_cast<const uint8_t*>(data) + i * 4;
+            w[i] = (uint32_t(ptr[0]) << 24) | (uint32_t(ptr[1]) << 16) | (uint32_t(ptr[2]) << 8) | uint32_t(ptr[3]);
+        }
+        for (uint8_t i = 16; i < 64; ++i)
+        {
+            const auto s0 = RotR(w[i - 15], 7) ^ RotR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const auto s1 = RotR(w[i - 2], 17) ^ RotR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+        for (uint8_t i = 0; i < 64; ++i)
+        {
+            const auto s1 = RotR(e, 6) ^ RotR(e, 11) ^ RotR(e, 25);
+            const auto ch = (e & f) ^ (~e & g);
+            const auto tmp1 = h + s1 + ch + SHA256RoundAdders[i / 4][i % 4] + w[i];
+            const auto s0 = RotR(a, 2) ^ RotR(a, 13) ^ RotR(a, 22);
+            const auto maj = (a & b) ^ (a & c) ^ (b & c);
+            const auto tmp2 = s0 + maj;
+            h = g; g = f; f = e; e = d + tmp1;
+            d = c; c = b; b = a; a = tmp1 + tmp2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
 #if (COMMON_ARCH_X86 && COMMON_SIMD_LV >= 41) || (COMMON_ARCH_ARM && COMMON_SIMD_LV >= 100)
 struct Sha256State
 {
@@ -464,22 +541,26 @@ forceinline static void VECCALL Sha256Block128(Calc& calc, U32x4 msg0, U32x4 msg
 }
 
 template<typename Calc>
-inline std::array<std::byte, 32> Sha256Main128(const std::byte* data, const size_t size) noexcept
+forceinline static const uint32_t* Sha256Blocks128(Calc& calc, const uint32_t* __restrict ptr, size_t count) noexcept
 {
-    static_assert(std::is_base_of_v<Sha256State, Calc>);
-    Calc calc;
-
-    size_t len = size;
-    const uint32_t* __restrict ptr = reinterpret_cast<const uint32_t*>(data);
-    while (len >= 64)
+    for (; count > 0; --count)
     {
         const auto msg0 = U32x4(ptr).SwapEndian(); ptr += 4;
         const auto msg1 = U32x4(ptr).SwapEndian(); ptr += 4;
         const auto msg2 = U32x4(ptr).SwapEndian(); ptr += 4;
         const auto msg3 = U32x4(ptr).SwapEndian(); ptr += 4;
         Sha256Block128(calc, msg0, msg1, msg2, msg3);
-        len -= 64;
     }
+    return ptr;
+}
+template<typename Calc>
+inline std::array<std::byte, 32> Sha256Main128(const std::byte* data, const size_t size) noexcept
+{
+    static_assert(std::is_base_of_v<Sha256State, Calc>);
+    Calc calc;
+
+    const size_t len = size % 64;
+    const uint32_t* __restrict ptr = Sha256Blocks128(calc, reinterpret_cast<const uint32_t*>(data), size / 64);
     const auto bitsv = U64x2::LoadLo(static_cast<uint64_t>(size) * 8);
     const auto bitsvBE = bitsv.As<U32x4>().Shuffle<3, 3, 1, 0>();
     if (len >= 48)
@@ -548,6 +629,21 @@ struct Sha256Round_SHANI : public Sha256State
         { 0x9b05688c, 0x510e527f, 0xbb67ae85, 0x6a09e667 }/*ABEF-rev*/, 
         { 0x5be0cd19, 0x1f83d9ab, 0xa54ff53a, 0x3c6ef372 }/*CDGH-rev*/) 
     { }
+    // keep state shuffle in 128bit, scalar gather may get merged into 256bit load and cause SSE/AVX transition penalty
+    explicit Sha256Round_SHANI(const uint32_t* state) noexcept : Sha256State(U32x4::AllZero(), U32x4::AllZero())
+    {
+        const auto badc = _mm_shuffle_epi32(U32x4(state + 0), 0xB1);
+        const auto hgfe = _mm_shuffle_epi32(U32x4(state + 4), 0x1B);
+        State0 = _mm_alignr_epi8(badc, hgfe, 8);    // ABEF-rev
+        State1 = _mm_blend_epi16(hgfe, badc, 0xF0); // CDGH-rev
+    }
+    forceinline void SaveState(uint32_t* state) const noexcept
+    {
+        const auto abef = _mm_shuffle_epi32(State0, 0x1B);
+        const auto ghcd = _mm_shuffle_epi32(State1, 0xB1);
+        U32x4(_mm_blend_epi16(abef, ghcd, 0xF0)).Save(state + 0);
+        U32x4(_mm_alignr_epi8(ghcd, abef, 8)).Save(state + 4);
+    }
     /* Save state */
     forceinline std::array<std::byte, 32> Output() const noexcept
     {
@@ -589,6 +685,12 @@ DEFINE_FASTPATH_METHOD(Sha256, SHANI)
 {
     return Sha256Main128<Sha256Round_SHANI>(data, size);
 }
+DEFINE_FASTPATH_METHOD(Sha256Block, SHANI)
+{
+    Sha256Round_SHANI calc(state);
+    Sha256Blocks128(calc, reinterpret_cast<const uint32_t*>(data), size / 64);
+    calc.SaveState(state);
+}
 
 # elif COMMON_ARCH_ARM && defined(__ARM_FEATURE_CRYPTO)
 
@@ -613,6 +715,13 @@ struct Sha256Round_SHA2 : public Sha256State
         { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a }/*ABCD*/,
         { 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 }/*EFGH*/) 
     { }
+    explicit Sha256Round_SHA2(const uint32_t* state) noexcept : Sha256State(U32x4(state), U32x4(state + 4))
+    { }
+    forceinline void SaveState(uint32_t* state) const noexcept
+    {
+        State0.Save(state);
+        State1.Save(state + 4);
+    }
     /* Save state */
     forceinline std::array<std::byte, 32> Output() const noexcept
     {
@@ -643,6 +752,12 @@ DEFINE_FASTPATH_METHOD(Sha256, SHA2)
 {
     return Sha256Main128<Sha256Round_SHA2>(data, size);
 }
+DEFINE_FASTPATH_METHOD(Sha256Block, SHA2)
+{
+    Sha256Round_SHA2 calc(state);
+    Sha256Blocks128(calc, reinterpret_cast<const uint32_t*>(data), size / 64);
+    calc.SaveState(state);
+}
 
 # endif
 
@@ -694,20 +809,24 @@ forceinline static void VECCALL Sha256Block256(Calc& calc, U32x8 msg01, U32x8 ms
     calc.State1 += cdgh_save;
 }
 template<typename Calc>
-inline std::array<std::byte, 32> Sha256Main256(const std::byte* data, const size_t size) noexcept
+forceinline static const uint32_t* Sha256Blocks256(Calc& calc, const uint32_t* __restrict ptr, size_t count) noexcept
 {
-    static_assert(std::is_base_of_v<Sha256State, Calc>);
-    Calc calc;
-
-    size_t len = size;
-    const uint32_t* __restrict ptr = reinterpret_cast<const uint32_t*>(data);
-    while (len >= 64)
+    for (; count > 0; --count)
     {
         const auto msg01 = U32x8(ptr).SwapEndian(); ptr += 8;
         const auto msg23 = U32x8(ptr).SwapEndian(); ptr += 8;
         Sha256Block256(calc, msg01, msg23);
-        len -= 64;
     }
+    return ptr;
+}
+template<typename Calc>
+inline std::array<std::byte, 32> Sha256Main256(const std::byte* data, const size_t size) noexcept
+{
+    static_assert(std::is_base_of_v<Sha256State, Calc>);
+    Calc calc;
+
+    const size_t len = size % 64;
+    const uint32_t* __restrict ptr = Sha256Blocks256(calc, reinterpret_cast<const uint32_t*>(data), size / 64);
     const auto bitsv = U64x2::LoadLo(static_cast<uint64_t>(size) * 8);
     //const auto bitsvBE = U32x8(U32x4::AllZero(), bitsv.As<U32x4>().Shuffle<3, 3, 1, 0>());
     const auto bitsvBE = bitsv.As<U32x4>().Shuffle<3, 3, 1, 0>();
@@ -751,6 +870,7 @@ inline std::array<std::byte, 32> Sha256Main256(const std::byte* data, const size
 # if COMMON_ARCH_X86 && (COMMON_COMPILER_MSVC || defined(__SHA__))
 struct Sha256Round_SHANIAVX2 : public Sha256Round_SHANI
 {
+    using Sha256Round_SHANI::Sha256Round_SHANI;
     // From http://software.intel.com/en-us/articles/intel-sha-extensions written by Sean Gulley.
     // Modifiled from code previously on https://github.com/mitls/hacl-star/tree/master/experimental/hash with BSD license.
     template<size_t Round>
@@ -790,7 +910,307 @@ DEFINE_FASTPATH_METHOD(Sha256, SHANIAVX2)
 {
     return Sha256Main256<Sha256Round_SHANIAVX2>(data, size);
 }
+DEFINE_FASTPATH_METHOD(Sha256Block, SHANIAVX2)
+{
+    Sha256Round_SHANIAVX2 calc(state);
+    Sha256Blocks256(calc, reinterpret_cast<const uint32_t*>(data), size / 64);
+    calc.SaveState(state);
+}
+# endif
+#endif
+
+
+
+
+static constexpr auto CRC32CTable = []() 
+{
+    std::array<uint32_t, 256> table = {};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+        for (uint32_t j = 0; j < 8; ++j)
+            crc = (crc >> 1) ^ ((crc & 1u) ? 0x82F63B78u : 0u);
+        table[i] = crc;
+    }
+    return table;
+}();
+
+DEFINE_FASTPATH_METHOD(Crc32C, NAIVE)
+{
+    uint32_t crc = ~init;
+    for (size_t i = 0; i < size; ++i)
+        crc = CRC32CTable[(crc ^ static_cast<uint8_t>(data[i])) & 0xffu] ^ (crc >> 8);
+    return ~crc;
+}
+
+#if (COMMON_ARCH_X86 && COMMON_SIMD_LV >= 42)
+# pragma message("Compiling HashFuncs with SSE4.2")
+DEFINE_FASTPATH_METHOD(Crc32C, SSE42)
+{
+# if COMMON_OSBIT == 64
+    uint64_t crc = ~init;
+    while (size >= 8)
+    {
+        uint64_t val;
+        memcpy(&val, data, 8);
+        crc = _mm_crc32_u64(crc, val);
+        data += 8, size -= 8;
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc);
+# else
+    uint32_t crc32 = ~init;
+# endif
+    while (size >= 4)
+    {
+        uint32_t val;
+        memcpy(&val, data, 4);
+        crc32 = _mm_crc32_u32(crc32, val);
+        data += 4, size -= 4;
+    }
+    while (size > 0)
+    {
+        crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+        data++, size--;
+    }
+    return ~crc32;
+}
+#endif
+
+#if COMMON_ARCH_ARM && defined(__ARM_FEATURE_CRC32)
+# pragma message("Compiling HashFuncs with ARMv8-CRC")
+DEFINE_FASTPATH_METHOD(Crc32C, ARMCRC)
+{
+    uint32_t crc = ~init;
+    while (size >= 8)
+    {
+        uint64_t val;
+        memcpy(&val, data, 8);
+        crc = __crc32cd(crc, val);
+        data += 8, size -= 8;
+    }
+    if (size >= 4)
+    {
+        uint32_t val;
+        memcpy(&val, data, 4);
+        crc = __crc32cw(crc, val);
+        data += 4, size -= 4;
+    }
+    while (size > 0)
+    {
+        crc = __crc32cb(crc, static_cast<uint8_t>(*data));
+        data++, size--;
+    }
+    return ~crc;
+}
+#endif
+
+
+// FastHash64 is an xxHash-class hash: xxh3-style 4-lane accumulation for bulk data (32-bit multiplies, SIMD friendly), 
+// xxh64-style merge, tail and avalanche. All variants share the same result, only bulk accumulation differs.
+namespace fasthash
+{
+constexpr uint64_t P1 = 0x9E3779B185EBCA87u, P2 = 0xC2B2AE3D27D4EB4Fu, P3 = 0x165667B19E3779F9u, P4 = 0x85EBCA77C2B2AE63u, P5 = 0x27D4EB2F165667C5u;
+constexpr uint32_t ScrambleP = 0x9E3779B1u;
+constexpr size_t StripeSize = 32, ScrambleStripes = 16;
+alignas(32) constexpr uint64_t Keys[4] = { 0xbe4ba423396cfeb8u, 0x1cad21f72c81017cu, 0xdb979083e96dd4deu, 0x1f67b3b7a4a44072u };
+
+forceinline static constexpr uint64_t RotL(const uint64_t val, const uint8_t bits) noexcept
+{
+    return (val << bits) | (val >> (64 - bits));
+}
+forceinline static uint64_t Load64(const std::byte* data) noexcept
+{
+    uint64_t val;
+    memcpy(&val, data, 8);
+    return val;
+}
+forceinline static uint32_t Load32(const std::byte* data) noexcept
+{
+    uint32_t val;
+    memcpy(&val, data, 4);
+    return val;
+}
+forceinline static constexpr uint64_t Round(uint64_t acc, const uint64_t val) noexcept
+{
+    acc += val * P2;
+    acc = RotL(acc, 31);
+    return acc * P1;
+}
+
+struct BulkNaive
+{
+    static void Accumulate(uint64_t(&acc)[4], const std::byte* data, size_t stripes) noexcept
+    {
+        for (size_t s = 0; s < stripes; ++s, data += StripeSize)
+        {
+            for (uint8_t i = 0; i < 4; ++i)
+            {
+                const auto val = Load64(data + i * 8);
+                const auto key = val ^ Keys[i];
+                acc[i ^ 1] += val;
+                acc[i] += (key & 0xffffffffu) * (key >> 32);
+            }
+            if ((s + 1) % ScrambleStripes == 0)
+            {
+                for (uint8_t i = 0; i < 4; ++i)
+                {
+                    auto a = acc[i];
+                    a ^= a >> 47;
+                    a ^= Keys[i];
+                    acc[i] = a * ScrambleP;
+                }
+            }
+        }
+    }
+};
+
+template<typename Bulk>
+static uint64_t Hash64Main(const std::byte* data, size_t size, const uint64_t seed) noexcept
+{
+    const auto len = size;
+    uint64_t hash;
+    if (size >= StripeSize)
+    {
+        uint64_t acc[4] = { seed + P1 + P2, seed + P2, seed, seed - P1 };
+        const auto stripes = size / StripeSize;
+        Bulk::Accumulate(acc, data, stripes);
+        data += stripes * StripeSize, size -= stripes * StripeSize;
+        hash = RotL(acc[0], 1) + RotL(acc[1], 7) + RotL(acc[2], 12) + RotL(acc[3], 18);
+        for (const auto a : acc)
+        {
+            hash ^= Round(0, a);
+            hash = hash * P1 + P4;
+        }
+    }
+    else
+        hash = seed + P5;
+    hash += len;
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        hash ^= Round(0, Load64(data));
+        hash = RotL(hash, 27) * P1 + P4;
+    }
+    if (size >= 4)
+    {
+        hash ^= static_cast<uint64_t>(Load32(data)) * P1;
+        hash = RotL(hash, 23) * P2 + P3;
+        data += 4, size -= 4;
+    }
+    for (; size > 0; data++, size--)
+    {
+        hash ^= static_cast<uint8_t>(*data) * P5;
+        hash = RotL(hash, 11) * P1;
+    }
+    hash ^= hash >> 33;
+    hash *= P2;
+    hash ^= hash >> 29;
+    hash *= P3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+}
+
+DEFINE_FASTPATH_METHOD(FastHash64, NAIVE)
+{
+    return fasthash::Hash64Main<fasthash::BulkNaive>(data, size, seed);
+}
+
+#if (COMMON_ARCH_X86 && COMMON_SIMD_LV >= 20) || (COMMON_ARCH_ARM && COMMON_SIMD_LV >= 10)
+namespace fasthash
+{
+struct Bulk128
+{
+# if COMMON_ARCH_X86
+    using T = __m128i;
+    forceinline static T Load(const void* ptr) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)); }
+    forceinline static T Add(const T& a, const T& b) noexcept { return _mm_add_epi64(a, b); }
+    forceinline static T Xor(const T& a, const T& b) noexcept { return _mm_xor_si128(a, b); }
+    forceinline static T Swap64(const T& a) noexcept { return _mm_shuffle_epi32(a, 0b01001110); }
+    forceinline static T MulLoHi32(const T& a) noexcept { return _mm_mul_epu32(a, _mm_srli_epi64(a, 32)); }
+    forceinline static T Scramble(T a, const T& key) noexcept
+    {
+        const auto muler = _mm_set1_epi32(static_cast<int32_t>(ScrambleP));
+        a = _mm_xor_si128(_mm_xor_si128(a, _mm_srli_epi64(a, 47)), key);
+        const auto lo = _mm_mul_epu32(a, muler);
+        const auto hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), muler);
+        return _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+    }
+# else
+    using T = uint64x2_t;
+    forceinline static T Load(const void* ptr) noexcept { return vreinterpretq_u64_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(ptr))); }
+    forceinline static T Add(const T& a, const T& b) noexcept { return vaddq_u64(a, b); }
+    forceinline static T Xor(const T& a, const T& b) noexcept { return veorq_u64(a, b); }
+    forceinline static T Swap64(const T& a) noexcept { return vextq_u64(a, a, 1); }
+    forceinline static T MulLoHi32(const T& a) noexcept { return vmull_u32(vmovn_u64(a), vshrn_n_u64(a, 32)); }
+    forceinline static T Scramble(T a, const T& key) noexcept
+    {
+        const auto muler = vdup_n_u32(ScrambleP);
+        a = veorq_u64(veorq_u64(a, vshrq_n_u64(a, 47)), key);
+        const auto lo = vmull_u32(vmovn_u64(a), muler);
+        const auto hi = vmull_u32(vshrn_n_u64(a, 32), muler);
+        return vaddq_u64(lo, vshlq_n_u64(hi, 32));
+    }
 # endif
+    static void Accumulate(uint64_t(&acc)[4], const std::byte* data, size_t stripes) noexcept
+    {
+        const auto key01 = Load(&Keys[0]), key23 = Load(&Keys[2]);
+        auto acc01 = Load(&acc[0]), acc23 = Load(&acc[2]);
+        for (size_t s = 0; s < stripes; ++s, data += StripeSize)
+        {
+            const auto val01 = Load(data), val23 = Load(data + 16);
+            acc01 = Add(acc01, Add(Swap64(val01), MulLoHi32(Xor(val01, key01))));
+            acc23 = Add(acc23, Add(Swap64(val23), MulLoHi32(Xor(val23, key23))));
+            if ((s + 1) % ScrambleStripes == 0)
+            {
+                acc01 = Scramble(acc01, key01);
+                acc23 = Scramble(acc23, key23);
+            }
+        }
+        memcpy(&acc[0], &acc01, 16);
+        memcpy(&acc[2], &acc23, 16);
+    }
+};
+}
+DEFINE_FASTPATH_METHOD(FastHash64, SIMD128)
+{
+    return fasthash::Hash64Main<fasthash::Bulk128>(data, size, seed);
+}
+#endif
+
+#if COMMON_ARCH_X86 && COMMON_SIMD_LV >= 200
+# pragma message("Compiling HashFuncs with AVX2")
+namespace fasthash
+{
+struct Bulk256
+{
+    static void Accumulate(uint64_t(&acc)[4], const std::byte* data, size_t stripes) noexcept
+    {
+        const auto key = _mm256_load_si256(reinterpret_cast<const __m256i*>(Keys));
+        const auto muler = _mm256_set1_epi32(static_cast<int32_t>(ScrambleP));
+        auto accs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+        for (size_t s = 0; s < stripes; ++s, data += StripeSize)
+        {
+            const auto val = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+            const auto valKey = _mm256_xor_si256(val, key);
+            const auto prod = _mm256_mul_epu32(valKey, _mm256_srli_epi64(valKey, 32));
+            accs = _mm256_add_epi64(accs, _mm256_add_epi64(_mm256_shuffle_epi32(val, 0b01001110), prod));
+            if ((s + 1) % ScrambleStripes == 0)
+            {
+                const auto a = _mm256_xor_si256(_mm256_xor_si256(accs, _mm256_srli_epi64(accs, 47)), key);
+                const auto lo = _mm256_mul_epu32(a, muler);
+                const auto hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), muler);
+                accs = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+            }
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), accs);
+    }
+};
+}
+DEFINE_FASTPATH_METHOD(FastHash64, AVX2)
+{
+    return fasthash::Hash64Main<fasthash::Bulk256>(data, size, seed);
+}
 #endif
 
 
@@ -830,6 +1250,7 @@ common::span<const DigestFuncs::PathInfo> DigestFuncs::GetSupportMap() noexcept
     {
         std::vector<PathInfo> ret;
         RegistFuncVars(DigestFuncs, Sha256, SHANIAVX2, SHA2, SHANI, NAIVE);
+        RegistFuncVars(DigestFuncs, Sha256Block, SHANIAVX2, SHA2, SHANI, NAIVE);
         return ret;
     }();
     return list;
@@ -838,9 +1259,93 @@ DigestFuncs::DigestFuncs(common::span<const VarItem> requests) noexcept { Init(r
 DigestFuncs::~DigestFuncs() {}
 bool DigestFuncs::IsComplete() const noexcept
 {
-    return Sha256;
+    return Sha256 && Sha256Block;
+}
+
+static constexpr uint32_t Sha256InitState[8] =
+{
+    0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au, 0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u
+};
+DigestFuncs::Sha256Stream::Sha256Stream(const DigestFuncs& host) noexcept : Host(host)
+{
+    Reset();
+}
+void DigestFuncs::Sha256Stream::Reset() noexcept
+{
+    Length = 0;
+    std::copy(std::begin(Sha256InitState), std::end(Sha256InitState), State.begin());
+}
+void DigestFuncs::Sha256Stream::Absorb(const std::byte* data, size_t size) noexcept
+{
+    auto buffered = static_cast<size_t>(Length % 64);
+    Length += size;
+    if (buffered > 0)
+    {
+        const auto len = std::min<size_t>(64 - buffered, size);
+        std::copy_n(data, len, Buffer.data() + buffered);
+        data += len, size -= len, buffered += len;
+        if (buffered < 64)
+            return;
+        Host.Sha256Block(State.data(), Buffer.data(), 64);
+    }
+    if (size >= 64)
+    {
+        const auto bulk = size & ~size_t(63);
+        Host.Sha256Block(State.data(), data, bulk);
+        data += bulk, size -= bulk;
+    }
+    if (size > 0)
+        std::copy_n(data, size, Buffer.data());
+}
+DigestFuncs::bytearray<32> DigestFuncs::Sha256Stream::Finalize() noexcept
+{
+    const auto buffered = static_cast<size_t>(Length % 64);
+    Buffer[buffered] = std::byte(0x80);
+    std::fill(Buffer.begin() + buffered + 1, Buffer.end(), std::byte(0));
+    if (buffered >= 56)
+    {
+        Host.Sha256Block(State.data(), Buffer.data(), 64);
+        std::fill(Buffer.begin(), Buffer.end(), std::byte(0));
+    }
+    const auto bits = Length * 8;
+    for (uint8_t i = 0; i < 8; ++i)
+        Buffer[56 + i] = static_cast<std::byte>(bits >> (56 - i * 8));
+    Host.Sha256Block(State.data(), Buffer.data(), 64);
+
+    bytearray<32> output;
+    for (uint8_t i = 0; i < 8; ++i)
+    {
+        output[i * 4 + 0] = static_cast<std::byte>(State[i] >> 24);
+        output[i * 4 + 1] = static_cast<std::byte>(State[i] >> 16);
+        output[i * 4 + 2] = static_cast<std::byte>(State[i] >> 8);
+        output[i * 4 + 3] = static_cast<std::byte>(State[i]);
+    }
+    Reset();
+    return output;
 }
 const DigestFuncs DigestFunc;
 
 
+
+
+common::span<const HashFuncs::PathInfo> HashFuncs::GetSupportMap() noexcept
+{
+    static auto list = []()
+    {
+        std::vector<PathInfo> ret;
+        RegistFuncVars(HashFuncs, Crc32C, SSE42, ARMCRC, NAIVE);
+        RegistFuncVars(HashFuncs, FastHash64, AVX2, SIMD128, NAIVE);
+        return ret;
+    }();
+    return list;
+}
+HashFuncs::HashFuncs(common::span<const VarItem> requests) noexcept { Init(requests); }
+HashFuncs::~HashFuncs() {}
+bool HashFuncs::IsComplete() const noexcept
+{
+    return Crc32C && FastHash64;
+}
+const HashFuncs HashFunc;
+
+
 }
\ No newline at end of file
@@ -129,7 +129,31 @@ public:
     using bytearray = std::array<std::byte, N>;
 private:
     bytearray<32>(*Sha256)(const std::byte*, const size_t) noexcept = nullptr;
+    // process size/64 whole blocks, state is { A,B,C,D,E,F,G,H }
+    void(*Sha256Block)(uint32_t* state, const std::byte* data, const size_t size) noexcept = nullptr;
 public:
+    // incremental SHA256, shares block kernels with the one-shot path
+    class SYSCOMMONAPI Sha256Stream
+    {
+        const DigestFuncs& Host;
+        uint64_t Length = 0;
+        std::array<uint32_t, 8> State;
+        std::array<std::byte, 64> Buffer;
+        void Absorb(const std::byte* data, size_t size) noexcept;
+    public:
+        Sha256Stream(const DigestFuncs& host) noexcept;
+        void Reset() noexcept;
+        template<typename T>
+        Sha256Stream& Update(const common::span<T> data) noexcept
+        {
+            const common::span<const std::byte> bytes = common::as_bytes(data);
+            Absorb(bytes.data(), bytes.size());
+            return *this;
+        }
+        [[nodiscard]] bytearray<32> Finalize() noexcept;
+        [[nodiscard]] constexpr uint64_t ProcessedBytes() const noexcept { return Length; }
+    };
+
     SYSCOMMONAPI [[nodiscard]] static common::span<const PathInfo> GetSupportMap() noexcept;
     SYSCOMMONAPI DigestFuncs(common::span<const VarItem> requests = {}) noexcept;
     SYSCOMMONAPI ~DigestFuncs();
@@ -141,9 +165,74 @@ public:
         const common::span<const std::byte> bytes = common::as_bytes(data);
         return Sha256(bytes.data(), bytes.size());
     }
+    [[nodiscard]] Sha256Stream SHA256Stream() const noexcept
+    {
+        return Sha256Stream(*this);
+    }
 };
 
 SYSCOMMONAPI extern const DigestFuncs DigestFunc;
 
 
+
+class HashFuncs final : public RuntimeFastPath<HashFuncs>
+{
+    friend ::common::fastpath::PathHack;
+private:
+    uint32_t(*Crc32C)(const std::byte* data, const size_t size, const uint32_t init) noexcept = nullptr;
+    uint64_t(*FastHash64)(const std::byte* data, const size_t size, const uint64_t seed) noexcept = nullptr;
+public:
+    SYSCOMMONAPI [[nodiscard]] static common::span<const PathInfo> GetSupportMap() noexcept;
+    SYSCOMMONAPI HashFuncs(common::span<const VarItem> requests = {}) noexcept;
+    SYSCOMMONAPI ~HashFuncs();
+    SYSCOMMONAPI [[nodiscard]] bool IsComplete() const noexcept final;
+
+    // CRC32-Castagnoli, pass previous result as init to continue on the next chunk
+    template<typename T>
+    [[nodiscard]] forceinline uint32_t CRC32C(const common::span<T> data, const uint32_t init = 0) const noexcept
+    {
+        const common::span<const std::byte> bytes = common::as_bytes(data);
+        return Crc32C(bytes.data(), bytes.size(), init);
+    }
+    // non-cryptographic 64bit hash, result is only guaranteed to be stable within the same version
+    template<typename T>
+    [[nodiscard]] forceinline uint64_t Hash64(const common::span<T> data, const uint64_t seed = 0) const noexcept
+    {
+        const common::span<const std::byte> bytes = common::as_bytes(data);
+        return FastHash64(bytes.data(), bytes.size(), seed);
+    }
+};
+
+SYSCOMMONAPI extern const HashFuncs HashFunc;
+
+
+// runtime hasher based on HashFuncs, used by HashedStrView/HashedStringPool, not usable in constexpr
+struct FastStrHash
+{
+    template<typename T>
+    [[nodiscard]] static uint64_t HashC(const T& str) noexcept
+    {
+        return HashFunc.Hash64(common::span<const typename T::value_type>(str.data(), str.size()));
+    }
+    template<typename T>
+    [[nodiscard]] static uint64_t Hash(const T& str) noexcept
+    {
+        if constexpr (std::is_array_v<common::remove_cvref_t<T>>)
+            return HashC(std::basic_string_view(str));
+        else
+            return HashC(str);
+    }
+    template<typename Ch>
+    [[nodiscard]] uint64_t operator()(std::basic_string_view<Ch> str) const noexcept
+    {
+        return HashC(str);
+    }
+    template<typename Ch>
+    [[nodiscard]] uint64_t operator()(const std::basic_string<Ch>& str) const noexcept
+    {
+        return HashC(str);
+    }
+};
+
+
 }
\ No newline at end of file
@@ -275,10 +275,11 @@ size_t RawFileInputStream::ReadMany(const size_t want, const size_t perSize, voi
 #else
         const uint64_t need = std::min<uint64_t>(left, 0x7ffff000u);
         const auto newread = read(GetHandle(), ptr, static_cast<uint32_t>(need));
-        if (newread == -1)
+        if (newread <= 0) // error or EOF
             break;
 #endif
         left -= newread;
+        ptr = reinterpret_cast<std::byte*>(ptr) + newread;
     }
     return (want * perSize - left) / perSize;
 }
@@ -8,6 +8,8 @@
 #include <boost/preprocessor/seq/for_each.hpp>
 #include <boost/preprocessor/seq/for_each_i.hpp>
 #include <tuple>
+#include <memory>
+#include <algorithm>
 
 #if COMMON_COMPILER_MSVC
 #   pragma warning(disable: 5046)
@@ -28,6 +30,38 @@ struct PathHack
     static auto HackFunc() noexcept;
 };
 
+// generates representative arguments for micro-benchmark, pointers get a dedicated scratch buffer of [Count] elements
+class BenchArgPool
+{
+    std::vector<std::unique_ptr<uint64_t[]>> Buffers;
+    uint32_t Count;
+public:
+    explicit BenchArgPool(uint32_t count) noexcept : Count(count) { }
+    template<typename T>
+    std::remove_cv_t<T> Get() noexcept
+    {
+        using U = std::remove_cv_t<T>;
+        if constexpr (std::is_pointer_v<U>)
+        {
+            using E = std::remove_cv_t<std::remove_pointer_t<U>>;
+            const size_t words = (sizeof(E) * Count + 7) / 8 + 8; // extra padding for overread
+            auto& buf = Buffers.emplace_back(std::make_unique<uint64_t[]>(words));
+            std::fill_n(buf.get(), words, UINT64_C(0x3c3c3c3c3c3c3c3c)); // keeps float/half values small and finite
+            return reinterpret_cast<U>(buf.get());
+        }
+        else if constexpr (std::is_same_v<U, bool>)
+            return false;
+        else if constexpr (std::is_same_v<U, size_t>)
+            return Count;
+        else if constexpr (std::is_floating_point_v<U>)
+            return static_cast<U>(1);
+        else if constexpr (std::is_integral_v<U>)
+            return static_cast<U>(UINT64_C(0x5a5a5a5a5a5a5a5a));
+        else
+            static_assert(!AlwaysTrue<T>, "unsupported argument type for benchmark");
+    }
+};
+
 template <typename T> struct PathInfo;
 template <typename R, typename... A>
 struct PathInfo<R(*)(A...) noexcept>
@@ -35,6 +69,14 @@ struct PathInfo<R(*)(A...) noexcept>
     using TFunc = R(A...) noexcept;
     using Ret = R;
     template<size_t I> using Arg = std::tuple_element_t<I, std::tuple<A...>>;
+    static void Bench(void* ptr, uint32_t count, uint32_t loops) noexcept
+    {
+        const auto func = reinterpret_cast<TFunc*>(ptr);
+        BenchArgPool pool(count);
+        const std::tuple<std::remove_cv_t<A>...> args{ pool.template Get<A>()... }; // braced-init keeps evaluation order
+        for (uint32_t i = 0; i < loops; ++i)
+            std::apply(func, args);
+    }
 };
 
 
@@ -72,7 +114,8 @@ if constexpr (GET_FASTPATH_FUNC(func)::MethodExist<var>())                  \
 }
 #define RegistFuncVars(clz, func, ...) do                                                                   \
 {                                                                                                           \
-    auto& path = ret.emplace_back(STRINGIZE(func), &common::fastpath::PathHack::Access<clz, &clz::func>);   \
+    auto& path = ret.emplace_back(STRINGIZE(func), &common::fastpath::PathHack::Access<clz, &clz::func>,    \
+        &GET_FASTPATH_FUNC(func)::Bench);                                                                   \
     BOOST_PP_SEQ_FOR_EACH(RegistFuncVar, func, BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))                       \
 } while(0)
 
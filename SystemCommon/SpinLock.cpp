@@ -0,0 +1,195 @@
+#include "SystemCommonPch.h"
+#include "SpinLock.h"
+#include <chrono>
+#if COMMON_ARCH_X86
+#   if COMMON_COMPILER_MSVC
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#       include <x86intrin.h>
+#   endif
+#endif
+#if COMMON_OS_LINUX || COMMON_OS_ANDROID
+#   include <linux/futex.h>
+#   include <climits>
+#elif COMMON_OS_WIN
+#   pragma comment(lib, "Synchronization.lib")
+#endif
+
+
+namespace common
+{
+
+// spin budget before parking, roughly a few microseconds, which covers a short critical section or a cross-core wakeup
+static constexpr uint32_t SpinRounds = 128;
+// spinning on single processor only delays the owner
+static const bool ShouldSpin = std::thread::hardware_concurrency() > 1;
+
+
+#if COMMON_ARCH_X86 && ((COMMON_COMPILER_GCC && COMMON_GCC_VER >= 90000) || (COMMON_COMPILER_CLANG && COMMON_CLANG_VER >= 70000) || COMMON_COMPILER_MSVC)
+#   define SPINLOCK_WAITPKG 1
+#   if COMMON_COMPILER_MSVC
+#       define WAITPKG_ATTR
+#   else
+#       define WAITPKG_ATTR __attribute__((target("waitpkg")))
+#   endif
+static bool CheckWaitPkg() noexcept
+{
+    // CPUID.(EAX=07H, ECX=0H):ECX.WAITPKG[bit 5]
+# if COMMON_COMPILER_MSVC
+    int regs[4] = { 0 };
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[2] >> 5) & 0x1;
+# else
+    uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_max(0, nullptr) < 7)
+        return false;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ecx >> 5) & 0x1;
+# endif
+}
+static const bool HasWaitPkg = CheckWaitPkg();
+
+// umonitor on the cacheline, umwait in C0.1 until it's written or the TSC deadline is reached
+WAITPKG_ATTR static bool SpinWaitUMWait(const std::atomic<uint32_t>& target, const uint32_t expected) noexcept
+{
+    constexpr uint64_t TSCBudget = 1u << 14;
+    const auto deadline = __rdtsc() + TSCBudget;
+    while (true)
+    {
+        _umonitor(const_cast<std::atomic<uint32_t>*>(&target));
+        if (target.load(std::memory_order_acquire) != expected)
+            return true;
+        _umwait(1, deadline);
+        if (target.load(std::memory_order_acquire) != expected)
+            return true;
+        if (__rdtsc() >= deadline)
+            return false;
+    }
+}
+#endif
+
+#if COMMON_ARCH_ARM && COMMON_OS_LINUX && !COMMON_COMPILER_MSVC && defined(__aarch64__)
+#   define SPINLOCK_WFE 1
+// ldaxr arms the exclusive monitor, a write from other core clears it and generates an event to wake wfe.
+// wfe may also return by the event stream (typically 100us), so the deadline is on the generic timer.
+static bool SpinWaitWFE(const std::atomic<uint32_t>& target, const uint32_t expected) noexcept
+{
+    uint64_t freq = 0, now = 0;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+    asm volatile("mrs %0, cntvct_el0" : "=r"(now));
+    const auto deadline = now + std::max<uint64_t>(freq / 200000u, 1u); // ~5us
+    asm volatile("sevl" ::: "memory");
+    while (true)
+    {
+        asm volatile("wfe" ::: "memory");
+        uint32_t val = 0;
+        asm volatile("ldaxr %w0, [%1]" : "=&r"(val) : "r"(&target) : "memory");
+        if (val != expected)
+            return true;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(now));
+        if (now >= deadline)
+            return false;
+    }
+}
+#endif
+
+
+bool AtomicWaiter::SpinWait(const std::atomic<uint32_t>& target, const uint32_t expected) noexcept
+{
+    if (!ShouldSpin)
+        return target.load(std::memory_order_acquire) != expected;
+#if SPINLOCK_WAITPKG
+    if (HasWaitPkg)
+        return SpinWaitUMWait(target, expected);
+#elif SPINLOCK_WFE
+    return SpinWaitWFE(target, expected);
+#endif
+    for (uint32_t i = 0; i < SpinRounds; ++i)
+    {
+        if (target.load(std::memory_order_relaxed) != expected)
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+        COMMON_PAUSE();
+    }
+    return target.load(std::memory_order_acquire) != expected;
+}
+
+
+#if COMMON_OS_LINUX || COMMON_OS_ANDROID
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex requires atomic<uint32_t> to be lock-free and plain");
+static uint32_t* FutexAddr(const std::atomic<uint32_t>& target) noexcept
+{
+    return reinterpret_cast<uint32_t*>(const_cast<std::atomic<uint32_t>*>(&target));
+}
+bool AtomicWaiter::Park(const std::atomic<uint32_t>& target, const uint32_t expected, const uint32_t timeoutMs) noexcept
+{
+    struct timespec ts = {};
+    if (timeoutMs != Infinite)
+    {
+        ts.tv_sec = static_cast<time_t>(timeoutMs / 1000);
+        ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000;
+    }
+    const auto ret = syscall(SYS_futex, FutexAddr(target), FUTEX_WAIT_PRIVATE, expected, timeoutMs == Infinite ? nullptr : &ts, nullptr, 0);
+    return ret == 0 || errno != ETIMEDOUT;
+}
+void AtomicWaiter::WakeOne(const std::atomic<uint32_t>& target) noexcept
+{
+    syscall(SYS_futex, FutexAddr(target), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+void AtomicWaiter::WakeAll(const std::atomic<uint32_t>& target) noexcept
+{
+    syscall(SYS_futex, FutexAddr(target), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#elif COMMON_OS_WIN
+
+bool AtomicWaiter::Park(const std::atomic<uint32_t>& target, const uint32_t expected, const uint32_t timeoutMs) noexcept
+{
+    auto cmp = expected;
+    const auto addr = const_cast<std::atomic<uint32_t>*>(&target);
+    if (WaitOnAddress(addr, &cmp, sizeof(uint32_t), timeoutMs == Infinite ? INFINITE : timeoutMs))
+        return true;
+    return GetLastError() != ERROR_TIMEOUT;
+}
+void AtomicWaiter::WakeOne(const std::atomic<uint32_t>& target) noexcept
+{
+    WakeByAddressSingle(const_cast<std::atomic<uint32_t>*>(&target));
+}
+void AtomicWaiter::WakeAll(const std::atomic<uint32_t>& target) noexcept
+{
+    WakeByAddressAll(const_cast<std::atomic<uint32_t>*>(&target));
+}
+
+#else
+
+// no public address-wait API, fallback to polling with backoff
+bool AtomicWaiter::Park(const std::atomic<uint32_t>& target, const uint32_t expected, const uint32_t timeoutMs) noexcept
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (uint32_t i = 0; target.load() == expected; ++i)
+    {
+        if (timeoutMs != Infinite && std::chrono::steady_clock::now() >= deadline)
+            return false;
+        if (i < 64)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(i < 256 ? 50 : 1000));
+    }
+    return true;
+}
+void AtomicWaiter::WakeOne(const std::atomic<uint32_t>&) noexcept
+{ }
+void AtomicWaiter::WakeAll(const std::atomic<uint32_t>&) noexcept
+{ }
+
+#endif
+
+
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+#include "SystemCommonRely.h"
+#include <atomic>
+
+#if COMMON_ARCH_X86
+#   include "common/simd/SIMD.hpp"
+#   if COMMON_SIMD_LV >= 20
+#       define COMMON_PAUSE() _mm_pause()
+#   elif (COMMON_COMPILER_CLANG && COMMON_CLANG_VER >= 30800) || (COMMON_COMPILER_GCC && COMMON_GCC_VER >= 40701)
+#       define COMMON_PAUSE() __builtin_ia32_pause()
+#   elif COMMON_COMPILER_MSVC
+#       define COMMON_PAUSE() __nop()
+#   else
+#       define COMMON_PAUSE() asm volatile ("pause")
+#   endif
+#elif COMMON_ARCH_ARM
+#   if COMMON_COMPILER_MSVC
+#       define COMMON_PAUSE() __yield()
+#   else
+#       define COMMON_PAUSE() asm volatile ("yield")
+#   endif
+#else
+#   define COMMON_PAUSE() do{} while(0)
+#endif
+
+namespace common
+{
+
+// wait/notify on a 32bit atomic.
+// Waiting spins for a bounded time (pause/umwait/wfe), then parks the thread (futex/WaitOnAddress).
+// Waiting may return spuriously, caller should always re-check the value.
+struct SYSCOMMONAPI AtomicWaiter
+{
+    static constexpr uint32_t Infinite = UINT32_MAX;
+    // spin only, return true if value changed
+    [[nodiscard]] static bool SpinWait(const std::atomic<uint32_t>& target, const uint32_t expected) noexcept;
+    // park only, return false when timeout
+    static bool Park(const std::atomic<uint32_t>& target, const uint32_t expected, const uint32_t timeoutMs = Infinite) noexcept;
+    // spin then park, return false when timeout
+    static bool Wait(const std::atomic<uint32_t>& target, const uint32_t expected, const uint32_t timeoutMs = Infinite) noexcept
+    {
+        return SpinWait(target, expected) || Park(target, expected, timeoutMs);
+    }
+    static void WakeOne(const std::atomic<uint32_t>& target) noexcept;
+    static void WakeAll(const std::atomic<uint32_t>& target) noexcept;
+};
+
+
+namespace detail
+{
+template<typename T, void(T::*Lock)(), void(T::*Unlock)()>
+struct [[nodiscard]] LockScope : NonCopyable
+{
+private:
+    T* Locker;
+public:
+    constexpr LockScope(T* locker) noexcept : Locker(locker)
+    {
+        (Locker->*Lock)();
+    }
+    constexpr LockScope(LockScope&& locker) noexcept : Locker(locker.Locker)
+    {
+        locker.Locker = nullptr;
+    }
+    ~LockScope() noexcept
+    {
+        if (Locker)
+            (Locker->*Unlock)();
+    }
+};
+
+// wait until pred(flag) becomes false, parked waiters are counted so that unlocker can skip waking
+template<typename F>
+inline uint32_t WaitWhile(const std::atomic<uint32_t>& flag, std::atomic<uint32_t>& parked, F&& pred) noexcept
+{
+    for (auto val = flag.load(); ; val = flag.load())
+    {
+        if (!pred(val))
+            return val;
+        if (AtomicWaiter::SpinWait(flag, val))
+            continue;
+        parked++;
+        AtomicWaiter::Park(flag, val);
+        parked--;
+    }
+}
+inline void WakeIfParked(const std::atomic<uint32_t>& flag, const std::atomic<uint32_t>& parked) noexcept
+{
+    if (parked.load() > 0)
+        AtomicWaiter::WakeAll(flag);
+}
+}
+
+struct EmptyLock
+{
+    constexpr void lock() noexcept {}
+    constexpr void unlock() noexcept {}
+};
+
+struct SpinLocker : public NonCopyable
+{
+private:
+    std::atomic<uint32_t> Flag{ 0 }; // 0: free, 1: locked, 2: locked with parked waiter
+public:
+    constexpr SpinLocker() noexcept { }
+    bool TryLock() noexcept
+    {
+        uint32_t expected = 0;
+        return Flag.compare_exchange_strong(expected, 1);
+    }
+    void Lock() noexcept
+    {
+        uint32_t expected = 0;
+        if (Flag.compare_exchange_strong(expected, 1))
+            return;
+        while (AtomicWaiter::SpinWait(Flag, expected)) // spin until free
+        {
+            expected = 0;
+            if (Flag.compare_exchange_strong(expected, 1))
+                return;
+        }
+        while (Flag.exchange(2) != 0) // mark waiting and park
+            AtomicWaiter::Park(Flag, 2);
+    }
+    void Unlock() noexcept
+    {
+        if (Flag.exchange(0) == 2)
+            AtomicWaiter::WakeOne(Flag);
+    }
+    using ScopeType = detail::LockScope<SpinLocker, &SpinLocker::Lock, &SpinLocker::Unlock>;
+    ScopeType LockScope() noexcept
+    {
+        return ScopeType(this);
+    }
+};
+
+
+struct PreferSpinLock : public NonCopyable //Strong-first
+{
+private:
+    std::atomic<uint32_t> Flag; //strong on high 16bit, weak on low 16bit
+    std::atomic<uint32_t> Parked;
+public:
+    constexpr PreferSpinLock() noexcept : Flag(0), Parked(0) { }
+    explicit PreferSpinLock(PreferSpinLock&& other) noexcept
+        : Flag(other.Flag.exchange(0)), Parked(0) { }
+    void LockWeak() noexcept
+    {
+        uint32_t expected = Flag.load() & 0x0000ffff; //assume no strong
+        while (!Flag.compare_exchange_strong(expected, expected + 1))
+        {
+            detail::WaitWhile(Flag, Parked, [](uint32_t val) { return (val & 0xffff0000) != 0; });
+            expected &= 0x0000ffff; //assume no strong
+        }
+    }
+    void UnlockWeak() noexcept
+    {
+        Flag--;
+        detail::WakeIfParked(Flag, Parked);
+    }
+    void LockStrong() noexcept
+    {
+        Flag.fetch_add(0x00010000);
+        detail::WaitWhile(Flag, Parked, [](uint32_t val) { return (val & 0x0000ffff) != 0; }); //loop until no weak
+    }
+    void UnlockStrong() noexcept
+    {
+        Flag.fetch_sub(0x00010000);
+        detail::WakeIfParked(Flag, Parked);
+    }
+    using WeakScopeType = detail::LockScope<PreferSpinLock, &PreferSpinLock::LockWeak, &PreferSpinLock::UnlockWeak>;
+    WeakScopeType WeakScope() noexcept
+    {
+        return WeakScopeType(this);
+    }
+    using StrongScopeType = detail::LockScope<PreferSpinLock, &PreferSpinLock::LockStrong, &PreferSpinLock::UnlockStrong>;
+    StrongScopeType StrongScope() noexcept
+    {
+        return StrongScopeType(this);
+    }
+};
+
+struct WRSpinLock : public NonCopyable //Writer-first
+{
+private:
+    std::atomic<uint32_t> Flag; //writer on most siginificant bit, reader on lower bits
+    std::atomic<uint32_t> Parked;
+public:
+    constexpr WRSpinLock() noexcept : Flag(0), Parked(0) { }
+    explicit WRSpinLock(WRSpinLock&& other) noexcept
+        : Flag(other.Flag.exchange(0)), Parked(0) { }
+    void LockRead() noexcept
+    {
+        uint32_t expected = Flag.load() & 0x7fffffff; //assume no writer
+        while (!Flag.compare_exchange_weak(expected, expected + 1))
+        {
+            if (expected & 0x80000000)
+                expected = detail::WaitWhile(Flag, Parked, [](uint32_t val) { return (val & 0x80000000) != 0; });
+            expected &= 0x7fffffff; //assume no writer
+        }
+    }
+    void UnlockRead() noexcept
+    {
+        if (Flag-- == 0x80000001) // last reader with a pending writer
+            detail::WakeIfParked(Flag, Parked);
+    }
+    void LockWrite() noexcept
+    {
+        uint32_t expected = Flag.load() & 0x7fffffff;
+        while (!Flag.compare_exchange_weak(expected, expected + 0x80000000))
+        {
+            if (expected & 0x80000000)
+                expected = detail::WaitWhile(Flag, Parked, [](uint32_t val) { return (val & 0x80000000) != 0; });
+            expected &= 0x7fffffff; //assume no other writer
+        }
+        detail::WaitWhile(Flag, Parked, [](uint32_t val) { return (val & 0x7fffffff) != 0; }); //loop until no reader
+    }
+    void UnlockWrite() noexcept
+    {
+        Flag -= 0x80000000;
+        detail::WakeIfParked(Flag, Parked);
+    }
+    using ReadScopeType = detail::LockScope<WRSpinLock, &WRSpinLock::LockRead, &WRSpinLock::UnlockRead>;
+    ReadScopeType ReadScope() noexcept
+    {
+        return ReadScopeType(this);
+    }
+    using WriteScopeType = detail::LockScope<WRSpinLock, &WRSpinLock::LockWrite, &WRSpinLock::UnlockWrite>;
+    WriteScopeType WriteScope() noexcept
+    {
+        return WriteScopeType(this);
+    }
+};
+
+struct RWSpinLock : public NonCopyable, public NonMovable //Reader-first
+{
+private:
+    std::atomic<uint32_t> Flag; //writer on most siginificant bit, reader on lower bits
+    std::atomic<uint32_t> Parked;
+public:
+    constexpr RWSpinLock() : Flag(0), Parked(0) { }
+    explicit RWSpinLock(RWSpinLock&& other) noexcept
+        : Flag(other.Flag.exchange(0)), Parked(0) { }
+    void LockRead() noexcept
+    {
+        Flag++;
+        detail::WaitWhile(Flag, Parked, [](uint32_t val) { return (val & 0x80000000) != 0; }); //loop until no writer
+    }
+    void UnlockRead() noexcept
+    {
+        Flag--;
+        detail::WakeIfParked(Flag, Parked);
+    }
+    void LockWrite() noexcept
+    {
+        uint32_t expected = 0;
+        while (!Flag.compare_exchange_weak(expected, 0x80000000))
+        {
+            if (expected != 0)
+                detail::WaitWhile(Flag, Parked, [](uint32_t val) { return val != 0; });
+            expected = 0; //assume no other locker
+        }
+    }
+    void UnlockWrite() noexcept
+    {
+        Flag -= 0x80000000;
+        detail::WakeIfParked(Flag, Parked);
+    }
+    using ReadScopeType = detail::LockScope<RWSpinLock, &RWSpinLock::LockRead, &RWSpinLock::UnlockRead>;
+    ReadScopeType ReadScope() noexcept
+    {
+        return ReadScopeType(this);
+    }
+    using WriteScopeType = detail::LockScope<RWSpinLock, &RWSpinLock::LockWrite, &RWSpinLock::UnlockWrite>;
+    WriteScopeType WriteScope() noexcept
+    {
+        return WriteScopeType(this);
+    }
+    //unsuported, may cause deadlock
+    //void UpgradeToWrite()
+    //{
+    //    uint32_t expected = 1;
+    //    while (!Flag.compare_exchange_weak(expected, 0x80000000))
+    //    {
+    //        expected = 1; //assume only self as locker
+    //    }
+    //}
+    void DowngradeToRead() noexcept
+    {
+        uint32_t expected = (Flag.load() | 0x80000000) + 1;
+        while (!Flag.compare_exchange_weak(expected, expected & 0x7fffffff))
+        {
+            expected = (expected | 0x80000000) + 1; //ensure there's a writer
+        }
+        detail::WakeIfParked(Flag, Parked);
+    }
+};
+
+}
@@ -10,6 +10,9 @@
 #   include <asm/hwcap.h>
 #endif
 #include <boost/version.hpp>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
 
 #pragma message("Compiling SystemCommon with [" STRINGIZE(COMMON_SIMD_INTRIN) "]" )
 #pragma message("Compiling SystemCommon with boost[" STRINGIZE(BOOST_LIB_VERSION) "]" )
@@ -61,6 +64,7 @@ std::string_view GetColorName(CommonColor color) noexcept
 
 struct CPUFeature
 {
+    std::string Name;
     std::vector<std::string_view> FeatureText;
     container::FrozenDenseStringSet<char, false> FeatureLookup;
     void TryCPUID() noexcept
@@ -75,6 +79,9 @@ struct CPUFeature
                 cpu_id_t data;
                 if (cpu_identify(&raw, &data) >= 0)
                 {
+                    Name = data.brand_str;
+                    while (!Name.empty() && Name.back() == ' ')
+                        Name.pop_back();
 # define CHECK_FEATURE(en, name) if (data.flags[CPU_FEATURE_##en]) FeatureText.push_back(#name""sv)
                     CHECK_FEATURE(SSE,          sse);
                     CHECK_FEATURE(SSE2,         sse2);
@@ -195,20 +202,199 @@ span<const std::string_view> GetCPUFeatures() noexcept
     static const auto& features = GetCPUFeatureHost();
     return features.FeatureText;
 }
+std::string_view GetCPUName() noexcept
+{
+    static const auto& features = GetCPUFeatureHost();
+    return features.Name;
+}
 
 
+bool CheckEnvOn(const char* name) noexcept
+{
+#if COMMON_COMPILER_MSVC
+#   pragma warning(suppress: 4996)
+#endif
+    const auto val = getenv(name);
+    if (!val) return false;
+    const std::string_view str(val);
+    return str == "1"sv || str == "on"sv || str == "ON"sv || str == "true"sv;
+}
+
+
+// Opt-in auto-tune, controlled by env:
+// COMMON_FASTPATH_TUNE=1           benchmark eligible variants when no explicit request is given
+// COMMON_FASTPATH_TUNE_CACHE=path  also enables tuning, choices are persisted into the file, keyed by CPU
+class FastPathTuneCache
+{
+    struct Item
+    {
+        std::string CPUKey;
+        std::string FuncName;
+        std::string MethodName;
+        uint64_t TimeNs;
+    };
+    std::mutex Mutex;
+    std::string FilePath;
+    std::string CPUKey;
+    std::vector<Item> Items;
+    void Load() noexcept
+    {
+        const auto fp = fopen(FilePath.c_str(), "r");
+        if (!fp) return;
+        char line[512];
+        while (fgets(line, sizeof(line), fp))
+        {
+            std::string_view str(line);
+            while (!str.empty() && (str.back() == '\n' || str.back() == '\r'))
+                str.remove_suffix(1);
+            std::string_view parts[4];
+            size_t idx = 0;
+            for (; idx < 3; ++idx)
+            {
+                const auto pos = str.find('|');
+                if (pos == std::string_view::npos) break;
+                parts[idx] = str.substr(0, pos);
+                str.remove_prefix(pos + 1);
+            }
+            if (idx != 3) continue;
+            parts[3] = str;
+            uint64_t time = 0;
+            for (const auto ch : parts[3])
+            {
+                if (ch < '0' || ch > '9') break;
+                time = time * 10 + (ch - '0');
+            }
+            Items.push_back({ std::string(parts[0]), std::string(parts[1]), std::string(parts[2]), time });
+        }
+        fclose(fp);
+    }
+    void Save() const noexcept
+    {
+        const auto fp = fopen(FilePath.c_str(), "w");
+        if (!fp) return;
+        for (const auto& item : Items)
+            fprintf(fp, "%s|%s|%s|%llu\n", item.CPUKey.c_str(), item.FuncName.c_str(), item.MethodName.c_str(), 
+                static_cast<unsigned long long>(item.TimeNs));
+        fclose(fp);
+    }
+public:
+    bool Enabled = false;
+    FastPathTuneCache() noexcept
+    {
+#if COMMON_COMPILER_MSVC
+#   pragma warning(suppress: 4996)
+#endif
+        if (const auto path = getenv("COMMON_FASTPATH_TUNE_CACHE"); path && *path)
+            FilePath = path;
+        Enabled = !FilePath.empty() || CheckEnvOn("COMMON_FASTPATH_TUNE");
+        CPUKey = GetCPUName();
+        CPUKey.append("[");
+        for (const auto& feat : GetCPUFeatures())
+            CPUKey.append(feat).append(",");
+        CPUKey.append("]");
+        if (!FilePath.empty())
+            Load();
+    }
+    std::optional<std::string_view> Query(std::string_view func) noexcept
+    {
+        if (FilePath.empty()) return {};
+        std::lock_guard<std::mutex> lock(Mutex);
+        for (const auto& item : Items)
+        {
+            if (item.CPUKey == CPUKey && item.FuncName == func)
+                return std::string_view(item.MethodName);
+        }
+        return {};
+    }
+    void Update(std::string_view func, std::string_view method, uint64_t timeNs) noexcept
+    {
+        if (FilePath.empty()) return;
+        std::lock_guard<std::mutex> lock(Mutex);
+        bool found = false;
+        for (auto& item : Items)
+        {
+            if (item.CPUKey == CPUKey && item.FuncName == func)
+            {
+                item.MethodName = method, item.TimeNs = timeNs;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            Items.push_back({ CPUKey, std::string(func), std::string(method), timeNs });
+        Save();
+    }
+};
+static FastPathTuneCache& GetTuneCache() noexcept
+{
+    static FastPathTuneCache Cache;
+    return Cache;
+}
+
+
+void FastPathBase::AutoTunePath(const PathInfo& path) noexcept
+{
+    constexpr uint32_t BenchCount = 4096, BenchLoops = 32, BenchTrials = 5;
+    auto& cache = GetTuneCache();
+    const PathInfo::MethodInfo* choice = nullptr;
+    if (const auto cached = cache.Query(path.FuncName); cached)
+    {
+        for (const auto& var : path.Variants)
+        {
+            if (var.MethodName == *cached)
+            {
+                choice = &var;
+                TuneInfo.push_back({ path.FuncName, var.MethodName, UINT64_MAX });
+                break;
+            }
+        }
+    }
+    if (!choice)
+    {
+        uint64_t bestTime = UINT64_MAX;
+        for (const auto& var : path.Variants)
+        {
+            path.Bench(var.FuncPtr, BenchCount, 1); // warm-up
+            uint64_t minTime = UINT64_MAX;
+            for (uint32_t i = 0; i < BenchTrials; ++i)
+            {
+                const auto t1 = std::chrono::high_resolution_clock::now();
+                path.Bench(var.FuncPtr, BenchCount, BenchLoops);
+                const auto t2 = std::chrono::high_resolution_clock::now();
+                const auto time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+                minTime = std::min(minTime, time);
+            }
+            TuneInfo.push_back({ path.FuncName, var.MethodName, minTime });
+            if (minTime < bestTime) // prefer earlier one when tie
+            {
+                bestTime = minTime;
+                choice = &var;
+            }
+        }
+        cache.Update(path.FuncName, choice->MethodName, bestTime);
+    }
+    path.Access(*this) = choice->FuncPtr;
+    VariantMap.emplace_back(path.FuncName, choice->MethodName);
+}
+
 void FastPathBase::Init(common::span<const PathInfo> info, common::span<const VarItem> requests) noexcept
 {
+    const bool autoTune = requests.empty() ? GetTuneCache().Enabled :
+        std::find(requests.begin(), requests.end(), AutoTune) != requests.end();
     if (requests.empty())
     {
         for (const auto& path : info)
         {
-            if (!path.Variants.empty())
+            if (path.Variants.empty())
+                continue;
+            if (autoTune && path.Bench && path.Variants.size() > 1)
             {
-                const auto& var = path.Variants.front();
-                path.Access(*this) = var.FuncPtr;
-                VariantMap.emplace_back(path.FuncName, var.MethodName);
+                AutoTunePath(path);
+                continue;
             }
+            const auto& var = path.Variants.front();
+            path.Access(*this) = var.FuncPtr;
+            VariantMap.emplace_back(path.FuncName, var.MethodName);
         }
     }
     else
@@ -234,6 +420,22 @@ void FastPathBase::Init(common::span<const PathInfo> info, common::span<const Va
                 break;
             }
         }
+        if (autoTune)
+        {
+            for (const auto& path : info)
+            {
+                if (path.Variants.empty() || path.Access(*this) != nullptr)
+                    continue;
+                if (path.Bench && path.Variants.size() > 1)
+                    AutoTunePath(path);
+                else
+                {
+                    const auto& var = path.Variants.front();
+                    path.Access(*this) = var.FuncPtr;
+                    VariantMap.emplace_back(path.FuncName, var.MethodName);
+                }
+            }
+        }
     }
 }
 
@@ -36,6 +36,9 @@ MAKE_ENUM_BITFIELD(CommonColor)
 
 [[nodiscard]] SYSCOMMONAPI bool CheckCPUFeature(str::HashedStrView<char> feature) noexcept;
 [[nodiscard]] SYSCOMMONAPI span<const std::string_view> GetCPUFeatures() noexcept;
+[[nodiscard]] SYSCOMMONAPI std::string_view GetCPUName() noexcept;
+// env is set to "1", "on", "ON" or "true"
+[[nodiscard]] SYSCOMMONAPI bool CheckEnvOn(const char* name) noexcept;
 
 class FastPathBase
 {
@@ -53,12 +56,23 @@ public:
             MethodInfo(std::string_view name, void* ptr) noexcept : FuncPtr(ptr), MethodName(name) { }
         };
         void*& (*Access)(FastPathBase&) noexcept = nullptr;
+        void (*Bench)(void* func, uint32_t count, uint32_t loops) noexcept = nullptr;
     public:
         str::HashedStrView<char> FuncName;
         std::vector<MethodInfo> Variants;
-        PathInfo(std::string_view name, void*& (*access)(FastPathBase&) noexcept) noexcept : Access(access), FuncName(name) { }
+        PathInfo(std::string_view name, void*& (*access)(FastPathBase&) noexcept,
+            void (*bench)(void*, uint32_t, uint32_t) noexcept = nullptr) noexcept : Access(access), Bench(bench), FuncName(name) { }
     };
     using VarItem = std::pair<std::string_view, std::string_view>;
+    struct TuneItem
+    {
+        std::string_view FuncName;
+        std::string_view MethodName;
+        // UINT64_MAX when the choice is loaded from cache
+        uint64_t TimeNs;
+    };
+    // put it inside requests to benchmark and pick the fastest variant for those not explicitly requested
+    static constexpr VarItem AutoTune = { std::string_view("*"), std::string_view("AutoTune") };
     COMMON_NO_COPY(FastPathBase)
     COMMON_NO_MOVE(FastPathBase)
     [[nodiscard]] virtual bool IsComplete() const noexcept = 0;
@@ -66,11 +80,17 @@ public:
     {
         return VariantMap;
     }
+    [[nodiscard]] common::span<const TuneItem> GetTuneInfo() const noexcept
+    {
+        return TuneInfo;
+    }
 protected:
     FastPathBase() noexcept {}
     SYSCOMMONAPI void Init(common::span<const PathInfo> info, common::span<const VarItem> requests) noexcept;
 private:
+    void AutoTunePath(const PathInfo& path) noexcept;
     std::vector<VarItem> VariantMap;
+    std::vector<TuneItem> TuneInfo;
 };
 namespace fastpath
 {
@@ -1,5 +1,7 @@
 #include "SystemCommonPch.h"
 #include "ThreadEx.h"
+#include <map>
+#include <set>
 #if COMMON_OS_ANDROID
 #   include <sys/prctl.h>
 #endif
@@ -173,7 +175,7 @@ uint64_t ThreadObject::GetCurrentThreadId()
 forceinline static uintptr_t CopyThreadHandle(void *src)
 {
     HANDLE Handle = nullptr;
-    DuplicateHandle(GetCurrentProcess(), (HANDLE)src, GetCurrentProcess(), &Handle, SYNCHRONIZE | THREAD_QUERY_INFORMATION, false, 0);
+    DuplicateHandle(GetCurrentProcess(), (HANDLE)src, GetCurrentProcess(), &Handle, SYNCHRONIZE | THREAD_QUERY_INFORMATION | THREAD_SET_INFORMATION, false, 0);
     return reinterpret_cast<uintptr_t>(Handle);
 }
 #endif
@@ -200,4 +202,382 @@ ThreadObject ThreadObject::GetThreadObject(std::thread& thr)
 }
 
 
+std::vector<uint32_t> ThreadObject::GetAffinity() const
+{
+    std::vector<uint32_t> ret;
+#if COMMON_OS_WIN
+    GROUP_AFFINITY affinity = {};
+    if (::GetThreadGroupAffinity((HANDLE)Handle, &affinity))
+    {
+        for (uint32_t i = 0; i < sizeof(KAFFINITY) * 8; ++i)
+            if (affinity.Mask & (KAFFINITY(1) << i))
+                ret.push_back(affinity.Group * 64u + i);
+    }
+#elif COMMON_OS_LINUX || COMMON_OS_ANDROID
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+#   if COMMON_OS_ANDROID
+    const auto err = IsCurrent() ? sched_getaffinity(0, sizeof(cpuset), &cpuset) : -1;
+#   else
+    const auto err = pthread_getaffinity_np((pthread_t)Handle, sizeof(cpuset), &cpuset);
+#   endif
+    if (err == 0)
+    {
+        for (uint32_t i = 0; i < CPU_SETSIZE; ++i)
+            if (CPU_ISSET(i, &cpuset))
+                ret.push_back(i);
+    }
+#endif
+    return ret;
+}
+bool ThreadObject::SetAffinity(const std::vector<uint32_t>& processors) const
+{
+    if (processors.empty())
+        return false;
+#if COMMON_OS_WIN
+    GROUP_AFFINITY affinity = {};
+    affinity.Group = static_cast<WORD>(processors[0] / 64);
+    for (const auto id : processors)
+    {
+        if (id / 64 != affinity.Group) // thread can only be bound to one processor group
+            return false;
+        affinity.Mask |= KAFFINITY(1) << (id % 64);
+    }
+    return ::SetThreadGroupAffinity((HANDLE)Handle, &affinity, nullptr);
+#elif COMMON_OS_LINUX || COMMON_OS_ANDROID
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (const auto id : processors)
+    {
+        if (id >= CPU_SETSIZE)
+            return false;
+        CPU_SET(id, &cpuset);
+    }
+#   if COMMON_OS_ANDROID
+    return IsCurrent() && sched_setaffinity(0, sizeof(cpuset), &cpuset) == 0;
+#   else
+    return pthread_setaffinity_np((pthread_t)Handle, sizeof(cpuset), &cpuset) == 0;
+#   endif
+#else
+    return false; // darwin only provides affinity tag as hint
+#endif
+}
+bool ThreadObject::SetPriority(const ThreadPriority priority) const
+{
+#if COMMON_OS_WIN
+    int val = THREAD_PRIORITY_NORMAL;
+    switch (priority)
+    {
+    case ThreadPriority::Idle:          val = THREAD_PRIORITY_IDLE;             break;
+    case ThreadPriority::BelowNormal:   val = THREAD_PRIORITY_BELOW_NORMAL;     break;
+    case ThreadPriority::Normal:        val = THREAD_PRIORITY_NORMAL;           break;
+    case ThreadPriority::AboveNormal:   val = THREAD_PRIORITY_ABOVE_NORMAL;     break;
+    case ThreadPriority::High:          val = THREAD_PRIORITY_HIGHEST;          break;
+    }
+    return ::SetThreadPriority((HANDLE)Handle, val);
+#elif COMMON_OS_DARWIN
+    // PRIO_DARWIN_THREAD only accepts 0/1 (background), while SCHED_OTHER has a real priority range on darwin
+    const auto minVal = sched_get_priority_min(SCHED_OTHER), maxVal = sched_get_priority_max(SCHED_OTHER);
+    if (minVal < 0 || maxVal < minVal)
+        return false;
+    const auto midVal = (minVal + maxVal) / 2;
+    sched_param param = {};
+    switch (priority)
+    {
+    case ThreadPriority::Idle:          param.sched_priority = minVal;                  break;
+    case ThreadPriority::BelowNormal:   param.sched_priority = (minVal + midVal) / 2;   break;
+    case ThreadPriority::Normal:        param.sched_priority = midVal;                  break;
+    case ThreadPriority::AboveNormal:   param.sched_priority = (midVal + maxVal) / 2;   break;
+    case ThreadPriority::High:          param.sched_priority = maxVal;                  break;
+    }
+    return pthread_setschedparam((pthread_t)Handle, SCHED_OTHER, &param) == 0;
+#else
+    // SCHED_OTHER only has static priority 0, use per-thread nice value instead
+    int val = 0;
+    switch (priority)
+    {
+    case ThreadPriority::Idle:          val = 19;   break;
+    case ThreadPriority::BelowNormal:   val = 5;    break;
+    case ThreadPriority::Normal:        val = 0;    break;
+    case ThreadPriority::AboveNormal:   val = -5;   break;
+    case ThreadPriority::High:          val = -10;  break;
+    }
+    if (!pthread_equal((pthread_t)Handle, pthread_self()))
+        return false;
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), val) == 0;
+#endif
+}
+
+
+#if COMMON_OS_LINUX || COMMON_OS_ANDROID
+static std::string ReadSysFile(const std::string& path)
+{
+    std::string ret;
+    if (auto fp = fopen(path.c_str(), "r"); fp)
+    {
+        char buf[256];
+        while (const auto len = fread(buf, 1, sizeof(buf), fp))
+            ret.append(buf, len);
+        fclose(fp);
+    }
+    while (!ret.empty() && (ret.back() == '\n' || ret.back() == ' '))
+        ret.pop_back();
+    return ret;
+}
+static std::optional<uint64_t> ReadSysNum(const std::string& path)
+{
+    const auto txt = ReadSysFile(path);
+    if (txt.empty())
+        return {};
+    char* end = nullptr;
+    const auto val = strtoll(txt.c_str(), &end, 10);
+    if (val < 0)
+        return {};
+    uint64_t ret = static_cast<uint64_t>(val);
+    if (end && (*end == 'K' || *end == 'k'))
+        ret *= 1024;
+    else if (end && (*end == 'M' || *end == 'm'))
+        ret *= 1024 * 1024;
+    return ret;
+}
+// parse list like "0-3,8,10-11"
+static std::vector<uint32_t> ParseCPUList(std::string_view txt)
+{
+    std::vector<uint32_t> ret;
+    while (!txt.empty())
+    {
+        const auto comma = txt.find(',');
+        const auto part = txt.substr(0, comma);
+        txt = comma == std::string_view::npos ? std::string_view{} : txt.substr(comma + 1);
+        const auto dash = part.find('-');
+        const auto from = static_cast<uint32_t>(strtoul(std::string(part.substr(0, dash)).c_str(), nullptr, 10));
+        const auto to = dash == std::string_view::npos ? from : static_cast<uint32_t>(strtoul(std::string(part.substr(dash + 1)).c_str(), nullptr, 10));
+        for (auto i = from; i <= to; ++i)
+            ret.push_back(i);
+    }
+    return ret;
+}
+#endif
+
+static CPUTopology DetectTopology() noexcept
+{
+    CPUTopology topo;
+    // raw info, Core is (package, core) before being remapped
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> coreMap;
+    std::set<uint32_t> packages, nodes;
+#if COMMON_OS_WIN
+    DWORD len = 0;
+    ::GetLogicalProcessorInformationEx(RelationAll, nullptr, &len);
+    std::vector<std::byte> buffer(len);
+    const auto infos = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+    if (len > 0 && ::GetLogicalProcessorInformationEx(RelationAll, infos, &len))
+    {
+        std::map<uint32_t, std::tuple<uint32_t, uint32_t, uint8_t, uint8_t>> procs; // id -> package, core, smt, eff
+        std::map<uint32_t, uint32_t> procNode;
+        uint32_t coreIdx = 0, pkgIdx = 0;
+        const auto forEachBit = [](const GROUP_AFFINITY& mask, auto&& func)
+        {
+            for (uint32_t i = 0; i < sizeof(KAFFINITY) * 8; ++i)
+                if (mask.Mask & (KAFFINITY(1) << i))
+                    func(mask.Group * 64u + i);
+        };
+        std::vector<std::pair<uint32_t, const PROCESSOR_RELATIONSHIP*>> pkgRels;
+        for (DWORD offset = 0; offset < len;)
+        {
+            const auto& info = *reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+            switch (info.Relationship)
+            {
+            case RelationProcessorCore:
+            {
+                uint8_t smt = 0;
+                for (WORD g = 0; g < info.Processor.GroupCount; ++g)
+                    forEachBit(info.Processor.GroupMask[g], [&](uint32_t id) 
+                        { procs[id] = { 0, coreIdx, smt++, info.Processor.EfficiencyClass }; });
+                topo.MaxEfficiencyClass = std::max(topo.MaxEfficiencyClass, info.Processor.EfficiencyClass);
+                coreIdx++;
+            } break;
+            case RelationProcessorPackage:
+                pkgRels.emplace_back(pkgIdx++, &info.Processor);
+                break;
+            case RelationNumaNode:
+                forEachBit(info.NumaNode.GroupMask, [&](uint32_t id) { procNode[id] = info.NumaNode.NodeNumber; });
+                nodes.insert(info.NumaNode.NodeNumber);
+                break;
+            case RelationCache:
+                if (info.Cache.Type == CacheData || info.Cache.Type == CacheUnified)
+                {
+                    auto& target = info.Cache.Level == 1 ? topo.L1DSize : (info.Cache.Level == 2 ? topo.L2Size : topo.L3Size);
+                    if (info.Cache.Level <= 3)
+                        target = std::max<uint32_t>(target, info.Cache.CacheSize);
+                }
+                break;
+            default:
+                break;
+            }
+            offset += info.Size;
+        }
+        for (const auto& [pkg, rel] : pkgRels)
+        {
+            for (WORD g = 0; g < rel->GroupCount; ++g)
+                forEachBit(rel->GroupMask[g], [&, pkg = pkg](uint32_t id) { std::get<0>(procs[id]) = pkg; });
+            packages.insert(pkg);
+        }
+        for (const auto& [id, val] : procs)
+        {
+            const auto& [pkg, core, smt, eff] = val;
+            coreMap.try_emplace({ pkg, core }, static_cast<uint32_t>(coreMap.size()));
+            const auto node = procNode.find(id);
+            topo.Processors.push_back({ id, pkg, core, node == procNode.end() ? 0u : node->second, smt, eff });
+        }
+    }
+#elif COMMON_OS_LINUX || COMMON_OS_ANDROID
+    const std::string cpuRoot = "/sys/devices/system/cpu/";
+    std::map<uint32_t, uint32_t> procNode;
+    for (const auto node : ParseCPUList(ReadSysFile("/sys/devices/system/node/online")))
+    {
+        for (const auto id : ParseCPUList(ReadSysFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")))
+            procNode[id] = node;
+        nodes.insert(node);
+    }
+    // intel hybrid exposes separate pmu for each core type, arm reports cpu_capacity
+    const auto bigCores = ParseCPUList(ReadSysFile("/sys/devices/cpu_core/cpus"));
+    const std::set<uint32_t> bigCoreSet(bigCores.begin(), bigCores.end());
+    std::map<uint32_t, uint64_t> capacities;
+    std::map<std::pair<uint32_t, uint32_t>, uint8_t> smtCounter;
+    for (const auto id : ParseCPUList(ReadSysFile(cpuRoot + "online")))
+    {
+        const auto prefix = cpuRoot + "cpu" + std::to_string(id) + "/";
+        const auto pkg  = static_cast<uint32_t>(ReadSysNum(prefix + "topology/physical_package_id").value_or(0));
+        const auto core = static_cast<uint32_t>(ReadSysNum(prefix + "topology/core_id").value_or(id));
+        const auto node = procNode.find(id);
+        const auto [it, _] = coreMap.try_emplace({ pkg, core }, static_cast<uint32_t>(coreMap.size()));
+        const auto smt = smtCounter[{ pkg, core }]++;
+        uint8_t eff = 0;
+        if (!bigCoreSet.empty())
+            eff = bigCoreSet.count(id) ? 1 : 0;
+        else if (const auto cap = ReadSysNum(prefix + "cpu_capacity"); cap)
+            capacities[id] = *cap;
+        topo.Processors.push_back({ id, pkg, it->second, node == procNode.end() ? 0u : node->second, smt, eff });
+        packages.insert(pkg);
+    }
+    if (!capacities.empty())
+    {
+        std::set<uint64_t> levels;
+        for (const auto& [id, cap] : capacities)
+            levels.insert(cap);
+        for (auto& proc : topo.Processors)
+        {
+            if (const auto cap = capacities.find(proc.Id); cap != capacities.end())
+                proc.EfficiencyClass = static_cast<uint8_t>(std::distance(levels.begin(), levels.find(cap->second)));
+        }
+    }
+    for (const auto& proc : topo.Processors)
+        topo.MaxEfficiencyClass = std::max(topo.MaxEfficiencyClass, proc.EfficiencyClass);
+    for (uint32_t idx = 0; idx < 16; ++idx)
+    {
+        const auto prefix = cpuRoot + "cpu0/cache/index" + std::to_string(idx) + "/";
+        const auto level = ReadSysNum(prefix + "level");
+        if (!level)
+            break;
+        if (ReadSysFile(prefix + "type") == "Instruction")
+            continue;
+        const auto size = static_cast<uint32_t>(ReadSysNum(prefix + "size").value_or(0));
+        switch (*level)
+        {
+        case 1: topo.L1DSize = size; break;
+        case 2: topo.L2Size  = size; break;
+        case 3: topo.L3Size  = size; break;
+        default: break;
+        }
+    }
+#endif
+    if (topo.Processors.empty()) // fallback, treat each logical processor as a physical core
+    {
+        const auto count = std::max(std::thread::hardware_concurrency(), 1u);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            topo.Processors.push_back({ i, 0, i, 0, 0, 0 });
+            coreMap.emplace(std::pair{ 0u, i }, i);
+        }
+    }
+    topo.PackageCount = static_cast<uint32_t>(std::max<size_t>(packages.size(), 1));
+    topo.CoreCount    = static_cast<uint32_t>(coreMap.size());
+    topo.NodeCount    = static_cast<uint32_t>(std::max<size_t>(nodes.size(), 1));
+    return topo;
+}
+
+const CPUTopology& CPUTopology::Get() noexcept
+{
+    static const CPUTopology topo = DetectTopology();
+    return topo;
+}
+std::vector<uint32_t> CPUTopology::GetProcessors(const std::optional<uint32_t> node, const bool skipSMT) const noexcept
+{
+    std::vector<uint32_t> ret;
+    for (const auto& proc : Processors)
+    {
+        if ((!node || proc.Node == *node) && (!skipSMT || proc.SMTIndex == 0))
+            ret.push_back(proc.Id);
+    }
+    return ret;
+}
+std::vector<uint32_t> CPUTopology::GetPerformanceProcessors(const bool skipSMT) const noexcept
+{
+    std::vector<uint32_t> ret;
+    for (const auto& proc : Processors)
+    {
+        if (proc.EfficiencyClass == MaxEfficiencyClass && (!skipSMT || proc.SMTIndex == 0))
+            ret.push_back(proc.Id);
+    }
+    return ret;
+}
+std::vector<uint32_t> CPUTopology::GetEfficiencyProcessors() const noexcept
+{
+    std::vector<uint32_t> ret;
+    if (MaxEfficiencyClass == 0) // homogeneous
+        return ret;
+    for (const auto& proc : Processors)
+    {
+        if (proc.EfficiencyClass < MaxEfficiencyClass)
+            ret.push_back(proc.Id);
+    }
+    return ret;
+}
+
+
+bool ThreadPlacement::Apply() const noexcept
+{
+    return ApplyTo(ThreadObject::GetCurrentThreadObject());
+}
+bool ThreadPlacement::ApplyTo(const ThreadObject& thread) const noexcept
+{
+    bool ret = true;
+    if (!Processors.empty())
+        ret &= thread.SetAffinity(Processors);
+    if (Priority)
+        ret &= thread.SetPriority(*Priority);
+    return ret;
+}
+ThreadPlacement ThreadPlacement::OnProcessors(std::vector<uint32_t> processors) noexcept
+{
+    ThreadPlacement placement;
+    placement.Processors = std::move(processors);
+    return placement;
+}
+ThreadPlacement ThreadPlacement::OnNode(const uint32_t node, const bool skipSMT) noexcept
+{
+    return OnProcessors(CPUTopology::Get().GetProcessors(node, skipSMT));
+}
+ThreadPlacement ThreadPlacement::OnPerformanceCores(const bool skipSMT) noexcept
+{
+    return OnProcessors(CPUTopology::Get().GetPerformanceProcessors(skipSMT));
+}
+ThreadPlacement ThreadPlacement::OnEfficiencyCores() noexcept
+{
+    // fallback to all processors when homogeneous
+    auto procs = CPUTopology::Get().GetEfficiencyProcessors();
+    return OnProcessors(procs.empty() ? CPUTopology::Get().GetProcessors() : std::move(procs));
+}
+
+
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <string_view>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #if !defined(_MANAGED) && !defined(_M_CEE)
 #   include <thread>
@@ -23,6 +24,48 @@ SYSCOMMONAPI std::u16string GetThreadName();
 #   pragma warning(push)
 #   pragma warning(disable:4275 4251)
 #endif
+
+struct SYSCOMMONAPI CPUTopology
+{
+    struct Processor // logical processor
+    {
+        uint32_t Id;                // index used by affinity
+        uint32_t Package;
+        uint32_t Core;              // index of physical core, unique across packages
+        uint32_t Node;              // NUMA node
+        uint8_t SMTIndex;           // 0 for the first logical processor of a physical core
+        uint8_t EfficiencyClass;    // higher means more performant, all 0 on homogeneous CPU
+    };
+    std::vector<Processor> Processors;
+    uint32_t PackageCount = 0, CoreCount = 0, NodeCount = 0;
+    uint32_t L1DSize = 0, L2Size = 0, L3Size = 0; // in bytes, 0 when unknown
+    uint8_t MaxEfficiencyClass = 0;
+
+    [[nodiscard]] std::vector<uint32_t> GetProcessors(const std::optional<uint32_t> node = {}, const bool skipSMT = false) const noexcept;
+    [[nodiscard]] std::vector<uint32_t> GetPerformanceProcessors(const bool skipSMT = false) const noexcept;
+    [[nodiscard]] std::vector<uint32_t> GetEfficiencyProcessors() const noexcept;
+    [[nodiscard]] static const CPUTopology& Get() noexcept;
+};
+
+enum class ThreadPriority : uint8_t { Idle, BelowNormal, Normal, AboveNormal, High };
+
+class ThreadObject;
+struct SYSCOMMONAPI ThreadPlacement
+{
+    std::vector<uint32_t> Processors; // empty means no restriction
+    std::optional<ThreadPriority> Priority;
+
+    // apply to current thread
+    bool Apply() const noexcept;
+    bool ApplyTo(const ThreadObject& thread) const noexcept;
+    [[nodiscard]] bool IsDefault() const noexcept { return Processors.empty() && !Priority.has_value(); }
+
+    [[nodiscard]] static ThreadPlacement OnProcessors(std::vector<uint32_t> processors) noexcept;
+    [[nodiscard]] static ThreadPlacement OnNode(const uint32_t node, const bool skipSMT = false) noexcept;
+    [[nodiscard]] static ThreadPlacement OnPerformanceCores(const bool skipSMT = false) noexcept;
+    [[nodiscard]] static ThreadPlacement OnEfficiencyCores() noexcept;
+};
+
 class SYSCOMMONAPI ThreadObject : public NonCopyable
 {
 protected:
@@ -52,6 +95,11 @@ public:
     std::optional<bool> IsAlive() const;
     bool IsCurrent() const;
     uint64_t GetId() const;
+    // logical processor ids from CPUTopology, empty means failure
+    std::vector<uint32_t> GetAffinity() const;
+    bool SetAffinity(const std::vector<uint32_t>& processors) const;
+    // on linux only current thread is supported
+    bool SetPriority(const ThreadPriority priority) const;
 };
 
 #if COMMON_COMPILER_MSVC
@@ -0,0 +1,166 @@
+#include "SystemCommonPch.h"
+#include "WorkerPool.h"
+#include "ThreadEx.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+namespace common
+{
+
+
+class WorkerPool::Host
+{
+public:
+    std::string Name;
+    std::mutex Mutex;
+    std::condition_variable CV;
+    std::deque<std::function<void()>> Tasks;
+    std::vector<std::thread> Workers;
+    uint32_t MaxWorkers;
+    uint32_t IdleWorkers = 0;
+    bool Stopping = false;
+
+    Host(std::string&& name, const uint32_t threads) : Name(std::move(name)),
+        MaxWorkers(threads > 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u))
+    { }
+    void WorkerMain(const size_t idx)
+    {
+        SetThreadName(Name + "-" + std::to_string(idx));
+        std::unique_lock<std::mutex> lock(Mutex);
+        while (true)
+        {
+            IdleWorkers++;
+            CV.wait(lock, [&]() { return Stopping || !Tasks.empty(); });
+            IdleWorkers--;
+            if (Stopping)
+                return;
+            auto task = std::move(Tasks.front());
+            Tasks.pop_front();
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch (...) // task should handle its own exception, keep the worker alive
+            { }
+            task = nullptr; // release captures outside the lock
+            lock.lock();
+        }
+    }
+};
+
+
+WorkerPool::WorkerPool(std::string name, const uint32_t threads) : Impl(std::make_unique<Host>(std::move(name), threads))
+{ }
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(Impl->Mutex);
+        Impl->Stopping = true;
+        Impl->Tasks.clear();
+    }
+    Impl->CV.notify_all();
+    for (auto& worker : Impl->Workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+uint32_t WorkerPool::GetThreadCount() const noexcept
+{
+    return Impl->MaxWorkers;
+}
+
+void WorkerPool::Post(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(Impl->Mutex);
+    if (Impl->Stopping)
+        return;
+    Impl->Tasks.push_back(std::move(task));
+    if (Impl->Tasks.size() > Impl->IdleWorkers && Impl->Workers.size() < Impl->MaxWorkers)
+    {
+        const auto idx = Impl->Workers.size();
+        Impl->Workers.emplace_back([host = Impl.get(), idx]() { host->WorkerMain(idx); });
+    }
+    else
+        Impl->CV.notify_one();
+}
+
+void WorkerPool::ParallelFor(const size_t count, const uint32_t threads, const std::function<void(size_t)>& func)
+{
+    if (count == 0)
+        return;
+    const auto helpers = std::min<size_t>(threads > 0 ? threads : Impl->MaxWorkers + 1, count) - 1;
+    if (helpers == 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    // helpers that start after the caller closed the state skip the work, so the caller only waits for running ones
+    struct State
+    {
+        const std::function<void(size_t)>& Func;
+        const size_t Count;
+        std::atomic<size_t> Index{ 0 };
+        std::mutex Mutex;
+        std::condition_variable CV;
+        std::exception_ptr Exception;
+        uint32_t Running = 0;
+        bool Closed = false;
+        State(const std::function<void(size_t)>& func, const size_t count) : Func(func), Count(count) { }
+        void Work() noexcept
+        {
+            try
+            {
+                for (auto i = Index++; i < Count; i = Index++)
+                    Func(i);
+            }
+            catch (...)
+            {
+                Index = Count;
+                std::lock_guard<std::mutex> lock(Mutex);
+                if (!Exception)
+                    Exception = std::current_exception();
+            }
+        }
+    };
+    const auto state = std::make_shared<State>(func, count);
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        Post([state]()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(state->Mutex);
+                    if (state->Closed)
+                        return;
+                    state->Running++;
+                }
+                state->Work();
+                std::lock_guard<std::mutex> lock(state->Mutex);
+                if (--state->Running == 0)
+                    state->CV.notify_all();
+            });
+    }
+    state->Work();
+    std::unique_lock<std::mutex> lock(state->Mutex);
+    state->Closed = true;
+    state->CV.wait(lock, [&]() { return state->Running == 0; });
+    if (state->Exception)
+        std::rethrow_exception(state->Exception);
+}
+
+WorkerPool& WorkerPool::GetShared()
+{
+    static WorkerPool Pool("CPUWorker");
+    return Pool;
+}
+
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "SystemCommonRely.h"
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <functional>
+
+
+namespace common
+{
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
+
+// threads for short CPU-bound tasks, workers are started on demand and joined when the pool is destructed.
+// tasks still queued when destructing are dropped without running.
+class SYSCOMMONAPI WorkerPool : public NonCopyable, public NonMovable
+{
+private:
+    class Host;
+    std::unique_ptr<Host> Impl;
+public:
+    // threads: max number of workers, 0 means number of processors
+    WorkerPool(std::string name, uint32_t threads = 0);
+    ~WorkerPool();
+    [[nodiscard]] uint32_t GetThreadCount() const noexcept;
+    void Post(std::function<void()> task);
+    // call [func] for each index in [0, count) with at most [threads] threads, 0 means all workers.
+    // calling thread also takes part and never waits for a queued task, so it is safe to be called inside a task.
+    // the first exception thrown by [func] is rethrown after all running calls finished.
+    void ParallelFor(const size_t count, const uint32_t threads, const std::function<void(size_t)>& func);
+
+    // process-wide pool shared by modules for CPU work
+    [[nodiscard]] static WorkerPool& GetShared();
+};
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
+
+}
@@ -3,15 +3,18 @@
 #include "OpenCLUtil/oclNLCL.h"
 #include "OpenCLUtil/oclPromise.h"
 #include "ImageUtil/ImageUtil.h"
+#include "ImageUtil/ImageBlur.h"
 #include "SystemCommon/MiniLogger.h"
 #include "SystemCommon/FileEx.h"
 #include "SystemCommon/RawFileEx.h"
 #include "SystemCommon/ConsoleEx.h"
 #include "common/MemoryStream.hpp"
 #include "common/Linq2.hpp"
+#include "common/TimeUtil.hpp"
 #include <thread>
 #include <mutex>
 #include <array>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -29,26 +32,6 @@ static MiniLogger<false>& log()
     return logger;
 }
 
-std::array<float, 4> ComputeCoeff(const float sigma)
-{
-    double q1, q2, q3;
-    if (sigma >= 2.5)
-        q1 = 0.98711 * sigma - 0.96330;
-    else if (sigma >= 0.5)
-        q1 = 3.97156 - 4.14554 * std::sqrt(1 - 0.26891 * sigma);
-    else
-        q1 = 0.1147705018520355224609375;
-    q2 = q1 * q1;
-    q3 = q1 * q2;
-    const double b0 = 1 / (1.57825 + (2.44413*q1) + (1.4281 * q2) + (0.422205 * q3));
-    std::array<float, 4> coeff;
-    coeff[1] = (float)(((2.44413 * q1) + (2.85619 * q2) + (1.26661 * q3)) * b0);
-    coeff[2] = (float)((                 -(1.4281 * q2) - (1.26661 * q3)) * b0);
-    coeff[3] = (float)((                                 (0.422205 * q3)) * b0);
-    coeff[0] = (float) (1 - coeff[1] - coeff[2] - coeff[3]);
-    return coeff;
-}
-
 Image ProcessImg(const oclProgram& prog, const oclContext& ctx, const oclCmdQue& cmdque, const Image& image, float sigma) try
 {
     oclKernel blurX = prog->GetKernel("blurX");
@@ -56,7 +39,7 @@ Image ProcessImg(const oclProgram& prog, const oclContext& ctx, const oclCmdQue&
 
     common::PromiseResult<void> pms;
 
-    const auto coeff = ComputeCoeff(sigma);
+    const auto coeff = ComputeIIRCoeff(sigma);
     auto rawBuf = oclBuffer_::Create(ctx, MemFlag::ReadWrite, image.GetSize());
     pms = rawBuf->WriteSpan(cmdque, image.AsSpan<uint32_t>());
     pms->WaitFinish();
@@ -137,6 +120,138 @@ catch (const common::BaseException& be)
     return {};
 }
 
+// repeated blur, intermediates are either created each time or acquired from a pool
+void BenchPool(const oclProgram& prog, const oclContext& ctx, const oclCmdQue& cmdque, const Image& image, float sigma) try
+{
+    constexpr uint32_t Loops = 20;
+    oclKernel blurX = prog->GetKernel("blurX");
+    oclKernel blurY = prog->GetKernel("blurY");
+    const auto coeff = ComputeIIRCoeff(sigma);
+    const auto width = image.GetWidth(), height = image.GetHeight();
+    const auto w4 = width - width % 4, h4 = height - height % 4;
+    xziar::img::Image img2(xziar::img::ImageDataType::RGBA);
+    img2.SetSize(image.GetWidth(), image.GetHeight());
+    const auto blur = [&](const oclBuffer& rawBuf, const oclBuffer& midBuf1, const oclBuffer& midBuf2)
+    {
+        const auto pmsW = rawBuf->WriteSpan(cmdque, image.AsSpan<uint32_t>());
+        const auto pmsX = blurX->Call<1>(rawBuf, midBuf1, midBuf2, w4, h4, width, coeff)(pmsW, cmdque, { h4 });
+        const auto pmsY = blurY->Call<1>(midBuf2, midBuf1, rawBuf, w4, h4, width, coeff)(pmsX, cmdque, { w4 });
+        rawBuf->ReadSpan(pmsY, cmdque, img2.AsSpan())->WaitFinish();
+    };
+
+    common::SimpleTimer timer;
+    timer.Start();
+    for (uint32_t i = 0; i < Loops; ++i)
+    {
+        blur(oclBuffer_::Create(ctx, MemFlag::ReadWrite, image.GetSize()),
+            oclBuffer_::Create(ctx, MemFlag::ReadWrite, image.GetSize() * sizeof(float)),
+            oclBuffer_::Create(ctx, MemFlag::ReadWrite, image.GetSize() * sizeof(float)));
+    }
+    timer.Stop();
+    const auto createNs = timer.ElapseNs();
+
+    const auto pool = oclMemPool_::Create(ctx);
+    timer.Start();
+    for (uint32_t i = 0; i < Loops; ++i)
+    {
+        blur(pool->AcquireBuffer(MemFlag::ReadWrite, image.GetSize()),
+            pool->AcquireBuffer(MemFlag::ReadWrite, image.GetSize() * sizeof(float)),
+            pool->AcquireBuffer(MemFlag::ReadWrite, image.GetSize() * sizeof(float)));
+    }
+    timer.Stop();
+    const auto poolNs = timer.ElapseNs();
+
+    const auto stats = pool->GetStats();
+    log().info(u"[{}] blurs: create {:.5}ms per run, pool {:.5}ms per run\n", Loops, createNs / 1e6f / Loops, poolNs / 1e6f / Loops);
+    log().info(u"pool: [{}] requests, [{}] hits, [{}] cached, [{:.3}]MB cached, [{:.3}]MB live\n", stats.Requests, stats.Hits,
+        stats.CachedCount, stats.CachedBytes / 1048576.0, stats.LiveBytes / 1048576.0);
+    pool->Trim();
+}
+catch (const common::BaseException& be)
+{
+    log().error(u"Error when bench image: {}\n", be.Message());
+}
+
+Image ProcessImgCPU(const Image& image, float sigma, const Image* clResult)
+{
+    common::SimpleTimer timer;
+    timer.Start();
+    auto img2 = GaussianBlurIIR(image, sigma);
+    timer.Stop();
+    log().info(u"CPU BLUR[{:.5}ms]\n", timer.ElapseNs() / 1e6f);
+    if (clResult && clResult->GetSize() == img2.GetSize())
+    {
+        // kernel only covers the 4-aligned area and truncates when converting back
+        const auto w4 = image.GetWidth() - image.GetWidth() % 4, h4 = image.GetHeight() - image.GetHeight() % 4;
+        uint32_t maxDiff = 0;
+        for (uint32_t y = 0; y < h4; ++y)
+        {
+            const auto rowCL = clResult->GetRawPtr<uint8_t>(y), rowCPU = img2.GetRawPtr<uint8_t>(y);
+            for (uint32_t x = 0; x < w4 * 4; ++x)
+                maxDiff = std::max<uint32_t>(maxDiff, std::abs(rowCL[x] - rowCPU[x]));
+        }
+        log().info(u"CPU vs CL max diff: [{}]\n", maxDiff);
+    }
+    return img2;
+}
+
+// GaussianIIR.cl's sRGB kernels on a synthetic image, CPU blur should give the same result
+void CompareSRGB(const oclContext& ctx, const oclCmdQue& cmdque, const oclDevice& dev, const common::fs::path& basepath) try
+{
+    auto clPath = common::fs::path(basepath).parent_path().parent_path().parent_path() / u"TextureUtil" / u"GaussianIIR.cl";
+    if (!common::fs::exists(clPath))
+        clPath = common::fs::path("GaussianIIR.cl");
+    const auto prog = oclProgram_::CreateAndBuild(ctx, common::file::ReadAllText(clPath), {}, dev);
+    oclKernel blurX = prog->GetKernel("IIR_SRGBX");
+    oclKernel blurY = prog->GetKernel("IIR_SRGBY");
+
+    // hard edges and gradients, both dimensions are 4-aligned as required by the kernels
+    constexpr uint32_t Width = 256, Height = 192;
+    constexpr float Sigma = 2.0f;
+    Image image(ImageDataType::RGBA);
+    image.SetSize(Width, Height);
+    for (uint32_t y = 0; y < Height; ++y)
+    {
+        auto ptr = image.GetRawPtr<uint8_t>(y);
+        for (uint32_t x = 0; x < Width; ++x, ptr += 4)
+        {
+            ptr[0] = ((x / 16 + y / 16) & 1) ? 230 : 20;
+            ptr[1] = static_cast<uint8_t>(x);
+            ptr[2] = static_cast<uint8_t>((x * y) >> 7);
+            ptr[3] = static_cast<uint8_t>(255 - x / 2);
+        }
+    }
+
+    const auto coeff = ComputeIIRCoeff(Sigma);
+    auto rawBuf = oclBuffer_::Create(ctx, MemFlag::ReadWrite, image.GetSize());
+    auto midBuf1 = oclBuffer_::Create(ctx, MemFlag::ReadWrite, image.GetSize() * sizeof(float));
+    auto midBuf2 = oclBuffer_::Create(ctx, MemFlag::ReadWrite, image.GetSize() * sizeof(float));
+    const auto pmsW = rawBuf->WriteSpan(cmdque, image.AsSpan<uint32_t>());
+    const auto pmsX = blurX->Call<1>(rawBuf, midBuf1, midBuf2, Width, Height, Width, coeff)(pmsW, cmdque, { Height });
+    const auto pmsY = blurY->Call<1>(midBuf2, midBuf1, rawBuf, Width, Height, Width, coeff)(pmsX, cmdque, { Width });
+    Image clResult(ImageDataType::RGBA);
+    clResult.SetSize(Width, Height);
+    rawBuf->ReadSpan(pmsY, cmdque, clResult.AsSpan())->WaitFinish();
+
+    const auto cpuResult = GaussianBlurIIR(image, Sigma, true);
+    uint32_t maxDiff = 0;
+    for (uint32_t y = 0; y < Height; ++y)
+    {
+        const auto rowCL = clResult.GetRawPtr<uint8_t>(y), rowCPU = cpuResult.GetRawPtr<uint8_t>(y);
+        for (uint32_t x = 0; x < Width * 4; ++x)
+            maxDiff = std::max<uint32_t>(maxDiff, std::abs(rowCL[x] - rowCPU[x]));
+    }
+    // native_powr in the kernel is allowed to be less precise
+    if (maxDiff <= 2)
+        log().success(u"sRGB blur, CPU vs GaussianIIR.cl max diff: [{}]\n", maxDiff);
+    else
+        log().error(u"sRGB blur, CPU vs GaussianIIR.cl max diff: [{}]\n", maxDiff);
+}
+catch (const common::BaseException& be)
+{
+    log().error(u"Error when compare sRGB blur: {}\n", be.Message());
+}
+
 template<typename T>
 uint32_t SelectIdx(const T& container, std::u16string_view name)
 {
@@ -166,7 +281,16 @@ int main() try
 
     const auto& plats = oclPlatform_::GetPlatforms();
     if (plats.size() == 0)
-        return {};
+    {
+        log().warning(u"No OpenCL platform found, only run CPU blur.\n");
+        common::mlog::SyncConsoleBackend();
+        const common::fs::path fpath = common::console::ConsoleEx::ReadLine("image path:");
+        const auto img1 = xziar::img::ReadImage(fpath);
+        const auto img2 = ProcessImgCPU(img1, 2.0f, nullptr);
+        xziar::img::WriteImage(img2, common::fs::path(fpath).replace_extension(".blur.cpu.jpg"));
+        getchar();
+        return 0;
+    }
 
     common::linq::FromIterable(plats)
         .ForEach([](const auto& plat, size_t idx) mutable
@@ -195,6 +319,8 @@ int main() try
     }
 
     
+    CompareSRGB(ctx, cmdque, thedev, basepath);
+
     common::mlog::SyncConsoleBackend();
     const string fname = common::console::ConsoleEx::ReadLine("image path:");
     common::fs::path fpath = fname;
@@ -219,7 +345,9 @@ int main() try
     xziar::img::WriteImage(img1, fpath2);
 
     auto img2 = ProcessImg(prog, ctx, cmdque, img1, 2.0f);
-
+    BenchPool(prog, ctx, cmdque, img1, 2.0f);
+    const auto img3 = ProcessImgCPU(img1, 2.0f, &img2);
+    xziar::img::WriteImage(img3, common::fs::path(fpath).replace_extension(".blur.cpu.jpg"));
 
 
     auto fpath3 = fpath;
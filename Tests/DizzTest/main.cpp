@@ -3,9 +3,11 @@
 #include "RenderCore/SceneManager.h"
 #include "RenderCore/PostProcessor.h"
 #include "RenderCore/FontTest.h"
+#include "RenderCore/TextureLoader.h"
 #include "ImageUtil/ImageUtil.h"
 #include "WindowHost/WindowHost.h"
 #include "common/Linq2.hpp"
+#include "common/TimeUtil.hpp"
 #include <cstdint>
 #include <cstdio>
 #include <memory>
@@ -55,6 +57,116 @@ void PrintException(const common::ExceptionBasicInfo& be)
 }
 
 
+static std::vector<std::pair<fs::path, dizz::TexLoadType>> PrepareBenchTextures(const uint32_t count, const uint32_t size)
+{
+    const auto dir = fs::temp_directory_path() / L"RayRenderer" / "TexBench";
+    fs::create_directories(dir);
+    std::vector<std::pair<fs::path, dizz::TexLoadType>> requests;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto fpath = dir / (std::to_string(i) + ".png");
+        if (!fs::exists(fpath))
+        {
+            xziar::img::Image img(xziar::img::ImageDataType::RGBA);
+            img.SetSize(size, size);
+            auto ptr = img.GetRawPtr<uint32_t>();
+            for (uint32_t y = 0; y < size; ++y)
+                for (uint32_t x = 0; x < size; ++x)
+                    *ptr++ = 0xff000000u | ((x * 255 / size + i * 32) & 0xff) | (((y * 255 / size) & 0xff) << 8) | ((((x ^ y) >> 5) & 0xff) << 16);
+            xziar::img::WriteImage(img, fpath);
+        }
+        requests.emplace_back(std::move(fpath), dizz::TexLoadType::Color);
+    }
+    return requests;
+}
+
+static uint64_t LoadBenchTextures(dizz::TextureLoader& loader, const std::vector<std::pair<fs::path, dizz::TexLoadType>>& requests)
+{
+    common::SimpleTimer timer;
+    timer.Start();
+    auto results = loader.GetTexturesAsync(requests);
+    for (auto& result : results)
+    {
+        if (const auto pms = std::get_if<common::PromiseResult<dizz::FakeTex>>(&result); pms)
+            (*pms)->Get();
+    }
+    timer.Stop();
+    return timer.ElapseNs();
+}
+
+// restores loader's disk cache and pipeline setting when leaving a bench
+class LoaderSettingGuard
+{
+    dizz::TextureLoader& Loader;
+    fs::path CacheDir;
+    uint64_t CacheMaxBytes = 0;
+    bool UsePipeline;
+public:
+    LoaderSettingGuard(dizz::TextureLoader& loader) : Loader(loader), UsePipeline(loader.GetPipeline())
+    {
+        if (const auto cache = Loader.GetDiskCache(); cache)
+        {
+            CacheDir = cache->GetDirectory();
+            CacheMaxBytes = cache->GetMaxBytes();
+        }
+    }
+    ~LoaderSettingGuard()
+    {
+        Loader.Shrink();
+        Loader.SetPipeline(UsePipeline);
+        Loader.SetDiskCache(CacheDir, CacheMaxBytes);
+    }
+};
+
+// load a batch of 8K textures with and without pipelined compression, disk cache is disabled meanwhile
+static void BenchTexLoading(dizz::TextureLoader& loader)
+{
+    constexpr uint32_t Count = 8, Size = 8192;
+    const auto requests = PrepareBenchTextures(Count, Size);
+    LoaderSettingGuard guard(loader);
+    loader.SetDiskCache({}, 0);
+    dizz::TexProcStats results[2];
+    uint64_t elapseNs[2] = { 0, 0 };
+    for (const bool pipeline : { false, true })
+    {
+        loader.Shrink();
+        loader.SetPipeline(pipeline);
+        loader.ResetProcStats();
+        elapseNs[pipeline] = LoadBenchTextures(loader, requests);
+        const auto& stats = results[pipeline] = loader.GetProcStats();
+        log().info(u"[{:9}] [{}] textures in {}ms, process {}ms, mipmap {}ms, compress {}ms (cpu), peak {}MB\n",
+            pipeline ? u"pipelined" : u"staged", stats.Count, elapseNs[pipeline] / 1000000, stats.TotalNs / 1000000,
+            stats.MipmapNs / 1000000, stats.CompressNs / 1000000, stats.PeakBytes / 1024 / 1024);
+    }
+    if (results[0].PeakBytes > 0 && results[1].PeakBytes > 0 && elapseNs[0] > 0)
+        log().info(u"pipelined: wall time x{:.2f}, peak memory x{:.2f} of staged\n",
+            static_cast<double>(elapseNs[1]) / elapseNs[0], static_cast<double>(results[1].PeakBytes) / results[0].PeakBytes);
+}
+
+// whole miss path (hash, decode, mipmap, BC compress, store) against hits from an empty disk cache, user's cache is restored after
+static void BenchTexCache(dizz::TextureLoader& loader)
+{
+    constexpr uint32_t Count = 8, Size = 4096;
+    const auto requests = PrepareBenchTextures(Count, Size);
+    LoaderSettingGuard guard(loader);
+    const auto cacheDir = fs::temp_directory_path() / L"RayRenderer" / "TexBenchCache";
+    fs::remove_all(cacheDir);
+    loader.SetDiskCache(cacheDir, uint64_t(1) << 32);
+    loader.Shrink();
+    const auto coldNs = LoadBenchTextures(loader, requests);
+    loader.Shrink();
+    const auto warmNs = LoadBenchTextures(loader, requests);
+    loader.Shrink();
+    // a new cache instance only has the persisted index, as on the next launch
+    loader.SetDiskCache(cacheDir, uint64_t(1) << 32);
+    const auto relaunchNs = LoadBenchTextures(loader, requests);
+    log().info(u"[disk cache] [{}] textures: cold {}ms, warm {}ms, relaunch {}ms, cache holds [{}]MB\n", Count,
+        coldNs / 1000000, warmNs / 1000000, relaunchNs / 1000000, loader.GetDiskCache()->GetTotalBytes() / 1024 / 1024);
+    loader.Shrink();
+    loader.SetDiskCache({}, 0);
+    fs::remove_all(cacheDir);
+}
+
 void RunDizzCore()
 {
     std::unique_ptr<dizz::RenderCore> tester;
@@ -215,6 +327,12 @@ void RunDizzCore()
                     const auto sceen = tester->Screenshot();
                     xziar::img::WriteImage(sceen, fs::temp_directory_path() / L"RayRenderer" / "sceen.png");
                 } return;
+            case event::CommonKeys::F4:
+                BenchTexLoading(*tester->GetTexLoader());
+                return;
+            case event::CommonKeys::F5:
+                BenchTexCache(*tester->GetTexLoader());
+                return;
             default:
                 break;
             }
@@ -0,0 +1,227 @@
+#include "rely.h"
+#include "Nailang/NailangParser.h"
+#include "Nailang/NailangOptimizer.h"
+
+
+using namespace std::string_view_literals;
+using common::parser::ParserContext;
+using xziar::nailang::MemoryPool;
+using xziar::nailang::NailangParser;
+using xziar::nailang::NailangOptimizer;
+using xziar::nailang::Expr;
+using xziar::nailang::Arg;
+using xziar::nailang::Block;
+using xziar::nailang::CompactEvaluateContext;
+
+
+struct OptBlkParser : public NailangParser
+{
+    using NailangParser::NailangParser;
+    static Block GetBlock(MemoryPool& pool, const std::u32string_view src)
+    {
+        ParserContext context(src);
+        OptBlkParser parser(pool, context);
+        Block ret;
+        parser.ParseContentIntoBlock(true, ret);
+        return ret;
+    }
+};
+
+static Expr ParseExpr(MemoryPool& pool, const std::u32string_view src)
+{
+    ParserContext context(src);
+    NailangParser parser(pool, context);
+    const auto [expr, delim] = parser.ParseExpr("");
+    EXPECT_EQ(delim, common::parser::special::CharEnd);
+    return expr;
+}
+
+#define CHECK_LITERAL(expr, type, val) do                   \
+{                                                           \
+    ASSERT_EQ(expr.TypeData, Expr::Type::type);             \
+    EXPECT_EQ(expr.GetVar<Expr::Type::type>(), val);        \
+} while(0)                                                  \
+
+
+TEST(NailangOptimizer, FoldExpr)
+{
+    MemoryPool pool;
+    NailangOptimizer optimizer(pool);
+    const auto Fold = [&](const std::u32string_view src)
+    {
+        return optimizer.OptimizeExpr(ParseExpr(pool, src));
+    };
+    {
+        const auto expr = Fold(U"(1 + 2) * 3"sv);
+        CHECK_LITERAL(expr, Int, 9);
+    }
+    {
+        const auto expr = Fold(U"!(3 > 4.5)"sv);
+        CHECK_LITERAL(expr, Bool, true);
+    }
+    {
+        const auto expr = Fold(U"\"Hello \" + \"World\""sv);
+        CHECK_LITERAL(expr, Str, U"Hello World"sv);
+    }
+    {
+        const auto expr = Fold(U"$Math.Max(1, 2.5, $Math.Sqrt(4.0))"sv);
+        CHECK_LITERAL(expr, FP, 2.5);
+    }
+    {
+        const auto expr = Fold(U"$Format(\"{}-{}\", 1, \"a\")"sv);
+        CHECK_LITERAL(expr, Str, U"1-a"sv);
+    }
+    {
+        const auto expr = Fold(U"true ? (2 * 3) : notexist"sv);
+        CHECK_LITERAL(expr, Int, 6);
+    }
+    {
+        const auto expr = Fold(U"false && notexist"sv);
+        CHECK_LITERAL(expr, Bool, false);
+    }
+    {
+        const auto expr = Fold(U"a + (1 + 2)"sv);
+        ASSERT_EQ(expr.TypeData, Expr::Type::Binary);
+        const auto& binary = *expr.GetVar<Expr::Type::Binary>();
+        EXPECT_EQ(binary.LeftOperand.TypeData, Expr::Type::Var);
+        CHECK_LITERAL(binary.RightOperand, Int, 3);
+    }
+    {
+        const auto expr = Fold(U"?a"sv);
+        EXPECT_EQ(expr.TypeData, Expr::Type::Unary);
+    }
+    {
+        const auto expr = Fold(U"$Math.Sqrt(\"x\")"sv); // error is left to runtime
+        EXPECT_EQ(expr.TypeData, Expr::Type::Func);
+    }
+    {
+        const auto expr = Fold(U"$Math.Unknown(1)"sv);
+        EXPECT_EQ(expr.TypeData, Expr::Type::Func);
+    }
+    {
+        const auto expr1 = Fold(U"\"ab\" + \"c\""sv);
+        const auto expr2 = Fold(U"\"a\" + \"bc\""sv);
+        ASSERT_EQ(expr1.TypeData, Expr::Type::Str);
+        ASSERT_EQ(expr2.TypeData, Expr::Type::Str);
+        EXPECT_EQ(expr1.GetVar<Expr::Type::Str>().data(), expr2.GetVar<Expr::Type::Str>().data());
+    }
+    const auto& stats = optimizer.GetStats();
+    EXPECT_EQ(stats.FoldedFuncs, 3u);
+    EXPECT_EQ(stats.InternedStrs, 3u);
+}
+
+
+static std::shared_ptr<CompactEvaluateContext> RunBlock(const Block& block)
+{
+    xziar::nailang::NailangBasicRuntime runtime(std::make_shared<CompactEvaluateContext>());
+    auto ctx = std::make_shared<CompactEvaluateContext>();
+    runtime.ExecuteBlock(block, {}, ctx);
+    return ctx;
+}
+static Arg GetArg(const std::shared_ptr<CompactEvaluateContext>& ctx, const std::u32string_view name)
+{
+    auto arg = ctx->LocateArg(name, false);
+    arg.Decay();
+    return arg;
+}
+
+TEST(NailangOptimizer, DecideMetas)
+{
+    MemoryPool pool;
+    constexpr auto txt = UR"(
+@If(1 > 2)
+    m = 1;
+@Else()
+    m = 2;
+@If($Math.Max(1, 2) == 2)
+    n = "a" + "b";
+@Else()
+    n = "c";
+@Skip(false)
+k = (3 * 4) + m;
+@Skip()
+k = 0;
+@MetaIf(true, "If", m == 2)
+j = 1;
+)"sv;
+    const auto block = OptBlkParser::GetBlock(pool, txt);
+    ASSERT_EQ(block.Size(), 7u);
+
+    NailangOptimizer optimizer(pool);
+    const auto optBlock = optimizer.OptimizeBlock(block);
+    ASSERT_EQ(optBlock.Size(), 4u);
+    EXPECT_TRUE(optBlock[0].first.empty());
+    EXPECT_TRUE(optBlock[1].first.empty());
+    EXPECT_TRUE(optBlock[2].first.empty());
+    ASSERT_EQ(optBlock[3].first.size(), 1u);
+    EXPECT_EQ(optBlock[3].first[0].FullFuncName(), U"If"sv);
+
+    const auto& stats = optimizer.GetStats();
+    EXPECT_EQ(stats.FoldedExprs, 4u);
+    EXPECT_EQ(stats.FoldedFuncs, 1u);
+    EXPECT_EQ(stats.DecidedMetas, 6u);
+    EXPECT_EQ(stats.RemovedStatements, 3u);
+
+    for (const auto blk : { &block, &optBlock })
+    {
+        const auto ctx = RunBlock(*blk);
+        EXPECT_EQ(GetArg(ctx, U"m"sv).GetInt(), 2);
+        EXPECT_EQ(GetArg(ctx, U"n"sv).GetStr(), U"ab"sv);
+        EXPECT_EQ(GetArg(ctx, U"k"sv).GetInt(), 14);
+        EXPECT_EQ(GetArg(ctx, U"j"sv).GetInt(), 1);
+    }
+}
+
+TEST(NailangOptimizer, KeepIfRecord)
+{
+    MemoryPool pool;
+    constexpr auto txt = UR"(
+@If(true)
+    m = 1;
+@Skip(m == 0)
+@Else()
+    m = 2;
+)"sv;
+    const auto block = OptBlkParser::GetBlock(pool, txt);
+    NailangOptimizer optimizer(pool);
+    const auto optBlock = optimizer.OptimizeBlock(block);
+    // [Else] is not the first meta, so [If] can not be decided
+    ASSERT_EQ(optBlock.Size(), 2u);
+    ASSERT_EQ(optBlock[0].first.size(), 1u);
+    EXPECT_EQ(optBlock[0].first[0].FullFuncName(), U"If"sv);
+    EXPECT_EQ(optimizer.GetStats().DecidedMetas, 0u);
+
+    for (const auto blk : { &block, &optBlock })
+    {
+        const auto ctx = RunBlock(*blk);
+        EXPECT_EQ(GetArg(ctx, U"m"sv).GetInt(), 1);
+    }
+}
+
+TEST(NailangOptimizer, NestedBlock)
+{
+    MemoryPool pool;
+    constexpr auto txt = UR"(
+#Block("outer")
+{
+    @If(1 == 1)
+    #Block("")
+    {
+        val := $Math.Pow(2, 3) + 1;
+    }
+}
+)"sv;
+    auto program = OptBlkParser::GetBlock(pool, txt);
+    NailangOptimizer optimizer(pool);
+    optimizer.OptimizeProgram(program);
+    ASSERT_EQ(program.Size(), 1u);
+    const auto& outer = *program[0].second.Get<Block>();
+    ASSERT_EQ(outer.Size(), 1u);
+    const auto [metas, content] = outer[0];
+    EXPECT_TRUE(metas.empty());
+    ASSERT_EQ(content.TypeData, xziar::nailang::Statement::Type::Block);
+    const auto& inner = *content.Get<Block>();
+    ASSERT_EQ(inner.Size(), 1u);
+    const auto& assign = *inner[0].second.Get<xziar::nailang::AssignExpr>();
+    CHECK_LITERAL(assign.Statement, FP, 9.0);
+}
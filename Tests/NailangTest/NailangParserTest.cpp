@@ -743,12 +743,12 @@ public:
     std::u32string_view Target;
     Replacer(std::u32string_view target) : Target(target) {}
     ~Replacer() override {}
-    void OnReplaceVariable(std::u32string& output, void*, std::u32string_view var) override
+    void OnReplaceVariable(xziar::nailang::TextRope& output, void*, std::u32string_view var) override
     {
         Vars.push_back(var);
         output.append(Target);
     }
-    void OnReplaceFunction(std::u32string& output, void*, std::u32string_view func, common::span<const std::u32string_view> args) override
+    void OnReplaceFunction(xziar::nailang::TextRope& output, void*, std::u32string_view func, common::span<const std::u32string_view> args) override
     {
         std::vector<std::u32string_view> arg(args.begin(), args.end());
         Funcs.emplace_back(func, std::move(arg));
@@ -0,0 +1,134 @@
+#include "rely.h"
+#include "Nailang/NailangParser.h"
+#include "Nailang/NailangRuntime.h"
+#include "Nailang/NailangProfiler.h"
+
+
+using namespace std::string_view_literals;
+using common::parser::ParserContext;
+using xziar::nailang::MemoryPool;
+using xziar::nailang::NailangParser;
+using xziar::nailang::NailangProfiler;
+using xziar::nailang::Block;
+using xziar::nailang::CompactEvaluateContext;
+
+
+struct ProfBlkParser : public NailangParser
+{
+    using NailangParser::NailangParser;
+    static Block GetBlock(MemoryPool& pool, const std::u32string_view src)
+    {
+        ParserContext context(src);
+        ProfBlkParser parser(pool, context);
+        Block ret;
+        parser.ParseContentIntoBlock(true, ret);
+        return ret;
+    }
+};
+
+static const NailangProfiler::Summary* FindSummary(common::span<const NailangProfiler::Summary> summaries,
+    NailangProfiler::Category type, std::u32string_view name)
+{
+    for (const auto& summary : summaries)
+    {
+        if (summary.Type == type && summary.Name == name)
+            return &summary;
+    }
+    return nullptr;
+}
+
+
+TEST(NailangProfiler, CallTree)
+{
+    MemoryPool pool;
+    constexpr auto txt = UR"(
+@DefFunc(m,n)
+#Block("gcd")
+{
+    tmp := m % n;
+    @If(tmp==0)
+    $Return(n);
+    $Return($gcd(n, tmp));
+}
+@While(i < 3)
+#Block("loop")
+{
+    val = $gcd(24, 18);
+    i += 1;
+}
+)"sv;
+    const auto program = ProfBlkParser::GetBlock(pool, txt);
+    const auto& funcBlk = *program[0].second.Get<Block>();
+    const auto& loopBlk = *program[1].second.Get<Block>();
+    ASSERT_EQ(funcBlk.Name, U"gcd"sv);
+    ASSERT_EQ(loopBlk.Name, U"loop"sv);
+
+    NailangProfiler profiler;
+    xziar::nailang::NailangBasicRuntime runtime(std::make_shared<CompactEvaluateContext>());
+    runtime.SetProfiler(&profiler);
+    {
+        auto ctx = std::make_shared<CompactEvaluateContext>();
+        ctx->LocateArg(U"i"sv, true).Set(int64_t(0));
+        runtime.ExecuteBlock(program, {}, ctx, false);
+    }
+    runtime.SetProfiler(nullptr);
+
+    const auto summaries = profiler.Summarize();
+    {
+        const auto loop = FindSummary(summaries, NailangProfiler::Category::Block, U"loop"sv);
+        ASSERT_NE(loop, nullptr);
+        EXPECT_EQ(loop->Count, 3u);
+    }
+    {
+        // gcd(24,18) -> gcd(18,6) -> 6, recursive call is inside [Return]
+        const auto gcd = FindSummary(summaries, NailangProfiler::Category::Func, U"gcd"sv);
+        ASSERT_NE(gcd, nullptr);
+        EXPECT_EQ(gcd->Count, 6u);
+        EXPECT_LE(gcd->ExclusiveNs, gcd->InclusiveNs);
+    }
+    {
+        const auto ret = FindSummary(summaries, NailangProfiler::Category::Func, U"Return"sv);
+        ASSERT_NE(ret, nullptr);
+        EXPECT_EQ(ret->Count, 6u);
+    }
+    uint64_t totalExclusive = 0;
+    for (const auto& node : profiler.GetNodes())
+        totalExclusive += node.ExclusiveNs();
+    EXPECT_LE(totalExclusive, profiler.GetTotalNs());
+
+    const auto folded = profiler.ExportFoldedStacks();
+    EXPECT_NE(folded.find("Block:;Block:loop;Func:gcd;Func:Return;Func:gcd;Func:Return "), std::string::npos);
+
+    profiler.Reset();
+    EXPECT_EQ(profiler.GetNodes().size(), 1u);
+    EXPECT_EQ(profiler.GetTotalNs(), 0u);
+}
+
+TEST(NailangProfiler, Discard)
+{
+    NailangProfiler profiler;
+    {
+        NailangProfiler::Scope outer(&profiler, NailangProfiler::Category::Func, U"outer"sv);
+        {
+            NailangProfiler::Scope ext(&profiler, NailangProfiler::Category::Extension, U"ext1"sv);
+            ext.Discard();
+        }
+        {
+            NailangProfiler::Scope ext(&profiler, NailangProfiler::Category::Extension, U"ext2"sv);
+        }
+    }
+    {
+        NailangProfiler::Scope disabled(nullptr, NailangProfiler::Category::Func, U"disabled"sv);
+    }
+    const auto summaries = profiler.Summarize();
+    ASSERT_EQ(summaries.size(), 2u);
+    EXPECT_EQ(FindSummary(summaries, NailangProfiler::Category::Extension, U"ext1"sv), nullptr);
+    const auto ext2 = FindSummary(summaries, NailangProfiler::Category::Extension, U"ext2"sv);
+    ASSERT_NE(ext2, nullptr);
+    EXPECT_EQ(ext2->Count, 1u);
+    const auto outer = FindSummary(summaries, NailangProfiler::Category::Func, U"outer"sv);
+    ASSERT_NE(outer, nullptr);
+    EXPECT_EQ(outer->Count, 1u);
+    EXPECT_GE(outer->InclusiveNs, ext2->InclusiveNs);
+    EXPECT_EQ(outer->InclusiveNs, profiler.GetTotalNs());
+}
@@ -0,0 +1,87 @@
+#include "rely.h"
+#include "Nailang/NailangRope.h"
+#include "Nailang/NailangParser.h"
+
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+using xziar::nailang::TextRope;
+
+
+TEST(NailangRope, Append)
+{
+    const std::u32string source = U"kernel void test(global int* restrict a, global const int* restrict b)\r\n{\r\n    a[0] = b[0];\r\n}\r\n";
+    const std::u32string_view src(source);
+    TextRope rope;
+    EXPECT_TRUE(rope.empty());
+    rope.AppendView(src.substr(0, 40));
+    rope.AppendView(src.substr(40)); // continuous slices are merged
+    EXPECT_EQ(rope.SegmentCount(), 1u);
+    EXPECT_LT(rope.OwnedBytes(), source.size() * sizeof(char32_t)); // nothing copied
+    rope.append(U"/*"sv);
+    rope.push_back(U' ');
+    rope.append(U"end */"s); // small appends are packed together
+    EXPECT_EQ(rope.SegmentCount(), 2u);
+    EXPECT_EQ(rope.back(), U'/');
+    rope.pop_back();
+    rope.pop_back();
+    EXPECT_EQ(rope.size(), source.size() + 7);
+    EXPECT_EQ(rope.ToU32String(), source + U"/* end "s);
+    rope.clear();
+    EXPECT_TRUE(rope.empty());
+    EXPECT_EQ(rope.SegmentCount(), 0u);
+}
+
+TEST(NailangRope, Splice)
+{
+    const std::u32string source = U"0123456789abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    TextRope rope;
+    rope.append(U"[head]"sv);
+    {
+        TextRope inner;
+        inner.append(U"<inner>"sv);
+        const auto kept = inner.Keep(std::u32string(U"kept string which is long enough to be referenced"));
+        inner.AppendView(kept);
+        inner.AppendView(source);
+        TextRope moved(std::move(inner));
+        EXPECT_TRUE(inner.empty());
+        rope.Append(std::move(moved));
+        EXPECT_TRUE(moved.empty());
+    } // storage of inner is moved into rope
+    rope.append(U"[tail]"sv);
+    rope.Prepend(U"[prefix]"sv);
+    EXPECT_EQ(rope.ToU32String(), U"[prefix][head]<inner>kept string which is long enough to be referenced"s + source + U"[tail]"s);
+}
+
+TEST(NailangRope, UTF8)
+{
+    TextRope rope;
+    rope.append(U"ascii, "sv);
+    rope.append(U"中文, "sv);
+    rope.append(U"\U0001F600"sv);
+    EXPECT_EQ(rope.ToUTF8(), "ascii, \xe4\xb8\xad\xe6\x96\x87, \xf0\x9f\x98\x80"s);
+    std::string output = "prefix ";
+    rope.AppendUTF8(output);
+    EXPECT_EQ(output, "prefix ascii, \xe4\xb8\xad\xe6\x96\x87, \xf0\x9f\x98\x80"s);
+}
+
+
+class RopeReplacer : public xziar::nailang::ReplaceEngine
+{
+public:
+    void OnReplaceVariable(TextRope& output, void*, std::u32string_view var) override
+    {
+        output.append(U"<"sv).append(var).append(U">"sv);
+    }
+    using ReplaceEngine::ProcessVariable;
+};
+TEST(NailangRope, ReplaceEngine)
+{
+    const std::u32string source = U"This is a long enough prefix to be referenced $$!{var} and a long enough suffix to be referenced";
+    RopeReplacer replacer;
+    TextRope rope;
+    replacer.ProcessVariable(rope, source, U"$$!{"sv, U"}"sv);
+    EXPECT_EQ(rope.ToUTF8(), "This is a long enough prefix to be referenced <var> and a long enough suffix to be referenced");
+    EXPECT_EQ(rope.SegmentCount(), 3u);
+    EXPECT_EQ(replacer.ProcessVariable(source, U"$$!{"sv, U"}"sv), rope.ToU32String());
+}
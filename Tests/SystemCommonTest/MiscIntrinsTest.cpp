@@ -54,6 +54,26 @@ INTRIN_TEST(CopyEx, Broadcast4)
     BroadcastTest(*Intrin, val, 139);
 }
 
+TEST_F(CopyEx, AutoTune)
+{
+    const common::FastPathBase::VarItem req[] = { common::FastPathBase::AutoTune };
+    const common::CopyManager intrin(req);
+    EXPECT_TRUE(intrin.IsComplete());
+    for (const auto& [inst, choice] : intrin.GetIntrinMap())
+    {
+        const auto support = std::find_if(common::CopyManager::GetSupportMap().begin(), common::CopyManager::GetSupportMap().end(),
+            [&](const auto& path) { return path.FuncName == inst; });
+        ASSERT_NE(support, common::CopyManager::GetSupportMap().end());
+        if (support->Variants.size() <= 1) 
+            continue;
+        bool tuned = false;
+        for (const auto& item : intrin.GetTuneInfo())
+            tuned |= (item.FuncName == inst && item.MethodName == choice);
+        EXPECT_TRUE(tuned) << "intrin [" << inst << "] not picked by tuning";
+    }
+    BroadcastTest(intrin, uint32_t(0xdeafbeefu), 139);
+}
+
 std::mt19937& GetRanEng()
 {
     static std::mt19937 gen(std::random_device{}());
@@ -340,4 +360,91 @@ INTRIN_TEST(DigestFuncs, Sha256)
         EXPECT_EQ(SHA256(txt),
             "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
     }
-}
\ No newline at end of file
+}
+
+INTRIN_TEST(DigestFuncs, Sha256Block)
+{
+    const auto SHA256 = [&](std::string_view dat, size_t chunk)
+    {
+        auto hasher = Intrin->SHA256Stream();
+        for (size_t offset = 0; offset < dat.size(); offset += chunk)
+            hasher.Update(common::to_span(dat.substr(offset, chunk)));
+        return Hex2Str(hasher.Finalize());
+    };
+    for (const size_t chunk : { 1, 7, 63, 64, 65, 1000 })
+    {
+        // 0
+        EXPECT_EQ(SHA256("", chunk),
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        // 64
+        EXPECT_EQ(SHA256("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ+-", chunk),
+            "346ed961649e04951caf255f18214542cc33a81c2af7e00bf56bb1f9b8f0119e");
+        // 3
+        EXPECT_EQ(SHA256("abc", chunk),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        // 56
+        EXPECT_EQ(SHA256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", chunk),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        // 112
+        EXPECT_EQ(SHA256("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", chunk),
+            "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1");
+    }
+    {
+        // 1000000
+        std::string txt(1000000, 'a');
+        EXPECT_EQ(SHA256(txt, 4093),
+            "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+}
+
+INTRIN_TESTSUITE(HashFuncs, common::HashFuncs, common::HashFunc);
+
+INTRIN_TEST(HashFuncs, Crc32C)
+{
+    const auto CRC32C = [&](std::string_view dat, uint32_t init = 0)
+    {
+        return Intrin->CRC32C(common::to_span(dat), init);
+    };
+    // Test cases come from RFC 3720 B.4
+    EXPECT_EQ(CRC32C(""), 0x0u);
+    EXPECT_EQ(CRC32C("123456789"), 0xE3069283u);
+    EXPECT_EQ(CRC32C(std::string(32, '\x00')), 0x8A9136AAu);
+    EXPECT_EQ(CRC32C(std::string(32, '\xff')), 0x62A8AB43u);
+    {
+        std::string txt(32, '\0');
+        for (size_t i = 0; i < 32; ++i)
+            txt[i] = static_cast<char>(i);
+        EXPECT_EQ(CRC32C(txt), 0x46DD794Eu);
+    }
+    {
+        const std::string_view txt = "The quick brown fox jumps over the lazy dog, 0123456789";
+        const auto full = CRC32C(txt);
+        for (size_t i = 0; i <= txt.size(); i += 7)
+            EXPECT_EQ(CRC32C(txt.substr(i), CRC32C(txt.substr(0, i))), full) << "when split at [" << i << "]";
+    }
+}
+
+INTRIN_TEST(HashFuncs, FastHash64)
+{
+    const auto Hash64 = [&](std::string_view dat, uint64_t seed = 0)
+    {
+        return Intrin->Hash64(common::to_span(dat), seed);
+    };
+    EXPECT_EQ(Hash64(""), UINT64_C(0xef46db3751d8e999));
+    EXPECT_EQ(Hash64("abc"), UINT64_C(0x44bc2cf5ad770999));
+    EXPECT_EQ(Hash64("0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ+-"), UINT64_C(0xb1d5e12d942ae33e));
+    EXPECT_EQ(Hash64(std::string(1000, 'a')), UINT64_C(0x610e9b350db8621a));
+    EXPECT_EQ(Hash64("abc", 42), UINT64_C(0x13c1d910702770e6));
+    EXPECT_NE(Hash64("abc"), Hash64("abd"));
+    {
+        // cross-check with NAIVE on all size, across scramble boundary
+        const std::pair<std::string_view, std::string_view> req{ "FastHash64"sv, "NAIVE"sv };
+        const common::HashFuncs ref(common::span<const common::HashFuncs::VarItem>{ &req, 1 });
+        const auto ptr = reinterpret_cast<const std::byte*>(RandVals.data());
+        for (size_t size = 0; size <= 1100; size += (size < 80 ? 1 : 37))
+        {
+            const common::span<const std::byte> dat(ptr + (size % 5), size);
+            EXPECT_EQ(Intrin->Hash64(dat, size), ref.Hash64(dat, size)) << "when test on [" << size << "] bytes";
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#include "rely.h"
+#include "SystemCommon/SpinLock.h"
+#include "SystemCommon/LoopBase.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using common::AtomicWaiter;
+
+
+TEST(SpinLock, WaitTimeout)
+{
+    std::atomic<uint32_t> flag{ 0 };
+    EXPECT_TRUE(AtomicWaiter::Wait(flag, 1)); // value differs, return immediately
+    const auto t0 = std::chrono::steady_clock::now();
+    EXPECT_FALSE(AtomicWaiter::Wait(flag, 0, 20));
+    const auto elapse = std::chrono::steady_clock::now() - t0;
+    EXPECT_GE(elapse, std::chrono::milliseconds(15));
+}
+
+TEST(SpinLock, WaitNotify)
+{
+    std::atomic<uint32_t> flag{ 0 };
+    std::atomic<uint32_t> seen{ 0 };
+    std::thread thr([&]()
+        {
+            while (flag.load() == 0)
+                AtomicWaiter::Wait(flag, 0);
+            seen = flag.load();
+        });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // let it park
+    flag = 42;
+    AtomicWaiter::WakeAll(flag);
+    thr.join();
+    EXPECT_EQ(seen.load(), 42u);
+}
+
+template<typename F>
+static void RunContention(F&& func)
+{
+    constexpr uint32_t ThreadCount = 4;
+    std::vector<std::thread> thrs;
+    for (uint32_t i = 0; i < ThreadCount; ++i)
+        thrs.emplace_back([&, i]() { func(i); });
+    for (auto& thr : thrs)
+        thr.join();
+}
+
+TEST(SpinLock, SpinLocker)
+{
+    constexpr uint32_t Loops = 20000;
+    common::SpinLocker locker;
+    uint64_t counter = 0;
+    RunContention([&](uint32_t)
+        {
+            for (uint32_t i = 0; i < Loops; ++i)
+            {
+                const auto lock = locker.LockScope();
+                counter++;
+            }
+        });
+    EXPECT_EQ(counter, 4u * Loops);
+    EXPECT_TRUE(locker.TryLock());
+    EXPECT_FALSE(locker.TryLock());
+    locker.Unlock();
+}
+
+template<typename T>
+static void TestRWLock()
+{
+    constexpr uint32_t Loops = 10000;
+    T locker;
+    uint64_t counter = 0;
+    std::atomic<uint32_t> readers{ 0 };
+    std::atomic<bool> violated{ false };
+    RunContention([&](uint32_t idx)
+        {
+            for (uint32_t i = 0; i < Loops; ++i)
+            {
+                if (idx % 2 == 0)
+                {
+                    const auto lock = locker.WriteScope();
+                    if (readers.load() != 0)
+                        violated = true;
+                    counter++;
+                }
+                else
+                {
+                    const auto lock = locker.ReadScope();
+                    readers++;
+                    [[maybe_unused]] const auto val = counter;
+                    readers--;
+                }
+            }
+        });
+    EXPECT_EQ(counter, 2u * Loops);
+    EXPECT_FALSE(violated.load());
+}
+
+TEST(SpinLock, WRSpinLock)
+{
+    TestRWLock<common::WRSpinLock>();
+}
+
+TEST(SpinLock, RWSpinLock)
+{
+    TestRWLock<common::RWSpinLock>();
+}
+
+TEST(SpinLock, LoopWakeup)
+{
+    struct Loop : public common::loop::LoopBase
+    {
+        std::atomic<uint32_t> Count{ 0 };
+        Loop() : LoopBase(LoopBase::GetThreadedExecutor) { }
+        ~Loop() override { Stop(); }
+        LoopAction OnLoop() override
+        {
+            Count++;
+            return LoopAction::Sleep();
+        }
+        bool SleepCheck() noexcept override { return true; }
+        using LoopBase::Start;
+        using LoopBase::Stop;
+        using LoopBase::Wakeup;
+    };
+    Loop loop;
+    loop.Start();
+    while (loop.Count == 0)
+        std::this_thread::yield();
+    for (uint32_t i = 1; i <= 10; ++i)
+    {
+        loop.Wakeup();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (loop.Count <= i && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+        ASSERT_GT(loop.Count.load(), i);
+    }
+    loop.Stop();
+}
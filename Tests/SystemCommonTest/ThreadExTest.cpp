@@ -0,0 +1,96 @@
+#include "rely.h"
+#include "SystemCommon/ThreadEx.h"
+#include "SystemCommon/LoopBase.h"
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+#if COMMON_OS_LINUX
+#   include <sched.h>
+#endif
+
+
+TEST(ThreadEx, Topology)
+{
+    const auto& topo = common::CPUTopology::Get();
+    ASSERT_FALSE(topo.Processors.empty());
+    EXPECT_GE(topo.PackageCount, 1u);
+    EXPECT_GE(topo.NodeCount, 1u);
+    EXPECT_GE(topo.CoreCount, topo.PackageCount);
+    EXPECT_LE(topo.CoreCount, topo.Processors.size());
+    std::set<uint32_t> ids, cores;
+    for (const auto& proc : topo.Processors)
+    {
+        EXPECT_TRUE(ids.insert(proc.Id).second);
+        EXPECT_LT(proc.Core, topo.CoreCount);
+        EXPECT_LE(proc.EfficiencyClass, topo.MaxEfficiencyClass);
+        if (proc.SMTIndex == 0)
+            EXPECT_TRUE(cores.insert(proc.Core).second);
+    }
+    EXPECT_EQ(cores.size(), topo.CoreCount);
+    EXPECT_EQ(topo.GetProcessors({}, true).size(), topo.CoreCount);
+    EXPECT_FALSE(topo.GetPerformanceProcessors().empty());
+}
+
+
+#if COMMON_OS_LINUX
+
+static uint32_t PickLastProcessor()
+{
+    const auto affinity = common::ThreadObject::GetCurrentThreadObject().GetAffinity();
+    EXPECT_FALSE(affinity.empty());
+    return affinity.empty() ? 0u : affinity.back();
+}
+
+TEST(ThreadEx, Affinity)
+{
+    const auto target = PickLastProcessor();
+    std::vector<uint32_t> affinity;
+    int cpu = -1;
+    std::thread thr([&]()
+        {
+            const auto placement = common::ThreadPlacement::OnProcessors({ target });
+            EXPECT_TRUE(placement.Apply());
+            affinity = common::ThreadObject::GetCurrentThreadObject().GetAffinity();
+            cpu = sched_getcpu();
+        });
+    thr.join();
+    EXPECT_EQ(affinity, std::vector<uint32_t>{ target });
+    EXPECT_EQ(cpu, static_cast<int>(target));
+}
+
+TEST(ThreadEx, LoopPlacement)
+{
+    struct Loop : public common::loop::LoopBase
+    {
+        std::vector<uint32_t> Affinity;
+        int CPU = -1;
+        std::atomic_bool Recorded{ false };
+        Loop(common::ThreadPlacement placement) : LoopBase(LoopBase::GetPlacedExecutor(std::move(placement))) { }
+        ~Loop() override { Stop(); }
+        LoopAction OnLoop() override
+        {
+            if (!Recorded)
+            {
+                Affinity = common::ThreadObject::GetCurrentThreadObject().GetAffinity();
+                CPU = sched_getcpu();
+                Recorded = true;
+            }
+            return LoopAction::Sleep();
+        }
+        void Run()
+        {
+            Start();
+            while (!Recorded)
+                std::this_thread::yield();
+            Stop();
+        }
+    };
+    const auto target = PickLastProcessor();
+    Loop loop(common::ThreadPlacement::OnProcessors({ target }));
+    loop.Run();
+    EXPECT_EQ(loop.Affinity, std::vector<uint32_t>{ target });
+    EXPECT_EQ(loop.CPU, static_cast<int>(target));
+}
+
+#endif
@@ -0,0 +1,50 @@
+#include "rely.h"
+#include "SystemCommon/WorkerPool.h"
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+
+TEST(WorkerPool, ParallelFor)
+{
+    common::WorkerPool pool("WPTest", 4);
+    std::vector<uint32_t> hits(10000, 0);
+    pool.ParallelFor(hits.size(), 0, [&](size_t i) { hits[i]++; });
+    for (const auto hit : hits)
+        EXPECT_EQ(hit, 1u);
+}
+
+TEST(WorkerPool, Nested)
+{
+    common::WorkerPool pool("WPTest", 2);
+    std::atomic<uint32_t> counter{ 0 };
+    // inner calls run inside pool tasks while all workers are busy
+    pool.ParallelFor(16, 0, [&](size_t)
+        {
+            pool.ParallelFor(16, 0, [&](size_t) { counter++; });
+        });
+    EXPECT_EQ(counter.load(), 256u);
+}
+
+TEST(WorkerPool, Exception)
+{
+    common::WorkerPool pool("WPTest", 4);
+    std::atomic<uint32_t> counter{ 0 };
+    EXPECT_THROW(pool.ParallelFor(1000, 0, [&](size_t i)
+        {
+            counter++;
+            if (i == 100)
+                throw std::runtime_error("stop");
+        }), std::runtime_error);
+    EXPECT_LE(counter.load(), 1000u);
+}
+
+TEST(WorkerPool, Post)
+{
+    common::WorkerPool pool("WPTest", 2);
+    std::promise<uint32_t> pms;
+    auto ret = pms.get_future();
+    pool.Post([&]() { pms.set_value(42u); });
+    EXPECT_EQ(ret.get(), 42u);
+}
@@ -21,6 +21,13 @@ void TestIntrinComplete(common::span<const common::FastPathBase::PathInfo> suppo
         }
         TestCout() << "intrin [" << inst << "] use [" << choice << "] within [" << allvar << "]\n";
     }
+    for (const auto& item : host.GetTuneInfo())
+    {
+        if (item.TimeNs == UINT64_MAX)
+            TestCout() << "tune [" << item.FuncName << "] cached [" << item.MethodName << "]\n";
+        else
+            TestCout() << "tune [" << item.FuncName << "] [" << item.MethodName << "] takes [" << item.TimeNs << "]ns\n";
+    }
     EXPECT_TRUE(host.IsComplete());
 }
 
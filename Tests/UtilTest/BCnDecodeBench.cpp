@@ -0,0 +1,52 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "ImageUtil/TexDecompress.h"
+#include <random>
+#include <thread>
+
+using namespace common::mlog;
+using namespace common;
+namespace img = xziar::img;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"BCnDecodeBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static void BCnDecodeBench()
+{
+    constexpr uint32_t Size = 4096;
+    // random blocks cover all paths (3-color BC1, all BC7 modes), decode cost does not depend on content much
+    vector<std::byte> data(size_t(Size) * Size);
+    {
+        std::mt19937 gen(42);
+        for (auto& b : data)
+            b = static_cast<std::byte>(gen());
+    }
+    SimpleTimer timer;
+    for (const auto format : { img::TextureFormat::BC1, img::TextureFormat::BC3, img::TextureFormat::BC4, img::TextureFormat::BC5, img::TextureFormat::BC7 })
+    {
+        for (const uint32_t threads : { 1u, 0u })
+        {
+            constexpr uint32_t Rounds = 5;
+            uint64_t checksum = 0;
+            timer.Start();
+            for (uint32_t i = 0; i < Rounds; ++i)
+            {
+                const auto out = img::DecompressTexture(data, Size, Size, format, threads);
+                checksum += *out.GetRawPtr<uint32_t>(Size - 1, Size - 1);
+            }
+            timer.Stop();
+            const auto mpix = double(Size) * Size * Rounds / 1e6;
+            log().info(u"[{:5}] x{:<2} {:9.2f}ms, {:9.2f} MPix/s, checksum {}\n", img::TexFormatUtil::GetFormatName(format),
+                threads == 0 ? std::thread::hardware_concurrency() : threads, timer.ElapseNs() / 1e6 / Rounds, mpix / (timer.ElapseNs() / 1e9), checksum);
+        }
+    }
+    log().success(u"BCn decode bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("BCnDecodeBench", &BCnDecodeBench);
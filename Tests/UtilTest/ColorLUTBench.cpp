@@ -0,0 +1,139 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "ImageUtil/ColorLUT.h"
+#include "OpenCLUtil/OpenCLUtil.h"
+#include "SystemCommon/FileEx.h"
+#include "SystemCommon/CopyEx.h"
+#include <random>
+#include <cmath>
+#include <optional>
+#include <thread>
+
+using namespace common::mlog;
+using namespace common;
+namespace img = xziar::img;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"ColorLUTBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+// ColorLUT.cl math in double, without lut
+static double RefGrade(const double color, const double exposure)
+{
+    const double lum = exposure * color;
+    const double aces = (lum * (2.51 * lum + 0.03)) / (lum * (2.43 * lum + 0.59) + 0.14);
+    return aces <= 0.00304 ? 12.92 * aces : 1.055 * std::pow(aces, 1 / 2.4) - 0.055;
+}
+
+// bake the same lut with GenerateLUT_ACES_SRGB from ColorLUT.cl
+static std::optional<vector<float>> BakeWithCL(const uint32_t size, const float exposure)
+{
+    using namespace oclu;
+    const auto plats = oclPlatform_::GetPlatforms();
+    if (plats.empty())
+        return {};
+    try
+    {
+        static const fs::path basepath(UTF16ER(__FILE__));
+        const auto clPath = fs::path(basepath).parent_path().parent_path().parent_path() / "RenderCore" / "ColorLUT.cl";
+        const auto src = file::ReadAllText(clPath);
+        const auto dev = plats[0]->GetDefaultDevice();
+        const auto ctx = plats[0]->CreateContext(dev);
+        const auto que = oclCmdQue_::Create(ctx, dev);
+        const auto prog = oclProgram_::CreateAndBuild(ctx, src, CLProgConfig{}, dev);
+        const auto kernel = prog->GetKernel("GenerateLUT_ACES_SRGB");
+        auto lutImg = oclImage3D_::Create(ctx, MemFlag::WriteOnly | MemFlag::HostReadOnly, size, size, size, img::TextureFormat::RGBAf);
+        kernel->Call<3>(1.0f / (size - 1), lutImg, exposure)(que, { size, size, size })->WaitFinish();
+        vector<float> data(size_t(size) * size * size * 4);
+        lutImg->ReadSpan(que, as_writable_bytes(to_span(data)))->WaitFinish();
+        return data;
+    }
+    catch (const BaseException& be)
+    {
+        log().warning(u"unable to bake lut with OpenCL: {}\n", be.Message());
+        return {};
+    }
+}
+
+static void ColorLUTBench()
+{
+    constexpr uint32_t LutSize = 32, Width = 3840, Height = 2160;
+    constexpr float Exposure = 1.5f;
+    const auto lut = img::ColorLUT3D::Bake(LutSize, img::LUTToneMap::ACES, Exposure);
+    if (const auto clLut = BakeWithCL(LutSize, Exposure); clLut)
+    {
+        const auto cpuLut = lut.GetData();
+        float maxDiff = 0;
+        // last entry maps to inf on CL side
+        for (size_t i = 0; i < cpuLut.size(); ++i)
+            if (std::isfinite((*clLut)[i]))
+                maxDiff = std::max(maxDiff, std::abs(cpuLut[i] - (*clLut)[i]));
+        log().info(u"CPU lut vs CL lut: max diff [{:.3e}]\n", maxDiff);
+    }
+    else
+        log().info(u"no OpenCL device, skip comparing with CL lut\n");
+
+    img::Image imgF(img::ImageDataType::RGBAf), img8(img::ImageDataType::RGBA);
+    imgF.SetSize(Width, Height);
+    img8.SetSize(Width, Height);
+    {
+        std::mt19937 gen(42);
+        std::exponential_distribution<float> dist(2.0f);
+        auto ptrF = imgF.GetRawPtr<float>();
+        auto ptr8 = img8.GetRawPtr<uint8_t>();
+        for (size_t i = 0; i < imgF.PixelCount() * 4; ++i)
+        {
+            ptrF[i] = (i % 4 == 3) ? 1.0f : dist(gen);
+            ptr8[i] = static_cast<uint8_t>(gen());
+        }
+    }
+    // accuracy against direct evaluation
+    for (const auto interp : { img::LUTInterp::Trilinear, img::LUTInterp::Tetrahedral })
+    {
+        const auto out = lut.Apply(imgF, interp);
+        const auto src = imgF.GetRawPtr<float>();
+        const auto dst = out.GetRawPtr<float>();
+        double maxErr = 0, sumErr = 0;
+        for (size_t i = 0; i < imgF.PixelCount() * 4; ++i)
+        {
+            if (i % 4 == 3)
+                continue;
+            const auto err = std::abs(dst[i] - RefGrade(src[i], Exposure));
+            maxErr = std::max(maxErr, err);
+            sumErr += err;
+        }
+        log().info(u"[{}] max err [{:.3e}], avg err [{:.3e}]\n", interp == img::LUTInterp::Tetrahedral ? u"tetrahedral" : u"trilinear",
+            maxErr, sumErr / (imgF.PixelCount() * 3));
+    }
+
+    SimpleTimer timer;
+    const auto run = [&](const char16_t* name, auto&& func)
+    {
+        constexpr uint32_t Rounds = 5;
+        timer.Start();
+        for (uint32_t i = 0; i < Rounds; ++i)
+            func();
+        timer.Stop();
+        const auto mpix = double(Width) * Height * Rounds / 1e6;
+        log().info(u"[{:16}] {:9.2f}ms, {:8.2f} MPix/s\n", name, timer.ElapseNs() / 1e6 / Rounds, mpix / (timer.ElapseNs() / 1e9));
+    };
+    vector<uint16_t> half(imgF.PixelCount() * 4);
+    CopyEx.CopyFloat(half.data(), imgF.GetRawPtr<float>(), half.size());
+    for (const uint32_t threads : { 1u, 0u })
+    {
+        log().info(u"threads: {}\n", threads == 0 ? std::thread::hardware_concurrency() : threads);
+        run(u"RGBA8 trilinear", [&]() { return lut.Apply(img8, img::LUTInterp::Trilinear, threads); });
+        run(u"RGBA8 tetra", [&]() { return lut.Apply(img8, img::LUTInterp::Tetrahedral, threads); });
+        run(u"RGBAf trilinear", [&]() { return lut.Apply(imgF, img::LUTInterp::Trilinear, threads); });
+        run(u"RGBAf tetra", [&]() { return lut.Apply(imgF, img::LUTInterp::Tetrahedral, threads); });
+        run(u"RGBA16F tetra", [&]() { lut.ApplyHalf(half, img::LUTInterp::Tetrahedral, threads); });
+    }
+    log().success(u"ColorLUT bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("ColorLUTBench", &ColorLUTBench);
@@ -0,0 +1,110 @@
+#include "TestRely.h"
+#include "SystemCommon/MiscIntrins.h"
+#include "SystemCommon/StringConvert.h"
+#include "common/TimeUtil.hpp"
+#include <algorithm>
+#include <iostream>
+#include <unordered_set>
+
+using namespace common::mlog;
+using namespace common;
+using namespace std::string_view_literals;
+using std::vector;
+using std::u32string;
+using std::u32string_view;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"HashBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static vector<u32string> ExtractIdentifiers(u32string_view txt)
+{
+    constexpr auto IsHead = [](char32_t ch) { return (ch >= U'a' && ch <= U'z') || (ch >= U'A' && ch <= U'Z') || ch == U'_'; };
+    constexpr auto IsBody = [](char32_t ch) { return (ch >= U'a' && ch <= U'z') || (ch >= U'A' && ch <= U'Z') || ch == U'_' || (ch >= U'0' && ch <= U'9') || ch == U'.'; };
+    std::unordered_set<u32string_view> names;
+    for (size_t i = 0; i < txt.size();)
+    {
+        if (!IsHead(txt[i]))
+        {
+            i++; continue;
+        }
+        size_t j = i + 1;
+        while (j < txt.size() && IsBody(txt[j])) j++;
+        names.insert(txt.substr(i, j - i));
+        i = j;
+    }
+    return { names.begin(), names.end() };
+}
+
+template<typename F>
+static void BenchHasher(std::u16string_view name, const vector<u32string>& idents, F&& hasher)
+{
+    constexpr uint32_t Rounds = 50;
+    size_t bytes = 0;
+    for (const auto& ident : idents)
+        bytes += ident.size() * sizeof(char32_t);
+    vector<uint64_t> hashes(idents.size());
+    SimpleTimer timer;
+    timer.Start();
+    for (uint32_t r = 0; r < Rounds; ++r)
+    {
+        for (size_t i = 0; i < idents.size(); ++i)
+            hashes[i] = hasher(u32string_view(idents[i]));
+    }
+    timer.Stop();
+    const auto perItem = static_cast<double>(timer.ElapseNs()) / (Rounds * idents.size());
+    const auto throughput = static_cast<double>(bytes) * Rounds / timer.ElapseNs() * 1e3; // MB/s
+
+    // collision in full hash, and in a power-of-2 bucket table like hashmap does
+    const auto fullUnique = std::unordered_set<uint64_t>(hashes.begin(), hashes.end()).size();
+    uint32_t bits = 1;
+    while ((size_t(1) << bits) < idents.size()) bits++;
+    const auto mask = (uint64_t(1) << bits) - 1;
+    vector<uint32_t> buckets(size_t(1) << bits, 0);
+    for (const auto hash : hashes)
+        buckets[hash & mask]++;
+    const auto maxLoad = *std::max_element(buckets.begin(), buckets.end());
+    const auto usedBuckets = std::count_if(buckets.begin(), buckets.end(), [](auto cnt) { return cnt > 0; });
+    log().info(u"[{:<16}] {:7.2f}ns/ident, {:8.1f}MB/s, full-collision [{}], bucket(2^{}) used [{}/{}] maxload [{}]\n",
+        name, perItem, throughput, idents.size() - fullUnique, bits, usedBuckets, idents.size(), maxLoad);
+}
+
+static void HashBench()
+{
+    const auto defPath = FindPath() / u"Tests" / u"Blur" / u"iirblur.nlcl";
+    log().info(u"input Nailang source file, empty for [{}]:\n", defPath.u16string());
+    std::string fpath;
+    std::getline(std::cin, fpath);
+    const common::fs::path filepath = fpath.empty() ? defPath : common::fs::path(fpath);
+    const auto txt = str::to_u32string(common::file::ReadAllText(filepath), str::Encoding::UTF8);
+    auto idents = ExtractIdentifiers(txt);
+    log().debug(u"[{}] unique identifiers from source\n", idents.size());
+    // identifier-heavy workload: mimic generated names like instantiated templates and local vars
+    const auto baseCount = idents.size();
+    for (size_t i = 0; baseCount > 0 && idents.size() < 200000; ++i)
+        idents.push_back(idents[i % baseCount] + U"_" + str::to_u32string(std::to_string(i / baseCount), str::Encoding::UTF8));
+    log().debug(u"[{}] identifiers after expansion\n", idents.size());
+
+    BenchHasher(u"DJBHash", idents, [](u32string_view str) { return DJBHash::HashC(str); });
+    BenchHasher(u"FastStrHash", idents, [](u32string_view str) { return FastStrHash::HashC(str); });
+    for (const auto& path : HashFuncs::GetSupportMap())
+    {
+        for (const auto& var : path.Variants)
+        {
+            const std::pair<std::string_view, std::string_view> req{ path.FuncName, var.MethodName };
+            const HashFuncs host(common::span<const HashFuncs::VarItem>{ &req, 1 });
+            const auto name = str::to_u16string(std::string(path.FuncName.View).append("/").append(var.MethodName.View), str::Encoding::UTF8);
+            if (path.FuncName == "Crc32C"sv)
+                BenchHasher(name, idents, [&](u32string_view str) { return uint64_t(host.CRC32C(common::span<const char32_t>(str.data(), str.size()))); });
+            else
+                BenchHasher(name, idents, [&](u32string_view str) { return host.Hash64(common::span<const char32_t>(str.data(), str.size())); });
+        }
+    }
+    log().success(u"Hash bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("HashBench", &HashBench);
@@ -0,0 +1,89 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "ImageUtil/ImageUtil.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+using namespace common::mlog;
+using namespace common;
+namespace img = xziar::img;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"ImageBatchBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static vector<fs::path> CollectImages(const fs::path& dir)
+{
+    vector<fs::path> paths;
+    for (const auto& entry : fs::recursive_directory_iterator(dir))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        auto ext = entry.path().extension().u16string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](char16_t ch) { return (ch >= u'A' && ch <= u'Z') ? ch - u'A' + u'a' : ch; });
+        if (ext == u".png" || ext == u".jpg" || ext == u".jpeg" || ext == u".tga" || ext == u".bmp")
+            paths.push_back(entry.path());
+    }
+    return paths;
+}
+
+static void ImageBatchBench()
+{
+    log().info(u"input directory of images (e.g. textures of a material library):\n");
+    std::string dir;
+    std::getline(std::cin, dir);
+    const auto paths = CollectImages(dir);
+    if (paths.empty())
+    {
+        log().error(u"no image found\n");
+        getchar();
+        return;
+    }
+    log().info(u"[{}] images found\n", paths.size());
+    SimpleTimer timer;
+
+    size_t bytes0 = 0;
+    timer.Start();
+    for (const auto& path : paths)
+    {
+        try
+        {
+            bytes0 += img::ReadImage(path).GetSize();
+        }
+        catch (const BaseException&) {}
+    }
+    timer.Stop();
+    const auto serialMs = timer.ElapseNs() / 1e6;
+    log().info(u"[serial  ] {:9.2f}ms, {:.1f}MB decoded\n", serialMs, bytes0 / 1048576.0);
+
+    for (const uint32_t parallelism : { 2u, 4u, 0u })
+    {
+        vector<img::ImageReadRequest> reqs;
+        for (const auto& path : paths)
+            reqs.push_back({ path, img::ImageDataType::RGBA });
+        size_t bytes1 = 0;
+        timer.Start();
+        auto results = img::ReadImages(std::move(reqs), parallelism);
+        for (auto& pms : results)
+        {
+            try
+            {
+                bytes1 += pms->Get().GetSize();
+            }
+            catch (const BaseException&) {}
+        }
+        timer.Stop();
+        const auto batchMs = timer.ElapseNs() / 1e6;
+        log().info(u"[batch x{}] {:9.2f}ms, {:.1f}MB decoded, {:5.2f}x\n", parallelism == 0 ? std::thread::hardware_concurrency() : parallelism,
+            batchMs, bytes1 / 1048576.0, serialMs / batchMs);
+    }
+    log().success(u"ImageBatch bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("ImageBatchBench", &ImageBatchBench);
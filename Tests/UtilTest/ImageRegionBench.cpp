@@ -0,0 +1,53 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "ImageUtil/ImageUtil.h"
+#include <random>
+
+using namespace common::mlog;
+using namespace common;
+namespace img = xziar::img;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"ImageRegionBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static void ImageRegionBench()
+{
+    // split an atlas into tiles, then downsample each tile
+    constexpr uint32_t AtlasSize = 8192, TileSize = 256;
+    img::Image atlas(img::ImageDataType::RGBA);
+    atlas.SetSize(AtlasSize, AtlasSize);
+    {
+        std::mt19937 gen(42);
+        auto ptr = atlas.GetRawPtr<uint32_t>();
+        for (size_t i = 0; i < atlas.PixelCount(); ++i)
+            ptr[i] = gen();
+    }
+    SimpleTimer timer;
+    const auto run = [&](const char16_t* name, auto&& func)
+    {
+        uint64_t checksum = 0;
+        timer.Start();
+        for (uint32_t y = 0; y < AtlasSize; y += TileSize)
+            for (uint32_t x = 0; x < AtlasSize; x += TileSize)
+                checksum += func(x, y);
+        timer.Stop();
+        log().info(u"[{:12}] {:9.2f}ms, checksum {}\n", name, timer.ElapseNs() / 1e6, checksum);
+    };
+    const auto sumOf = [](const img::Image& tile) { return static_cast<uint64_t>(*tile.GetRawPtr<uint32_t>(tile.GetHeight() - 1, tile.GetWidth() - 1)); };
+
+    run(u"copy crop", [&](uint32_t x, uint32_t y) { return sumOf(atlas.Region(x, y, TileSize, TileSize)); });
+    run(u"view crop", [&](uint32_t x, uint32_t y) { return sumOf(atlas.RegionView(x, y, TileSize, TileSize).ToImage()); });
+    run(u"copy+resize", [&](uint32_t x, uint32_t y) { return sumOf(atlas.Region(x, y, TileSize, TileSize).ResizeTo(TileSize / 4, TileSize / 4)); });
+    run(u"view+resize", [&](uint32_t x, uint32_t y) { return sumOf(atlas.RegionView(x, y, TileSize, TileSize).ResizeTo(TileSize / 4, TileSize / 4)); });
+    run(u"copy+convert", [&](uint32_t x, uint32_t y) { return sumOf(atlas.Region(x, y, TileSize, TileSize).ConvertTo(img::ImageDataType::BGR)); });
+    run(u"view+convert", [&](uint32_t x, uint32_t y) { return sumOf(atlas.RegionView(x, y, TileSize, TileSize).ConvertTo(img::ImageDataType::BGR)); });
+    log().success(u"ImageRegion bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("ImageRegionBench", &ImageRegionBench);
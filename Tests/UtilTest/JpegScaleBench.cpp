@@ -0,0 +1,70 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "ImageUtil/ImageUtil.h"
+#include <iostream>
+#include <random>
+
+using namespace common::mlog;
+using namespace common;
+namespace img = xziar::img;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"JpegScaleBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static vector<std::byte> PrepareJpeg()
+{
+    log().info(u"input jpeg file, empty to generate a 6000x4000 one:\n");
+    std::string fpath;
+    std::getline(std::cin, fpath);
+    if (!fpath.empty())
+        return file::ReadAll<std::byte>(fpath);
+    // smooth gradient with noise, close to a photo in entropy
+    img::Image src(img::ImageDataType::RGB);
+    src.SetSize(6000, 4000);
+    std::mt19937 gen(42);
+    for (uint32_t y = 0; y < src.GetHeight(); ++y)
+    {
+        auto ptr = src.GetRawPtr<uint8_t>(y);
+        for (uint32_t x = 0; x < src.GetWidth(); ++x)
+        {
+            const auto noise = static_cast<int32_t>(gen() % 32);
+            *ptr++ = static_cast<uint8_t>((x * 255 / src.GetWidth() + noise) & 0xff);
+            *ptr++ = static_cast<uint8_t>((y * 255 / src.GetHeight() + noise) & 0xff);
+            *ptr++ = static_cast<uint8_t>(((x + y) / 64 * 16 + noise) & 0xff);
+        }
+    }
+    return img::WriteImage<std::byte>(src, u"jpg", 90);
+}
+
+static void JpegScaleBench()
+{
+    const auto data = PrepareJpeg();
+    SimpleTimer timer;
+    timer.Start();
+    const auto full = img::ReadImage(data, u"jpg", img::ImageDataType::RGB);
+    timer.Stop();
+    log().info(u"[{}x{}] full decode: {:8.2f}ms, {:6.1f}MB\n", full.GetWidth(), full.GetHeight(), timer.ElapseNs() / 1e6, full.GetSize() / 1048576.0);
+
+    for (const uint32_t target : { 3000u, 1500u, 750u, 256u })
+    {
+        timer.Start();
+        const auto resized = img::ReadImage(data, u"jpg", img::ImageDataType::RGB).ResizeTo(target, 0);
+        timer.Stop();
+        const auto t0 = timer.ElapseNs() / 1e6;
+        timer.Start();
+        const auto scaled = img::ReadImage(data, u"jpg", target, target, img::ImageDataType::RGB);
+        timer.Stop();
+        const auto t1 = timer.ElapseNs() / 1e6;
+        log().info(u"target[{:4}] decode+resize: {:8.2f}ms [{}x{}], scaled decode: {:8.2f}ms [{}x{}], {:5.2f}x\n",
+            target, t0, resized.GetWidth(), resized.GetHeight(), t1, scaled.GetWidth(), scaled.GetHeight(), t0 / t1);
+    }
+    log().success(u"JpegScale bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("JpegScaleBench", &JpegScaleBench);
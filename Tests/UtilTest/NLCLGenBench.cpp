@@ -0,0 +1,71 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "OpenCLUtil/OpenCLUtil.h"
+#include "OpenCLUtil/oclNLCL.h"
+#include "XComputeBase/XCompNailang.h"
+#include <iostream>
+
+using namespace common::mlog;
+using namespace common;
+using namespace oclu;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"NLCLGenBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+// whole XCNL generation (DirectOutput, replacement and UTF-8 encoding) on real NLCL files, without building
+static void NLCLGenBench()
+{
+    const auto plats = oclPlatform_::GetPlatforms();
+    std::vector<oclDevice> devs;
+    for (const auto& plat : plats)
+    {
+        for (const auto& dev : plat->GetDevices())
+            devs.push_back(dev);
+    }
+    if (devs.empty())
+    {
+        log().error(u"No OpenCL device found!\n");
+        return;
+    }
+    const auto dev = devs[SelectIdx(devs, u"device", [](const auto& dev) { return dev->Name; })];
+    log().info(u"Use device [{}].\n", dev->Name);
+
+    constexpr uint32_t Loops = 20;
+    const auto defPath = FindPath() / u"Tests" / u"Blur" / u"iirblur.nlcl";
+    NLCLProcessor proc;
+    while (true)
+    {
+        log().info(u"input NLCL file, empty for [{}], \"exit\" to quit:\n", defPath.u16string());
+        std::string fpath;
+        std::getline(std::cin, fpath);
+        if (fpath == "exit")
+            break;
+        const common::fs::path filepath = fpath.empty() ? defPath : common::fs::path(fpath);
+        try
+        {
+            const auto source = common::file::ReadAll<std::byte>(filepath);
+            const auto prog = proc.Parse(source, filepath.filename().u16string());
+            size_t outputSize = 0;
+            SimpleTimer timer;
+            timer.Start();
+            for (uint32_t i = 0; i < Loops; ++i)
+                outputSize = proc.ProcessCL(prog, dev)->GetNewSource().size();
+            timer.Stop();
+            log().info(u"[{}]: [{}] bytes source, [{}] bytes output, {:8.3f}ms per generation\n", filepath.filename().u16string(),
+                source.size(), outputSize, timer.ElapseNs() / 1e6 / Loops);
+        }
+        catch (const BaseException& be)
+        {
+            log().error(u"Error: {}\n", be.Message());
+        }
+    }
+    log().success(u"NLCL generation bench over!\n");
+}
+
+const static uint32_t ID = RegistTest("NLCLGenBench", &NLCLGenBench);
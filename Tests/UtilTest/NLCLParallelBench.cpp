@@ -0,0 +1,103 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "OpenCLUtil/OpenCLUtil.h"
+#include "OpenCLUtil/oclNLCL.h"
+#include "XComputeBase/XCompNailang.h"
+
+using namespace common::mlog;
+using namespace common;
+using namespace oclu;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"NLCLParallelBench", { GetConsoleBackend() });
+    return log;
+}
+#define APPEND_FMT(str, syntax, ...) fmt::format_to(std::back_inserter(str), FMT_STRING(syntax), __VA_ARGS__)
+
+
+// many independent kernels sharing a few patched helpers, like a large generated kernel library
+static std::string GenerateProgram(const uint32_t count)
+{
+    std::string source = R"(
+#Block.oclu.Prepare("bench")
+{
+    `DefType = "uint";
+}
+)";
+    constexpr std::string_view Mimics[] = { "plain"sv, "auto"sv };
+    constexpr std::string_view Signs[] = { "uu"sv, "ss"sv, "us"sv, "su"sv };
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        APPEND_FMT(source, R"(
+@xcomp.Replace()
+@oclu.Dp4aExt("{}")
+@oclu.BufArg("global", "uint", "src", "const restrict")
+@oclu.BufArg("global", "uint", "dst", "      restrict")
+@oclu.SimpleArg("",    "uint", "count", "const")
+#Raw.oclu.Kernel("kernel_{}")
+{{@@Kernel
+    const $$!{{#DefType}} gid = get_global_id(0);
+    uint acc = {};
+    for (uint i = 0; i < count; ++i)
+    {{
+        const uint a = src[gid * count + i], b = src[i];
+        acc = $$!oclu.Dp4a({}, acc, as_uchar4(a), as_uchar4(b));
+    }}
+    dst[gid] = acc;
+@@Kernel}}
+)", Mimics[i % 2], i, i, Signs[i % 4]);
+    }
+    return source;
+}
+
+static void NLCLParallelBench()
+{
+    const auto plats = oclPlatform_::GetPlatforms();
+    std::vector<oclDevice> devs;
+    for (const auto& plat : plats)
+    {
+        for (const auto& dev : plat->GetDevices())
+            devs.push_back(dev);
+    }
+    if (devs.empty())
+    {
+        log().error(u"No OpenCL device found!\n");
+        return;
+    }
+    const auto dev = devs[SelectIdx(devs, u"device", [](const auto& dev) { return dev->Name; })];
+    log().info(u"Use device [{}].\n", dev->Name);
+
+    for (const uint32_t count : { 64u, 256u, 1024u })
+    {
+        const auto source = GenerateProgram(count);
+        NLCLProcessor proc;
+        const auto prog = proc.Parse(common::as_bytes(common::to_span(source)), u"bench.nlcl");
+        std::string baseline;
+        uint64_t baselineNs = 0;
+        for (const uint32_t threads : { 1u, 2u, 4u, 8u })
+        {
+            proc.SetParallelism(threads);
+            SimpleTimer timer;
+            timer.Start();
+            const auto result = proc.ProcessCL(prog, dev);
+            timer.Stop();
+            const auto output = result->GetNewSource();
+            if (threads == 1)
+            {
+                baseline.assign(output);
+                baselineNs = timer.ElapseNs();
+            }
+            log().info(u"[{:4}] kernels, [{}] threads: {:8.3f}ms, x{:.2f}\n", count, threads,
+                timer.ElapseNs() / 1e6, static_cast<double>(baselineNs) / timer.ElapseNs());
+            if (output != baseline)
+                log().error(u"output mismatch with [{}] threads!\n", threads);
+        }
+    }
+    log().success(u"NLCL parallel bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("NLCLParallelBench", &NLCLParallelBench);
@@ -0,0 +1,98 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "Nailang/NailangParser.h"
+#include "Nailang/NailangOptimizer.h"
+
+using namespace common::mlog;
+using namespace common;
+using namespace xziar::nailang;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"NailangOptBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+struct BenchParser : public NailangParser
+{
+    using NailangParser::NailangParser;
+    static Block GetBlock(MemoryPool& pool, const std::u32string_view src)
+    {
+        common::parser::ParserContext context(src);
+        BenchParser parser(pool, context);
+        Block ret;
+        parser.ParseContentIntoBlock(true, ret);
+        return ret;
+    }
+};
+
+// mimics config blocks of NLCL: config-dependent branches, math on literals and string concatenations
+static std::u32string GenerateScript(const uint32_t count)
+{
+    std::u32string script;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const auto idx = std::to_string(i);
+        const std::u32string id(idx.begin(), idx.end());
+        script.append(UR"(
+@If(($Math.Max(4, 8) * 2) >= 16)
+    :v)").append(id).append(UR"( := "u32v" + $Format("{}", 4);
+@Else()
+    :v)").append(id).append(UR"( := "u8";
+@MetaIf(false, "Skip")
+:w)").append(id).append(UR"( := $Math.Log2(1024) + ()").append(id).append(UR"( % 3) + Width;
+@Skip(1 > 2)
+:x)").append(id).append(UR"( := (true ? "fast" : "slow") + "-" + $Format("{}x{}", 16, 16);
+@If(Width > 1024)
+:y)").append(id).append(UR"( := $Math.Ceil(Width / 64.0);
+)");
+    }
+    return script;
+}
+
+static uint64_t RunBlock(NailangBasicRuntime& runtime, const Block& block, const uint32_t loops)
+{
+    SimpleTimer timer;
+    timer.Start();
+    for (uint32_t i = 0; i < loops; ++i)
+    {
+        auto ctx = std::make_shared<CompactEvaluateContext>();
+        ctx->LocateArg(U"Width"sv, true).Set(uint64_t(1920));
+        runtime.ExecuteBlock(block, {}, std::move(ctx));
+    }
+    timer.Stop();
+    return timer.ElapseNs();
+}
+
+static void NailangOptBench()
+{
+    constexpr uint32_t Count = 64, Loops = 2000;
+    const auto script = GenerateScript(Count);
+    MemoryPool pool;
+    const auto block = BenchParser::GetBlock(pool, script);
+
+    NailangOptimizer optimizer(pool);
+    const auto optBlock = optimizer.OptimizeBlock(block);
+    const auto& stats = optimizer.GetStats();
+    log().info(u"optimized [{}] statements into [{}] in {:.3f}ms\n", block.Size(), optBlock.Size(), stats.TimeNs / 1e6);
+    log().info(u"folded [{}] exprs, [{}] funcs, decided [{}] metas, removed [{}] statements, interned [{}] strs\n",
+        stats.FoldedExprs, stats.FoldedFuncs, stats.DecidedMetas, stats.RemovedStatements, stats.InternedStrs);
+
+    NailangBasicRuntime runtime(std::make_shared<CompactEvaluateContext>());
+    // warm up
+    RunBlock(runtime, block, 10);
+    RunBlock(runtime, optBlock, 10);
+    const auto rawNs = RunBlock(runtime, block, Loops);
+    const auto optNs = RunBlock(runtime, optBlock, Loops);
+    log().info(u"[original ] {:8.2f}us per expansion\n", rawNs / 1e3 / Loops);
+    log().info(u"[optimized] {:8.2f}us per expansion, saved {:.1f}%, optimization pays off after [{}] expansions\n",
+        optNs / 1e3 / Loops, (1.0 - double(optNs) / double(rawNs)) * 100.0,
+        rawNs > optNs ? (stats.TimeNs * Loops + (rawNs - optNs) - 1) / (rawNs - optNs) : 0);
+    log().success(u"Nailang optimization bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("NailangOptBench", &NailangOptBench);
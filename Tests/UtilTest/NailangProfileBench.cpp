@@ -0,0 +1,107 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "Nailang/NailangParser.h"
+#include "Nailang/NailangRuntime.h"
+#include "Nailang/NailangProfiler.h"
+#include "SystemCommon/StringConvert.h"
+
+using namespace common::mlog;
+using namespace common;
+using namespace xziar::nailang;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"NailangProfileBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+struct ProfBenchParser : public NailangParser
+{
+    using NailangParser::NailangParser;
+    static Block GetBlock(MemoryPool& pool, const std::u32string_view src)
+    {
+        common::parser::ParserContext context(src);
+        ProfBenchParser parser(pool, context);
+        Block ret;
+        parser.ParseContentIntoBlock(true, ret);
+        return ret;
+    }
+};
+
+// call-heavy script, so that the per-scope cost dominates
+static constexpr auto BenchScript = UR"(
+@DefFunc(m,n)
+#Block("gcd")
+{
+    tmp := m % n;
+    @If(tmp==0)
+    $Return(n);
+    $Return($gcd(n, tmp));
+}
+@DefFunc(x)
+#Block("square")
+{
+    $Return(x * x);
+}
+@While(i < 200)
+#Block("loop")
+{
+    val = $gcd(832040, 514229) + $square(i) + $Math.Max(i, 3);
+    i += 1;
+}
+)"sv;
+
+static uint64_t RunBlock(NailangBasicRuntime& runtime, const Block& block, const uint32_t loops)
+{
+    SimpleTimer timer;
+    timer.Start();
+    for (uint32_t i = 0; i < loops; ++i)
+    {
+        auto ctx = std::make_shared<CompactEvaluateContext>();
+        ctx->LocateArg(U"i"sv, true).Set(int64_t(0));
+        runtime.ExecuteBlock(block, {}, std::move(ctx), false);
+    }
+    timer.Stop();
+    return timer.ElapseNs();
+}
+
+static void NailangProfileBench()
+{
+    constexpr uint32_t Loops = 50;
+    MemoryPool pool;
+    const auto block = ProfBenchParser::GetBlock(pool, BenchScript);
+    NailangBasicRuntime runtime(std::make_shared<CompactEvaluateContext>());
+    NailangProfiler profiler;
+
+    // warm up
+    RunBlock(runtime, block, 2);
+    const auto offNs = RunBlock(runtime, block, Loops);
+    runtime.SetProfiler(&profiler);
+    const auto onNs = RunBlock(runtime, block, Loops);
+    runtime.SetProfiler(nullptr);
+
+    uint64_t scopes = 0;
+    for (const auto& node : profiler.GetNodes())
+        scopes += node.Count;
+    log().info(u"[disabled] {:8.3f}ms per run\n", offNs / 1e6 / Loops);
+    log().info(u"[enabled ] {:8.3f}ms per run, [{}] scopes per run, {:.1f}ns overhead per scope ({:.1f}%)\n",
+        onNs / 1e6 / Loops, scopes / Loops, onNs > offNs ? double(onNs - offNs) / scopes : 0.0,
+        (double(onNs) / double(offNs) - 1.0) * 100.0);
+
+    const auto summaries = profiler.Summarize();
+    log().info(u"{:>10} {:>10} {:>10}  {}\n", u"count"sv, u"incl(ms)"sv, u"excl(ms)"sv, u"name"sv);
+    for (const auto& summary : summaries)
+    {
+        log().info(u"{:>10} {:>10.3f} {:>10.3f}  [{}]{}\n", summary.Count, summary.InclusiveNs / 1e6, summary.ExclusiveNs / 1e6,
+            NailangProfiler::GetCategoryName(summary.Type), summary.Name);
+    }
+    const auto folded = profiler.ExportFoldedStacks();
+    log().info(u"folded stacks:\n{}\n", common::str::to_u16string(folded, common::str::Encoding::UTF8));
+    log().success(u"Nailang profile bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("NailangProfileBench", &NailangProfileBench);
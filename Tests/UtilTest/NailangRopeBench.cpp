@@ -0,0 +1,97 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "Nailang/NailangParser.h"
+#include "Nailang/NailangRope.h"
+#include "SystemCommon/StringConvert.h"
+
+using namespace common::mlog;
+using namespace common;
+using namespace xziar::nailang;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"NailangRopeBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+struct RopeBenchReplacer : public ReplaceEngine
+{
+    void OnReplaceVariable(TextRope& output, void*, std::u32string_view var) override
+    {
+        if (var == U"@vec"sv)
+            output.append(U"float4"sv);
+        else
+            output.append(U"16"sv);
+    }
+    using ReplaceEngine::ProcessVariable;
+};
+
+// mimics kernel blocks of a large NLCL file: long plain code with sparse replacements
+static std::u32string GenerateSource(const uint32_t count)
+{
+    std::u32string source;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const auto idx = std::to_string(i);
+        const std::u32string id(idx.begin(), idx.end());
+        source.append(UR"(
+    // stage )").append(id).append(UR"( of the reduction, shared memory is reused between stages
+    const uint lid)").append(id).append(UR"( = get_local_id(0), gid)").append(id).append(UR"( = get_global_id(0);
+    $$!{@vec} val)").append(id).append(UR"( = vload4(gid)").append(id).append(UR"(, src) * ($$!{@vec})(scale);
+    for (uint step = $$!{width} / 2; step > 0; step >>= 1)
+    {
+        if (lid)").append(id).append(UR"( < step)
+            tmp[lid)").append(id).append(UR"(] += tmp[lid)").append(id).append(UR"( + step];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+)");
+    }
+    return source;
+}
+
+static void NailangRopeBench()
+{
+    constexpr uint32_t Loops = 20;
+    const auto source = GenerateSource(20000);
+    RopeBenchReplacer replacer;
+
+    std::string strOutput, ropeOutput;
+    size_t strBytes = 0, ropeBytes = 0, segments = 0;
+    SimpleTimer timer;
+    // previous path: replace into a u32string then convert the whole string
+    timer.Start();
+    for (uint32_t i = 0; i < Loops; ++i)
+    {
+        const auto u32 = replacer.ProcessVariable(source, U"$$!{"sv, U"}"sv);
+        strOutput = common::str::to_string(u32, common::str::Encoding::UTF8, common::str::Encoding::UTF32);
+        strBytes = u32.capacity() * sizeof(char32_t);
+    }
+    timer.Stop();
+    const auto strNs = timer.ElapseNs();
+    // rope path: reference the source and encode once
+    timer.Start();
+    for (uint32_t i = 0; i < Loops; ++i)
+    {
+        TextRope rope;
+        replacer.ProcessVariable(rope, source, U"$$!{"sv, U"}"sv);
+        ropeOutput = rope.ToUTF8();
+        ropeBytes = rope.OwnedBytes();
+        segments = rope.SegmentCount();
+    }
+    timer.Stop();
+    const auto ropeNs = timer.ElapseNs();
+
+    log().info(u"source: [{}] chars, output: [{}] bytes\n", source.size(), ropeOutput.size());
+    log().info(u"[u32string] {:8.3f}ms per run, {:8.1f}KB intermediate\n", strNs / 1e6 / Loops, strBytes / 1024.0);
+    log().info(u"[rope     ] {:8.3f}ms per run, {:8.1f}KB intermediate, [{}] segments\n", ropeNs / 1e6 / Loops, ropeBytes / 1024.0, segments);
+    if (strOutput != ropeOutput)
+        log().error(u"output mismatch!\n");
+    else
+        log().success(u"Nailang rope bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("NailangRopeBench", &NailangRopeBench);
@@ -0,0 +1,158 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "XComputeBase/XCompNailang.h"
+
+using namespace common::mlog;
+using namespace common;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"NamedTextBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+struct PatchInfo
+{
+    std::u32string ID;
+    std::u32string Content;
+    std::vector<std::u32string> Depends;
+};
+
+static std::u32string PatchName(const uint32_t idx)
+{
+    const auto str = std::to_string(idx);
+    return U"patch_helper_" + std::u32string(str.begin(), str.end());
+}
+
+// each patch depends on an earlier one, some also depend on a later one (late bind)
+static std::vector<PatchInfo> GeneratePatches(const uint32_t count)
+{
+    std::vector<PatchInfo> patches;
+    patches.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto& patch = patches.emplace_back();
+        patch.ID = PatchName(i);
+        patch.Content = U"inline void " + patch.ID + U"() { }";
+        if (i > 0)
+            patch.Depends.push_back(PatchName(i / 2));
+        if (i % 3 == 0 && i + 1 < count)
+            patch.Depends.push_back(PatchName(i + 1));
+    }
+    return patches;
+}
+
+// previous approach: linear lookup for each add, scan whole container each round for output
+struct LinearHolder
+{
+    struct Item
+    {
+        const PatchInfo* Patch;
+        std::vector<uint32_t> Depends;
+    };
+    std::vector<Item> Items;
+    std::optional<uint32_t> Find(std::u32string_view id) const noexcept
+    {
+        for (uint32_t i = 0; i < Items.size(); ++i)
+        {
+            if (Items[i].Patch->ID == id)
+                return i;
+        }
+        return {};
+    }
+    void Add(const PatchInfo& patch)
+    {
+        if (Find(patch.ID))
+            return;
+        auto& item = Items.emplace_back();
+        item.Patch = &patch;
+        for (const auto& dep : patch.Depends)
+            item.Depends.push_back(Find(dep).value_or(UINT32_MAX));
+    }
+    std::u32string Write() const
+    {
+        std::u32string output;
+        std::vector<bool> outputMask(Items.size(), false);
+        size_t waiting = Items.size();
+        while (waiting > 0)
+        {
+            const auto last = waiting;
+            for (size_t i = 0; i < Items.size(); ++i)
+            {
+                if (outputMask[i])
+                    continue;
+                const auto& item = Items[i];
+                bool satisfy = true;
+                for (size_t j = 0; satisfy && j < item.Depends.size(); ++j)
+                {
+                    const auto depIdx = item.Depends[j] != UINT32_MAX ? item.Depends[j] : Find(item.Patch->Depends[j]).value();
+                    satisfy = outputMask[depIdx];
+                }
+                if (!satisfy)
+                    continue;
+                output.append(U"/* Patched Block ["sv).append(item.Patch->ID).append(U"] */\r\n"sv)
+                    .append(item.Patch->Content).append(U"\r\n\r\n"sv);
+                outputMask[i] = true;
+                waiting--;
+            }
+            if (last == waiting)
+                break;
+        }
+        return output;
+    }
+};
+
+static void NamedTextBench()
+{
+    for (const uint32_t count : { 1000u, 2000u, 4000u, 8000u })
+    {
+        const auto patches = GeneratePatches(count);
+        SimpleTimer timer;
+
+        // every helper is requested twice, like helpers shared by multiple kernels
+        LinearHolder linear;
+        timer.Start();
+        for (uint32_t round = 0; round < 2; ++round)
+            for (const auto& patch : patches)
+                linear.Add(patch);
+        timer.Stop();
+        const auto linearAddNs = timer.ElapseNs();
+        timer.Start();
+        const auto linearOutput = linear.Write();
+        timer.Stop();
+        const auto linearWriteNs = timer.ElapseNs();
+
+        xcomp::XCNLContext context(common::CLikeDefines{});
+        timer.Start();
+        for (uint32_t round = 0; round < 2; ++round)
+        {
+            for (const auto& patch : patches)
+            {
+                context.AddPatchedBlock(patch.ID, [&]()
+                    {
+                        std::vector<std::u32string_view> depends(patch.Depends.begin(), patch.Depends.end());
+                        return std::pair{ patch.Content, std::move(depends) };
+                    });
+            }
+        }
+        timer.Stop();
+        const auto indexedAddNs = timer.ElapseNs();
+        xziar::nailang::TextRope rope;
+        timer.Start();
+        context.WritePatchedBlock(rope);
+        timer.Stop();
+        const auto indexedWriteNs = timer.ElapseNs();
+
+        log().info(u"[{:5}] patches: linear add {:8.3f}ms write {:8.3f}ms, indexed add {:8.3f}ms write {:8.3f}ms\n", count,
+            linearAddNs / 1e6, linearWriteNs / 1e6, indexedAddNs / 1e6, indexedWriteNs / 1e6);
+        if (rope.ToU32String() != linearOutput)
+            log().error(u"output mismatch at [{}] patches!\n", count);
+    }
+    log().success(u"NamedText bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("NamedTextBench", &NamedTextBench);
@@ -0,0 +1,138 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "OpenCLUtil/OpenCLUtil.h"
+#include "OpenCLUtil/oclNLCL.h"
+#include "XComputeBase/XCompNailang.h"
+#include <chrono>
+
+using namespace common::mlog;
+using namespace common;
+using namespace oclu;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"OCLBuildBench", { GetConsoleBackend() });
+    return log;
+}
+#define APPEND_FMT(str, syntax, ...) fmt::format_to(std::back_inserter(str), FMT_STRING(syntax), __VA_ARGS__)
+
+
+// salt makes every source unique, so driver's binary cache does not hide the compile time
+static std::string GenerateCL(const uint32_t idx, const uint64_t salt)
+{
+    std::string source;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        APPEND_FMT(source, R"(
+kernel void prog{}_kernel{}(global const float* restrict src, global float* restrict dst, const uint count)
+{{
+    const uint gid = get_global_id(0);
+    float acc = {}.f;
+    for (uint i = 0; i < count; ++i)
+        acc = mad(src[gid + i], sin(acc + {}.f), cos(src[i] * {}u));
+    dst[gid] = acc;
+}}
+)", idx, i, salt % 1000, i, idx);
+    }
+    return source;
+}
+
+static std::string GenerateNLCL(const uint32_t idx, const uint64_t salt)
+{
+    std::string source;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        APPEND_FMT(source, R"(
+@oclu.BufArg("global", "float", "src", "const restrict")
+@oclu.BufArg("global", "float", "dst", "      restrict")
+@oclu.SimpleArg("",    "uint",  "count", "const")
+#Raw.oclu.Kernel("nlcl{}_kernel{}")
+{{@@Kernel
+    const uint gid = get_global_id(0);
+    float acc = {}.f;
+    for (uint i = 0; i < count; ++i)
+        acc = mad(src[gid + i], sin(acc + {}.f), cos(src[i] * {}u));
+    dst[gid] = acc;
+@@Kernel}}
+)", idx, i, salt % 1000, i, idx);
+    }
+    return source;
+}
+
+static void OCLBuildBench()
+{
+    const auto plats = oclPlatform_::GetPlatforms();
+    std::vector<oclDevice> devs;
+    for (const auto& plat : plats)
+    {
+        for (const auto& dev : plat->GetDevices())
+            devs.push_back(dev);
+    }
+    if (devs.empty())
+    {
+        log().error(u"No OpenCL device found!\n");
+        return;
+    }
+    const auto dev = devs[SelectIdx(devs, u"device", [](const auto& dev) { return dev->Name; })];
+    log().info(u"Use device [{}] of [{}].\n", dev->Name, dev->Platform->Name);
+
+    constexpr uint32_t ProgCount = 6;
+    const auto ctx = dev->Platform->CreateContext(dev);
+    NLCLProcessor proc;
+    for (uint32_t round = 0; round < 2; ++round)
+    {
+        const auto salt = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        std::vector<std::string> clSrcs[2];
+        std::vector<std::shared_ptr<xcomp::XCNLProgram>> nlclProgs[2];
+        for (uint32_t i = 0; i < ProgCount; ++i)
+        {
+            for (uint32_t j = 0; j < 2; ++j) // different salt for each mode
+            {
+                clSrcs[j].push_back(GenerateCL(i, salt + j));
+                const auto nlclSrc = GenerateNLCL(i, salt + j);
+                nlclProgs[j].push_back(proc.Parse(common::as_bytes(common::to_span(nlclSrc)), u"bench.nlcl"));
+            }
+        }
+        SimpleTimer timer;
+        uint32_t kernelCount[2] = { 0, 0 };
+
+        // startup as before: programs are built one after another
+        timer.Start();
+        for (uint32_t i = 0; i < ProgCount; ++i)
+        {
+            kernelCount[0] += static_cast<uint32_t>(oclProgram_::CreateAndBuild(ctx, clSrcs[0][i], {}, dev)->GetKernelNames().size());
+            kernelCount[0] += static_cast<uint32_t>(proc.CompileProgram(nlclProgs[0][i], ctx, dev)->GetProgram()->GetKernelNames().size());
+        }
+        timer.Stop();
+        const auto syncNs = timer.ElapseNs();
+
+        // all builds are issued first, then waited
+        timer.Start();
+        {
+            std::vector<PromiseResult<oclProgram>> clPms;
+            std::vector<PromiseResult<std::unique_ptr<NLCLResult>>> nlclPms;
+            for (uint32_t i = 0; i < ProgCount; ++i)
+            {
+                clPms.push_back(oclProgram_::CreateAndBuildAsync(ctx, clSrcs[1][i], {}, dev));
+                nlclPms.push_back(proc.CompileProgramAsync(nlclProgs[1][i], ctx, dev));
+            }
+            for (const auto& pms : clPms)
+                kernelCount[1] += static_cast<uint32_t>(pms->Get()->GetKernelNames().size());
+            for (const auto& pms : nlclPms)
+                kernelCount[1] += static_cast<uint32_t>(pms->Get()->GetProgram()->GetKernelNames().size());
+        }
+        timer.Stop();
+        const auto asyncNs = timer.ElapseNs();
+
+        log().info(u"[{}] CL + [{}] NLCL programs: sequential {:8.3f}ms, async {:8.3f}ms, x{:.2f}\n", ProgCount, ProgCount,
+            syncNs / 1e6, asyncNs / 1e6, static_cast<double>(syncNs) / asyncNs);
+        if (kernelCount[0] != kernelCount[1])
+            log().error(u"kernel count mismatch: [{}] vs [{}]!\n", kernelCount[0], kernelCount[1]);
+    }
+    log().success(u"OpenCL build bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("OCLBuildBench", &OCLBuildBench);
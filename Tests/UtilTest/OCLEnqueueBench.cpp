@@ -0,0 +1,88 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "OpenCLUtil/OpenCLUtil.h"
+
+using namespace common::mlog;
+using namespace common;
+using namespace oclu;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"OCLEnqueueBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+// tiny per-tile kernel, so that host overhead dominates
+static constexpr auto KernelSource = R"(
+kernel void fill_tile(global uint* restrict dst, global const uint* restrict lut, const uint offset, const uint val)
+{
+    const uint idx = offset + get_global_id(0);
+    dst[idx] = lut[idx & 255] + val;
+}
+)"sv;
+
+static void OCLEnqueueBench()
+{
+    const auto plats = oclPlatform_::GetPlatforms();
+    std::vector<oclDevice> devs;
+    for (const auto& plat : plats)
+    {
+        for (const auto& dev : plat->GetDevices())
+            devs.push_back(dev);
+    }
+    if (devs.empty())
+    {
+        log().error(u"No OpenCL device found!\n");
+        return;
+    }
+    const auto dev = devs[SelectIdx(devs, u"device", [](const auto& dev) { return dev->Name; })];
+    log().info(u"Use device [{}] of [{}].\n", dev->Name, dev->Platform->Name);
+
+    constexpr uint32_t Tiles = 10000, TileSize = 64;
+    const auto ctx = dev->Platform->CreateContext(dev);
+    const auto que = oclCmdQue_::Create(ctx, dev, false);
+    const auto prog = oclProgram_::CreateAndBuild(ctx, std::string(KernelSource), CLProgConfig{}, dev);
+    const auto kernel = prog->GetKernel("fill_tile");
+    const auto dst = oclBuffer_::Create(ctx, MemFlag::ReadWrite | MemFlag::HostNoAccess, size_t(Tiles) * TileSize * sizeof(uint32_t));
+    std::vector<uint32_t> lutData(256, 1u);
+    const auto lut = oclBuffer_::Create(ctx, MemFlag::ReadOnly | MemFlag::HostNoAccess, lutData.size() * sizeof(uint32_t), lutData.data());
+
+    for (uint32_t round = 0; round < 3; ++round)
+    {
+        SimpleTimer timer;
+        // new call site per tile: clone kernel and set every arg
+        timer.Start();
+        for (uint32_t i = 0; i < Tiles; ++i)
+        {
+            [[maybe_unused]] const auto pms = kernel->Call<1>(dst, lut, i * TileSize, round)(que, { TileSize });
+        }
+        timer.Stop();
+        const auto callNs = timer.ElapseNs();
+        que->Finish();
+
+        // prepared call: only the tile offset is set again
+        timer.Start();
+        {
+            auto call = kernel->PrepareCall<1>();
+            call.SetArg(0, dst).SetArg(1, lut).SetSimpleArg(2, 0u).SetSimpleArg(3, round);
+            for (uint32_t i = 0; i < Tiles; ++i)
+            {
+                call.SetArg(0, dst).SetArg(1, lut).SetSimpleArg(3, round); // unchanged, skipped
+                [[maybe_unused]] const auto pms = call.SetSimpleArg(2, i * TileSize)(que, { TileSize });
+            }
+        }
+        timer.Stop();
+        const auto preparedNs = timer.ElapseNs();
+        que->Finish();
+
+        log().info(u"[{}] tiles: per-tile call {:8.3f}ms ({:8.0f}/s), prepared call {:8.3f}ms ({:8.0f}/s)\n", Tiles,
+            callNs / 1e6, Tiles * 1e9 / callNs, preparedNs / 1e6, Tiles * 1e9 / preparedNs);
+    }
+    log().success(u"OpenCL enqueue bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("OCLEnqueueBench", &OCLEnqueueBench);
@@ -0,0 +1,97 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "OpenCLUtil/OpenCLUtil.h"
+
+using namespace common::mlog;
+using namespace common;
+using namespace oclu;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"OCLTransferBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static constexpr auto KernelSource = R"(
+kernel void inc(global uint* restrict data)
+{
+    data[get_global_id(0)] += 1;
+}
+)"sv;
+
+static void OCLTransferBench()
+{
+    const auto plats = oclPlatform_::GetPlatforms();
+    std::vector<oclDevice> devs;
+    for (const auto& plat : plats)
+    {
+        for (const auto& dev : plat->GetDevices())
+            devs.push_back(dev);
+    }
+    if (devs.empty())
+    {
+        log().error(u"No OpenCL device found!\n");
+        return;
+    }
+    const auto dev = devs[SelectIdx(devs, u"device", [](const auto& dev) { return dev->Name; })];
+    log().info(u"Use device [{}] of [{}], unified host memory: [{}].\n", dev->Name, dev->Platform->Name, dev->HostUnifiedMemory);
+
+    constexpr uint32_t Loops = 10;
+    const auto ctx = dev->Platform->CreateContext(dev);
+    const auto que = oclCmdQue_::Create(ctx, dev, false);
+    const auto prog = oclProgram_::CreateAndBuild(ctx, std::string(KernelSource), CLProgConfig{}, dev);
+    const auto kernel = prog->GetKernel("inc");
+    const auto align = oclMem_::GetHostAlignment(*ctx);
+
+    for (const size_t count : { size_t(1) << 20, size_t(1) << 24 })
+    {
+        const auto bytes = count * sizeof(uint32_t);
+        bool match = true;
+        SimpleTimer timer;
+
+        // copy path: host data is written to and read back from device memory
+        AlignedBuffer host(bytes, align), result(bytes, align);
+        const auto devBuf = oclBuffer_::Create(ctx, MemFlag::ReadWrite, bytes);
+        timer.Start();
+        for (uint32_t i = 0; i < Loops; ++i)
+        {
+            std::fill_n(host.GetRawPtr<uint32_t>(), count, i);
+            const auto pmsW = devBuf->WriteSpan(que, host.AsSpan());
+            const auto pmsK = kernel->Call<1>(devBuf)(pmsW, que, { count });
+            devBuf->ReadSpan(pmsK, que, result.AsSpan())->WaitFinish();
+            match &= result.GetRawPtr<uint32_t>()[count - 1] == i + 1;
+        }
+        timer.Stop();
+        const auto copyNs = timer.ElapseNs();
+
+        // host path: device works on the host data, access through map
+        const auto hostBuf = oclBuffer_::CreateFromHost(ctx, MemFlag::ReadWrite, host);
+        timer.Start();
+        for (uint32_t i = 0; i < Loops; ++i)
+        {
+            {
+                const auto ptr = hostBuf->Map(que, MapFlag::Write);
+                const auto data = ptr.AsType<uint32_t>();
+                std::fill(data.begin(), data.end(), i);
+            }
+            kernel->Call<1>(hostBuf)(que, { count })->WaitFinish();
+            const auto view = hostBuf->ReadView(que);
+            match &= view.AsSpan<uint32_t>()[count - 1] == i + 1;
+        }
+        timer.Stop();
+        const auto hostNs = timer.ElapseNs();
+
+        log().info(u"[{:5}]MB: copy {:8.3f}ms ({:8.1f}MB/s), host {:8.3f}ms ({:8.1f}MB/s), zero-copy [{}]\n", bytes >> 20,
+            copyNs / 1e6 / Loops, bytes * 2.0 * Loops / copyNs * 1e3, hostNs / 1e6 / Loops, bytes * 2.0 * Loops / hostNs * 1e3,
+            hostBuf->IsZeroCopy());
+        if (!match)
+            log().error(u"result mismatch at [{}]MB!\n", bytes >> 20);
+    }
+    log().success(u"OpenCL transfer bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("OCLTransferBench", &OCLTransferBench);
@@ -0,0 +1,170 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "OpenCLUtil/OpenCLUtil.h"
+#include "SystemCommon/FileEx.h"
+#include "common/ContainerEx.hpp"
+#include <thread>
+
+using namespace common::mlog;
+using namespace common;
+using namespace oclu;
+using namespace std::string_view_literals;
+
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"OCLTuneBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+// 3x3 box filter, output only depends on input
+static constexpr auto KernelSource = R"(
+kernel void box3(global const float* restrict src, global float* restrict dst, const uint width, const uint height)
+{
+    const uint x = get_global_id(0), y = get_global_id(1);
+    float sum = 0.f;
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+        const uint row = clamp((int)y + dy, 0, (int)height - 1) * width;
+        for (int dx = -1; dx <= 1; ++dx)
+            sum += src[row + clamp((int)x + dx, 0, (int)width - 1)];
+    }
+    dst[y * width + x] = sum / 9.f;
+}
+)"sv;
+
+// pass "-auto" to run without prompts on a CPU device (PoCL preferred), using a temp cache file, eg. for CI
+static void OCLTuneBench()
+{
+    const bool isAuto = common::container::FindInVec(GetCmdArgs(), [](const auto str) { return str == "auto"; }) != nullptr;
+    const auto plats = oclPlatform_::GetPlatforms();
+    std::vector<oclDevice> devs;
+    for (const auto& plat : plats)
+    {
+        for (const auto& dev : plat->GetDevices())
+            devs.push_back(dev);
+    }
+    if (devs.empty())
+    {
+        log().error(u"No OpenCL device found!\n");
+        return;
+    }
+    oclDevice dev;
+    if (isAuto)
+    {
+        for (const auto& cand : devs)
+        {
+            if (cand->Type != DeviceType::CPU)
+                continue;
+            if (!dev || cand->Platform->Name.find(u"Portable Computing Language"sv) != std::u16string::npos)
+                dev = cand;
+        }
+        if (!dev)
+            dev = devs[0];
+    }
+    else
+        dev = devs[SelectIdx(devs, u"device", [](const auto& dev) { return dev->Name; })];
+    log().info(u"Use device [{}] of [{}].\n", dev->Name, dev->Platform->Name);
+
+    auto& tuner = oclLocalSizeTuner::Get();
+    const auto cacheFile = fs::temp_directory_path() / u"OCLTuneBench.cache";
+    if (isAuto)
+    {
+        fs::remove(cacheFile);
+        tuner.SetCacheFile(cacheFile.string());
+    }
+
+    constexpr uint32_t Width = 2048, Height = 2048, Loops = 20;
+    const auto ctx = dev->Platform->CreateContext(dev);
+    const auto que = oclCmdQue_::Create(ctx, dev);
+    const auto prog = oclProgram_::CreateAndBuild(ctx, std::string(KernelSource), CLProgConfig{}, dev);
+    const auto kernel = prog->GetKernel("box3");
+    std::vector<float> input(size_t(Width) * Height);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = static_cast<float>(i % 251) / 251.f;
+    const auto src = oclBuffer_::Create(ctx, MemFlag::ReadOnly | MemFlag::HostWriteOnly, input.size() * sizeof(float));
+    const auto dst = oclBuffer_::Create(ctx, MemFlag::WriteOnly | MemFlag::HostReadOnly, input.size() * sizeof(float));
+    src->WriteSpan(que, input)->WaitFinish();
+
+    auto call = kernel->PrepareCall<2>();
+    call.SetArg(0, src).SetArg(1, dst).SetSimpleArg(2, Width).SetSimpleArg(3, Height);
+    const auto bench = [&](const SizeN<2> localsize)
+    {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < Loops; ++i)
+        {
+            const auto pms = call(que, { Width, Height }, localsize);
+            pms->WaitFinish();
+            total += pms->ElapseNs();
+        }
+        return total / Loops;
+    };
+    const auto readOutput = [&]()
+    {
+        std::vector<float> output(input.size());
+        dst->ReadSpan(que, output)->WaitFinish();
+        return output;
+    };
+
+    SimpleTimer timer;
+    timer.Start();
+    call(que, { Width, Height }, AutoLocalSize)->WaitFinish();
+    timer.Stop();
+    const auto tuneMs = timer.ElapseMs();
+    const size_t worksize[2] = { Width, Height };
+    const auto key = oclLocalSizeTuner::MakeKey(kernel->TuneKey, 2, worksize);
+    const auto tuned = tuner.Query(key);
+    log().info(u"first auto call (including tuning) cost {}ms, picked [{}x{}].\n", tuneMs,
+        tuned ? (*tuned)[0] : 0, tuned ? (*tuned)[1] : 0);
+    const auto tunedOutput = readOutput();
+
+    const auto defaultNs = bench({});
+    const auto defaultOutput = readOutput();
+    const auto autoNs = bench(AutoLocalSize);
+    log().info(u"[{}x{}]: driver default {:8.3f}us, auto {:8.3f}us\n", Width, Height, defaultNs / 1e3, autoNs / 1e3);
+
+    bool isOK = tuned.has_value();
+    if (tunedOutput != defaultOutput)
+    {
+        log().error(u"output with tuned local size differs from driver default!\n");
+        isOK = false;
+    }
+    if (isAuto)
+    {
+        // a new call site of the same kernel from other threads, only one of them tunes
+        constexpr uint32_t Threads = 4;
+        std::vector<std::thread> workers;
+        for (uint32_t i = 0; i < Threads; ++i)
+        {
+            workers.emplace_back([&]()
+                {
+                    auto call2 = kernel->PrepareCall<2>();
+                    call2.SetArg(0, src).SetArg(1, dst).SetSimpleArg(2, Width / 2).SetSimpleArg(3, Height / 2);
+                    call2(que, { Width / 2, Height / 2 }, AutoLocalSize)->WaitFinish();
+                });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        const size_t halfsize[2] = { Width / 2, Height / 2 };
+        const auto halfKey = oclLocalSizeTuner::MakeKey(kernel->TuneKey, 2, halfsize);
+        isOK &= tuner.Query(halfKey).has_value();
+        // switching file flushes pending records
+        tuner.SetCacheFile({});
+        const auto saved = common::file::ReadAllText(cacheFile);
+        if (saved.find(key) == std::string::npos || saved.find(halfKey) == std::string::npos)
+        {
+            log().error(u"tuned records are not persisted!\n");
+            isOK = false;
+        }
+        fs::remove(cacheFile);
+    }
+    if (isOK)
+        log().success(u"OpenCL local size tune bench over!\n");
+    else
+        log().error(u"OpenCL local size tune check failed!\n");
+    if (!isAuto)
+        getchar();
+}
+
+const static uint32_t ID = RegistTest("OCLTuneBench", &OCLTuneBench);
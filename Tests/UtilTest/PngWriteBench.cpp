@@ -0,0 +1,84 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "common/MemoryStream.hpp"
+#include "ImageUtil/ImageUtil.h"
+#include "ImageUtil/ImagePNG.h"
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace common::mlog;
+using namespace common;
+namespace img = xziar::img;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"PngWriteBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static img::Image PrepareImage()
+{
+    log().info(u"input image file, empty to generate a 4096x4096 one:\n");
+    std::string fpath;
+    std::getline(std::cin, fpath);
+    if (!fpath.empty())
+        return img::ReadImage(fpath, img::ImageDataType::RGBA);
+    // smooth gradient with noise, similar to a rendered screenshot
+    img::Image src(img::ImageDataType::RGBA);
+    src.SetSize(4096, 4096);
+    std::mt19937 gen(42);
+    for (uint32_t y = 0; y < src.GetHeight(); ++y)
+    {
+        auto ptr = src.GetRawPtr<uint8_t>(y);
+        for (uint32_t x = 0; x < src.GetWidth(); ++x)
+        {
+            const auto noise = static_cast<int32_t>(gen() % 8);
+            *ptr++ = static_cast<uint8_t>((x * 255 / src.GetWidth() + noise) & 0xff);
+            *ptr++ = static_cast<uint8_t>((y * 255 / src.GetHeight() + noise) & 0xff);
+            *ptr++ = static_cast<uint8_t>(((x + y) / 64 * 16 + noise) & 0xff);
+            *ptr++ = 0xff;
+        }
+    }
+    return src;
+}
+
+static void PngWriteBench()
+{
+    const auto src = PrepareImage();
+    log().info(u"[{}x{}] {:.1f}MB\n", src.GetWidth(), src.GetHeight(), src.GetSize() / 1048576.0);
+    const auto threads = std::max(std::thread::hardware_concurrency(), 2u);
+    SimpleTimer timer;
+    for (const uint8_t quality : { 70u, 90u, 95u })
+    {
+        for (const auto filter : { img::png::PngFilter::Paeth, img::png::PngFilter::Adaptive })
+        {
+            const auto fname = filter == img::png::PngFilter::Paeth ? u"paeth" : u"adapt";
+            double baseMs = 0;
+            for (const uint32_t thr : { 1u, threads })
+            {
+                vector<std::byte> output;
+                io::ContainerOutputStream<vector<std::byte>> stream(output);
+                img::png::PngWriter writer(stream);
+                writer.Filter = filter;
+                writer.Threads = thr;
+                timer.Start();
+                writer.Write(src, quality);
+                timer.Stop();
+                const auto ms = timer.ElapseNs() / 1e6;
+                if (thr == 1)
+                    baseMs = ms;
+                const auto check = img::ReadImage(output, u"png", img::ImageDataType::RGBA);
+                const bool match = check.GetSize() == src.GetSize() && memcmp(check.GetRawPtr(), src.GetRawPtr(), src.GetSize()) == 0;
+                log().info(u"[q{}][{}][x{:2}] {:9.2f}ms, {:8.2f}KB, {:5.2f}x {}\n", quality, fname, thr, ms, output.size() / 1024.0,
+                    baseMs / ms, match ? u"" : u"MISMATCH");
+            }
+        }
+    }
+    log().success(u"PngWrite bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("PngWriteBench", &PngWriteBench);
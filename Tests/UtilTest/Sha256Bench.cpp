@@ -0,0 +1,64 @@
+#include "TestRely.h"
+#include "SystemCommon/MiscIntrins.h"
+#include "SystemCommon/FileMapperEx.h"
+#include "common/TimeUtil.hpp"
+#include <iostream>
+#include <random>
+
+using namespace common::mlog;
+using namespace common;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"Sha256Bench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static fs::path PrepareFile()
+{
+    log().info(u"input file to hash, empty to generate a 512MB temp file:\n");
+    std::string fpath;
+    std::getline(std::cin, fpath);
+    if (!fpath.empty())
+        return fpath;
+    const auto tmpPath = fs::temp_directory_path() / u"Sha256Bench.bin";
+    vector<uint32_t> data(512 * 1024 * 1024 / sizeof(uint32_t));
+    std::mt19937 gen(42);
+    for (auto& dat : data)
+        dat = gen();
+    file::WriteAll(tmpPath, data);
+    return tmpPath;
+}
+
+static void Sha256Bench()
+{
+    const auto filepath = PrepareFile();
+    log().info(u"hashing [{}]\n", filepath.u16string());
+    SimpleTimer timer;
+
+    timer.Start();
+    const auto data = file::ReadAll<std::byte>(filepath);
+    const auto sha0 = DigestFunc.SHA256(common::span<const std::byte>(data));
+    timer.Stop();
+    log().info(u"[oneshot ] {:8.2f}ms, {}\n", timer.ElapseNs() / 1e6, MiscIntrin.HexToStr(sha0));
+
+    timer.Start();
+    const auto sha1 = file::SHA256OfFile(filepath, true);
+    timer.Stop();
+    log().info(u"[mapping ] {:8.2f}ms, {}\n", timer.ElapseNs() / 1e6, MiscIntrin.HexToStr(sha1));
+
+    timer.Start();
+    const auto sha2 = file::SHA256OfFile(filepath, false);
+    timer.Stop();
+    log().info(u"[chunked ] {:8.2f}ms, {}\n", timer.ElapseNs() / 1e6, MiscIntrin.HexToStr(sha2));
+
+    if (sha0 == sha1 && sha0 == sha2)
+        log().success(u"Sha256 bench over!\n");
+    else
+        log().error(u"Sha256 mismatch!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("Sha256Bench", &Sha256Bench);
@@ -0,0 +1,132 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "ImageUtil/ImageUtil.h"
+#include "ImageUtil/TexDiskCache.h"
+#include <random>
+
+using namespace common::mlog;
+using namespace common;
+namespace img = xziar::img;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"TexCacheBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static vector<fs::path> PrepareSources(const fs::path& dir, const uint32_t count, const uint32_t size)
+{
+    vector<fs::path> paths;
+    std::mt19937 gen(42);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        img::Image src(img::ImageDataType::RGBA);
+        src.SetSize(size, size);
+        auto ptr = src.GetRawPtr<uint8_t>();
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                const auto noise = static_cast<uint32_t>(gen() % 32);
+                *ptr++ = static_cast<uint8_t>((x * 255 / size + noise + i * 16) & 0xff);
+                *ptr++ = static_cast<uint8_t>((y * 255 / size + noise) & 0xff);
+                *ptr++ = static_cast<uint8_t>(((x + y) / 64 * 16 + noise) & 0xff);
+                *ptr++ = 255;
+            }
+        }
+        paths.push_back(dir / (std::to_string(i) + ".png"));
+        img::WriteImage(src, paths.back());
+    }
+    return paths;
+}
+
+// stands for TextureLoader's processing, BC compression lives in TextureUtil so only mip levels are generated here
+static img::CompressedTex ProcessSource(const fs::path& path)
+{
+    auto level = img::ReadImage(path, img::ImageDataType::RGBA);
+    img::CompressedTex tex;
+    tex.Format = img::TextureFormat::RGBA8;
+    tex.Width = level.GetWidth();
+    tex.Height = level.GetHeight();
+    while (true)
+    {
+        const auto w = level.GetWidth(), h = level.GetHeight();
+        auto next = (w > 4 && h > 4) ? level.ResizeTo(w / 2, h / 2, true) : img::Image{};
+        tex.Levels.push_back(level.ExtractData());
+        if (next.GetSize() == 0)
+            break;
+        level = std::move(next);
+    }
+    return tex;
+}
+
+static void TexCacheBench()
+{
+    constexpr uint32_t Count = 8, Size = 2048, Variant = 0x01000101;
+    const auto baseDir = fs::temp_directory_path() / u"TexCacheBench";
+    const auto srcDir = baseDir / u"src", cacheDir = baseDir / u"cache";
+    fs::remove_all(baseDir);
+    fs::create_directories(srcDir);
+    const auto sources = PrepareSources(srcDir, Count, Size);
+    SimpleTimer timer;
+
+    // whole miss path: lookup, hashing, processing and storing
+    img::TexDiskCache cache(cacheDir, uint64_t(1) << 32);
+    uint64_t stageNs[3] = { 0, 0, 0 };
+    SimpleTimer stageTimer;
+    timer.Start();
+    for (const auto& src : sources)
+    {
+        stageTimer.Start();
+        auto hash = cache.LookupFile(src);
+        if (!hash)
+            hash = cache.RecordFile(src);
+        stageTimer.Stop();
+        stageNs[0] += stageTimer.ElapseNs();
+        stageTimer.Start();
+        auto tex = ProcessSource(src);
+        stageTimer.Stop();
+        stageNs[1] += stageTimer.ElapseNs();
+        stageTimer.Start();
+        cache.Store({ *hash, Variant }, tex);
+        stageTimer.Stop();
+        stageNs[2] += stageTimer.ElapseNs();
+    }
+    timer.Stop();
+    log().info(u"[cold        ] {:9.2f}ms per texture (hash {:.2f}ms, decode+mips {:.2f}ms, store {:.2f}ms, no BC), cache holds [{}] bytes\n", 
+        timer.ElapseNs() / 1e6 / Count, stageNs[0] / 1e6 / Count, stageNs[1] / 1e6 / Count, stageNs[2] / 1e6 / Count, cache.GetTotalBytes());
+
+    for (const bool useMapping : { true, false })
+    {
+        // a fresh instance, sources are recognized from the persisted index without hashing
+        img::TexDiskCache warmCache(cacheDir, uint64_t(1) << 32, useMapping);
+        uint32_t hits = 0;
+        uint64_t checksum = 0;
+        timer.Start();
+        for (const auto& src : sources)
+        {
+            const auto hash = warmCache.LookupFile(src);
+            const auto tex = hash ? warmCache.Load({ *hash, Variant }) : std::nullopt;
+            if (!tex)
+                continue;
+            hits++;
+            // touch every page like an upload would
+            for (const auto& level : tex->Levels)
+                for (size_t i = 0; i < level.GetSize(); i += 4096)
+                    checksum += static_cast<uint8_t>(level.GetRawPtr()[i]);
+        }
+        timer.Stop();
+        log().info(u"[warm {:7}] {:9.2f}ms per texture, [{}/{}] hit, checksum {}\n", useMapping ? u"mapping" : u"read",
+            timer.ElapseNs() / 1e6 / Count, hits, Count, checksum);
+    }
+
+    cache.SetMaxBytes(cache.GetTotalBytes() / 2);
+    log().info(u"[LRU         ] after halving the limit, cache holds [{}] bytes\n", cache.GetTotalBytes());
+    fs::remove_all(baseDir);
+    log().success(u"TexCache bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("TexCacheBench", &TexCacheBench);
@@ -0,0 +1,75 @@
+#include "TestRely.h"
+#include "common/TimeUtil.hpp"
+#include "ImageUtil/ImageUtil.h"
+#include <iostream>
+#include <random>
+
+using namespace common::mlog;
+using namespace common;
+namespace img = xziar::img;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"TgaRleBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static img::Image PrepareImage(const img::ImageDataType dataType)
+{
+    // flat regions with short noisy gaps, typical for UI/mask textures that benefit from RLE
+    img::Image src(dataType);
+    src.SetSize(4096, 4096);
+    std::mt19937 gen(42);
+    const auto eleSize = src.GetElementSize();
+    for (uint32_t y = 0; y < src.GetHeight(); ++y)
+    {
+        auto ptr = src.GetRawPtr<uint8_t>(y);
+        for (uint32_t x = 0; x < src.GetWidth();)
+        {
+            const bool isFlat = gen() % 4 != 0;
+            const auto len = std::min<uint32_t>(isFlat ? 16 + gen() % 300 : 1 + gen() % 24, src.GetWidth() - x);
+            const auto color = static_cast<uint32_t>(gen());
+            for (uint32_t i = 0; i < len; ++i, ptr += eleSize)
+            {
+                const auto val = isFlat ? color : static_cast<uint32_t>(gen());
+                memcpy(ptr, &val, eleSize);
+            }
+            x += len;
+        }
+    }
+    return src;
+}
+
+static void TgaRleBench()
+{
+    constexpr uint32_t Rounds = 8;
+    for (const auto dataType : { img::ImageDataType::GRAY, img::ImageDataType::RGB, img::ImageDataType::RGBA })
+    {
+        const auto src = PrepareImage(dataType);
+        const auto mbytes = src.GetSize() / 1048576.0;
+        SimpleTimer timer;
+        vector<std::byte> data;
+        timer.Start();
+        for (uint32_t i = 0; i < Rounds; ++i)
+            data = img::WriteImage<std::byte>(src, u"tga", 100);
+        timer.Stop();
+        const auto encMs = timer.ElapseNs() / 1e6 / Rounds;
+        
+        img::Image dst;
+        timer.Start();
+        for (uint32_t i = 0; i < Rounds; ++i)
+            dst = img::ReadImage(data, u"tga", dataType);
+        timer.Stop();
+        const auto decMs = timer.ElapseNs() / 1e6 / Rounds;
+        const bool match = dst.GetSize() == src.GetSize() && memcmp(dst.GetRawPtr(), src.GetRawPtr(), src.GetSize()) == 0;
+        log().info(u"[{}ch] {:.1f}MB -> {:.1f}MB, encode {:8.2f}ms ({:7.1f}MB/s), decode {:8.2f}ms ({:7.1f}MB/s) {}\n", 
+            src.GetElementSize(), mbytes, data.size() / 1048576.0, encMs, mbytes * 1000 / encMs, decMs, mbytes * 1000 / decMs, 
+            match ? u"" : u"MISMATCH");
+    }
+    log().success(u"TgaRle bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("TgaRleBench", &TgaRleBench);
@@ -0,0 +1,188 @@
+#include "TestRely.h"
+#include "SystemCommon/SpinLock.h"
+#include "SystemCommon/LoopBase.h"
+#include "common/TimeUtil.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace common::mlog;
+using namespace common;
+using std::vector;
+
+static MiniLogger<false>& log()
+{
+    static MiniLogger<false> log(u"WaitBench", { GetConsoleBackend() });
+    return log;
+}
+
+
+static constexpr uint32_t PingPongRounds = 20000;
+
+// two threads bounce a token, each round-trip contains 2 wakeups
+static void BenchPingPongWaiter()
+{
+    std::atomic<uint32_t> token{ 0 };
+    std::thread peer([&]()
+        {
+            for (uint32_t i = 0; i < PingPongRounds; ++i)
+            {
+                while (token.load() != 1)
+                    AtomicWaiter::Wait(token, 0);
+                token = 0;
+                AtomicWaiter::WakeOne(token);
+            }
+        });
+    SimpleTimer timer;
+    timer.Start();
+    for (uint32_t i = 0; i < PingPongRounds; ++i)
+    {
+        token = 1;
+        AtomicWaiter::WakeOne(token);
+        while (token.load() != 0)
+            AtomicWaiter::Wait(token, 1);
+    }
+    timer.Stop();
+    peer.join();
+    log().info(u"[pingpong AtomicWaiter] {:8.1f}ns/wakeup\n", timer.ElapseNs() / (PingPongRounds * 2.0));
+}
+
+static void BenchPingPongCondVar()
+{
+    std::mutex mtx;
+    std::condition_variable cond;
+    uint32_t token = 0;
+    std::thread peer([&]()
+        {
+            for (uint32_t i = 0; i < PingPongRounds; ++i)
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cond.wait(lock, [&]() { return token == 1; });
+                token = 0;
+                cond.notify_one();
+            }
+        });
+    SimpleTimer timer;
+    timer.Start();
+    for (uint32_t i = 0; i < PingPongRounds; ++i)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        token = 1;
+        cond.notify_one();
+        cond.wait(lock, [&]() { return token == 0; });
+    }
+    timer.Stop();
+    peer.join();
+    log().info(u"[pingpong condvar      ] {:8.1f}ns/wakeup\n", timer.ElapseNs() / (PingPongRounds * 2.0));
+}
+
+
+// Wakeup() from outside until OnLoop is called, like a task queue being fed
+static void BenchLoopWakeup()
+{
+    struct Loop : public loop::LoopBase
+    {
+        std::atomic<uint32_t> Count{ 0 };
+        Loop() : LoopBase(LoopBase::GetThreadedExecutor) { }
+        ~Loop() override { Stop(); }
+        LoopAction OnLoop() override
+        {
+            Count++;
+            AtomicWaiter::WakeOne(Count);
+            return LoopAction::Sleep();
+        }
+        using LoopBase::Start;
+        using LoopBase::Wakeup;
+    };
+    constexpr uint32_t Rounds = 5000;
+    Loop loop;
+    loop.Start();
+    while (loop.Count == 0)
+        std::this_thread::yield();
+    SimpleTimer timer;
+    timer.Start();
+    for (uint32_t i = 1; i <= Rounds; ++i)
+    {
+        for (auto cnt = loop.Count.load(); cnt <= i; cnt = loop.Count.load())
+        {
+            loop.Wakeup(); // may be ignored when loop has not turned to sleep yet
+            AtomicWaiter::Wait(loop.Count, cnt, 1);
+        }
+    }
+    timer.Stop();
+    log().info(u"[loop wakeup           ] {:8.1f}ns/wakeup\n", timer.ElapseNs() / (Rounds * 1.0));
+}
+
+
+template<typename F>
+static void BenchContention(std::u16string_view name, const uint32_t threads, F&& func)
+{
+    constexpr uint32_t Loops = 200000;
+    vector<std::thread> thrs;
+    SimpleTimer timer;
+    timer.Start();
+    for (uint32_t i = 0; i < threads; ++i)
+        thrs.emplace_back([&, i]()
+            {
+                for (uint32_t j = 0; j < Loops; ++j)
+                    func(i, j);
+            });
+    for (auto& thr : thrs)
+        thr.join();
+    timer.Stop();
+    log().info(u"[{:<10}] x{:2} threads: {:8.2f}Mops/s\n", name, threads, (double)Loops * threads / timer.ElapseNs() * 1e3);
+}
+
+static void BenchLocks(const uint32_t threads)
+{
+    uint64_t counter = 0;
+    {
+        SpinLocker locker;
+        BenchContention(u"SpinLocker", threads, [&](uint32_t, uint32_t)
+            {
+                const auto lock = locker.LockScope();
+                counter++;
+            });
+    }
+    {
+        std::mutex mtx;
+        BenchContention(u"std::mutex", threads, [&](uint32_t, uint32_t)
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                counter++;
+            });
+    }
+    {
+        WRSpinLock locker;
+        BenchContention(u"WRSpinLock", threads, [&](uint32_t, uint32_t j)
+            {
+                if (j % 16 == 0)
+                {
+                    const auto lock = locker.WriteScope();
+                    counter++;
+                }
+                else
+                {
+                    const auto lock = locker.ReadScope();
+                    [[maybe_unused]] const auto val = counter;
+                }
+            });
+    }
+    log().verbose(u"counter: {}\n", counter);
+}
+
+
+static void WaitBench()
+{
+    BenchPingPongWaiter();
+    BenchPingPongCondVar();
+    BenchLoopWakeup();
+    const auto maxThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    for (uint32_t threads = 1; threads <= maxThreads * 2; threads *= 2)
+        BenchLocks(threads);
+    log().success(u"Wait bench over!\n");
+    getchar();
+}
+
+const static uint32_t ID = RegistTest("WaitBench", &WaitBench);
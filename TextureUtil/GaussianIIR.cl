@@ -26,9 +26,10 @@ float3 LinearToSRGB(const float3 color)
     ret.z = color.z <= 0.00304f ? 12.92f * color.z : 1.055f * native_powr(color.z, 1.0f / 2.4f) - 0.055f;
     return ret;
 }
+// color is normalized to [0,1]
 uchar4 LinearToSRGBA8(const float4 color)
 {
-    return convert_uchar4((float4)(LinearToSRGB(color.xyz), color.w));
+    return convert_uchar4_sat_rte((float4)(LinearToSRGB(color.xyz), color.w) * 255.0f);
 }
 
 //stageX,Linear
@@ -121,11 +122,12 @@ kernel void IIR_SRGBX(global const uchar* restrict src, global float* restrict m
     {
         global const uchar * restrict ptrIn  = src + get_global_id(0) * stride * 4;
         global       float * restrict ptrOut = mid + get_global_id(0) * width * 4;
-        in4.s0123 = convert_float4(vload4(0, ptrIn));
+        in4.s0123 = convert_float4(vload4(0, ptrIn)) * (1.0f / 255.0f);
+        in4.s012 = SRGBToLinear(in4.s012);
         tmp = (float16)(in4.s0123, in4.s0123, in4.s0123, in4.s0123);
         for (uint i=0, j=0; j < width; j+=4)
         {
-            in4 = convert_float16(vload16(i, ptrIn));
+            in4 = convert_float16(vload16(i, ptrIn)) * (1.0f / 255.0f);
             in4.s012 = SRGBToLinear(in4.s012); in4.s456 = SRGBToLinear(in4.s456); in4.s89a = SRGBToLinear(in4.s89a); in4.scde = SRGBToLinear(in4.scde);
             tmp.s0123 = in4.s0123 * coeff.x + tmp.scdef * coeff.y + tmp.s89ab * coeff.z + tmp.s4567 * coeff.w;
             tmp.s4567 = in4.s4567 * coeff.x + tmp.s0123 * coeff.y + tmp.scdef * coeff.z + tmp.s89ab * coeff.w;
@@ -215,9 +217,10 @@ half3 LinearHToSRGB(const half3 color)
     ret.z = color.z <= 0.00304h ? 12.92h * color.z : 1.055h * native_powr(color.z, 1.0h / 2.4h) - 0.055h;
     return ret;
 }
+// color is normalized to [0,1]
 uchar4 LinearHToSRGBA8(const half4 color)
 {
-    return convert_uchar4((half4)(LinearHToSRGB(color.xyz), color.w));
+    return convert_uchar4_sat_rte((half4)(LinearHToSRGB(color.xyz), color.w) * 255.0h);
 }
 
 //stageX,Linear,fp16 opt
@@ -310,11 +313,12 @@ kernel void IIR_SRGBXH(global const uchar* restrict src, global half* restrict m
     {
         global const uchar * restrict ptrIn  = src + get_global_id(0) * stride * 4;
         global       half * restrict ptrOut = mid + get_global_id(0) * width * 4;
-        in4.s0123 = convert_half4(vload4(0, ptrIn));
+        in4.s0123 = convert_half4(vload4(0, ptrIn)) * (1.0h / 255.0h);
+        in4.s012 = SRGBToLinearH(in4.s012);
         tmp = (half16)(in4.s0123, in4.s0123, in4.s0123, in4.s0123);
         for (uint i=0, j=0; j < width; j+=4)
         {
-            in4 = convert_half16(vload16(i, ptrIn));
+            in4 = convert_half16(vload16(i, ptrIn)) * (1.0h / 255.0h);
             in4.s012 = SRGBToLinearH(in4.s012); in4.s456 = SRGBToLinearH(in4.s456); in4.s89a = SRGBToLinearH(in4.s89a); in4.scde = SRGBToLinearH(in4.scde);
             tmp.s0123 = in4.s0123 * coeff.x + tmp.scdef * coeff.y + tmp.s89ab * coeff.z + tmp.s4567 * coeff.w;
             tmp.s4567 = in4.s4567 * coeff.x + tmp.s0123 * coeff.y + tmp.scdef * coeff.z + tmp.s89ab * coeff.w;
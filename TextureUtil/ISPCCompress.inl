@@ -6,11 +6,11 @@
 
 namespace oglu::texutil::detail
 {
-using xziar::img::ImageView;
+using xziar::img::ImageRegion;
 using xziar::img::ImageDataType;
 
 
-static common::AlignedBuffer CompressBC1(const ImageView& img)
+static common::AlignedBuffer CompressBC1(const ImageRegion& img)
 {
     if (HAS_FIELD(img.GetDataType(), ImageDataType::FLOAT_MASK))
         COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"float data type not supported in BC1");
@@ -20,14 +20,14 @@ static common::AlignedBuffer CompressBC1(const ImageView& img)
         const auto tmpImg = img.ConvertTo(ImageDataType::RGBA);
         return CompressBC1(tmpImg);
     }
-    const rgba_surface surface{ const_cast<uint8_t*>(img.GetRawPtr<uint8_t>()), (int32_t)img.GetWidth(), (int32_t)img.GetHeight(), (int32_t)img.RowSize() };
+    const rgba_surface surface{ const_cast<uint8_t*>(img.GetRawPtr<uint8_t>()), (int32_t)img.GetWidth(), (int32_t)img.GetHeight(), (int32_t)img.RowPitch() };
     const uint32_t blkCount = img.GetWidth() * img.GetHeight() / 4 / 4;
     common::AlignedBuffer buffer(8 * blkCount);
     CompressBlocksBC1(&surface, buffer.GetRawPtr<uint8_t>());
     return buffer;
 }
 
-static common::AlignedBuffer CompressBC3(const ImageView& img)
+static common::AlignedBuffer CompressBC3(const ImageRegion& img)
 {
     if (HAS_FIELD(img.GetDataType(), ImageDataType::FLOAT_MASK))
         COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"float data type not supported in BC3");
@@ -37,14 +37,14 @@ static common::AlignedBuffer CompressBC3(const ImageView& img)
         const auto tmpImg = img.ConvertTo(ImageDataType::RGBA);
         return CompressBC3(tmpImg);
     }
-    const rgba_surface surface{ const_cast<uint8_t*>(img.GetRawPtr<uint8_t>()), (int32_t)img.GetWidth(), (int32_t)img.GetHeight(), (int32_t)img.RowSize() };
+    const rgba_surface surface{ const_cast<uint8_t*>(img.GetRawPtr<uint8_t>()), (int32_t)img.GetWidth(), (int32_t)img.GetHeight(), (int32_t)img.RowPitch() };
     const uint32_t blkCount = img.GetWidth() * img.GetHeight() / 4 / 4;
     common::AlignedBuffer buffer(16 * blkCount);
     CompressBlocksBC3(&surface, buffer.GetRawPtr<uint8_t>());
     return buffer;
 }
 
-static common::AlignedBuffer CompressBC7(const ImageView& img, const bool needAlpha)
+static common::AlignedBuffer CompressBC7(const ImageRegion& img, const bool needAlpha)
 {
     if (HAS_FIELD(img.GetDataType(), ImageDataType::FLOAT_MASK))
         COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"float data type not supported in BC7");
@@ -54,7 +54,7 @@ static common::AlignedBuffer CompressBC7(const ImageView& img, const bool needAl
         const auto tmpImg = img.ConvertTo(ImageDataType::RGBA);
         return CompressBC7(tmpImg, needAlpha);
     }
-    const rgba_surface surface{ const_cast<uint8_t*>(img.GetRawPtr<uint8_t>()), (int32_t)img.GetWidth(), (int32_t)img.GetHeight(), (int32_t)img.RowSize() };
+    const rgba_surface surface{ const_cast<uint8_t*>(img.GetRawPtr<uint8_t>()), (int32_t)img.GetWidth(), (int32_t)img.GetHeight(), (int32_t)img.RowPitch() };
     const uint32_t blkCount = img.GetWidth() * img.GetHeight() / 4 / 4;
     common::AlignedBuffer buffer(16 * blkCount);
     bc7_enc_settings settings;
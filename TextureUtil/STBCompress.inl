@@ -22,7 +22,7 @@
 
 namespace oglu::texutil::detail
 {
-using xziar::img::ImageView;
+using xziar::img::ImageRegion;
 using xziar::img::ImageDataType;
 
 //SIMD optimized according to stb's implementation
@@ -301,16 +301,16 @@ public:
     }
 
     template<typename Prepare, typename Process>
-    common::AlignedBuffer EachBlock(const ImageView& img, const size_t bytePerBlock, Prepare&& prepare, Process&& process)
+    common::AlignedBuffer EachBlock(const ImageRegion& img, const size_t bytePerBlock, Prepare&& prepare, Process&& process)
     {
         common::AlignedBuffer buffer(bytePerBlock * (img.GetWidth() * img.GetHeight() / 4 / 4));
         const auto blockStride = img.GetElementSize() * 4;
-        const auto rowStride = img.GetWidth() * img.GetElementSize();
-        const uint8_t * __restrict row = img.GetRawPtr<uint8_t>();
+        const auto rowStride = img.RowPitch();
         uint8_t * __restrict output = buffer.GetRawPtr<uint8_t>();
 
-        for (uint32_t y = img.GetHeight(); y > 0; y -= 4)
+        for (uint32_t y = 0; y < img.GetHeight(); y += 4)
         {
+            const uint8_t * __restrict row = img.GetRawPtr<uint8_t>(y);
             for (uint32_t x = img.GetWidth(); x > 0; x -= 4)
             {
                 prepare(row, rowStride, data);
@@ -318,14 +318,13 @@ public:
                 row += blockStride;
                 output += bytePerBlock;
             }
-            row += rowStride * 3;
         }
         return buffer;
     }
 };
 
 
-static common::AlignedBuffer CompressBC5(const ImageView& img)
+static common::AlignedBuffer CompressBC5(const ImageRegion& img)
 {
     if (HAS_FIELD(img.GetDataType(), ImageDataType::FLOAT_MASK))
         COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"float data type not supported in BC5");
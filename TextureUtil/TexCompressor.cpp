@@ -2,6 +2,10 @@
 #include "TexCompressor.h"
 #include "ISPCCompress.inl"
 #include "STBCompress.inl"
+#include "SystemCommon/WorkerPool.h"
+#include <deque>
+#include <mutex>
+#include <optional>
 
 
 namespace oglu::texutil
@@ -9,7 +13,7 @@ namespace oglu::texutil
 using namespace xziar::img;
 
 
-static void CheckImgSize(const ImageView& img)
+static void CheckImgSize(const ImageRegion& img)
 {
     if (img.GetWidth() % 4 != 0 || img.GetHeight() % 4 != 0)
         COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"image being comoressed should has a size of multiple of 4.");
@@ -17,28 +21,32 @@ static void CheckImgSize(const ImageView& img)
         COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"image being comoressed should has a non-zero size.");
 }
 
-common::AlignedBuffer CompressToDat(const ImageView& img, const TextureFormat format, const bool needAlpha)
+static common::AlignedBuffer Compress(const ImageRegion& img, const TextureFormat format, const bool needAlpha)
 {
-    CheckImgSize(img);
-    common::SimpleTimer timer;
-    common::AlignedBuffer result;
-    timer.Start();
     switch (format)
     {
     case TextureFormat::BC1:
     case TextureFormat::BC1SRGB:
-        result = detail::CompressBC1(img); break;
+        return detail::CompressBC1(img);
     case TextureFormat::BC3:
     case TextureFormat::BC3SRGB:
-        result = detail::CompressBC3(img); break;
+        return detail::CompressBC3(img);
     case TextureFormat::BC5:
-        result = detail::CompressBC5(img); break;
+        return detail::CompressBC5(img);
     case TextureFormat::BC7:
     case TextureFormat::BC7SRGB:
-        result = detail::CompressBC7(img, needAlpha); break;
+        return detail::CompressBC7(img, needAlpha);
     default:
         COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"not supported compression yet");
     }
+}
+
+common::AlignedBuffer CompressToDat(const ImageRegion& img, const TextureFormat format, const bool needAlpha)
+{
+    CheckImgSize(img);
+    common::SimpleTimer timer;
+    timer.Start();
+    auto result = Compress(img, format, needAlpha);
     timer.Stop();
     texLog().debug(u"Compressed a image of [{}x{}] to [{}], cost {}ms.\n",
         img.GetWidth(), img.GetHeight(), xziar::img::TexFormatUtil::GetFormatName(format), timer.ElapseMs());
@@ -46,4 +54,161 @@ common::AlignedBuffer CompressToDat(const ImageView& img, const TextureFormat fo
 }
 
 
+// tiles are about this many pixels, small enough to balance across workers while keeping ispc's per-call cost negligible
+constexpr uint32_t TilePixels = 256 * 1024;
+
+// shared with queued tiles, so an abandoned stream does not need to wait for them
+class MipCompressStream::Host
+{
+public:
+    struct Level
+    {
+        ImageView Source;
+        common::AlignedBuffer Output;
+        size_t BlockRowBytes = 0;
+        uint32_t PendingTiles = 0;
+        Level(ImageView&& src) : Source(std::move(src)) { }
+    };
+    std::deque<Level> Levels; // stable address
+    std::vector<Level*> LevelIndex;
+    std::mutex Mutex;
+    std::exception_ptr Error;
+    std::optional<common::BasicPromise<std::vector<common::AlignedBuffer>>> Result; // set by Finish
+    TexCompressStats Stats;
+    size_t LiveBytes = 0;
+    uint32_t PendingTiles = 0;
+    TextureFormat Format;
+    bool NeedAlpha;
+    bool IsAbandoned = false;
+    Host(const TextureFormat format, const bool needAlpha) : Format(format), NeedAlpha(needAlpha) { }
+
+    void RunTile(Level& level, const uint32_t rowBegin, const uint32_t rowCount)
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            if (IsAbandoned)
+                return;
+        }
+        common::SimpleTimer timer;
+        timer.Start();
+        std::exception_ptr error;
+        try
+        {
+            const auto src = level.Source.RegionView(0, rowBegin, level.Source.GetWidth(), rowCount);
+            const auto dat = Compress(src, Format, NeedAlpha);
+            const auto offset = level.BlockRowBytes * (rowBegin / 4);
+            memcpy_s(level.Output.GetRawPtr() + offset, level.Output.GetSize() - offset, dat.GetRawPtr(), dat.GetSize());
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        timer.Stop();
+
+        std::unique_lock<std::mutex> lock(Mutex);
+        if (error && !Error)
+            Error = error;
+        Stats.CompressNs += timer.ElapseNs();
+        if (--level.PendingTiles == 0)
+        {
+            LiveBytes -= level.Source.GetSize();
+            level.Source = Image(level.Source.GetDataType()); // release source
+        }
+        if (--PendingTiles == 0 && Result)
+            Complete(lock);
+    }
+    // caller holds the lock, promise is fulfilled outside it
+    void Complete(std::unique_lock<std::mutex>& lock)
+    {
+        auto pms = std::move(*Result);
+        Result.reset();
+        std::vector<common::AlignedBuffer> outputs;
+        auto error = Error;
+        if (!error)
+        {
+            for (const auto level : LevelIndex)
+            {
+                if (!level)
+                {
+                    error = std::make_exception_ptr(OGLException(OGLException::GLComponent::OGLU, u"missing mip level in MipCompressStream"));
+                    break;
+                }
+                outputs.push_back(std::move(level->Output));
+            }
+        }
+        lock.unlock();
+        if (error)
+            pms.SetException(error);
+        else
+            pms.SetData(std::move(outputs));
+    }
+};
+
+
+MipCompressStream::MipCompressStream(const TextureFormat format, const bool needAlpha) :
+    Impl(std::make_shared<Host>(format, needAlpha))
+{
+    if (!TexFormatUtil::IsCompressType(format))
+        COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"MipCompressStream only accepts compressed format");
+}
+MipCompressStream::~MipCompressStream()
+{
+    std::lock_guard<std::mutex> lock(Impl->Mutex);
+    Impl->IsAbandoned = true;
+}
+
+void MipCompressStream::Push(const uint8_t level, ImageView img)
+{
+    CheckImgSize(img);
+    const auto width = img.GetWidth(), height = img.GetHeight();
+    const uint32_t blockBytes = TexFormatUtil::BitPerPixel(Impl->Format) * 2;
+    const uint32_t tileRows = std::max(TilePixels / width / 4 * 4, 4u);
+    Host::Level* target = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(Impl->Mutex);
+        if (Impl->Result)
+            COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"mip level pushed after Finish");
+        if (Impl->LevelIndex.size() <= level)
+            Impl->LevelIndex.resize(level + 1, nullptr);
+        if (Impl->LevelIndex[level])
+            COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"mip level pushed twice");
+        target = &Impl->Levels.emplace_back(std::move(img));
+        Impl->LevelIndex[level] = target;
+        target->BlockRowBytes = size_t(width / 4) * blockBytes;
+        target->Output = common::AlignedBuffer(target->BlockRowBytes * (height / 4));
+        target->PendingTiles = (height + tileRows - 1) / tileRows;
+        Impl->PendingTiles += target->PendingTiles;
+        Impl->Stats.Tiles += target->PendingTiles;
+        Impl->LiveBytes += target->Source.GetSize() + target->Output.GetSize();
+        Impl->Stats.PeakBytes = std::max(Impl->Stats.PeakBytes, Impl->LiveBytes);
+    }
+    auto& pool = common::WorkerPool::GetShared();
+    for (uint32_t row = 0; row < height; row += tileRows)
+    {
+        pool.Post([host = Impl, target, row, count = std::min(tileRows, height - row)]()
+        {
+            host->RunTile(*target, row, count);
+        });
+    }
+}
+
+common::PromiseResult<std::vector<common::AlignedBuffer>> MipCompressStream::Finish()
+{
+    std::unique_lock<std::mutex> lock(Impl->Mutex);
+    if (Impl->Result)
+        COMMON_THROW(OGLException, OGLException::GLComponent::OGLU, u"MipCompressStream finished twice");
+    Impl->Result.emplace();
+    auto ret = Impl->Result->GetPromiseResult();
+    if (Impl->PendingTiles == 0)
+        Impl->Complete(lock);
+    return ret;
+}
+
+TexCompressStats MipCompressStream::GetStats() const noexcept
+{
+    std::lock_guard<std::mutex> lock(Impl->Mutex);
+    return Impl->Stats;
+}
+
+
 }
@@ -1,10 +1,48 @@
 #pragma once
 #include "TexUtilRely.h"
+#include <memory>
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(push)
+#   pragma warning(disable:4275 4251)
+#endif
 
 namespace oglu::texutil
 {
 
-TEXUTILAPI common::AlignedBuffer CompressToDat(const xziar::img::ImageView& img, const xziar::img::TextureFormat format, const bool needAlpha = true);
+TEXUTILAPI common::AlignedBuffer CompressToDat(const xziar::img::ImageRegion& img, const xziar::img::TextureFormat format, const bool needAlpha = true);
+
+
+struct TexCompressStats
+{
+    uint64_t CompressNs = 0; // summed over all workers
+    size_t PeakBytes = 0; // peak of alive source levels and outputs
+    uint32_t Tiles = 0;
+};
+
+// compress mip levels as soon as they are pushed, each level is split into tiles of block rows and compressed on the shared worker pool.
+// source of a level is released once all its tiles are done, results are the same as CompressToDat on each level.
+class TEXUTILAPI MipCompressStream : public common::NonCopyable, public common::NonMovable
+{
+private:
+    class Host;
+    std::shared_ptr<Host> Impl;
+public:
+    ///<param name="format">compressed format</param>
+    ///<param name="needAlpha">same as CompressToDat</param>
+    MipCompressStream(const xziar::img::TextureFormat format, const bool needAlpha = true);
+    // tiles still queued are skipped
+    ~MipCompressStream();
+    // can be called from any thread before Finish, levels can come in any order
+    void Push(const uint8_t level, xziar::img::ImageView img);
+    // fulfilled when all pushed levels are compressed, carries the first error
+    [[nodiscard]] common::PromiseResult<std::vector<common::AlignedBuffer>> Finish();
+    [[nodiscard]] TexCompressStats GetStats() const noexcept;
+};
 
 
 }
+
+#if COMMON_COMPILER_MSVC
+#   pragma warning(pop)
+#endif
@@ -25,6 +25,7 @@ TexMipmap::TexMipmap(const std::shared_ptr<TexUtilWorker>& worker) : Worker(work
         CmdQue = Worker->CmdQue;
         if (CLContext)
         {
+            MemPool = oclMemPool_::Create(CLContext, 0);
             try
             {
                 oclu::CLProgConfig config;
@@ -163,9 +164,19 @@ PromiseResult<vector<Image>> TexMipmap::GenerateMipmapsCL(const ImageView src, c
             common::AlignedBuffer mainBuf(bytes, 4096);
             vector<Image> images;
             auto infoBuf = oclBuffer_::Create(CLContext, MemFlag::ReadOnly  | MemFlag::HostNoAccess | MemFlag::HostCopy, sizeof(Info) * infos.size(), infos.data());
-            auto inBuf   = oclBuffer_::Create(CLContext, MemFlag::ReadWrite | MemFlag::HostNoAccess | MemFlag::HostCopy, src.GetSize(), src.GetRawPtr());
-            auto midBuf  = oclBuffer_::Create(CLContext, MemFlag::ReadWrite | MemFlag::HostNoAccess                    , src.GetSize() / 2);
+            // ping-pong buffers are reused across calls, pool is bounded by the largest pair seen,
+            // older cached ones are trimmed so this pair fits when returned
+            const auto pairBytes = oclMemPool_::GetSizeClass(src.GetSize()) + oclMemPool_::GetSizeClass(src.GetSize() / 2);
+            if (pairBytes > MaxPairBytes)
+            {
+                MaxPairBytes = pairBytes;
+                MemPool->SetCapacity(MaxPairBytes * PoolPairs);
+            }
+            auto inBuf   = MemPool->AcquireBuffer(MemFlag::ReadWrite | MemFlag::HostWriteOnly, src.GetSize());
+            auto midBuf  = MemPool->AcquireBuffer(MemFlag::ReadWrite | MemFlag::HostNoAccess,  src.GetSize() / 2);
+            MemPool->Trim(MaxPairBytes * PoolPairs - pairBytes);
             auto outBuf  = oclBuffer_::Create(CLContext, MemFlag::WriteOnly | MemFlag::HostReadOnly | MemFlag::UseHost , mainBuf.GetSize(), mainBuf.GetRawPtr());
+            const auto pmsIn = inBuf->WriteSpan(CmdQue, src.AsSpan());
 
             size_t offset = 0;
             PromiseResult<oclu::CallResult> pms;
@@ -178,7 +189,7 @@ PromiseResult<vector<Image>> TexMipmap::GenerateMipmapsCL(const ImageView src, c
                 if (idx == 0)
                 {
                     pms = DownsampleSrc->Call<2>(inBuf, infoBuf, idx, midBuf, outBuf)
-                        (CmdQue, { (size_t)info.SrcWidth / 4, (size_t)info.SrcHeight / 4 }, { GroupX,GroupY });
+                        (pmsIn, CmdQue, { (size_t)info.SrcWidth / 4, (size_t)info.SrcHeight / 4 }, { GroupX,GroupY });
                 }
                 else
                 {
@@ -253,6 +264,44 @@ PromiseResult<vector<Image>> TexMipmap::GenerateMipmapsCPU(const ImageView src,
     });
 }
 
+PromiseResult<uint8_t> TexMipmap::GenerateMipmapsCPU(ImageView src, LevelCallback onLevel, const bool isSRGB, const uint8_t levels)
+{
+    auto infos = GenerateInfo(src.GetWidth(), src.GetHeight(), levels);
+    return Worker->AddTask([isSRGB, src = std::move(src), onLevel = std::move(onLevel), infos = std::move(infos)](const common::asyexe::AsyncAgent& agent) mutable
+    {
+        // only the last level is kept for next downsample
+        ImageView img = std::move(src);
+        uint64_t totalTime = 0;
+        common::SimpleTimer timer;
+        for (uint8_t idx = 0; idx < infos.size(); ++idx)
+        {
+            const auto& info = infos[idx];
+            timer.Start();
+            img = img.ResizeTo(info.SrcWidth / 2, info.SrcHeight / 2, isSRGB, false);
+            timer.Stop();
+            totalTime += timer.ElapseNs();
+            onLevel(idx, img);
+            agent.YieldThis();
+        }
+        texLog().debug(u"Mipmap streamed [{}] level within {}us.\n", infos.size(), totalTime / 1000);
+        return static_cast<uint8_t>(infos.size());
+    });
+}
+
+PromiseResult<uint8_t> TexMipmap::GenerateMipmaps(ImageView src, LevelCallback onLevel, const bool isSRGB, const uint8_t levels)
+{
+    if (!CLContext)
+        return GenerateMipmapsCPU(std::move(src), std::move(onLevel), isSRGB, levels);
+    auto pms = GenerateMipmapsCL(std::move(src), isSRGB, levels);
+    return Worker->AddTask([pms = std::move(pms), onLevel = std::move(onLevel)](const common::asyexe::AsyncAgent& agent)
+    {
+        auto images = agent.Await(pms);
+        for (uint8_t idx = 0; idx < images.size(); ++idx)
+            onLevel(idx, std::move(images[idx]));
+        return static_cast<uint8_t>(images.size());
+    });
+}
+
 common::PromiseResult<std::vector<xziar::img::Image>> TexMipmap::GenerateMipmaps(const xziar::img::ImageView src, const bool isSRGB, const uint8_t levels)
 {
     if (CLContext)
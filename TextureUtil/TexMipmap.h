@@ -1,5 +1,6 @@
 #pragma once
 #include "TexUtilRely.h"
+#include <functional>
 
 
 #if COMMON_COMPILER_MSVC
@@ -13,11 +14,18 @@ namespace oglu::texutil
 
 class TEXUTILAPI TexMipmap : public common::NonCopyable, public common::NonMovable
 {
+public:
+    // receives mip level [level] (0 is the first downsampled one), called on worker thread
+    using LevelCallback = std::function<void(const uint8_t level, xziar::img::ImageView img)>;
 private:
     std::shared_ptr<TexUtilWorker> Worker;
     oglContext GLContext;
     oclu::oclContext CLContext;
     oclu::oclCmdQue CmdQue;
+    oclu::oclMemPool MemPool;
+    // bytes of the largest ping-pong pair requested, pool keeps at most [PoolPairs] of it
+    size_t MaxPairBytes = 0;
+    static constexpr size_t PoolPairs = 2;
     oclu::oclKernel DownsampleSrc;
     oclu::oclKernel DownsampleMid;
     oclu::oclKernel DownsampleRaw;
@@ -26,11 +34,17 @@ private:
         (const xziar::img::ImageView src, const bool isSRGB, const uint8_t levels);
     common::PromiseResult<std::vector<xziar::img::Image>> GenerateMipmapsCPU
         (const xziar::img::ImageView src, const bool isSRGB, const uint8_t levels);
+    common::PromiseResult<uint8_t> GenerateMipmapsCPU
+        (xziar::img::ImageView src, LevelCallback onLevel, const bool isSRGB, const uint8_t levels);
 public:
     TexMipmap(const std::shared_ptr<TexUtilWorker>& worker);
     ~TexMipmap();
     common::PromiseResult<std::vector<xziar::img::Image>> GenerateMipmaps
         (const xziar::img::ImageView src, const bool isSRGB = true, const uint8_t levels = 255);
+    // hand each level to [onLevel] once it's generated without keeping it, returns count of levels.
+    // CPU path streams level by level, CL path generates all levels in one buffer so they come together.
+    common::PromiseResult<uint8_t> GenerateMipmaps
+        (xziar::img::ImageView src, LevelCallback onLevel, const bool isSRGB = true, const uint8_t levels = 255);
 
     void Test();
     void Test2();
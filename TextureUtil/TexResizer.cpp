@@ -18,11 +18,15 @@ using namespace std::literals;
 
 TexResizer::TexResizer(const std::shared_ptr<TexUtilWorker>& worker) : Worker(worker)
 {
-    Worker->AddTask([this](const auto&)
+    Worker->AddTask([this](const auto& agent)
     {
         GLContext = Worker->GLContext;
         CLContext = Worker->CLContext;
         CmdQue = Worker->CmdQue;
+        // CL program is built on build workers while GL shaders are compiled here
+        PromiseResult<oclProgram> clProgPms;
+        if (CLContext)
+            clProgPms = oclProgram_::CreateAndBuildAsync(CLContext, LoadShaderFromDLL(IDR_SHADER_CLRESIZER), {}, CLContext->Devices[0]);
         GLContext->SetSRGBFBO(true);
         GLContext->SetDepthTest(DepthTestType::OFF);
         const auto shaderTxt = LoadShaderFromDLL(IDR_SHADER_GLRESIZER);
@@ -71,8 +75,7 @@ TexResizer::TexResizer(const std::shared_ptr<TexUtilWorker>& worker) : Worker(wo
         {
             try
             {
-                oclu::CLProgConfig config;
-                auto clProg = oclProgram_::CreateAndBuild(CLContext, LoadShaderFromDLL(IDR_SHADER_CLRESIZER), config, CLContext->Devices[0]);
+                const auto clProg = agent.Await(clProgPms);
                 KerToImg = clProg->GetKernel("ResizeToImg");
                 KerToDat3 = clProg->GetKernel("ResizeToDat3");
                 KerToDat4 = clProg->GetKernel("ResizeToDat4");
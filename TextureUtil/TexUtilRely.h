@@ -17,6 +17,7 @@
 #include "OpenCLUtil/oclProgram.h"
 #include "OpenCLUtil/oclImage.h"
 #include "OpenCLUtil/oclBuffer.h"
+#include "OpenCLUtil/oclMemPool.h"
 #include "ImageUtil/ImageCore.h"
 #include "SystemCommon/PromiseTask.h"
 #include "SystemCommon/Exceptions.h"
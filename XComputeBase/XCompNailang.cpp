@@ -1,10 +1,14 @@
 #include "XCompNailang.h"
 #include "SystemCommon/StackTrace.h"
 #include "SystemCommon/StringConvert.h"
+#include "SystemCommon/FileEx.h"
+#include "SystemCommon/WorkerPool.h"
 #include "common/StrParsePack.hpp"
 #include "common/StaticLookup.hpp"
 #include <shared_mutex>
 #include <mutex>
+#include <thread>
+#include <algorithm>
 
 namespace xcomp
 {
@@ -32,6 +36,8 @@ using xziar::nailang::NailangFrame;
 using xziar::nailang::NailangExecutor;
 using xziar::nailang::NailangRuntime;
 using xziar::nailang::NailangRuntimeException;
+using xziar::nailang::NailangProfiler;
+using xziar::nailang::TextRope;
 using xziar::nailang::detail::ExceptionTarget;
 using common::mlog::LogLevel;
 using common::str::Encoding;
@@ -82,7 +88,32 @@ NamedTextHolder::NamedText::NamedText(std::u32string_view content,
 NamedTextHolder::~NamedTextHolder()
 { }
 
-void NamedTextHolder::ForceAdd(std::vector<NamedText>& container, std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends)
+std::optional<common::StringPiece<char32_t>> NamedTextHolder::FindName(std::u32string_view name) const noexcept
+{
+    const auto [begin, end] = NameIndex.equal_range(common::DJBHash::HashC(name));
+    for (auto it = begin; it != end; ++it)
+    {
+        if (Names.GetStringView(it->second) == name)
+            return it->second;
+    }
+    return {};
+}
+
+common::StringPiece<char32_t> NamedTextHolder::InternName(std::u32string_view name)
+{
+    const auto hash = common::DJBHash::HashC(name);
+    const auto [begin, end] = NameIndex.equal_range(hash);
+    for (auto it = begin; it != end; ++it)
+    {
+        if (Names.GetStringView(it->second) == name)
+            return it->second;
+    }
+    const auto piece = Names.AllocateString(name);
+    NameIndex.emplace(hash, piece);
+    return piece;
+}
+
+void NamedTextHolder::ForceAdd(NamedTextList& container, std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends)
 {
     const auto offset = Dependencies.size();
     Dependencies.reserve(offset + depends.size());
@@ -90,38 +121,24 @@ void NamedTextHolder::ForceAdd(std::vector<NamedText>& container, std::u32string
     {
         if (dep == id) // early check for self-dependency
             COMMON_THROW(common::BaseException, FMTSTR(u"self dependency at [{}] for [{}]"sv, &dep - depends.data(), id));
-
-        bool match = false;
-        for (size_t i = 0; i < container.size(); ++i)
-        {
-            const auto& item = container[i];
-            if (GetID(item) == dep)
-            {
-                const auto idx = gsl::narrow_cast<uint32_t>(i);
-                Dependencies.emplace_back(item.IDStr, idx);
-                match = true;
-                break;
-            }
-        }
-
-        if (!match)
-        {
-            const auto str = Names.AllocateString(dep);
-            Dependencies.emplace_back(str, UINT32_MAX);
-        }
+        const auto str = InternName(dep);
+        const auto it = container.Index.find(NameKey(str));
+        Dependencies.emplace_back(str, it == container.Index.end() ? UINT32_MAX : it->second);
     }
-    const auto idstr = Names.AllocateString(id);
-    container.push_back({ content.ExtractStr(), idstr, offset, depends.size() });
+    const auto idstr = InternName(id);
+    const auto idx = gsl::narrow_cast<uint32_t>(container.Items.size());
+    container.Items.push_back({ content.ExtractStr(), idstr, offset, depends.size() });
+    container.Index.try_emplace(NameKey(idstr), idx); // keep the first one for duplicated id
 }
 
-void NamedTextHolder::Write(std::u32string& output, const NamedText& item) const
+void NamedTextHolder::Write(TextRope& output, const NamedText& item) const
 {
     APPEND_FMT(output, U"    //vvvvvvvv below injected by {}  vvvvvvvv\r\n"sv, GetID(item));
     output.append(item.Content).append(U"\r\n"sv);
     APPEND_FMT(output, U"    //^^^^^^^^ above injected by {}  ^^^^^^^^\r\n\r\n"sv, GetID(item));
 }
 
-void NamedTextHolder::Write(std::u32string& output, const std::vector<NamedText>& container) const
+void NamedTextHolder::Write(TextRope& output, const NamedTextList& container) const
 {
     if (Dependencies.empty() || container.empty()) // fast path
     {
@@ -129,49 +146,67 @@ void NamedTextHolder::Write(std::u32string& output, const std::vector<NamedText>
             Write(output, item);
         return;
     }
-    std::vector<bool> outputMask(container.size(), false);
-    size_t waiting = container.size();
-    while (waiting > 0)
+    // Items are output in rounds, each round outputs items in order when all their dependencies are output.
+    // So the round of an item is decided by its dependencies: same round if the dependency is before it, otherwise the next round.
+    // Calculate it with DFS once instead of scanning the container round by round.
+    constexpr uint32_t NotVisited = UINT32_MAX, Visiting = UINT32_MAX - 1, Unresolved = UINT32_MAX - 2;
+    const auto count = gsl::narrow_cast<uint32_t>(container.size());
+    std::vector<uint32_t> rounds(count, NotVisited);
+    std::vector<std::pair<uint32_t, uint32_t>> stack; // item, next dependency to visit
+    for (uint32_t i = 0; i < count; ++i)
     {
-        const auto last = waiting;
-        for (size_t i = 0; i < container.size(); ++i)
+        if (rounds[i] != NotVisited)
+            continue;
+        rounds[i] = Visiting;
+        stack.emplace_back(i, 0u);
+        while (!stack.empty())
         {
-            if (outputMask[i])
+            const auto [cur, next] = stack.back();
+            const auto& item = container[cur];
+            if (next < item.DependCount())
+            {
+                stack.back().second++;
+                const auto depIdx = SearchDepend(container, item, next);
+                if (!depIdx.has_value())
+                    COMMON_THROW(common::BaseException, FMTSTR(u"unsolved dependency [{}] for [{}]"sv,
+                        GetDepend(item, next), GetID(item)));
+                if (rounds[*depIdx] == NotVisited)
+                {
+                    rounds[*depIdx] = Visiting;
+                    stack.emplace_back(*depIdx, 0u);
+                }
                 continue;
-            const auto& item = container[i];
-            if (item.DependCount() != 0)
+            }
+            uint32_t round = 0;
+            for (uint32_t j = 0; j < item.DependCount(); ++j)
             {
-                bool satisfy = true;
-                for (uint32_t j = 0; satisfy && j < item.DependCount(); ++j)
+                const auto depIdx = *SearchDepend(container, item, j);
+                const auto depRound = rounds[depIdx];
+                if (depRound >= Unresolved) // circular dependency, or depends on unresolved one
                 {
-                    const auto depIdx = SearchDepend(container, item, j);
-                    if (!depIdx.has_value())
-                    {
-                        satisfy = false;
-                        COMMON_THROW(common::BaseException, FMTSTR(u"unsolved dependency [{}] for [{}]"sv,
-                            GetDepend(item, j), GetID(item)));
-                    }
-                    else if (!outputMask[depIdx.value()])
-                    {
-                        satisfy = false;
-                    }
+                    round = Unresolved;
+                    break;
                 }
-                if (!satisfy) // skip this item
-                    continue;
+                round = std::max(round, depIdx < cur ? depRound : depRound + 1);
             }
-            Write(output, item);
-            outputMask[i] = true;
-            waiting--;
+            rounds[cur] = round;
+            stack.pop_back();
         }
-        if (last == waiting) // some item cannot be resolved
-            break;
     }
-    if (waiting > 0) // generate report and throw
+
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (rounds[i] != Unresolved)
+            order.push_back(i);
+    }
+    if (order.size() < count) // generate report and throw
     {
         std::u16string report = u"unmatched dependencies:\r\n"s;
-        for (size_t i = 0; i < container.size(); ++i)
+        for (uint32_t i = 0; i < count; ++i)
         {
-            if (outputMask[i])
+            if (rounds[i] != Unresolved)
                 continue;
             const auto& item = container[i];
             Expects(item.DependCount() != 0);
@@ -181,7 +216,7 @@ void NamedTextHolder::Write(std::u32string& output, const std::vector<NamedText>
             {
                 const auto depIdx = SearchDepend(container, item, j);
                 Expects(depIdx.has_value());
-                if (!outputMask[depIdx.value()])
+                if (rounds[depIdx.value()] == Unresolved)
                 {
                     if (unmth++ > 0)
                         report.append(u", "sv);
@@ -193,6 +228,12 @@ void NamedTextHolder::Write(std::u32string& output, const std::vector<NamedText>
         }
         COMMON_THROW(common::BaseException, report);
     }
+    std::stable_sort(order.begin(), order.end(), [&](const uint32_t lhs, const uint32_t rhs)
+        {
+            return rounds[lhs] < rounds[rhs];
+        });
+    for (const auto idx : order)
+        Write(output, container[idx]);
 }
 
 
@@ -413,10 +454,50 @@ size_t XCNLContext::FindStruct(std::u32string_view name) const
     return SIZE_MAX;
 }
 
-void XCNLContext::Write(std::u32string& output, const NamedText& item) const
+void XCNLContext::AddPatch(std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends)
+{
+    if (RecordPatch)
+        PatchLog.push_back({ {}, gsl::narrow_cast<uint32_t>(PatchedBlocks.size()), PatchEvent::Types::Commit });
+    ForceAdd(PatchedBlocks, id, std::move(content), depends);
+}
+
+void XCNLContext::MergePatches(const XCNLContext& fork)
+{
+    // a request whose patch already exists here would not have run its generator, so skip its nested events
+    uint32_t skipLevel = 0;
+    std::vector<std::u32string_view> depends;
+    for (const auto& evt : fork.PatchLog)
+    {
+        switch (evt.Type)
+        {
+        case PatchEvent::Types::Enter:
+            if (skipLevel > 0 || CheckExists(PatchedBlocks, evt.ID))
+                skipLevel++;
+            break;
+        case PatchEvent::Types::Leave:
+            if (skipLevel > 0)
+                skipLevel--;
+            break;
+        case PatchEvent::Types::Commit:
+            if (skipLevel == 0)
+            {
+                const auto& item = fork.PatchedBlocks[evt.Index];
+                depends.clear();
+                for (uint32_t i = 0; i < item.DependCount(); ++i)
+                    depends.push_back(fork.GetDepend(item, i));
+                AddPatch(fork.GetID(item), std::u32string(item.Content), depends);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void XCNLContext::Write(TextRope& output, const NamedText& item) const
 {
     APPEND_FMT(output, U"/* Patched Block [{}] */\r\n"sv, GetID(item));
-    output.append(item.Content).append(U"\r\n\r\n"sv);
+    output.AppendView(item.Content).append(U"\r\n\r\n"sv); // context outlives the output
 }
 
 
@@ -450,11 +531,14 @@ Arg XCNLExecutor::EvaluateFunc(FuncEvalPack& func)
                 return std::move(ret.value());
         }
     }
+    const auto profiler = Runtime->GetProfiler();
     for (const auto& ext : GetExtensions())
     {
+        NailangProfiler::Scope profScope(profiler, NailangProfiler::Category::Extension, ext->GetName());
         auto ret = ext->ConfigFunc(*this, func);
         if (ret)
             return std::move(ret.value());
+        profScope.Discard();
     }
     return NailangExecutor::EvaluateFunc(func);
 }
@@ -621,9 +705,10 @@ std::optional<common::str::StrVariant<char32_t>> XCNLRawExecutor::CommonReplaceF
                 }
             }
             auto frame = PushFrame(*block, std::move(ctx), nullptr);
-            auto output = FMTSTR(U"// template block [{}]\r\n"sv, args[0]);
+            TextRope output;
+            APPEND_FMT(output, U"// template block [{}]\r\n"sv, args[0]);
             DirectOutput(*block, output);
-            return output;
+            return output.ToU32String();
         }
         break;
     }
@@ -635,13 +720,16 @@ std::optional<common::str::StrVariant<char32_t>> XCNLRawExecutor::CommonReplaceF
 ReplaceResult XCNLRawExecutor::ExtensionReplaceFunc(std::u32string_view func, U32StrSpan args)
 {
     auto& runtime = GetRuntime();
+    const auto profiler = runtime.GetProfiler();
     for (const auto& ext : GetExtensions())
     {
         if (!ext) continue;
+        NailangProfiler::Scope profScope(profiler, NailangProfiler::Category::Extension, ext->GetName());
         auto ret = ext->ReplaceFunc(*this, func, args);
         const auto str = ret.GetStr();
         if (!ret && ret.CheckAllowFallback())
         {
+            profScope.Discard();
             if (!str.empty())
                 runtime.Logger.warning(FMT_STRING(u"when replace-func [{}]: {}\r\n"), func, ret.GetStr());
             continue;
@@ -669,7 +757,7 @@ ReplaceResult XCNLRawExecutor::ExtensionReplaceFunc(std::u32string_view func, U3
     return { FMTSTR(U"[{}] with [{}]args not resolved", func, args.size()), false };
 }
 
-void XCNLRawExecutor::OnReplaceOptBlock(std::u32string& output, void*, std::u32string_view cond, std::u32string_view content)
+void XCNLRawExecutor::OnReplaceOptBlock(TextRope& output, void*, std::u32string_view cond, std::u32string_view content)
 {
     auto& executor = GetExecutor();
     if (cond.back() == U';')
@@ -700,11 +788,11 @@ void XCNLRawExecutor::OnReplaceOptBlock(std::u32string& output, void*, std::u32s
     }
     else if (ret.GetBool().value())
     {
-        output.append(content);
+        output.AppendView(content);
     }
 }
 
-void XCNLRawExecutor::OnReplaceVariable(std::u32string& output, [[maybe_unused]] void* cookie, std::u32string_view var)
+void XCNLRawExecutor::OnReplaceVariable(TextRope& output, [[maybe_unused]] void* cookie, std::u32string_view var)
 {
     auto& executor = GetExecutor();
     if (var.size() == 0)
@@ -739,9 +827,10 @@ void XCNLRawExecutor::OnReplaceVariable(std::u32string& output, [[maybe_unused]]
     }
 }
 
-void XCNLRawExecutor::OnReplaceFunction(std::u32string& output, void*, std::u32string_view func, common::span<const std::u32string_view> args)
+void XCNLRawExecutor::OnReplaceFunction(TextRope& output, void*, std::u32string_view func, common::span<const std::u32string_view> args)
 {
     auto& executor = GetExecutor();
+    NailangProfiler::Scope profScope(GetRuntime().GetProfiler(), NailangProfiler::Category::ReplaceFunc, func);
     if (IsBeginWith(func, U"xcomp."sv))
     {
         const auto subName = func.substr(6);
@@ -766,7 +855,7 @@ void XCNLRawExecutor::OnReplaceFunction(std::u32string& output, void*, std::u32s
     }
 }
 
-void XCNLRawExecutor::OutputConditions(common::span<const xziar::nailang::FuncCall> metas, std::u32string& dst)
+void XCNLRawExecutor::OutputConditions(common::span<const xziar::nailang::FuncCall> metas, TextRope& dst)
 {
     // std::set<std::u32string_view> lateVars;
     for (const auto& meta : metas)
@@ -783,7 +872,7 @@ void XCNLRawExecutor::OutputConditions(common::span<const xziar::nailang::FuncCa
     }
 }
 
-void XCNLRawExecutor::BeforeOutputBlock(const OutputBlock& block, std::u32string& dst) const
+void XCNLRawExecutor::BeforeOutputBlock(const OutputBlock& block, TextRope& dst) const
 {
     APPEND_FMT(dst, U"\r\n/* From {} Block [{}] */\r\n"sv, block.GetBlockTypeName(), block.Block->Name);
 
@@ -792,45 +881,67 @@ void XCNLRawExecutor::BeforeOutputBlock(const OutputBlock& block, std::u32string
     OutputConditions(block.MetaFunc, dst);
 }
 
-void XCNLRawExecutor::DirectOutput(const OutputBlock& block, std::u32string& dst)
+void XCNLRawExecutor::DirectOutput(const OutputBlock& block, TextRope& dst)
 {
     auto& executor = GetExecutor();
     auto& runtime = GetRuntime();
     Expects(runtime.CurFrame() != nullptr);
     OutputConditions(block.MetaFunc, dst);
-    common::str::StrVariant<char32_t> source(block.Block->Source);
+    std::u32string_view source = block.Block->Source;
     EvalTempStore store;
     for (const auto& [var, arg] : block.PreAssignArgs)
     {
         runtime.LocateArg(var, true).Set(executor.EvaluateExpr(arg, store));
         store.Reset();
     }
-    if (block.ReplaceVar || block.ReplaceFunc)
-        source = ProcessOptBlock(source.StrView(), U"$$@"sv, U"@$$"sv);
+    if (!block.ReplaceVar && !block.ReplaceFunc)
+    {
+        dst.AppendView(source);
+        return;
+    }
+    // each stage reads the flattened text of the previous one and keeps it,
+    // so an intermediate is released once the next stage is built, only the last one goes to dst
+    TextRope stage;
+    ProcessOptBlock(stage, source, U"$$@"sv, U"@$$"sv);
+    const auto nextStage = [&]()
+    {
+        TextRope next;
+        source = next.Keep(stage.ToU32String());
+        stage = std::move(next);
+    };
     if (block.ReplaceVar)
-        source = ProcessVariable(source.StrView(), U"$$!{"sv, U"}"sv);
+    {
+        nextStage();
+        ProcessVariable(stage, source, U"$$!{"sv, U"}"sv);
+    }
     if (block.ReplaceFunc)
-        source = ProcessFunction(source.StrView(), U"$$!"sv, U""sv);
-    dst.append(source.StrView());
+    {
+        nextStage();
+        ProcessFunction(stage, source, U"$$!"sv, U""sv);
+    }
+    dst.Append(std::move(stage));
 }
 
-void XCNLRawExecutor::ProcessGlobal(const OutputBlock& block, std::u32string& output)
+void XCNLRawExecutor::ProcessGlobal(const OutputBlock& block, TextRope& output)
 {
+    NailangProfiler::Scope profScope(GetRuntime().GetProfiler(), NailangProfiler::Category::RawBlock, block.Name());
     auto frame = PushFrame(block, GetExecutor().CreateContext(), nullptr);
     BeforeOutputBlock(block, output);
     DirectOutput(block, output);
 }
 
-void XCNLRawExecutor::ProcessStruct(const OutputBlock& block, std::u32string& output)
+void XCNLRawExecutor::ProcessStruct(const OutputBlock& block, TextRope& output)
 {
+    NailangProfiler::Scope profScope(GetRuntime().GetProfiler(), NailangProfiler::Category::RawBlock, block.Name());
     auto frame = PushFrame(block, GetExecutor().CreateContext(), nullptr);
     BeforeOutputBlock(block, output);
     DirectOutput(block, output);
 }
 
-void XCNLRawExecutor::ProcessInstance(const OutputBlock& block, std::u32string& output)
+void XCNLRawExecutor::ProcessInstance(const OutputBlock& block, TextRope& output)
 {
     Expects(block.Type == OutputBlock::BlockType::Instance);
+    NailangProfiler::Scope profScope(GetRuntime().GetProfiler(), NailangProfiler::Category::RawBlock, block.Name());
     BeforeOutputBlock(block, output);
 
     auto& executor = GetExecutor();
@@ -1251,11 +1362,21 @@ InstanceArgData XCNLRuntime::ParseInstanceArg(std::u32string_view argTypeName, F
     return { std::move(args), std::move(name), std::move(dtype), argType, texType };
 }
 
-void XCNLRuntime::BeforeFinishOutput(std::u32string&, std::u32string&, std::u32string&, std::u32string&)
+void XCNLRuntime::BeforeFinishOutput(TextRope&, TextRope&, TextRope&, TextRope&)
+{ }
+
+bool XCNLRuntime::SupportParallelInstance() const noexcept
+{
+    return std::all_of(XCContext.Extensions.cbegin(), XCContext.Extensions.cend(),
+        [](const auto& ext) { return ext->SupportParallelInstance(); });
+}
+
+void XCNLRuntime::MergeFork(XCNLRuntime&)
 { }
 
 void XCNLRuntime::ProcessConfigBlock(const Block& block, MetaFuncs metas)
 {
+    NailangProfiler::Scope profScope(Profiler, NailangProfiler::Category::Block, block.Name);
     auto& executor = GetConfigurator().GetExecutor();
     auto frame = executor.PushBlockFrame(ConstructEvalContext(), NailangFrame::FrameFlags::FlowScope, &block, metas);
     if (!metas.empty())
@@ -1270,6 +1391,7 @@ void XCNLRuntime::ProcessConfigBlock(const Block& block, MetaFuncs metas)
 
 void XCNLRuntime::ProcessStructBlock(const Block& block, MetaFuncs metas)
 {
+    NailangProfiler::Scope profScope(Profiler, NailangProfiler::Category::Block, block.Name);
     auto& handler = GetStructHandler();
     auto& executor = handler.GetExecutor();
     auto dummyFrame = executor.PushBlockFrame(ConstructEvalContext(), NailangFrame::FrameFlags::FlowScope, &block, metas);
@@ -1290,6 +1412,8 @@ void XCNLRuntime::CollectRawBlock(const RawBlock& block, MetaFuncs metas)
     const auto type = GetBlockType(block, metas);
     if (type == OutputBlock::BlockType::None)
         return;
+    if (XCContext.InstanceOnly && type != OutputBlock::BlockType::Instance && type != OutputBlock::BlockType::Template)
+        return;
     OutputBlock outBlk(&block, metas, type);
     if (!GetConfigurator().PrepareOutputBlock(outBlk))
         return;
@@ -1298,19 +1422,21 @@ void XCNLRuntime::CollectRawBlock(const RawBlock& block, MetaFuncs metas)
     dst.push_back(std::move(outBlk));
 }
 
-std::string XCNLRuntime::GenerateOutput()
+void XCNLRuntime::OutputCommon(TextRope& prefixes, TextRope& structs, TextRope& globals)
 {
-    std::u32string prefixes, structs, globals, kernels;
     auto& rawExe = GetRawExecutor();
-
     for (const auto& block : XCContext.OutputBlocks)
     {
         if (block.Type == OutputBlock::BlockType::Prefix)
             rawExe.ProcessGlobal(block, prefixes);
     }
-    for (const auto& target : XCContext.CustomStructs)
     {
-        GetStructHandler().OutputStruct(*target, structs);
+        std::u32string structDefs;
+        for (const auto& target : XCContext.CustomStructs)
+        {
+            GetStructHandler().OutputStruct(*target, structDefs);
+        }
+        structs.AppendView(structs.Keep(std::move(structDefs)));
     }
     for (const auto& block : XCContext.OutputBlocks)
     {
@@ -1322,11 +1448,24 @@ std::string XCNLRuntime::GenerateOutput()
         if (block.Type == OutputBlock::BlockType::Global)
             rawExe.ProcessGlobal(block, globals);
     }
+}
+
+void XCNLRuntime::OutputInstances(size_t begin, size_t end, TextRope& kernels)
+{
+    auto& rawExe = GetRawExecutor();
+    size_t idx = 0;
     for (const auto& block : XCContext.OutputBlocks)
     {
-        if (block.Type == OutputBlock::BlockType::Instance)
+        if (block.Type != OutputBlock::BlockType::Instance)
+            continue;
+        if (idx >= begin && idx < end)
             rawExe.ProcessInstance(block, kernels);
+        idx++;
     }
+}
+
+std::string XCNLRuntime::FinishOutput(TextRope& prefixes, TextRope& structs, TextRope& globals, TextRope& kernels)
+{
     for (const auto& ext : XCContext.Extensions)
     {
         ext->FinishXCNL(*this);
@@ -1336,15 +1475,25 @@ std::string XCNLRuntime::GenerateOutput()
 
     // Output patched blocks
     XCContext.WritePatchedBlock(structs);
+    // encode all parts in one pass
     std::string output;
-    for (const auto& part : std::array<std::u32string_view, 4>{ prefixes, structs, globals, kernels })
+    output.reserve(prefixes.size() + structs.size() + globals.size() + kernels.size());
+    for (const auto part : { &prefixes, &structs, &globals, &kernels })
     {
-        output.append(common::str::to_string(part, Encoding::UTF8, Encoding::UTF32));
+        part->AppendUTF8(output);
     }
 
     return output;
 }
 
+std::string XCNLRuntime::GenerateOutput()
+{
+    TextRope prefixes, structs, globals, kernels;
+    OutputCommon(prefixes, structs, globals);
+    OutputInstances(0, SIZE_MAX, kernels);
+    return FinishOutput(prefixes, structs, globals, kernels);
+}
+
 
 class XComputeParser : xziar::nailang::NailangParser
 {
@@ -1374,9 +1523,76 @@ XCNLProgStub::XCNLProgStub(const std::shared_ptr<const XCNLProgram>& program, st
     std::unique_ptr<XCNLRuntime>&& runtime) : Program(program), Context(std::move(context)), Runtime(std::move(runtime))
 {
     Prepare(Runtime->Logger);
+    if (common::CheckEnvOn("XCNL_PROFILE"))
+        EnableProfiler();
+    else
+    {
+        // read in native encoding, so that non-ASCII paths survive on Windows
+#if COMMON_COMPILER_MSVC
+#   pragma warning(suppress: 4996)
+#endif
+#if COMMON_OS_WIN
+        const auto env = _wgetenv(L"XCNL_PROFILE");
+#else
+        const auto env = getenv("XCNL_PROFILE");
+#endif
+        if (env && *env)
+            EnableProfiler(common::fs::path(env));
+    }
+#if COMMON_COMPILER_MSVC
+#   pragma warning(suppress: 4996)
+#endif
+    if (const auto env = getenv("XCNL_THREADS"); env && *env)
+    {
+        SetParallelism(static_cast<uint32_t>(std::strtoul(env, nullptr, 10)));
+    }
 }
 XCNLProgStub::~XCNLProgStub()
 { }
+common::mlog::MiniLogger<false>& XCNLProgStub::GetLogger() const noexcept
+{
+    return Runtime->Logger;
+}
+void XCNLProgStub::SetParallelism(uint32_t threads) noexcept
+{
+    Parallelism = threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threads;
+}
+xziar::nailang::NailangProfiler& XCNLProgStub::EnableProfiler(common::fs::path output)
+{
+    if (!Profiler)
+        Profiler = std::make_unique<NailangProfiler>();
+    ProfileOutput = std::move(output);
+    Runtime->SetProfiler(Profiler.get());
+    return *Profiler;
+}
+void XCNLProgStub::ReportProfile() const
+{
+    if (!Profiler)
+        return;
+    const auto summaries = Profiler->Summarize();
+    std::u16string txt;
+    APPEND_FMT(txt, u"XCNL profile of [{}], total [{:.3f}]ms:\n"sv, Program->FileName, Profiler->GetTotalNs() / 1e6);
+    APPEND_FMT(txt, u"{:>10} {:>10} {:>10}  {}\n"sv, u"count"sv, u"incl(ms)"sv, u"excl(ms)"sv, u"name"sv);
+    for (const auto& summary : summaries)
+    {
+        APPEND_FMT(txt, u"{:>10} {:>10.3f} {:>10.3f}  [{}]{}\n"sv, summary.Count, summary.InclusiveNs / 1e6, summary.ExclusiveNs / 1e6,
+            NailangProfiler::GetCategoryName(summary.Type), summary.Name);
+    }
+    Runtime->Logger.debug(txt);
+    if (!ProfileOutput.empty())
+    {
+        const auto path = ProfileOutput.u16string();
+        try
+        {
+            common::file::WriteAll(ProfileOutput, Profiler->ExportFoldedStacks());
+            Runtime->Logger.debug(u"Folded stacks written to [{}].\n", path);
+        }
+        catch (const common::BaseException& be)
+        {
+            Runtime->Logger.warning(u"Failed to write folded stacks to [{}]: {}\n", path, be.Message());
+        }
+    }
+}
 void XCNLProgStub::Prepare(common::mlog::MiniLogger<false>& logger)
 {
     Context->Extensions.clear();
@@ -1449,6 +1665,89 @@ void XCNLProgStub::PostAct(common::span<const std::u32string_view> types) const
         ExecuteBlocks(type);
     }
 }
+std::unique_ptr<XCNLProgStub> XCNLProgStub::Fork(common::mlog::MiniLogger<false>&) const
+{
+    return {};
+}
+std::string XCNLProgStub::GenerateOutput(const std::function<void(XCNLProgStub&)>& configurer)
+{
+    const auto instCount = static_cast<size_t>(std::count_if(Context->OutputBlocks.cbegin(), Context->OutputBlocks.cend(),
+        [](const OutputBlock& block) { return block.Type == OutputBlock::BlockType::Instance; }));
+    const auto threads = std::min<size_t>(Parallelism, instCount);
+    if (threads <= 1 || !Runtime->SupportParallelInstance())
+        return Runtime->GenerateOutput();
+    // forks log through their own logger, which is muted while replaying the configuration already logged by this stub
+    auto& logger = GetLogger();
+    const auto logLevel = logger.GetLeastLevel();
+    std::vector<std::unique_ptr<common::mlog::MiniLogger<false>>> forkLoggers;
+    std::vector<std::unique_ptr<XCNLProgStub>> forks;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        auto& forkLogger = *forkLoggers.emplace_back(std::make_unique<common::mlog::MiniLogger<false>>(logger, common::mlog::LogLevel::None));
+        auto fork = Fork(forkLogger);
+        if (!fork)
+            return Runtime->GenerateOutput();
+        fork->Runtime->SetProfiler(nullptr);
+        fork->Profiler.reset();
+        fork->Context->RecordPatch = true;
+        fork->Context->InstanceOnly = true;
+        forks.push_back(std::move(fork));
+    }
+
+    // each fork replays the configuration and expands a continuous range of instances, 
+    // while common blocks are output by this stub
+    std::vector<TextRope> forkKernels(threads);
+    std::vector<std::exception_ptr> forkErrors(threads);
+    TextRope prefixes, structs, globals, kernels;
+    std::exception_ptr error;
+    // index 0 outputs common blocks, others run forks, errors are kept and rethrown in order after all finished
+    common::WorkerPool::GetShared().ParallelFor(threads + 1, 0, [&](const size_t idx)
+        {
+            if (idx == 0)
+            {
+                try
+                {
+                    Runtime->OutputCommon(prefixes, structs, globals);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                return;
+            }
+            const auto i = idx - 1;
+            try
+            {
+                auto& fork = *forks[i];
+                configurer(fork);
+                if (fork.Context->OutputBlocks.size() != instCount)
+                    COMMON_THROW(common::BaseException, u"Forked stub collected different instance blocks"sv);
+                forkLoggers[i]->SetLeastLevel(logLevel);
+                fork.Runtime->OutputInstances(instCount * i / threads, instCount * (i + 1) / threads, forkKernels[i]);
+            }
+            catch (...)
+            {
+                forkErrors[i] = std::current_exception();
+            }
+        });
+    if (error)
+        std::rethrow_exception(error);
+    for (const auto& forkError : forkErrors)
+    {
+        if (forkError)
+            std::rethrow_exception(forkError);
+    }
+
+    // merge in instance order, so patches and kernels are the same as sequential output
+    for (size_t i = 0; i < threads; ++i)
+    {
+        Context->MergePatches(*forks[i]->Context);
+        Runtime->MergeFork(*forks[i]->Runtime);
+        kernels.Append(std::move(forkKernels[i]));
+    }
+    // kernels may reference storage of forks, keep them until encoded
+    return Runtime->FinishOutput(prefixes, structs, globals, kernels);
+}
 
 
 enum class GVecRefFlags : uint8_t
@@ -2,10 +2,13 @@
 #include "XCompRely.h"
 #include "XCompDebug.h"
 #include "Nailang/NailangParser.h"
+#include "Nailang/NailangRope.h"
 #include "Nailang/NailangRuntime.h"
+#include "Nailang/NailangOptimizer.h"
 #include "common/CLikeConfig.hpp"
 
 #include <boost/container/small_vector.hpp>
+#include <unordered_map>
 
 
 namespace xcomp
@@ -59,7 +62,15 @@ class XCOMPBASAPI NamedTextHolder
 {
 private:
     common::StringPool<char32_t> Names;
+    std::unordered_multimap<uint64_t, common::StringPiece<char32_t>> NameIndex; // hash of interned names
     std::vector<std::pair<common::StringPiece<char32_t>, uint32_t>> Dependencies;
+    // names are interned, so the same name always gets the same piece
+    static constexpr uint64_t NameKey(const common::StringPiece<char32_t> piece) noexcept
+    {
+        return (static_cast<uint64_t>(piece.GetOffset()) << 32) | piece.GetLength();
+    }
+    [[nodiscard]] std::optional<common::StringPiece<char32_t>> FindName(std::u32string_view name) const noexcept;
+    [[nodiscard]] common::StringPiece<char32_t> InternName(std::u32string_view name);
 public:
     struct NamedText
     {
@@ -72,6 +83,19 @@ public:
         common::StringPiece<char32_t> IDStr;
         std::pair<uint32_t, uint32_t> Dependency = { 0,0 };
     };
+    class NamedTextList
+    {
+        friend NamedTextHolder;
+    private:
+        std::vector<NamedText> Items;
+        std::unordered_map<uint64_t, uint32_t> Index; // NameKey of id -> first item with the id
+    public:
+        [[nodiscard]] forceinline auto begin() const noexcept { return Items.cbegin(); }
+        [[nodiscard]] forceinline auto end() const noexcept { return Items.cend(); }
+        [[nodiscard]] forceinline size_t size() const noexcept { return Items.size(); }
+        [[nodiscard]] forceinline bool empty() const noexcept { return Items.empty(); }
+        [[nodiscard]] forceinline const NamedText& operator[](const size_t idx) const noexcept { return Items[idx]; }
+    };
     virtual ~NamedTextHolder();
 protected:
     forceinline std::u32string_view GetID(const NamedText& item) const noexcept
@@ -83,35 +107,27 @@ protected:
         Expects(idx < item.DependCount());
         return Names.GetStringView(Dependencies[(size_t)item.Dependency.first + idx].first);
     }
-    forceinline std::optional<uint32_t> SearchDepend(const std::vector<NamedText>& container, const NamedText& item, const uint32_t idx) const noexcept
+    forceinline std::optional<uint32_t> SearchDepend(const NamedTextList& container, const NamedText& item, const uint32_t idx) const noexcept
     {
         Expects(idx < item.DependCount());
         const auto [depStr, depIdx] = Dependencies[(size_t)item.Dependency.first + idx];
         if (depIdx != UINT32_MAX)
             return depIdx;
         // late bind dependency
-        const auto depName = Names.GetStringView(depStr);
-        for (uint32_t i = 0; i < container.size(); ++i)
-        {
-            if (GetID(container[i]) == depName)
-            {
-                return i;
-            }
-        }
+        if (const auto it = container.Index.find(NameKey(depStr)); it != container.Index.end())
+            return it->second;
         return {};
     }
-    forceinline std::optional<uint32_t> CheckExists(std::vector<NamedText>& container, std::u32string_view id) const noexcept
+    forceinline std::optional<uint32_t> CheckExists(const NamedTextList& container, std::u32string_view id) const noexcept
     {
-        uint32_t idx = 0;
-        for (const auto& item : container)
+        if (const auto name = FindName(id); name)
         {
-            if (GetID(item) == id)
-                return idx;
-            idx++;
+            if (const auto it = container.Index.find(NameKey(*name)); it != container.Index.end())
+                return it->second;
         }
         return {};
     }
-    forceinline bool Add(std::vector<NamedText>& container, std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends)
+    forceinline bool Add(NamedTextList& container, std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends)
     {
         // check exists
         if (CheckExists(container, id))
@@ -119,10 +135,10 @@ protected:
         ForceAdd(container, id, std::move(content), depends);
         return true;
     }
-    void ForceAdd(std::vector<NamedText>& container, std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends);
-    void Write(std::u32string& output, const std::vector<NamedText>& container) const;
+    void ForceAdd(NamedTextList& container, std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends);
+    void Write(xziar::nailang::TextRope& output, const NamedTextList& container) const;
 
-    virtual void Write(std::u32string& output, const NamedText& item) const;
+    virtual void Write(xziar::nailang::TextRope& output, const NamedText& item) const;
 };
 
 
@@ -140,20 +156,20 @@ public:
         return Add(BodySuffixes, id, content, depends);
     }
 
-    forceinline void WritePrefixes(std::u32string& output) const
+    forceinline void WritePrefixes(xziar::nailang::TextRope& output) const
     {
         Write(output, BodyPrefixes);
     }
-    forceinline void WriteSuffixes(std::u32string& output) const
+    forceinline void WriteSuffixes(xziar::nailang::TextRope& output) const
     {
         Write(output, BodySuffixes);
     }
 
     std::u32string_view InsatnceName;
-    std::u32string Content;
+    xziar::nailang::TextRope Content;
 protected:
-    std::vector<NamedText> BodyPrefixes;
-    std::vector<NamedText> BodySuffixes;
+    NamedTextList BodyPrefixes;
+    NamedTextList BodySuffixes;
 };
 
 
@@ -420,6 +436,7 @@ protected:
 public:
     XCNLExtension(XCNLContext& context);
     virtual ~XCNLExtension();
+    [[nodiscard]] virtual std::u32string_view GetName() const noexcept { return U"XCNLExtension"; }
     virtual void  BeginXCNL(XCNLRuntime&) { }
     virtual void FinishXCNL(XCNLRuntime&) { }
     virtual void  BeginInstance(XCNLRuntime&, InstanceContext&) { } 
@@ -433,6 +450,8 @@ public:
     {
         return {};
     }
+    // whether instances can be generated by forked runtimes, only when its states are per-instance or set by config blocks
+    [[nodiscard]] virtual bool SupportParallelInstance() const noexcept { return false; }
 
     using XCNLExtGen = std::unique_ptr<XCNLExtension>(*)(common::mlog::MiniLogger<false>&, XCNLContext&);
     template<typename T>
@@ -444,6 +463,8 @@ private:
     static uintptr_t RegExt(XCNLExtGen creator) noexcept;
 };
 #define XCNL_EXT_FUNC(type, ...)                                    \
+    [[nodiscard]] std::u32string_view GetName() const noexcept      \
+        override { return U"" #type; }                              \
     static std::unique_ptr<XCNLExtension> Create(                   \
         [[maybe_unused]] common::mlog::MiniLogger<false>& logger,   \
         [[maybe_unused]] xcomp::XCNLContext& context)               \
@@ -495,21 +516,47 @@ private:
             Expects(Idx == SIZE_MAX);
             Idx = Context.PatchedBlocks.size();
             if constexpr (std::is_base_of_v<DependBase, D>)
-                Context.ForceAdd(Context.PatchedBlocks, ID, std::forward<S>(content), depends.GetDependSpan());
+                Context.AddPatch(ID, std::forward<S>(content), depends.GetDependSpan());
             else if constexpr (std::is_same_v<ReplaceDepend, D>)
-                Context.ForceAdd(Context.PatchedBlocks, ID, std::forward<S>(content), depends.GetPatchedBlock().GetDependSpan());
+                Context.AddPatch(ID, std::forward<S>(content), depends.GetPatchedBlock().GetDependSpan());
             else if constexpr (std::is_convertible_v<D, std::u32string_view>)
             {
                 const std::u32string_view depend = depends;
                 if (depend.empty())
-                    Context.ForceAdd(Context.PatchedBlocks, ID, std::forward<S>(content), {});
+                    Context.AddPatch(ID, std::forward<S>(content), {});
                 else
-                    Context.ForceAdd(Context.PatchedBlocks, ID, std::forward<S>(content), { &depend, 1 });
+                    Context.AddPatch(ID, std::forward<S>(content), { &depend, 1 });
             }
             else
-                Context.ForceAdd(Context.PatchedBlocks, ID, std::forward<S>(content), depends);
+                Context.AddPatch(ID, std::forward<S>(content), depends);
         }
     };
+    // patch requests of a forked context, replayed by the main context to get the same patches in the same order
+    struct PatchEvent
+    {
+        enum class Types : uint8_t { Enter, Commit, Leave };
+        std::u32string ID; // for Enter
+        uint32_t Index;    // for Commit
+        Types Type;
+    };
+    class PatchLogScope
+    {
+    private:
+        std::vector<PatchEvent>* Log;
+    public:
+        PatchLogScope(XCNLContext& ctx, std::u32string_view id) : Log(ctx.RecordPatch ? &ctx.PatchLog : nullptr)
+        {
+            if (Log)
+                Log->push_back({ std::u32string(id), 0, PatchEvent::Types::Enter });
+        }
+        ~PatchLogScope()
+        {
+            if (Log)
+                Log->push_back({ {}, 0, PatchEvent::Types::Leave });
+        }
+        COMMON_NO_COPY(PatchLogScope)
+        COMMON_NO_MOVE(PatchLogScope)
+    };
 public:
     XCNLContext(const common::CLikeDefines& info);
     ~XCNLContext() override;
@@ -519,26 +566,27 @@ public:
         if (const auto idx = CheckExists(PatchedBlocks, id); idx)
             return PatchResult{ this, *idx, false };
         using R = std::decay_t<std::invoke_result_t<F, Args...>>;
+        PatchLogScope logScope(*this, id);
         auto ret = generator(std::forward<Args>(args)...);
         if constexpr (std::is_convertible_v<R, std::u32string_view>)
-            ForceAdd(PatchedBlocks, id, std::move(ret), {});
+            AddPatch(id, std::move(ret), {});
         else if constexpr (common::is_specialization<R, std::pair>::value)
         {
             static_assert(std::is_convertible_v<typename R::first_type, std::u32string_view>, "need return pair<str,str[]>");
             if constexpr (std::is_base_of_v<DependBase, std::decay_t<typename R::second_type>>)
             {
                 auto depends = ret.second.GetDependSpan();
-                ForceAdd(PatchedBlocks, id, std::move(ret.first), depends);
+                AddPatch(id, std::move(ret.first), depends);
             }
             else if constexpr (std::is_same_v<ReplaceDepend, std::decay_t<typename R::second_type>>)
             {
                 auto depends = ret.second.GetPatchedBlock().GetDependSpan();
-                ForceAdd(PatchedBlocks, id, std::move(ret.first), depends);
+                AddPatch(id, std::move(ret.first), depends);
             }
             else if constexpr (std::is_convertible_v<typename R::second_type, std::u32string_view>)
-                ForceAdd(PatchedBlocks, id, std::move(ret.first), std::array<std::u32string_view, 1>{ret.second});
+                AddPatch(id, std::move(ret.first), std::array<std::u32string_view, 1>{ret.second});
             else
-                ForceAdd(PatchedBlocks, id, std::move(ret.first), ret.second);
+                AddPatch(id, std::move(ret.first), ret.second);
         }
         else
             static_assert(common::AlwaysTrue<R>, "need return str or pair<str,str[]>");
@@ -550,10 +598,11 @@ public:
         if (const auto idx = CheckExists(PatchedBlocks, id); idx)
             return PatchResult{ this, *idx, false };
         PatchSession session(*this, id);
+        PatchLogScope logScope(*this, id);
         generator(session, std::forward<Args>(args)...);
         return PatchResult{ this, session.Idx, true };
     }
-    forceinline void WritePatchedBlock(std::u32string& output) const
+    forceinline void WritePatchedBlock(xziar::nailang::TextRope& output) const
     {
         NamedTextHolder::Write(output, PatchedBlocks);
     }
@@ -566,13 +615,19 @@ protected:
     std::vector<std::unique_ptr<XCNLExtension>> Extensions;
     std::vector<OutputBlock> OutputBlocks;
     std::vector<OutputBlock> TemplateBlocks;
-    std::vector<NamedText> PatchedBlocks;
+    NamedTextList PatchedBlocks;
     std::vector<std::unique_ptr<XCNLStruct>> CustomStructs;
+    std::vector<PatchEvent> PatchLog;
+    bool RecordPatch = false;
+    bool InstanceOnly = false; // only collect instance and template blocks, used by forks
     [[nodiscard]] size_t FindStruct(std::u32string_view name) const;
+    void AddPatch(std::u32string_view id, common::str::StrVariant<char32_t> content, U32StrSpan depends);
+    // add patches of a forked context, as if its patch requests were made on this context
+    void MergePatches(const XCNLContext& fork);
 private:
     COMMON_NO_COPY(XCNLContext)
     [[nodiscard]] XCNLExtension* FindExt(std::function<bool(const XCNLExtension*)> func) const;
-    void Write(std::u32string& output, const NamedText& item) const override;
+    void Write(xziar::nailang::TextRope& output, const NamedText& item) const override;
 };
 
 
@@ -596,12 +651,19 @@ protected:
 
     [[nodiscard]] virtual OutputBlock::BlockType GetBlockType(const RawBlock& block, MetaFuncs metas) const noexcept;
     virtual void HandleInstanceArg(const InstanceArgInfo& arg, InstanceContext& ctx, const xziar::nailang::FuncPack& meta, const xziar::nailang::Arg* source);
-    virtual void BeforeFinishOutput(std::u32string& prefixes, std::u32string& structs, std::u32string& globals, std::u32string& kernels);
+    virtual void BeforeFinishOutput(xziar::nailang::TextRope& prefixes, xziar::nailang::TextRope& structs, xziar::nailang::TextRope& globals, xziar::nailang::TextRope& kernels);
+    [[nodiscard]] virtual bool SupportParallelInstance() const noexcept;
+    // merge states produced by a forked runtime during its instances, patches are merged by the context
+    virtual void MergeFork(XCNLRuntime& fork);
 private:
     virtual XCNLConfigurator& GetConfigurator() noexcept = 0;
     virtual XCNLRawExecutor& GetRawExecutor() noexcept = 0;
     virtual XCNLStructHandler& GetStructHandler() noexcept = 0;
     InstanceArgData ParseInstanceArg(std::u32string_view argTypeName, xziar::nailang::FuncPack& func);
+    void OutputCommon(xziar::nailang::TextRope& prefixes, xziar::nailang::TextRope& structs, xziar::nailang::TextRope& globals);
+    // output instance blocks in [begin, end) of all instance blocks
+    void OutputInstances(size_t begin, size_t end, xziar::nailang::TextRope& kernels);
+    std::string FinishOutput(xziar::nailang::TextRope& prefixes, xziar::nailang::TextRope& structs, xziar::nailang::TextRope& globals, xziar::nailang::TextRope& kernels);
 public:
     ~XCNLRuntime() override;
     COMMON_NO_COPY(XCNLRuntime)
@@ -708,7 +770,7 @@ private:
     [[nodiscard]] virtual const XCNLExecutor& GetExecutor() const noexcept = 0;
     [[nodiscard]] virtual XCNLExecutor& GetExecutor() noexcept = 0;
     [[nodiscard]] virtual std::unique_ptr<InstanceContext> PrepareInstance(const OutputBlock& block) = 0;
-    virtual void OutputInstance(const OutputBlock& block, std::u32string& dst) = 0;
+    virtual void OutputInstance(const OutputBlock& block, xziar::nailang::TextRope& dst) = 0;
 protected:
     struct InstanceFrame : public xziar::nailang::NailangRawBlockFrame
     {
@@ -732,26 +794,26 @@ protected:
         return GetExecutor().GetExtensions();
     }
     [[nodiscard]] InstanceContext& GetInstanceInfo() const;
-    static void OutputConditions(common::span<const xziar::nailang::FuncCall> metas, std::u32string& dst);
+    static void OutputConditions(common::span<const xziar::nailang::FuncCall> metas, xziar::nailang::TextRope& dst);
     [[nodiscard]] xziar::nailang::NailangFrameStack::FrameHolder<xziar::nailang::NailangRawBlockFrame> PushFrame(
         const OutputBlock& block, std::shared_ptr<xziar::nailang::EvaluateContext> ctx, InstanceContext* instance = nullptr);
     [[nodiscard]] bool HandleInstanceMeta(xziar::nailang::FuncPack& meta);
     [[nodiscard]] std::optional<common::str::StrVariant<char32_t>> CommonReplaceFunc(const std::u32string_view name,
         const std::u32string_view call, U32StrSpan args);
     [[nodiscard]] ReplaceResult ExtensionReplaceFunc(std::u32string_view func, U32StrSpan args);
-    void BeforeOutputBlock(const OutputBlock& block, std::u32string& dst) const;
-    void DirectOutput(const OutputBlock& block, std::u32string& dst);
+    void BeforeOutputBlock(const OutputBlock& block, xziar::nailang::TextRope& dst) const;
+    void DirectOutput(const OutputBlock& block, xziar::nailang::TextRope& dst);
 
-    void OnReplaceOptBlock(std::u32string& output, void* cookie, std::u32string_view cond, std::u32string_view content) final;
-    void OnReplaceVariable(std::u32string& output, void* cookie, std::u32string_view var) final;
-    void OnReplaceFunction(std::u32string& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args) override;
+    void OnReplaceOptBlock(xziar::nailang::TextRope& output, void* cookie, std::u32string_view cond, std::u32string_view content) final;
+    void OnReplaceVariable(xziar::nailang::TextRope& output, void* cookie, std::u32string_view var) final;
+    void OnReplaceFunction(xziar::nailang::TextRope& output, void* cookie, std::u32string_view func, common::span<const std::u32string_view> args) override;
 public:
     ~XCNLRawExecutor() override;
     void ThrowByReplacerArgCount(const std::u32string_view call, const U32StrSpan args,
         const size_t count, const xziar::nailang::ArgLimits limit = xziar::nailang::ArgLimits::Exact) const;
-    virtual void ProcessGlobal(const OutputBlock& block, std::u32string& output);
-    virtual void ProcessStruct(const OutputBlock& block, std::u32string& output);
-    void ProcessInstance(const OutputBlock& block, std::u32string& output);
+    virtual void ProcessGlobal(const OutputBlock& block, xziar::nailang::TextRope& output);
+    virtual void ProcessStruct(const OutputBlock& block, xziar::nailang::TextRope& output);
+    void ProcessInstance(const OutputBlock& block, xziar::nailang::TextRope& output);
     [[noreturn]] void HandleException(const xziar::nailang::NailangParseException& ex) const final;
     [[noreturn]] void HandleException(const xziar::nailang::NailangRuntimeException& ex) const;
     [[nodiscard]] XCNLRuntime& GetRuntime() const noexcept 
@@ -815,6 +877,7 @@ protected:
     std::u32string Source;
     std::u16string FileName;
     xziar::nailang::Block Program;
+    xziar::nailang::NailangOptStats OptStats;
     using ExtGen = std::function<std::unique_ptr<XCNLExtension>(common::mlog::MiniLogger<false>&, XCNLContext&)>;
     std::vector<ExtGen> ExtraExtension;
     XCNLProgram(std::u32string source, std::u16string fname) : 
@@ -833,6 +896,7 @@ public:
     }
 
     [[nodiscard]] constexpr const xziar::nailang::Block& GetProgram() const noexcept { return Program; }
+    [[nodiscard]] constexpr const xziar::nailang::NailangOptStats& GetOptStats() const noexcept { return OptStats; }
 
     [[nodiscard]] XCOMPBASAPI static std::shared_ptr<XCNLProgram> Create(std::u32string source, std::u16string fname);
     template<typename T>
@@ -840,6 +904,10 @@ public:
     {
         auto prog = Create_(std::move(source), std::move(fname));
         T::GetBlock(prog->MemPool, prog->Source, prog->FileName, prog->Program);
+        // fold config-dependent constants once, instead of every time the blocks are executed
+        xziar::nailang::NailangOptimizer optimizer(prog->MemPool);
+        optimizer.OptimizeProgram(prog->Program);
+        prog->OptStats = optimizer.GetStats();
         return prog;
     }
 };
@@ -854,10 +922,22 @@ protected:
     std::shared_ptr<const XCNLProgram> Program;
     std::shared_ptr<XCNLContext> Context;
     std::unique_ptr<XCNLRuntime> Runtime;
+    std::unique_ptr<xziar::nailang::NailangProfiler> Profiler;
+    common::fs::path ProfileOutput;
+    uint32_t Parallelism = 1;
+    [[nodiscard]] common::mlog::MiniLogger<false>& GetLogger() const noexcept;
     void ExecuteBlocks(const std::u32string_view type) const;
     void Prepare(common::span<const std::u32string_view> types) const;
     void Collect(common::span<const std::u32string_view> prefixes) const;
     void PostAct(common::span<const std::u32string_view> types) const;
+    // create an unconfigured stub over the same program with a fresh context and the given logger, nullptr if not supported
+    [[nodiscard]] virtual std::unique_ptr<XCNLProgStub> Fork(common::mlog::MiniLogger<false>& logger) const;
+    /**
+     * @brief generate output, instance blocks are split among forked stubs when parallelism is enabled and supported
+     * @param configurer replays the configuration (Prepare/Collect) done on this stub onto a fork,
+     *        forks only collect instance and template blocks, and their logs are muted meanwhile
+    */
+    [[nodiscard]] std::string GenerateOutput(const std::function<void(XCNLProgStub&)>& configurer);
 public:
     XCNLProgStub(const std::shared_ptr<const XCNLProgram>& program, std::shared_ptr<XCNLContext>&& context, std::unique_ptr<XCNLRuntime>&& runtime);
     XCNLProgStub(XCNLProgStub&&) = default;
@@ -875,6 +955,23 @@ public:
     {
         return *Runtime;
     }
+    /**
+     * @brief attach a profiler to the runtime, also enabled by env [XCNL_PROFILE]
+     * @param output file to write folded stacks, empty to only print to logger
+    */
+    xziar::nailang::NailangProfiler& EnableProfiler(common::fs::path output = {});
+    [[nodiscard]] const xziar::nailang::NailangProfiler* GetProfiler() const noexcept
+    {
+        return Profiler.get();
+    }
+    // print profile to the debug channel, also write folded stacks if required
+    void ReportProfile() const;
+    /**
+     * @brief set threads used to generate instance blocks, also set by env [XCNL_THREADS]
+     * @param threads 1 to disable, 0 to use hardware concurrency
+    */
+    void SetParallelism(uint32_t threads) noexcept;
+    [[nodiscard]] constexpr uint32_t GetParallelism() const noexcept { return Parallelism; }
 };
 
 
@@ -147,16 +147,18 @@ struct PreHashed
 };
 
 
-template<typename Ch>
-struct HashedStrView : public PreHashed<DJBHash>
+// Hasher can be a runtime one (e.g, FastStrHash from SystemCommon), then it's no longer constexpr
+template<typename Ch, typename Hasher = DJBHash>
+struct HashedStrView : public PreHashed<Hasher>
 {
+    using PreHashed<Hasher>::Hash;
     std::basic_string_view<Ch> View;
     constexpr HashedStrView() noexcept : 
-        PreHashed(DJBHash::HashC(std::basic_string_view<Ch>{})), View{} { }
+        PreHashed<Hasher>(Hasher::HashC(std::basic_string_view<Ch>{})), View{} { }
     constexpr HashedStrView(std::basic_string_view<Ch> str) noexcept : 
-        PreHashed(DJBHash::HashC(str)), View(str) { }
+        PreHashed<Hasher>(Hasher::HashC(str)), View(str) { }
     constexpr explicit HashedStrView(const uint64_t hash, std::basic_string_view<Ch> str) noexcept :
-        PreHashed(hash), View(str) { }
+        PreHashed<Hasher>(hash), View(str) { }
     constexpr operator std::basic_string_view<Ch>() const noexcept 
     { 
         return View;
@@ -165,9 +167,9 @@ struct HashedStrView : public PreHashed<DJBHash>
     { 
         return View == other;
     }
-    constexpr bool operator==(const HashedStrView<Ch>& other) const noexcept 
+    constexpr bool operator==(const HashedStrView<Ch, Hasher>& other) const noexcept 
     { 
-        return Hash == other.Hash && View == other;
+        return Hash == other.Hash && View == other.View;
     }
 };
 
@@ -11,7 +11,7 @@ namespace common
 
 template<typename T>
 class StringPool;
-template<typename T>
+template<typename T, typename Hasher>
 class HashedStringPool;
 
 
@@ -19,7 +19,7 @@ template<typename T>
 class StringPiece
 {
     friend StringPool<T>;
-    friend HashedStringPool<T>;
+    template<typename, typename> friend class HashedStringPool;
     uint32_t Offset, Length;
 public:
     constexpr StringPiece() noexcept : Offset(0), Length(0) {}
@@ -84,7 +84,7 @@ public:
     forceinline std::basic_string_view<T> GetAllStr() const noexcept { return { Pool.data(), Pool.size() }; }
 };
 
-template<typename T>
+template<typename T, typename Hasher = DJBHash>
 class HashedStringPool : protected StringPool<T>
 {
 private:
@@ -93,7 +93,7 @@ private:
     static constexpr size_t UnitCount = sizeof(uint64_t) / sizeof(T);
     static constexpr size_t SizeMask = ~(UnitCount - 1);
 public:
-    StringPiece<T> AllocateString(const str::HashedStrView<T>& str)
+    StringPiece<T> AllocateString(const str::HashedStrView<T, Hasher>& str)
     {
         const auto view = str.View;
         const auto padding = ((view.size() + UnitCount - 1) & SizeMask) - view.size();
@@ -107,12 +107,12 @@ public:
             this->Pool.insert(this->Pool.end(), padding, static_cast<T>('\0'));
         return { offset, size };
     }
-    str::HashedStrView<T> GetHashedStr(StringPiece<T> piece) const noexcept
+    str::HashedStrView<T, Hasher> GetHashedStr(StringPiece<T> piece) const noexcept
     {
         if (piece.Length == 0) return {};
         Expects(piece.Offset >= UnitCount && (piece.Offset % UnitCount == 0));
         const auto* ptr = reinterpret_cast<const uint64_t*>(&this->Pool[piece.Offset - UnitCount]);
-        return str::HashedStrView<T>{ *ptr, { &this->Pool[piece.Offset], piece.Length } };
+        return str::HashedStrView<T, Hasher>{ *ptr, { &this->Pool[piece.Offset], piece.Length } };
     }
     using StringPool<T>::GetStringView;
     using StringPool<T>::IsEmpty;